@@ -152,8 +152,9 @@ def makecmds(args):
         if args.verbose:
             print("Running %i procs for each of %i topologies" % (procs_per_topology, len(args.topologies)))
 
-    # build a command for each proc, or each topology if its more
-    for topology in args.topologies:
+    # build a command for each topology, which loads it once and
+    # then forks its share of the procs to run the scenarios
+    for i, topology in enumerate(args.topologies):
         startnum = args.start # reset for each topology
 
         # determine how many procs for this topology
@@ -162,60 +163,50 @@ def makecmds(args):
             numprocs += 1
             remainder_procs_per_topology -= 1
 
-        # set nruns for each proc in this topology
-        runs_per_proc = args.runs/numprocs
-        remainder_runs_per_proc = args.runs % numprocs
+        cmd = "./waf --run %s --command-template='" % 'geocron-example' #was 'ron'
+        if args.debug:
+            cmd += "gdb --args "
+        cmd += r'%s '
 
-        for i in range(numprocs):
-            nruns = runs_per_proc
-            if remainder_runs_per_proc:
-                nruns += 1
-                remainder_runs_per_proc -= 1
+        # first, ns3 typeId system configurations
+        cmd += '--ns3::GeocronExperiment::TopologyType=%s ' % args.topology_type
 
-            cmd = "./waf --run %s --command-template='" % 'geocron-example' #was 'ron'
-            if args.debug:
-                cmd += "gdb --args "
-            cmd += r'%s '
+        # individual parameters
+        if args.disasters != default_disasters:
+            disasters = ('"%s"' % '-'.join(args.disasters))
+        else:
+            disasters = default_disasters[topology]
+        cmd += '--disaster=%s ' % disasters
 
-            # first, ns3 typeId system configurations
-            cmd += '--ns3::GeocronExperiment::TopologyType=%s ' % args.topology_type
-
-            # individual parameters
-            if args.disasters != default_disasters:
-                disasters = ('"%s"' % '-'.join(args.disasters))
-            else:
-                disasters = default_disasters[topology]
-            cmd += '--disaster=%s ' % disasters
-
-            #TODO: brite topologies too
-            #cmd += '--file=rocketfuel/maps/%s.cch ' % topology
-            
-            # instead, this hack lets us put the different runs in the same directory,
-            # but separate different processes since they will have different topologies 
-            cmd += '--file=%s ' % i
-
-            cmd += '--fail_prob=%s ' % fprobs
-            cmd += '--runs=%i ' % nruns
-            cmd += '--start_run=%i ' % startnum
-            cmd += '--heuristic=%s ' % heuristics
+        #TODO: brite topologies too
+        #cmd += '--file=rocketfuel/maps/%s.cch ' % topology
+        
+        # instead, this hack lets us put the different runs in the same directory,
+        # but separate different processes since they will have different topologies 
+        cmd += '--file=%s ' % i
 
-            # static args
-            cmd += "--latencies=rocketfuel/weights/all_latencies.intra "
-            cmd += "--locations=rocketfuel/city_locations.txt "
-            cmd += "--contact_attempts=20 --timeout=0.5"
+        cmd += '--fail_prob=%s ' % fprobs
+        cmd += '--runs=%i ' % args.runs
+        cmd += '--start_run=%i ' % startnum
+        if numprocs > 1:
+            cmd += '--nprocs=%i ' % numprocs
+        cmd += '--heuristic=%s ' % heuristics
 
-            ## $$$$ NO LONGER ASSUME SPACES " " AFTER COMMANDS!
+        # static args
+        cmd += "--latencies=rocketfuel/weights/all_latencies.intra "
+        cmd += "--locations=rocketfuel/city_locations.txt "
+        cmd += "--contact_attempts=20 --timeout=0.5"
 
-            if args.verbose:
-                cmd += ' --verbose=%i' % args.verbose
-            cmd += "'" #terminate command template (non-waf args)
+        ## $$$$ NO LONGER ASSUME SPACES " " AFTER COMMANDS!
 
-            if args.visualize:
-                cmd += ' --visualize'
+        if args.verbose:
+            cmd += ' --verbose=%i' % args.verbose
+        cmd += "'" #terminate command template (non-waf args)
 
-            startnum += nruns
+        if args.visualize:
+            cmd += ' --visualize'
 
-            yield cmd
+        yield cmd
 
 # Main
 if __name__ == "__main__":
@@ -0,0 +1,106 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ATOMIC_COUNT_H
+#define ATOMIC_COUNT_H
+
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup core
+ * \brief counters shared by the threads of a parallel simulation
+ *
+ * Reference counts, and the other counters of objects which events running
+ * on different threads may share, are updated with atomic instructions
+ * while a simulator implementation runs events on several threads, and
+ * with plain ones otherwise, so that sequential simulations only pay for
+ * one predictable branch.
+ *
+ * The code which keeps objects in free lists, or lets copies of an object
+ * write to shared storage when it knows no other copy reads that part of
+ * it, also checks IsThreaded and doesn't do so while it is true.
+ */
+class AtomicCount
+{
+public:
+  /**
+   * \param threaded whether events may run on several threads from now on
+   *
+   * Must only be called while no event runs.
+   */
+  static void SetThreaded (bool threaded);
+  /**
+   * \returns true if events may be running on several threads
+   */
+  static bool IsThreaded (void);
+  static void Increment (uint32_t &count);
+  /**
+   * \returns the count after decrementing it
+   */
+  static uint32_t Decrement (uint32_t &count);
+  /**
+   * \returns the count before incrementing it
+   */
+  static uint32_t FetchAndIncrement (uint32_t &count);
+
+private:
+  static bool g_threaded;
+};
+
+inline bool
+AtomicCount::IsThreaded (void)
+{
+  return g_threaded;
+}
+
+inline void
+AtomicCount::Increment (uint32_t &count)
+{
+  if (g_threaded)
+    {
+      __sync_fetch_and_add (&count, 1);
+    }
+  else
+    {
+      count++;
+    }
+}
+
+inline uint32_t
+AtomicCount::Decrement (uint32_t &count)
+{
+  if (g_threaded)
+    {
+      return __sync_sub_and_fetch (&count, 1);
+    }
+  return --count;
+}
+
+inline uint32_t
+AtomicCount::FetchAndIncrement (uint32_t &count)
+{
+  if (g_threaded)
+    {
+      return __sync_fetch_and_add (&count, 1);
+    }
+  return count++;
+}
+
+} // namespace ns3
+
+#endif /* ATOMIC_COUNT_H */
@@ -25,6 +25,9 @@
 
 #include "ptr.h"
 #include "pointer.h"
+#include "double.h"
+#include "uinteger.h"
+#include "string.h"
 #include "assert.h"
 #include "log.h"
 
@@ -46,6 +49,25 @@ DefaultSimulatorImpl::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::DefaultSimulatorImpl")
     .SetParent<SimulatorImpl> ()
     .AddConstructor<DefaultSimulatorImpl> ()
+    .AddAttribute ("CompactionRatio",
+                   "Fraction of the events in the event list which may be cancelled "
+                   "before they are all removed from it at once.",
+                   DoubleValue (0.5),
+                   MakeDoubleAccessor (&DefaultSimulatorImpl::m_compactionRatio),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("CompactionMinEvents",
+                   "Number of cancelled events below which they are never removed "
+                   "from the event list at once.",
+                   UintegerValue (1024),
+                   MakeUintegerAccessor (&DefaultSimulatorImpl::m_compactionMinEvents),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ProfileFile",
+                   "Name of the file to which the time taken and the events scheduled "
+                   "by each type of event, in total and for each node, are written "
+                   "at Simulator::Destroy.  Events are not profiled if it is empty.",
+                   StringValue (""),
+                   MakeStringAccessor (&DefaultSimulatorImpl::m_profileFile),
+                   MakeStringChecker ())
   ;
   return tid;
 }
@@ -64,6 +86,9 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
   m_currentTs = 0;
   m_currentContext = 0xffffffff;
   m_unscheduledEvents = 0;
+  m_cancelledEvents = 0;
+  m_compactions = 0;
+  m_profiler = 0;
   m_eventsWithContextEmpty = true;
   m_main = SystemThread::Self();
 }
@@ -71,12 +96,14 @@ DefaultSimulatorImpl::DefaultSimulatorImpl ()
 DefaultSimulatorImpl::~DefaultSimulatorImpl ()
 {
   NS_LOG_FUNCTION (this);
+  delete m_profiler;
 }
 
 void
 DefaultSimulatorImpl::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  NS_LOG_INFO ("cancelled ratio " << GetCancelledRatio () << " after " << m_compactions << " compactions");
   while (!m_events->IsEmpty ())
     {
       Scheduler::Event next = m_events->RemoveNext ();
@@ -99,6 +126,12 @@ DefaultSimulatorImpl::Destroy ()
           ev->Invoke ();
         }
     }
+  if (m_profiler != 0)
+    {
+      m_profiler->Write (m_profileFile);
+      delete m_profiler;
+      m_profiler = 0;
+    }
 }
 
 void
@@ -133,11 +166,27 @@ DefaultSimulatorImpl::ProcessOneEvent (void)
   NS_ASSERT (next.key.m_ts >= m_currentTs);
   m_unscheduledEvents--;
 
+  if (m_cancelledEvents > 0 && next.impl->IsCancelled ())
+    {
+      m_cancelledEvents--;
+    }
+
   NS_LOG_LOGIC ("handle " << next.key.m_ts);
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  if (m_profiler == 0 || next.impl->IsCancelled ())
+    {
+      next.impl->Invoke ();
+    }
+  else
+    {
+      uint32_t uid = m_uid;
+      EventProfiler::Function function = EventProfiler::GetFunction (next.impl);
+      uint64_t start = EventProfiler::GetTimeNs ();
+      next.impl->Invoke ();
+      m_profiler->Record (function, next.key.m_context, EventProfiler::GetTimeNs () - start, m_uid - uid);
+    }
   next.impl->Unref ();
 
   ProcessEventsWithContext ();
@@ -185,6 +234,10 @@ DefaultSimulatorImpl::Run (void)
   NS_LOG_FUNCTION (this);
   // Set the current threadId as the main threadId
   m_main = SystemThread::Self();
+  if (m_profiler == 0 && !m_profileFile.empty ())
+    {
+      m_profiler = new EventProfiler ();
+    }
   ProcessEventsWithContext ();
   m_stop = false;
 
@@ -350,10 +403,66 @@ DefaultSimulatorImpl::Remove (const EventId &id)
 void
 DefaultSimulatorImpl::Cancel (const EventId &id)
 {
-  if (!IsExpired (id))
+  if (IsExpired (id))
+    {
+      return;
+    }
+  if (id.GetUid () == 2)
     {
       id.PeekEventImpl ()->Cancel ();
+      return;
     }
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  event.impl->Cancel ();
+  if (m_events->TryRemove (event))
+    {
+      event.impl->Unref ();
+      m_unscheduledEvents--;
+      return;
+    }
+  m_cancelledEvents++;
+  if (m_cancelledEvents >= m_compactionMinEvents
+      && m_cancelledEvents > m_compactionRatio * m_unscheduledEvents)
+    {
+      Compact ();
+    }
+}
+
+void
+DefaultSimulatorImpl::Compact (void)
+{
+  NS_LOG_FUNCTION (this << m_cancelledEvents << m_unscheduledEvents);
+  std::vector<Scheduler::Event> cancelled;
+  m_events->RemoveCancelled (cancelled);
+  for (std::vector<Scheduler::Event>::const_iterator i = cancelled.begin (); i != cancelled.end (); i++)
+    {
+      i->impl->Unref ();
+    }
+  m_unscheduledEvents -= cancelled.size ();
+  m_cancelledEvents = 0;
+  m_compactions++;
+}
+
+double
+DefaultSimulatorImpl::GetCancelledRatio (void) const
+{
+  return m_unscheduledEvents == 0 ? 0 : double (m_cancelledEvents) / m_unscheduledEvents;
+}
+
+uint32_t
+DefaultSimulatorImpl::GetCompactions (void) const
+{
+  return m_compactions;
+}
+
+const EventProfiler *
+DefaultSimulatorImpl::GetProfiler (void) const
+{
+  return m_profiler;
 }
 
 bool
@@ -24,12 +24,14 @@
 #include "simulator-impl.h"
 #include "scheduler.h"
 #include "event-impl.h"
+#include "event-profiler.h"
 #include "system-thread.h"
 #include "ns3/system-mutex.h"
 
 #include "ptr.h"
 
 #include <list>
+#include <string>
 
 namespace ns3 {
 
@@ -60,10 +62,28 @@ public:
   virtual uint32_t GetSystemId (void) const; 
   virtual uint32_t GetContext (void) const;
 
+  /**
+   * \returns the fraction of the events in the event list which have been
+   *      cancelled but not yet removed from it
+   */
+  double GetCancelledRatio (void) const;
+  /**
+   * \returns the number of times the cancelled events have been removed
+   *      from the event list together since the simulator was created
+   */
+  uint32_t GetCompactions (void) const;
+  /**
+   * \returns the profile of the events run so far, or zero if the
+   *      ProfileFile attribute is empty
+   */
+  const EventProfiler *GetProfiler (void) const;
+
 private:
   virtual void DoDispose (void);
   void ProcessOneEvent (void);
   void ProcessEventsWithContext (void);
+  /** Remove the cancelled events from the event list. */
+  void Compact (void);
  
   struct EventWithContext {
     uint32_t context;
@@ -87,6 +107,16 @@ private:
   // number of events that have been inserted but not yet scheduled,
   // not counting the "destroy" events; this is used for validation
   int m_unscheduledEvents;
+  // number of those events which have been cancelled but which the
+  // scheduler couldn't remove right away
+  uint32_t m_cancelledEvents;
+  double m_compactionRatio;
+  uint32_t m_compactionMinEvents;
+  uint32_t m_compactions;
+
+  // created by Run if m_profileFile is set, written and deleted by Destroy
+  EventProfiler *m_profiler;
+  std::string m_profileFile;
 
   SystemThread::ThreadId m_main;
 };
@@ -18,20 +18,198 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 
+#include "ns3/core-config.h"
 #include "event-impl.h"
 #include "log.h"
+#include <new>
+#ifdef HAVE_PTHREAD_H
+#include <pthread.h>
+#endif /* HAVE_PTHREAD_H */
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
 namespace ns3 {
 
+namespace {
+
+const std::size_t BLOCK_ALIGN = 16;
+const std::size_t MAX_BLOCK_SIZE = 256;
+const uint32_t N_BLOCK_SIZES = MAX_BLOCK_SIZE / BLOCK_ALIGN;
+const std::size_t SLAB_SIZE = 16384;
+
+struct FreeBlock
+{
+  FreeBlock *next;
+};
+
+/** The free blocks and counters of one thread. */
+struct EventPool
+{
+  FreeBlock *free[N_BLOCK_SIZES];
+  EventImpl::PoolStats stats;
+  /** in the list of all the pools */
+  EventPool *next;
+  /** in the list of the pools left by threads which have exited */
+  EventPool *nextOrphan;
+};
+
+EventPool *g_pools = 0;
+EventPool *g_orphans = 0;
+
+#ifdef HAVE_PTHREAD_H
+__thread EventPool *g_pool = 0;
+pthread_mutex_t g_poolsMutex = PTHREAD_MUTEX_INITIALIZER;
+pthread_once_t g_poolKeyOnce = PTHREAD_ONCE_INIT;
+pthread_key_t g_poolKey;
+
+/** Called when a thread exits, so that the next thread started reuses its blocks. */
+void
+ReleasePool (void *pool)
+{
+  g_pool = 0;
+  pthread_mutex_lock (&g_poolsMutex);
+  static_cast<EventPool *> (pool)->nextOrphan = g_orphans;
+  g_orphans = static_cast<EventPool *> (pool);
+  pthread_mutex_unlock (&g_poolsMutex);
+}
+
+void
+CreatePoolKey (void)
+{
+  pthread_key_create (&g_poolKey, &ReleasePool);
+}
+#else /* HAVE_PTHREAD_H */
+EventPool *g_pool = 0;
+#endif /* HAVE_PTHREAD_H */
+
+EventPool *
+AcquirePool (void)
+{
+#ifdef HAVE_PTHREAD_H
+  pthread_once (&g_poolKeyOnce, &CreatePoolKey);
+  pthread_mutex_lock (&g_poolsMutex);
+#endif /* HAVE_PTHREAD_H */
+  EventPool *pool = g_orphans;
+  if (pool != 0)
+    {
+      g_orphans = pool->nextOrphan;
+    }
+  else
+    {
+      // pools are never freed, as events may be freed at any time, even
+      // after the simulator and the thread which allocated them are gone
+      pool = new EventPool ();
+      pool->next = g_pools;
+      g_pools = pool;
+    }
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_unlock (&g_poolsMutex);
+  pthread_setspecific (g_poolKey, pool);
+#endif /* HAVE_PTHREAD_H */
+  return pool;
+}
+
+inline EventPool *
+GetPool (void)
+{
+  if (g_pool == 0)
+    {
+      g_pool = AcquirePool ();
+    }
+  return g_pool;
+}
+
+/** Carve a new slab into free blocks of the given size class. */
+FreeBlock *
+Refill (EventPool *pool, uint32_t sizeClass)
+{
+  std::size_t blockSize = (sizeClass + 1) * BLOCK_ALIGN;
+  char *slab = static_cast<char *> (::operator new (SLAB_SIZE));
+  FreeBlock *head = 0;
+  for (std::size_t offset = SLAB_SIZE - SLAB_SIZE % blockSize; offset != 0; )
+    {
+      offset -= blockSize;
+      FreeBlock *block = reinterpret_cast<FreeBlock *> (slab + offset);
+      block->next = head;
+      head = block;
+    }
+  pool->stats.slabs++;
+  pool->stats.slabBytes += SLAB_SIZE;
+  return head;
+}
+
+} // anonymous namespace
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  EventPool *pool = GetPool ();
+  if (size > MAX_BLOCK_SIZE)
+    {
+      pool->stats.largeAllocations++;
+      return ::operator new (size);
+    }
+  uint32_t sizeClass = (size - 1) / BLOCK_ALIGN;
+  FreeBlock *block = pool->free[sizeClass];
+  if (block == 0)
+    {
+      block = Refill (pool, sizeClass);
+    }
+  pool->free[sizeClass] = block->next;
+  pool->stats.allocations++;
+  return block;
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  if (p == 0)
+    {
+      return;
+    }
+  if (size > MAX_BLOCK_SIZE)
+    {
+      ::operator delete (p);
+      return;
+    }
+  EventPool *pool = GetPool ();
+  uint32_t sizeClass = (size - 1) / BLOCK_ALIGN;
+  FreeBlock *block = static_cast<FreeBlock *> (p);
+  block->next = pool->free[sizeClass];
+  pool->free[sizeClass] = block;
+  pool->stats.frees++;
+}
+
+EventImpl::PoolStats
+EventImpl::GetPoolStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  PoolStats total = { 0, 0, 0, 0, 0 };
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_lock (&g_poolsMutex);
+#endif /* HAVE_PTHREAD_H */
+  for (EventPool *pool = g_pools; pool != 0; pool = pool->next)
+    {
+      total.allocations += pool->stats.allocations;
+      total.frees += pool->stats.frees;
+      total.largeAllocations += pool->stats.largeAllocations;
+      total.slabs += pool->stats.slabs;
+      total.slabBytes += pool->stats.slabBytes;
+    }
+#ifdef HAVE_PTHREAD_H
+  pthread_mutex_unlock (&g_poolsMutex);
+#endif /* HAVE_PTHREAD_H */
+  return total;
+}
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
 }
 
 EventImpl::EventImpl ()
-  : m_cancel (false)
+  : m_cancel (false),
+    m_schedulerHandle (0)
 {
   NS_LOG_FUNCTION (this);
 }
@@ -60,4 +238,10 @@ EventImpl::IsCancelled (void)
   return m_cancel;
 }
 
+void *
+EventImpl::GetFunction (void)
+{
+  return 0;
+}
+
 } // namespace ns3
@@ -21,6 +21,7 @@
 #define EVENT_IMPL_H
 
 #include <stdint.h>
+#include <cstddef>
 #include "simple-ref-count.h"
 
 namespace ns3 {
@@ -35,12 +36,47 @@ namespace ns3 {
  * obviously (there are Ref and Unref methods) reference-counted and
  * most subclasses are usually created by one of the many Simulator::Schedule
  * methods.
+ *
+ * Events are allocated from pools of fixed-size blocks rather than by
+ * malloc: the size of each subclass, which holds the function to call and
+ * copies of its arguments, is rounded up to a multiple of 16 bytes and the
+ * block is taken from the free list of that size, which is refilled a slab
+ * of blocks at a time.  Each thread has its own pools, so scheduling and
+ * freeing events never takes a lock; a block freed by another thread than
+ * the one which allocated it simply joins the pools of the freeing thread.
+ * Events larger than the largest block size use the global operator new.
  */
 class EventImpl : public SimpleRefCount<EventImpl>
 {
 public:
+  /**
+   * Counters of the event pools, summed over all the threads.
+   */
+  struct PoolStats
+  {
+    /** events allocated from the pools */
+    uint64_t allocations;
+    /** events returned to the pools */
+    uint64_t frees;
+    /** events too large for the pools, allocated with the global operator new */
+    uint64_t largeAllocations;
+    /** slabs allocated to refill the pools */
+    uint64_t slabs;
+    /** bytes held by the pools, whether or not their blocks are in use */
+    uint64_t slabBytes;
+  };
+
   EventImpl ();
   virtual ~EventImpl () = 0;
+  static void *operator new (std::size_t size);
+  static void operator delete (void *p, std::size_t size);
+  /**
+   * \returns the counters of the event pools
+   *
+   * The counters of other threads are read without synchronization, so
+   * they may be slightly out of date while those threads schedule events.
+   */
+  static PoolStats GetPoolStats (void);
   /**
    * Called by the simulation engine to notify the event that it has expired.
    */
@@ -57,14 +93,45 @@ public:
    * Invoked by the simulation engine before calling Invoke.
    */
   bool IsCancelled (void);
+  /**
+   * \param handle where the scheduler holding the event keeps it
+   *
+   * Schedulers whose Remove doesn't search for the event record here
+   * where they keep it.
+   */
+  void SetSchedulerHandle (uint32_t handle);
+  /**
+   * \returns the handle last set by SetSchedulerHandle
+   */
+  uint32_t GetSchedulerHandle (void) const;
+  /**
+   * \returns the address of the function the event calls, or zero if it
+   *      is unknown
+   *
+   * The events made by MakeEvent know it; it names them in event profiles.
+   */
+  virtual void *GetFunction (void);
 
 protected:
   virtual void Notify (void) = 0;
 
 private:
   bool m_cancel;
+  uint32_t m_schedulerHandle;
 };
 
+inline void
+EventImpl::SetSchedulerHandle (uint32_t handle)
+{
+  m_schedulerHandle = handle;
+}
+
+inline uint32_t
+EventImpl::GetSchedulerHandle (void) const
+{
+  return m_schedulerHandle;
+}
+
 } // namespace ns3
 
 #endif /* EVENT_IMPL_H */
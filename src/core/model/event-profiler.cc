@@ -0,0 +1,313 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/core-config.h"
+#include "event-profiler.h"
+#include "event-impl.h"
+#include "fatal-error.h"
+#include "log.h"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+#include <cstdlib>
+#include <time.h>
+#if (__GNUC__ >= 3)
+#include <cxxabi.h>
+#endif
+#ifdef HAVE_DLADDR
+#include <dlfcn.h>
+#endif /* HAVE_DLADDR */
+
+NS_LOG_COMPONENT_DEFINE ("EventProfiler");
+
+namespace ns3 {
+
+namespace {
+
+const uint32_t NO_CONTEXT = 0xffffffff;
+
+template <typename T>
+bool
+MoreTime (const std::pair<T, EventProfiler::Entry> &a, const std::pair<T, EventProfiler::Entry> &b)
+{
+  return a.second.ns > b.second.ns;
+}
+
+void
+WriteEntry (std::ostream &os, const EventProfiler::Entry &entry)
+{
+  os << std::setw (12) << entry.count
+     << std::setw (14) << std::fixed << std::setprecision (6) << entry.ns / 1e9
+     << std::setw (12) << std::setprecision (3) << (entry.count == 0 ? 0.0 : entry.ns / 1e3 / entry.count)
+     << std::setw (10) << std::setprecision (2) << (entry.count == 0 ? 0.0 : double (entry.fanOut) / entry.count);
+}
+
+void
+WriteHeader (std::ostream &os, std::string first)
+{
+  os << first
+     << std::setw (12) << "count"
+     << std::setw (14) << "total(s)"
+     << std::setw (12) << "mean(us)"
+     << std::setw (10) << "fan-out"
+     << "  event" << std::endl;
+}
+
+std::string
+Demangle (const std::string &mangled)
+{
+#if (__GNUC__ >= 3)
+  int status;
+  char *demangled = abi::__cxa_demangle (mangled.c_str (), NULL, NULL, &status);
+  if (status == 0)
+    {
+      std::string ret = demangled;
+      std::free (demangled);
+      return ret;
+    }
+#endif
+  return mangled;
+}
+
+} // anonymous namespace
+
+bool
+EventProfiler::Function::operator < (const Function &o) const
+{
+  if (address != o.address)
+    {
+      return address < o.address;
+    }
+  // events whose function is unknown are told apart by their type
+  return address == 0 && *type != *o.type && type->before (*o.type);
+}
+
+bool
+EventProfiler::Function::operator != (const Function &o) const
+{
+  return address != o.address || (address == 0 && *type != *o.type);
+}
+
+EventProfiler::EventProfiler ()
+  : m_last (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint64_t
+EventProfiler::GetTimeNs (void)
+{
+  struct timespec ts;
+  clock_gettime (CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+EventProfiler::Function
+EventProfiler::GetFunction (EventImpl *event)
+{
+  Function function;
+  function.address = event->GetFunction ();
+  function.type = &typeid (*event);
+  return function;
+}
+
+void
+EventProfiler::Record (const Function &function, uint32_t context, uint64_t ns, uint64_t fanOut)
+{
+  if (m_last == 0 || m_lastKey.second != context || m_lastKey.first != function)
+    {
+      m_lastKey = Key (function, context);
+      Entries::iterator i = m_entries.find (m_lastKey);
+      if (i == m_entries.end ())
+        {
+          Entry entry = { 0, 0, 0 };
+          i = m_entries.insert (std::make_pair (m_lastKey, entry)).first;
+        }
+      m_last = &i->second;
+    }
+  m_last->count++;
+  m_last->ns += ns;
+  m_last->fanOut += fanOut;
+}
+
+void
+EventProfiler::Add (Entry &to, const Entry &from)
+{
+  to.count += from.count;
+  to.ns += from.ns;
+  to.fanOut += from.fanOut;
+}
+
+std::string
+EventProfiler::GetName (const Function &function)
+{
+#ifdef HAVE_DLADDR
+  Dl_info info;
+  if (function.address != 0 && dladdr (function.address, &info) != 0
+      && info.dli_sname != 0 && info.dli_saddr == function.address)
+    {
+      std::string symbol = info.dli_sname;
+      return symbol.compare (0, 2, "_Z") == 0 ? Demangle (symbol) : symbol;
+    }
+#endif /* HAVE_DLADDR */
+  // the events made by MakeEvent are classes local to it, named after
+  // the whole MakeEvent signature: keep only its template arguments
+  std::ostringstream name;
+  std::string type = Demangle (function.type->name ());
+  std::string::size_type start = type.find ("MakeEvent<");
+  std::string::size_type end = type.size ();
+  if (start == std::string::npos)
+    {
+      start = 0;
+    }
+  else
+    {
+      int depth = 0;
+      for (std::string::size_type i = start + 9; i < type.size (); i++)
+        {
+          if (type[i] == '<')
+            {
+              depth++;
+            }
+          else if (type[i] == '>' && --depth == 0)
+            {
+              end = i + 1;
+              break;
+            }
+        }
+    }
+  name << type.substr (start, end - start);
+  if (function.address != 0)
+    {
+      name << " at " << function.address;
+    }
+  return name.str ();
+}
+
+EventProfiler::Entry
+EventProfiler::GetTotal (void) const
+{
+  Entry total = { 0, 0, 0 };
+  for (Entries::const_iterator i = m_entries.begin (); i != m_entries.end (); i++)
+    {
+      Add (total, i->second);
+    }
+  return total;
+}
+
+EventProfiler::Entry
+EventProfiler::Get (EventImpl *event) const
+{
+  Function function = GetFunction (event);
+  Entry total = { 0, 0, 0 };
+  for (Entries::const_iterator i = m_entries.lower_bound (Key (function, 0));
+       i != m_entries.end () && !(i->first.first != function); i++)
+    {
+      Add (total, i->second);
+    }
+  return total;
+}
+
+void
+EventProfiler::Merge (const EventProfiler &other)
+{
+  NS_LOG_FUNCTION (this << &other);
+  Entry zero = { 0, 0, 0 };
+  for (Entries::const_iterator i = other.m_entries.begin (); i != other.m_entries.end (); i++)
+    {
+      Add (m_entries.insert (std::make_pair (i->first, zero)).first->second, i->second);
+    }
+}
+
+void
+EventProfiler::Write (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this);
+  typedef std::map<Function, Entry> ByFunction;
+  typedef std::vector<std::pair<Function, Entry> > Functions;
+  typedef std::map<uint32_t, std::pair<Entry, Functions> > ByContext;
+  ByFunction byFunction;
+  ByContext byContext;
+  Entry zero = { 0, 0, 0 };
+  for (Entries::const_iterator i = m_entries.begin (); i != m_entries.end (); i++)
+    {
+      Add (byFunction.insert (std::make_pair (i->first.first, zero)).first->second, i->second);
+      std::pair<Entry, Functions> &context = byContext[i->first.second];
+      Add (context.first, i->second);
+      context.second.push_back (std::make_pair (i->first.first, i->second));
+    }
+
+  Entry total = GetTotal ();
+  os << "# " << total.count << " events calling " << byFunction.size () << " functions in "
+     << std::fixed << std::setprecision (6) << total.ns / 1e9 << " s" << std::endl;
+
+  os << std::endl << "# flat" << std::endl;
+  WriteHeader (os, "");
+  Functions functions (byFunction.begin (), byFunction.end ());
+  std::stable_sort (functions.begin (), functions.end (), MoreTime<Function>);
+  for (uint32_t i = 0; i < functions.size (); i++)
+    {
+      WriteEntry (os, functions[i].second);
+      os << "  " << GetName (functions[i].first) << std::endl;
+    }
+
+  os << std::endl << "# by node" << std::endl;
+  WriteHeader (os, "      node");
+  std::vector<std::pair<uint32_t, Entry> > contexts;
+  for (ByContext::const_iterator i = byContext.begin (); i != byContext.end (); i++)
+    {
+      contexts.push_back (std::make_pair (i->first, i->second.first));
+    }
+  std::stable_sort (contexts.begin (), contexts.end (), MoreTime<uint32_t>);
+  for (uint32_t i = 0; i < contexts.size (); i++)
+    {
+      uint32_t context = contexts[i].first;
+      if (context == NO_CONTEXT)
+        {
+          os << std::setw (10) << "-";
+        }
+      else
+        {
+          os << std::setw (10) << context;
+        }
+      WriteEntry (os, contexts[i].second);
+      os << "  (all)" << std::endl;
+      Functions events = byContext[context].second;
+      std::stable_sort (events.begin (), events.end (), MoreTime<Function>);
+      for (uint32_t j = 0; j < events.size (); j++)
+        {
+          os << std::setw (10) << "";
+          WriteEntry (os, events[j].second);
+          os << "  " << GetName (events[j].first) << std::endl;
+        }
+    }
+}
+
+void
+EventProfiler::Write (std::string filename) const
+{
+  NS_LOG_FUNCTION (this << filename);
+  std::ofstream os (filename.c_str ());
+  if (!os)
+    {
+      NS_FATAL_ERROR ("Can't open event profile file " << filename);
+    }
+  Write (os);
+}
+
+} // namespace ns3
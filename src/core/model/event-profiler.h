@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef EVENT_PROFILER_H
+#define EVENT_PROFILER_H
+
+#include <stdint.h>
+#include <map>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+
+namespace ns3 {
+
+class EventImpl;
+
+/**
+ * \ingroup core
+ * \brief aggregates the cost of the events run by a simulator
+ *
+ * A simulator implementation whose ProfileFile attribute is set records
+ * each event it runs here: the function the event calls, as told by
+ * EventImpl::GetFunction, the context (the node) it ran in, the wall-clock
+ * time Invoke took and the number of events it scheduled.  The report lists
+ * the functions by total time, then the nodes by total time with the
+ * functions which ran in each of them.  Functions are named by their symbol
+ * when it can be looked up, and otherwise by the type of their events,
+ * which MakeEvent names after the function signature and the object type.
+ *
+ * When profiling is disabled, the simulators hold no profiler and only
+ * test for it once per event.
+ */
+class EventProfiler
+{
+public:
+  /** Counters of the events calling one function run in one context. */
+  struct Entry
+  {
+    uint64_t count;
+    /** wall-clock nanoseconds spent in Invoke */
+    uint64_t ns;
+    /** events scheduled by these events */
+    uint64_t fanOut;
+  };
+
+  /** What an event is profiled under: its function, if known, is enough. */
+  struct Function
+  {
+    void *address;
+    const std::type_info *type;
+    bool operator < (const Function &o) const;
+    bool operator != (const Function &o) const;
+  };
+
+  EventProfiler ();
+
+  /**
+   * \returns a monotonic wall-clock time, in nanoseconds
+   */
+  static uint64_t GetTimeNs (void);
+
+  /**
+   * \param event an event about to be run
+   * \returns what the event is profiled under
+   *
+   * Must be called before Invoke, which may delete the object a member
+   * function is called on, as looking up a virtual one reads the object.
+   */
+  static Function GetFunction (EventImpl *event);
+  /**
+   * \param function what the event which was run is profiled under
+   * \param context the context it was run in
+   * \param ns the wall-clock nanoseconds its Invoke took
+   * \param fanOut the number of events it scheduled
+   */
+  void Record (const Function &function, uint32_t context, uint64_t ns, uint64_t fanOut);
+  /**
+   * \returns the counters summed over all the events recorded
+   */
+  Entry GetTotal (void) const;
+  /**
+   * \param event an event calling the function to look up
+   * \returns the counters summed over all the events calling the same
+   *      function as event
+   */
+  Entry Get (EventImpl *event) const;
+  /**
+   * \param other a profiler, such as the one of another thread, whose
+   *      counters are added to those of this one
+   */
+  void Merge (const EventProfiler &other);
+  /**
+   * \param os the stream to write the flat and by-node reports to
+   */
+  void Write (std::ostream &os) const;
+  /**
+   * \param filename the file to write the report to, replacing it
+   */
+  void Write (std::string filename) const;
+
+private:
+  typedef std::pair<Function, uint32_t> Key;
+  typedef std::map<Key, Entry> Entries;
+
+  static void Add (Entry &to, const Entry &from);
+  static std::string GetName (const Function &function);
+
+  Entries m_entries;
+  /** the entry of the last event recorded, as events of a function tend to run in a row */
+  Key m_lastKey;
+  Entry *m_last;
+};
+
+} // namespace ns3
+
+#endif /* EVENT_PROFILER_H */
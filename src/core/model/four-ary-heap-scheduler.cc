@@ -0,0 +1,280 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "four-ary-heap-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "fatal-error.h"
+#include "log.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+NS_LOG_COMPONENT_DEFINE ("FourAryHeapScheduler");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (FourAryHeapScheduler);
+
+namespace {
+
+const uint32_t ROOT = 3;
+const size_t CACHE_LINE = 64;
+
+inline uint32_t
+Parent (uint32_t id)
+{
+  return (id + 8) / 4;
+}
+
+inline uint32_t
+FirstChild (uint32_t id)
+{
+  return 4 * id - 8;
+}
+
+inline bool
+IsLess (const Scheduler::EventKey &a, const Scheduler::EventKey &b)
+{
+  return a.m_ts < b.m_ts || (a.m_ts == b.m_ts && a.m_uid < b.m_uid);
+}
+
+} // anonymous namespace
+
+TypeId
+FourAryHeapScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FourAryHeapScheduler")
+    .SetParent<Scheduler> ()
+    .AddConstructor<FourAryHeapScheduler> ()
+  ;
+  return tid;
+}
+
+FourAryHeapScheduler::FourAryHeapScheduler ()
+  : m_keys (0),
+    m_impls (0),
+    m_end (ROOT),
+    m_capacity (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+FourAryHeapScheduler::~FourAryHeapScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+  std::free (m_keys);
+  std::free (m_impls);
+}
+
+void
+FourAryHeapScheduler::Grow (void)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t capacity = m_capacity == 0 ? 64 : 2 * m_capacity;
+  void *keys;
+  void *impls;
+  if (posix_memalign (&keys, CACHE_LINE, capacity * sizeof (EventKey)) != 0
+      || posix_memalign (&impls, CACHE_LINE, capacity * sizeof (EventImpl *)) != 0)
+    {
+      NS_FATAL_ERROR ("Out of memory for " << capacity << " events");
+    }
+  if (m_capacity != 0)
+    {
+      std::memcpy (keys, m_keys, m_end * sizeof (EventKey));
+      std::memcpy (impls, m_impls, m_end * sizeof (EventImpl *));
+    }
+  std::free (m_keys);
+  std::free (m_impls);
+  m_keys = static_cast<EventKey *> (keys);
+  m_impls = static_cast<EventImpl **> (impls);
+  m_capacity = capacity;
+}
+
+void
+FourAryHeapScheduler::Put (uint32_t id, const EventKey &key, EventImpl *impl)
+{
+  m_keys[id] = key;
+  m_impls[id] = impl;
+  impl->SetSchedulerHandle (id);
+}
+
+void
+FourAryHeapScheduler::BottomUp (uint32_t id, const EventKey &key, EventImpl *impl)
+{
+  while (id > ROOT)
+    {
+      uint32_t parent = Parent (id);
+      if (!IsLess (key, m_keys[parent]))
+        {
+          break;
+        }
+      Put (id, m_keys[parent], m_impls[parent]);
+      id = parent;
+    }
+  Put (id, key, impl);
+}
+
+void
+FourAryHeapScheduler::TopDown (uint32_t id, const EventKey &key, EventImpl *impl)
+{
+  while (true)
+    {
+      uint32_t child = FirstChild (id);
+      if (child >= m_end)
+        {
+          break;
+        }
+      uint32_t last = std::min (child + 4, m_end);
+      uint32_t smallest = child;
+      for (child++; child < last; child++)
+        {
+          if (IsLess (m_keys[child], m_keys[smallest]))
+            {
+              smallest = child;
+            }
+        }
+      if (!IsLess (m_keys[smallest], key))
+        {
+          break;
+        }
+      Put (id, m_keys[smallest], m_impls[smallest]);
+      id = smallest;
+    }
+  Put (id, key, impl);
+}
+
+void
+FourAryHeapScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  if (m_end >= m_capacity)
+    {
+      Grow ();
+    }
+  BottomUp (m_end++, ev.key, ev.impl);
+}
+
+bool
+FourAryHeapScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_end == ROOT;
+}
+
+Scheduler::Event
+FourAryHeapScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  Event ev;
+  ev.impl = m_impls[ROOT];
+  ev.key = m_keys[ROOT];
+  return ev;
+}
+
+void
+FourAryHeapScheduler::RemoveAt (uint32_t id)
+{
+  m_end--;
+  if (id == m_end)
+    {
+      return;
+    }
+  EventKey key = m_keys[m_end];
+  EventImpl *impl = m_impls[m_end];
+  if (id > ROOT && IsLess (key, m_keys[Parent (id)]))
+    {
+      BottomUp (id, key, impl);
+    }
+  else
+    {
+      TopDown (id, key, impl);
+    }
+}
+
+Scheduler::Event
+FourAryHeapScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  Event ev = PeekNext ();
+  RemoveAt (ROOT);
+  return ev;
+}
+
+void
+FourAryHeapScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (!IsEmpty ());
+  uint32_t id = ev.impl->GetSchedulerHandle ();
+  NS_ASSERT (id >= ROOT && id < m_end && m_impls[id] == ev.impl && m_keys[id].m_uid == ev.key.m_uid);
+  RemoveAt (id);
+}
+
+bool
+FourAryHeapScheduler::TryRemove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  // the handle may have been set by another scheduler
+  uint32_t id = ev.impl->GetSchedulerHandle ();
+  if (id < ROOT || id >= m_end || m_impls[id] != ev.impl)
+    {
+      return false;
+    }
+  RemoveAt (id);
+  return true;
+}
+
+void
+FourAryHeapScheduler::RemoveCancelled (std::vector<Event> &cancelled)
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t end = ROOT;
+  for (uint32_t i = ROOT; i < m_end; i++)
+    {
+      if (m_impls[i]->IsCancelled ())
+        {
+          Event ev;
+          ev.impl = m_impls[i];
+          ev.key = m_keys[i];
+          cancelled.push_back (ev);
+        }
+      else
+        {
+          m_keys[end] = m_keys[i];
+          m_impls[end] = m_impls[i];
+          end++;
+        }
+    }
+  m_end = end;
+  // heapify bottom-up, from the parent of the last element to the root
+  if (m_end > ROOT + 1)
+    {
+      for (uint32_t id = Parent (m_end - 1) + 1; id-- > ROOT; )
+        {
+          EventKey key = m_keys[id];
+          TopDown (id, key, m_impls[id]);
+        }
+    }
+  for (uint32_t id = ROOT; id < m_end; id++)
+    {
+      m_impls[id]->SetSchedulerHandle (id);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,81 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef FOUR_ARY_HEAP_SCHEDULER_H
+#define FOUR_ARY_HEAP_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a cache-aligned 4-ary heap event scheduler
+ *
+ * Compared to HeapScheduler, this heap:
+ *  - has four children per node, so it is half as deep and each step of
+ *    a top-down heapify picks the smallest of four keys;
+ *  - keeps the 16-byte keys apart from the EventImpl pointers, which the
+ *    heapify loops never look at, so four keys fill one 64-byte cache line;
+ *  - aligns the keys so that the four children of a node are always in
+ *    one cache line: the root is at index 3 and the children of index i
+ *    are at 4i-8 to 4i-5;
+ *  - moves a hole down or up rather than exchanging elements at each step.
+ *
+ * Each event's index in the heap is kept as its scheduler handle, so that
+ * Remove and TryRemove don't search for it, and RemoveCancelled rebuilds the heap in
+ * linear time.
+ */
+class FourAryHeapScheduler : public Scheduler
+{
+public:
+  static TypeId GetTypeId (void);
+
+  FourAryHeapScheduler ();
+  virtual ~FourAryHeapScheduler ();
+
+  virtual void Insert (const Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Event PeekNext (void) const;
+  virtual Event RemoveNext (void);
+  virtual void Remove (const Event &ev);
+  virtual bool TryRemove (const Event &ev);
+  virtual void RemoveCancelled (std::vector<Event> &cancelled);
+
+private:
+  FourAryHeapScheduler (const FourAryHeapScheduler &);
+  FourAryHeapScheduler &operator= (const FourAryHeapScheduler &);
+
+  void Grow (void);
+  inline void Put (uint32_t id, const EventKey &key, EventImpl *impl);
+  /** Move the hole at id up until the key can be put in it, and put it there. */
+  void BottomUp (uint32_t id, const EventKey &key, EventImpl *impl);
+  /** Move the hole at id down until the key can be put in it, and put it there. */
+  void TopDown (uint32_t id, const EventKey &key, EventImpl *impl);
+  /** Remove the element at id, filling its place with the last one. */
+  void RemoveAt (uint32_t id);
+
+  EventKey *m_keys;
+  EventImpl **m_impls;
+  /** the index after the last element */
+  uint32_t m_end;
+  uint32_t m_capacity;
+};
+
+} // namespace ns3
+
+#endif /* FOUR_ARY_HEAP_SCHEDULER_H */
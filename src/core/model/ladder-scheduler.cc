@@ -0,0 +1,363 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+#include "event-impl.h"
+#include "assert.h"
+#include "log.h"
+#include <algorithm>
+
+NS_LOG_COMPONENT_DEFINE ("LadderScheduler");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (LadderScheduler);
+
+namespace {
+
+const uint32_t NONE = 0xffffffff;
+/** buckets holding more events than this are spread over a new rung rather than sorted */
+const uint32_t THRESHOLD = 50;
+const uint32_t MAX_RUNGS = 8;
+/** Bottom is spread over a new rung when inserts make it hold more events than this */
+const uint32_t BOTTOM_MAX = 4 * THRESHOLD;
+
+/** Orders Bottom with the earliest event last, so that it is removed from the end. */
+bool
+Later (const Scheduler::Event &a, const Scheduler::Event &b)
+{
+  return b < a;
+}
+
+} // anonymous namespace
+
+TypeId
+LadderScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LadderScheduler")
+    .SetParent<Scheduler> ()
+    .AddConstructor<LadderScheduler> ()
+  ;
+  return tid;
+}
+
+LadderScheduler::LadderScheduler ()
+  : m_free (NONE),
+    m_top (NONE),
+    m_topCount (0),
+    m_topStart (0),
+    m_topMin (0),
+    m_topMax (0),
+    m_nRungs (0),
+    m_count (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LadderScheduler::~LadderScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+LadderScheduler::Allocate (const Event &ev)
+{
+  uint32_t node = m_free;
+  if (node == NONE)
+    {
+      node = m_nodes.size ();
+      m_nodes.push_back (Node ());
+    }
+  else
+    {
+      m_free = m_nodes[node].next;
+    }
+  m_nodes[node].ev = ev;
+  m_nodes[node].next = NONE;
+  return node;
+}
+
+void
+LadderScheduler::Release (uint32_t node)
+{
+  m_nodes[node].next = m_free;
+  m_free = node;
+}
+
+void
+LadderScheduler::Link (Rung &rung, uint32_t node)
+{
+  uint32_t bucket = (m_nodes[node].ev.key.m_ts - rung.start) / rung.width;
+  NS_ASSERT (bucket >= rung.current && bucket < rung.buckets.size ());
+  m_nodes[node].next = rung.buckets[bucket];
+  rung.buckets[bucket] = node;
+  rung.counts[bucket]++;
+  rung.count++;
+}
+
+void
+LadderScheduler::Spread (uint32_t list, uint32_t count, uint64_t start, uint64_t end)
+{
+  NS_LOG_FUNCTION (this << count << start << end);
+  NS_ASSERT (m_nRungs < MAX_RUNGS && count > 0);
+  if (m_rungs.size () == m_nRungs)
+    {
+      m_rungs.push_back (Rung ());
+    }
+  Rung &rung = m_rungs[m_nRungs++];
+  rung.start = start;
+  // about one event per bucket, with the last bucket ending after end
+  rung.width = (end - start) / count + 1;
+  uint32_t nBuckets = (end - start) / rung.width + 1;
+  rung.current = 0;
+  rung.count = 0;
+  rung.buckets.assign (nBuckets, NONE);
+  rung.counts.assign (nBuckets, 0);
+  while (list != NONE)
+    {
+      uint32_t next = m_nodes[list].next;
+      Link (rung, list);
+      list = next;
+    }
+  NS_ASSERT (rung.count == count);
+}
+
+uint64_t
+LadderScheduler::GetCurrentStart (const Rung &rung) const
+{
+  return rung.start + rung.current * rung.width;
+}
+
+void
+LadderScheduler::SortIntoBottom (uint32_t list)
+{
+  NS_ASSERT (m_bottom.empty ());
+  while (list != NONE)
+    {
+      m_bottom.push_back (m_nodes[list].ev);
+      uint32_t next = m_nodes[list].next;
+      Release (list);
+      list = next;
+    }
+  std::sort (m_bottom.begin (), m_bottom.end (), Later);
+}
+
+void
+LadderScheduler::InsertIntoBottom (const Event &ev)
+{
+  m_bottom.insert (std::lower_bound (m_bottom.begin (), m_bottom.end (), ev, Later), ev);
+}
+
+void
+LadderScheduler::Refill (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_bottom.empty () && m_count > 0);
+  while (true)
+    {
+      if (m_nRungs == 0)
+        {
+          NS_ASSERT (m_topCount > 0);
+          uint32_t top = m_top;
+          uint32_t topCount = m_topCount;
+          m_top = NONE;
+          m_topCount = 0;
+          m_topStart = m_topMax + 1;
+          if (topCount <= THRESHOLD || m_topMin == m_topMax)
+            {
+              SortIntoBottom (top);
+              return;
+            }
+          Spread (top, topCount, m_topMin, m_topMax);
+        }
+
+      Rung &rung = m_rungs[m_nRungs - 1];
+      if (rung.count == 0)
+        {
+          m_nRungs--;
+          continue;
+        }
+      while (rung.counts[rung.current] == 0)
+        {
+          rung.current++;
+        }
+      uint32_t list = rung.buckets[rung.current];
+      uint32_t count = rung.counts[rung.current];
+      uint64_t start = GetCurrentStart (rung);
+      uint64_t end = start + rung.width - 1;
+      rung.buckets[rung.current] = NONE;
+      rung.counts[rung.current] = 0;
+      rung.count -= count;
+      rung.current++;
+      if (count > THRESHOLD && rung.width > 1 && m_nRungs < MAX_RUNGS)
+        {
+          // the new rung must take all the events routed to this bucket
+          // from now on, so it spreads the whole bucket
+          uint64_t min = end;
+          for (uint32_t node = list; node != NONE; node = m_nodes[node].next)
+            {
+              min = std::min (min, m_nodes[node].ev.key.m_ts);
+            }
+          Spread (list, count, min, end);
+          continue;
+        }
+      SortIntoBottom (list);
+      return;
+    }
+}
+
+void
+LadderScheduler::Insert (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  m_count++;
+  uint64_t ts = ev.key.m_ts;
+  if (ts >= m_topStart)
+    {
+      uint32_t node = Allocate (ev);
+      m_nodes[node].next = m_top;
+      m_top = node;
+      if (m_topCount == 0)
+        {
+          m_topMin = ts;
+          m_topMax = ts;
+        }
+      else
+        {
+          m_topMin = std::min (m_topMin, ts);
+          m_topMax = std::max (m_topMax, ts);
+        }
+      m_topCount++;
+      return;
+    }
+  for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+      if (ts >= GetCurrentStart (m_rungs[i]))
+        {
+          Link (m_rungs[i], Allocate (ev));
+          return;
+        }
+    }
+
+  // Bottom only stays small if it is spread over a rung when too many
+  // events are inserted before the ladder
+  if (m_bottom.size () >= BOTTOM_MAX && m_nRungs < MAX_RUNGS
+      && m_bottom.front ().key.m_ts != m_bottom.back ().key.m_ts)
+    {
+      uint64_t end = (m_nRungs == 0 ? m_topStart : GetCurrentStart (m_rungs[m_nRungs - 1])) - 1;
+      uint64_t start = m_bottom.back ().key.m_ts;
+      uint32_t list = NONE;
+      for (std::vector<Event>::const_iterator i = m_bottom.begin (); i != m_bottom.end (); i++)
+        {
+          uint32_t node = Allocate (*i);
+          m_nodes[node].next = list;
+          list = node;
+        }
+      uint32_t count = m_bottom.size ();
+      m_bottom.clear ();
+      Spread (list, count, std::min (start, ts), end);
+      Link (m_rungs[m_nRungs - 1], Allocate (ev));
+      return;
+    }
+  InsertIntoBottom (ev);
+}
+
+bool
+LadderScheduler::IsEmpty (void) const
+{
+  NS_LOG_FUNCTION (this);
+  return m_count == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  if (m_bottom.empty ())
+    {
+      // refilling Bottom doesn't change which events are held
+      const_cast<LadderScheduler *> (this)->Refill ();
+    }
+  return m_bottom.back ();
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!IsEmpty ());
+  if (m_bottom.empty ())
+    {
+      Refill ();
+    }
+  Event ev = m_bottom.back ();
+  m_bottom.pop_back ();
+  m_count--;
+  return ev;
+}
+
+bool
+LadderScheduler::RemoveFromList (uint32_t &list, const Event &ev)
+{
+  for (uint32_t *node = &list; *node != NONE; node = &m_nodes[*node].next)
+    {
+      if (m_nodes[*node].ev.key.m_uid == ev.key.m_uid)
+        {
+          NS_ASSERT (m_nodes[*node].ev.impl == ev.impl);
+          uint32_t removed = *node;
+          *node = m_nodes[removed].next;
+          Release (removed);
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+LadderScheduler::Remove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  NS_ASSERT (!IsEmpty ());
+  uint64_t ts = ev.key.m_ts;
+  m_count--;
+  // the event is where Insert would put it now
+  if (ts >= m_topStart)
+    {
+      bool found = RemoveFromList (m_top, ev);
+      NS_ASSERT (found);
+      m_topCount--;
+      return;
+    }
+  for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+      Rung &rung = m_rungs[i];
+      if (ts >= GetCurrentStart (rung))
+        {
+          uint32_t bucket = (ts - rung.start) / rung.width;
+          bool found = RemoveFromList (rung.buckets[bucket], ev);
+          NS_ASSERT (found);
+          rung.counts[bucket]--;
+          rung.count--;
+          return;
+        }
+    }
+  std::vector<Event>::iterator i = std::lower_bound (m_bottom.begin (), m_bottom.end (), ev, Later);
+  NS_ASSERT (i != m_bottom.end () && i->key.m_uid == ev.key.m_uid);
+  m_bottom.erase (i);
+}
+
+} // namespace ns3
@@ -0,0 +1,116 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the Ladder Queue of Tang, Goh and Thng,
+ * "Ladder Queue: An O(1) Priority Queue Structure for Large-Scale Discrete
+ * Event Simulation" (2005).  Unlike the calendar queue, it never resizes by
+ * rehashing all its events, so it stays O(1) amortized when the timestamps
+ * are very unevenly spread, e.g. many events a few microseconds ahead and
+ * many others seconds ahead.
+ *
+ * Events are kept in three tiers:
+ *  - Top: an unsorted list of the events at or after the end of the ladder;
+ *  - the Ladder: rungs of buckets, each rung spreading one bucket of the
+ *    rung above (or, for the first rung, all of Top) over narrower buckets;
+ *  - Bottom: a small sorted list of the earliest events.
+ *
+ * When Bottom runs out, the next bucket of the lowest rung is either sorted
+ * into it or, if it holds too many events, spread over a new rung.  Events
+ * are never compared except when a bucket is sorted, and the events of a
+ * bucket are linked through a shared pool rather than allocated one by one.
+ */
+class LadderScheduler : public Scheduler
+{
+public:
+  static TypeId GetTypeId (void);
+
+  LadderScheduler ();
+  virtual ~LadderScheduler ();
+
+  virtual void Insert (const Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Event PeekNext (void) const;
+  virtual Event RemoveNext (void);
+  virtual void Remove (const Event &ev);
+
+private:
+  /** An event linked into Top or a bucket. */
+  struct Node
+  {
+    Event ev;
+    uint32_t next;
+  };
+  struct Rung
+  {
+    uint64_t start;
+    uint64_t width;
+    /** the first bucket not yet sorted into Bottom or spread over a rung below */
+    uint32_t current;
+    uint32_t count;
+    std::vector<uint32_t> buckets;
+    std::vector<uint32_t> counts;
+  };
+
+  uint32_t Allocate (const Event &ev);
+  void Release (uint32_t node);
+  /** Link the node into the bucket of the rung for its timestamp. */
+  void Link (Rung &rung, uint32_t node);
+  /** Spread the events of the list over a new lowest rung starting at start. */
+  void Spread (uint32_t list, uint32_t count, uint64_t start, uint64_t end);
+  uint64_t GetCurrentStart (const Rung &rung) const;
+  /** Refill Bottom from the ladder or Top if it is empty. */
+  void Refill (void);
+  /** Sort the events of the list into Bottom. */
+  void SortIntoBottom (uint32_t list);
+  void InsertIntoBottom (const Event &ev);
+  /** Unlink the event from the list, returning whether it was there. */
+  bool RemoveFromList (uint32_t &list, const Event &ev);
+
+  std::vector<Node> m_nodes;
+  uint32_t m_free;
+
+  uint32_t m_top;
+  uint32_t m_topCount;
+  uint64_t m_topStart;
+  uint64_t m_topMin;
+  uint64_t m_topMax;
+
+  /** the rungs in use are the first m_nRungs, the others are kept for their buckets */
+  std::vector<Rung> m_rungs;
+  uint32_t m_nRungs;
+
+  /** sorted with the earliest event last */
+  std::vector<Event> m_bottom;
+
+  uint32_t m_count;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
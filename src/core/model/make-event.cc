@@ -26,6 +26,10 @@ protected:
     {
       (*m_function)();
     }
+    virtual void *GetFunction (void)
+    {
+      return reinterpret_cast<void *> (m_function);
+    }
 private:
     F m_function;
   } *ev = new EventFunctionImpl0 (f);
@@ -73,6 +73,48 @@ struct EventMemberImplObjTraits<T *>
   }
 };
 
+namespace internal {
+
+/**
+ * \returns the address of the function called through mem_ptr on obj, or
+ *      zero if the layout of pointers to member functions isn't known
+ */
+template <typename MEM, typename T>
+void *
+GetMemberFunction (MEM mem_ptr, T &obj)
+{
+#if defined (__GNUC__) && (defined (__x86_64__) || defined (__i386__))
+  // Itanium C++ ABI: the pointer is either the address of a non-virtual
+  // function, or one plus the offset of the function in the vtable of the
+  // object adjusted by adj
+  union
+  {
+    MEM mem;
+    struct
+    {
+      uintptr_t ptr;
+      ptrdiff_t adj;
+    } raw;
+  } u;
+  if (sizeof (MEM) != sizeof (u.raw))
+    {
+      return 0;
+    }
+  u.mem = mem_ptr;
+  if ((u.raw.ptr & 1) == 0)
+    {
+      return reinterpret_cast<void *> (u.raw.ptr);
+    }
+  const char *object = reinterpret_cast<const char *> (&obj) + u.raw.adj;
+  const char *vtable = *reinterpret_cast<const char * const *> (object);
+  return *reinterpret_cast<void * const *> (vtable + u.raw.ptr - 1);
+#else
+  return 0;
+#endif
+}
+
+} // namespace internal
+
 template <typename MEM, typename OBJ>
 EventImpl * MakeEvent (MEM mem_ptr, OBJ obj)
 {
@@ -93,6 +135,10 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)();
     }
+    virtual void *GetFunction (void)
+    {
+      return internal::GetMemberFunction (m_function, EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+    }
     OBJ m_obj;
     MEM m_function;
   } *ev = new EventMemberImpl0 (obj, mem_ptr);
@@ -123,6 +169,10 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1);
     }
+    virtual void *GetFunction (void)
+    {
+      return internal::GetMemberFunction (m_function, EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -154,6 +204,10 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2);
     }
+    virtual void *GetFunction (void)
+    {
+      return internal::GetMemberFunction (m_function, EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -187,6 +241,10 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3);
     }
+    virtual void *GetFunction (void)
+    {
+      return internal::GetMemberFunction (m_function, EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -222,6 +280,10 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4);
     }
+    virtual void *GetFunction (void)
+    {
+      return internal::GetMemberFunction (m_function, EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -260,6 +322,10 @@ private:
     {
       (EventMemberImplObjTraits<OBJ>::GetReference (m_obj).*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5);
     }
+    virtual void *GetFunction (void)
+    {
+      return internal::GetMemberFunction (m_function, EventMemberImplObjTraits<OBJ>::GetReference (m_obj));
+    }
     OBJ m_obj;
     MEM m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
@@ -294,6 +360,10 @@ private:
     {
       (*m_function)(m_a1);
     }
+    virtual void *GetFunction (void)
+    {
+      return reinterpret_cast<void *> (m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
   } *ev = new EventFunctionImpl1 (f, a1);
@@ -324,6 +394,10 @@ private:
     {
       (*m_function)(m_a1, m_a2);
     }
+    virtual void *GetFunction (void)
+    {
+      return reinterpret_cast<void *> (m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -357,6 +431,10 @@ private:
     {
       (*m_function)(m_a1, m_a2, m_a3);
     }
+    virtual void *GetFunction (void)
+    {
+      return reinterpret_cast<void *> (m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -392,6 +470,10 @@ private:
     {
       (*m_function)(m_a1, m_a2, m_a3, m_a4);
     }
+    virtual void *GetFunction (void)
+    {
+      return reinterpret_cast<void *> (m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -429,6 +511,10 @@ private:
     {
       (*m_function)(m_a1, m_a2, m_a3, m_a4, m_a5);
     }
+    virtual void *GetFunction (void)
+    {
+      return reinterpret_cast<void *> (m_function);
+    }
     F m_function;
     typename TypeTraits<T1>::ReferencedType m_a1;
     typename TypeTraits<T2>::ReferencedType m_a2;
@@ -102,4 +102,17 @@ MapScheduler::Remove (const Event &ev)
   m_list.erase (i);
 }
 
+bool
+MapScheduler::TryRemove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  EventMapI i = m_list.find (ev.key);
+  if (i == m_list.end () || i->second != ev.impl)
+    {
+      return false;
+    }
+  m_list.erase (i);
+  return true;
+}
+
 } // namespace ns3
@@ -165,10 +165,15 @@ Object::DoGetObject (TypeId tid) const
           // that the aggregate array is sorted by the number of accesses
           // to each object.
 
-          // first, increment the access count
-          current->m_getObjectCount++;
-          // then, update the sort
-          UpdateSortedArray (m_aggregates, i);
+          // Other threads may be looking the array up too if events run on
+          // several threads, so it is left alone then.
+          if (!AtomicCount::IsThreaded ())
+            {
+              // first, increment the access count
+              current->m_getObjectCount++;
+              // then, update the sort
+              UpdateSortedArray (m_aggregates, i);
+            }
           // finally, return the match
           return const_cast<Object *> (current);
         }
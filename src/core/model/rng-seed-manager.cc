@@ -57,4 +57,10 @@ uint64_t RngSeedManager::GetNextStreamIndex (void)
   return next;
 }
 
+void RngSeedManager::ResetNextStreamIndex (uint64_t index)
+{
+  NS_LOG_FUNCTION (index);
+  g_nextStreamIndex = index;
+}
+
 } // namespace ns3
@@ -61,6 +61,15 @@ public:
   static uint64_t GetRun (void);
 
   static uint64_t GetNextStreamIndex(void);
+  /**
+   * \brief Make GetNextStreamIndex return index next
+   * \param index an index GetNextStreamIndex returned before
+   *
+   * The random variables created from then on draw from the same streams
+   * as those created after index was returned, so that a program can run
+   * several simulations from the same starting point.
+   */
+  static void ResetNextStreamIndex (uint64_t index);
 
 };
 
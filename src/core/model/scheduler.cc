@@ -19,6 +19,7 @@
  */
 
 #include "scheduler.h"
+#include "event-impl.h"
 #include "assert.h"
 #include "log.h"
 
@@ -42,4 +43,35 @@ Scheduler::GetTypeId (void)
   return tid;
 }
 
+bool
+Scheduler::TryRemove (const Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  return false;
+}
+
+void
+Scheduler::RemoveCancelled (std::vector<Event> &cancelled)
+{
+  NS_LOG_FUNCTION (this);
+  std::vector<Event> kept;
+  while (!IsEmpty ())
+    {
+      Event ev = RemoveNext ();
+      if (ev.impl->IsCancelled ())
+        {
+          cancelled.push_back (ev);
+        }
+      else
+        {
+          kept.push_back (ev);
+        }
+    }
+  // inserting the latest first keeps lists from being searched
+  for (std::vector<Event>::reverse_iterator i = kept.rbegin (); i != kept.rend (); i++)
+    {
+      Insert (*i);
+    }
+}
+
 } // namespace ns3
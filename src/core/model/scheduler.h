@@ -22,6 +22,7 @@
 #define SCHEDULER_H
 
 #include <stdint.h>
+#include <vector>
 #include "object.h"
 
 namespace ns3 {
@@ -95,6 +96,32 @@ public:
    * This methods cannot be invoked if the list is empty.
    */
   virtual void Remove (const Event &ev) = 0;
+  /**
+   * \param ev the event to remove
+   * \returns true if the event was removed, false if it isn't in the
+   *      event list or if the scheduler can't remove it in at most
+   *      logarithmic time.
+   *
+   * Simulators try to remove cancelled events this way right away rather
+   * than leaving them in the event list until they expire.  Unlike Remove,
+   * this method may be given an event which isn't in the event list, such
+   * as one scheduled in an earlier simulation.  The default implementation
+   * returns false.
+   */
+  virtual bool TryRemove (const Event &ev);
+  /**
+   * \param cancelled the vector to which the cancelled events removed are added
+   *
+   * Remove all the cancelled events from the event list.  The caller is
+   * responsible for unreferencing the events removed, as after the other
+   * Remove methods.
+   *
+   * The default implementation removes all the events and inserts those
+   * which aren't cancelled back, the latest first, so schedulers which
+   * assume that no event is inserted before the last one removed must
+   * override it.
+   */
+  virtual void RemoveCancelled (std::vector<Event> &cancelled);
 };
 
 /* Note the invariants which this function must provide:
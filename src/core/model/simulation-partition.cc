@@ -0,0 +1,98 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "simulation-partition.h"
+
+namespace ns3 {
+
+__thread SimulationPartition *SimulationPartition::g_current = 0;
+
+SimulationPartition::SimulationPartition (uint32_t id)
+  : m_id (id),
+    m_uid (0)
+{
+}
+
+SimulationPartition::~SimulationPartition ()
+{
+  for (uint32_t i = 0; i < m_buffers.size (); i++)
+    {
+      delete m_buffers[i].second;
+    }
+}
+
+SimulationPartition *
+SimulationPartition::GetCurrent (void)
+{
+  return g_current;
+}
+
+void
+SimulationPartition::SetCurrent (SimulationPartition *partition)
+{
+  g_current = partition;
+}
+
+std::ostream *
+SimulationPartition::GetStream (std::ostream *os)
+{
+  if (g_current == 0)
+    {
+      return os;
+    }
+  return g_current->GetBuffer (os);
+}
+
+std::ostream *
+SimulationPartition::GetBuffer (std::ostream *os)
+{
+  // a node writes to few streams
+  for (uint32_t i = 0; i < m_buffers.size (); i++)
+    {
+      if (m_buffers[i].first == os)
+        {
+          return m_buffers[i].second;
+        }
+    }
+  std::ostringstream *buffer = new std::ostringstream ();
+  // the buffer formats numbers as the stream does
+  buffer->copyfmt (*os);
+  m_buffers.push_back (std::make_pair (os, buffer));
+  return buffer;
+}
+
+uint64_t
+SimulationPartition::AllocateUid (void)
+{
+  return static_cast<uint64_t> (m_id) << 32 | m_uid++;
+}
+
+void
+SimulationPartition::Flush (void)
+{
+  for (uint32_t i = 0; i < m_buffers.size (); i++)
+    {
+      std::ostringstream *buffer = m_buffers[i].second;
+      if (buffer->tellp () > 0)
+        {
+          std::string data = buffer->str ();
+          m_buffers[i].first->write (data.data (), data.size ());
+          buffer->str ("");
+        }
+    }
+}
+
+} // namespace ns3
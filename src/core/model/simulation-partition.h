@@ -0,0 +1,93 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SIMULATION_PARTITION_H
+#define SIMULATION_PARTITION_H
+
+#include <stdint.h>
+#include <ostream>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup core
+ * \brief per-node state of a parallel simulation
+ *
+ * A simulator implementation which runs the events of different nodes on
+ * several threads gives each node a partition, and makes it current on
+ * the thread which runs the events of the node.  So that the results
+ * don't depend on which threads ran the nodes, nor when, the code the
+ * events call draws uids from the counter of the current partition
+ * rather than from a global one, and writes its output to the streams
+ * of the current partition, which the simulator flushes to the real ones
+ * in the order of the partitions once the threads are done.
+ */
+class SimulationPartition
+{
+public:
+  /**
+   * \param id the upper 32 bits of the uids of the partition
+   */
+  SimulationPartition (uint32_t id);
+  ~SimulationPartition ();
+
+  /**
+   * \returns the partition whose events the calling thread runs, or 0
+   */
+  static SimulationPartition *GetCurrent (void);
+  /**
+   * \param partition the partition whose events the calling thread runs
+   *        from now on, or 0
+   */
+  static void SetCurrent (SimulationPartition *partition);
+  /**
+   * \param os a stream
+   * \returns the stream to write to instead of os: os itself, or the
+   *          buffer of the current partition for it
+   */
+  static std::ostream *GetStream (std::ostream *os);
+
+  /**
+   * \returns the next uid of the partition: its id in the upper 32 bits
+   *          and a counter in the lower ones
+   */
+  uint64_t AllocateUid (void);
+  /**
+   * Writes what was written to the buffers of the partition to their
+   * streams, in the order the streams were first written to.
+   */
+  void Flush (void);
+
+private:
+  SimulationPartition (const SimulationPartition &);
+  SimulationPartition &operator = (const SimulationPartition &);
+
+  std::ostream *GetBuffer (std::ostream *os);
+
+  static __thread SimulationPartition *g_current;
+
+  uint32_t m_id;
+  uint32_t m_uid;
+  // the streams written to, and their buffers
+  std::vector<std::pair<std::ostream *, std::ostringstream *> > m_buffers;
+};
+
+} // namespace ns3
+
+#endif /* SIMULATION_PARTITION_H */
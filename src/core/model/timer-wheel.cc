@@ -0,0 +1,362 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "timer-wheel.h"
+#include "simulator.h"
+#include "assert.h"
+#include "log.h"
+
+NS_LOG_COMPONENT_DEFINE ("TimerWheel");
+
+namespace ns3 {
+
+static const uint32_t NONE = 0xffffffff;
+
+TimerWheel::Id::Id ()
+  : m_index (NONE),
+    m_generation (0)
+{
+}
+
+TimerWheel::TimerWheel (Time tick, uint32_t slotBits, uint32_t levels)
+  : m_tick (tick),
+    m_slotBits (slotBits),
+    m_levels (levels),
+    m_currentTick (0),
+    m_nextTick (0),
+    m_event (),
+    m_nPending (0),
+    m_slots ((levels << slotBits) + 1, NONE),
+    m_free (NONE)
+{
+  NS_LOG_FUNCTION (this << tick << slotBits << levels);
+  NS_ASSERT_MSG (tick.IsStrictlyPositive (), "TimerWheel needs a positive tick");
+  NS_ASSERT_MSG (slotBits > 0 && levels > 1 && slotBits * levels < 64, "TimerWheel needs two to 63/slotBits levels");
+}
+
+TimerWheel::~TimerWheel ()
+{
+  NS_LOG_FUNCTION (this);
+  CancelAll ();
+  m_event.Cancel ();
+}
+
+void
+TimerWheel::SetTick (Time tick)
+{
+  NS_LOG_FUNCTION (this << tick);
+  NS_ASSERT_MSG (m_nPending == 0, "Can't change the tick of a TimerWheel with timeouts pending");
+  NS_ASSERT_MSG (tick.IsStrictlyPositive (), "TimerWheel needs a positive tick");
+  m_tick = tick;
+  m_currentTick = 0;
+  m_event.Cancel ();
+}
+
+Time
+TimerWheel::GetTick (void) const
+{
+  return m_tick;
+}
+
+TimerWheel::Id
+TimerWheel::Schedule (Time const &delay, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << delay << event);
+  NS_ASSERT_MSG (!delay.IsStrictlyNegative (), "TimerWheel can't schedule a timeout in the past");
+
+  // nothing happens before the pending event, so the ticks up to now can be skipped;
+  // an idle wheel starts over from now, since the simulator may have been restarted
+  int64_t tick = m_tick.GetTimeStep ();
+  uint64_t now = Simulator::Now ().GetTimeStep () / tick;
+  if (m_nPending == 0)
+    {
+      m_event.Cancel ();
+      m_currentTick = now;
+    }
+  else if (now > m_currentTick)
+    {
+      m_currentTick = now;
+    }
+  uint64_t expiry = (Simulator::Now ().GetTimeStep () + delay.GetTimeStep () + tick - 1) / tick;
+  if (expiry < m_currentTick)
+    {
+      expiry = m_currentTick;
+    }
+
+  uint32_t index = Allocate ();
+  m_entries[index].event = event;
+  m_entries[index].expiry = expiry;
+  Insert (index);
+  m_nPending++;
+  ScheduleNextTick ();
+
+  Id id;
+  id.m_index = index;
+  id.m_generation = m_entries[index].generation;
+  return id;
+}
+
+TimerWheel::Id
+TimerWheel::Schedule (Time const &delay, void (*f)(void))
+{
+  return Schedule (delay, MakeEvent (f));
+}
+
+void
+TimerWheel::Cancel (Id id)
+{
+  NS_LOG_FUNCTION (this);
+  if (!IsRunning (id))
+    {
+      return;
+    }
+  EventImpl *event = m_entries[id.m_index].event;
+  Unlink (id.m_index);
+  Release (id.m_index);
+  event->Unref ();
+}
+
+void
+TimerWheel::CancelAll (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < m_entries.size (); i++)
+    {
+      EventImpl *event = m_entries[i].event;
+      if (event != 0)
+        {
+          Unlink (i);
+          Release (i);
+          event->Unref ();
+        }
+    }
+}
+
+bool
+TimerWheel::IsRunning (Id id) const
+{
+  return id.m_index < m_entries.size () &&
+         m_entries[id.m_index].generation == id.m_generation &&
+         m_entries[id.m_index].event != 0;
+}
+
+uint32_t
+TimerWheel::GetN (void) const
+{
+  return m_nPending;
+}
+
+uint32_t
+TimerWheel::Allocate (void)
+{
+  if (m_free == NONE)
+    {
+      Entry entry;
+      entry.event = 0;
+      entry.generation = 1;
+      entry.slot = NONE;
+      entry.prev = entry.next = NONE;
+      m_entries.push_back (entry);
+      return m_entries.size () - 1;
+    }
+  uint32_t index = m_free;
+  m_free = m_entries[index].next;
+  return index;
+}
+
+void
+TimerWheel::Release (uint32_t index)
+{
+  Entry &entry = m_entries[index];
+  entry.event = 0;
+  // so that the ids of the timeout no longer match
+  entry.generation++;
+  entry.slot = NONE;
+  entry.next = m_free;
+  m_free = index;
+  m_nPending--;
+}
+
+void
+TimerWheel::Link (uint32_t index, uint32_t slot)
+{
+  Entry &entry = m_entries[index];
+  entry.slot = slot;
+  entry.prev = NONE;
+  entry.next = m_slots[slot];
+  if (entry.next != NONE)
+    {
+      m_entries[entry.next].prev = index;
+    }
+  m_slots[slot] = index;
+}
+
+void
+TimerWheel::Unlink (uint32_t index)
+{
+  Entry &entry = m_entries[index];
+  if (entry.prev != NONE)
+    {
+      m_entries[entry.prev].next = entry.next;
+    }
+  else
+    {
+      m_slots[entry.slot] = entry.next;
+    }
+  if (entry.next != NONE)
+    {
+      m_entries[entry.next].prev = entry.prev;
+    }
+}
+
+void
+TimerWheel::Insert (uint32_t index)
+{
+  uint64_t expiry = m_entries[index].expiry;
+  NS_ASSERT (expiry >= m_currentTick);
+
+  // those beyond the last level wait in its furthest slot to be spread again
+  uint64_t delta = expiry - m_currentTick;
+  uint64_t range = (uint64_t)1 << (m_slotBits * m_levels);
+  if (delta >= range)
+    {
+      delta = range - 1;
+      expiry = m_currentTick + delta;
+    }
+
+  uint32_t level = 0;
+  while (delta >= ((uint64_t)1 << (m_slotBits * (level + 1))))
+    {
+      level++;
+    }
+  uint64_t mask = ((uint64_t)1 << m_slotBits) - 1;
+  Link (index, (level << m_slotBits) + ((expiry >> (m_slotBits * level)) & mask));
+}
+
+void
+TimerWheel::Cascade (uint32_t level)
+{
+  uint64_t mask = ((uint64_t)1 << m_slotBits) - 1;
+  uint32_t slot = (level << m_slotBits) + ((m_currentTick >> (m_slotBits * level)) & mask);
+  uint32_t index = m_slots[slot];
+  m_slots[slot] = NONE;
+  while (index != NONE)
+    {
+      uint32_t next = m_entries[index].next;
+      Insert (index);
+      index = next;
+    }
+}
+
+uint64_t
+TimerWheel::GetNextTick (void) const
+{
+  uint64_t slots = (uint64_t)1 << m_slotBits;
+  uint64_t mask = slots - 1;
+
+  // the first level may hold timeouts for the ticks until it wraps around
+  uint64_t tick = m_currentTick;
+  for (; tick < m_currentTick + slots; tick++)
+    {
+      if (m_slots[tick & mask] != NONE)
+        {
+          return tick;
+        }
+      if ((tick & mask) == 0)
+        {
+          uint64_t second = (tick >> m_slotBits) & mask;
+          if (second == 0 || m_slots[slots + second] != NONE)
+            {
+              return tick;
+            }
+        }
+    }
+
+  // after that, only spreading the second level fills it, and the further
+  // levels are spread at the start of each of its rotations
+  tick = (tick + mask) & ~mask;
+  while (true)
+    {
+      uint64_t second = (tick >> m_slotBits) & mask;
+      if (second == 0 || m_slots[slots + second] != NONE)
+        {
+          return tick;
+        }
+      tick += slots;
+    }
+}
+
+void
+TimerWheel::ScheduleNextTick (void)
+{
+  if (m_nPending == 0)
+    {
+      return;
+    }
+  uint64_t next = GetNextTick ();
+  if (m_event.IsRunning () && m_nextTick <= next)
+    {
+      return;
+    }
+  m_event.Cancel ();
+  m_nextTick = next;
+  m_event = Simulator::Schedule (TimeStep (next * m_tick.GetTimeStep ()) - Simulator::Now (),
+                                 &TimerWheel::Expire, this);
+}
+
+void
+TimerWheel::Expire (void)
+{
+  NS_LOG_FUNCTION (this << m_nextTick);
+
+  // nothing was due in the ticks since the last one
+  m_currentTick = m_nextTick;
+  uint64_t mask = ((uint64_t)1 << m_slotBits) - 1;
+  for (uint32_t level = 1; level < m_levels; level++)
+    {
+      if (((m_currentTick >> (m_slotBits * (level - 1))) & mask) != 0)
+        {
+          break;
+        }
+      Cascade (level);
+    }
+
+  // collect those due now first, so that they may cancel each other
+  uint32_t due = m_levels << m_slotBits;
+  uint32_t index = m_slots[m_currentTick & mask];
+  m_slots[m_currentTick & mask] = NONE;
+  while (index != NONE)
+    {
+      uint32_t next = m_entries[index].next;
+      NS_ASSERT (m_entries[index].expiry == m_currentTick);
+      Link (index, due);
+      index = next;
+    }
+  m_currentTick++;
+
+  while (m_slots[due] != NONE)
+    {
+      index = m_slots[due];
+      EventImpl *event = m_entries[index].event;
+      Unlink (index);
+      Release (index);
+      event->Invoke ();
+      event->Unref ();
+    }
+
+  ScheduleNextTick ();
+}
+
+} // namespace ns3
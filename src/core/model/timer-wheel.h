@@ -0,0 +1,198 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include "nstime.h"
+#include "event-id.h"
+#include "event-impl.h"
+#include "make-event.h"
+
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup core
+ * \brief a hierarchical timing wheel for many coarse timeouts
+ *
+ * Applications that keep a timeout per outstanding packet, most of which
+ * are cancelled, can schedule them here instead of with the Simulator.
+ * The wheel rounds every expiration time up to a multiple of its tick, so
+ * the timeouts due in the same tick share one simulator event, and
+ * cancelling a timeout unlinks it from its slot in O(1) rather than
+ * leaving a dead event in the simulator's queue.
+ *
+ * The wheel has a number of levels, each with 2^slotBits slots: the
+ * slots of the first level each hold one tick and those of every other
+ * level hold as many ticks as the whole level below, whose slots they
+ * are spread over as time reaches them.  While it has timeouts pending,
+ * the wheel schedules one simulator event at a time, for the next tick
+ * with a timeout or at which a slot must be spread over the level below.
+ */
+class TimerWheel
+{
+public:
+  /**
+   * Identifies a scheduled timeout, to cancel it.  Ids of timeouts that
+   * have expired or been cancelled are never reused.
+   */
+  class Id
+  {
+public:
+    Id ();
+private:
+    friend class TimerWheel;
+    uint32_t m_index;
+    uint32_t m_generation;
+  };
+
+  /**
+   * \param tick the resolution of the timeouts
+   * \param slotBits log2 of the number of slots in each level
+   * \param levels the number of levels, at least two; timeouts further in
+   *        the future than all of them cover are spread over them repeatedly
+   */
+  TimerWheel (Time tick = MilliSeconds (1), uint32_t slotBits = 8, uint32_t levels = 4);
+  ~TimerWheel ();
+
+  /**
+   * \param tick the resolution of the timeouts
+   *
+   * Only allowed while no timeouts are pending.
+   */
+  void SetTick (Time tick);
+  Time GetTick (void) const;
+
+  /**
+   * \param delay the time from now after which the timeout expires,
+   *        rounded up to the next tick
+   * \param event the event to invoke when it does, which the wheel now owns
+   * \returns the id of the timeout
+   */
+  Id Schedule (Time const &delay, EventImpl *event);
+  template <typename MEM, typename OBJ>
+  Id Schedule (Time const &delay, MEM mem_ptr, OBJ obj);
+  template <typename MEM, typename OBJ, typename T1>
+  Id Schedule (Time const &delay, MEM mem_ptr, OBJ obj, T1 a1);
+  template <typename MEM, typename OBJ, typename T1, typename T2>
+  Id Schedule (Time const &delay, MEM mem_ptr, OBJ obj, T1 a1, T2 a2);
+  Id Schedule (Time const &delay, void (*f)(void));
+  template <typename U1, typename T1>
+  Id Schedule (Time const &delay, void (*f)(U1), T1 a1);
+
+  /**
+   * \param id the timeout to cancel
+   *
+   * Does nothing if it already expired or was cancelled.
+   */
+  void Cancel (Id id);
+  /**
+   * Cancel all the pending timeouts.
+   */
+  void CancelAll (void);
+  /**
+   * \param id the timeout to check
+   * \returns true if it is still pending
+   */
+  bool IsRunning (Id id) const;
+  /**
+   * \returns the number of pending timeouts
+   */
+  uint32_t GetN (void) const;
+
+private:
+  TimerWheel (const TimerWheel &);
+  TimerWheel & operator = (const TimerWheel &);
+
+  /** One timeout, linked into the list of its slot. */
+  struct Entry
+  {
+    EventImpl *event;
+    uint64_t expiry;
+    uint32_t generation;
+    uint32_t slot;
+    uint32_t prev;
+    uint32_t next;
+  };
+
+  uint32_t Allocate (void);
+  void Release (uint32_t index);
+  void Link (uint32_t index, uint32_t slot);
+  void Unlink (uint32_t index);
+  /** Link the timeout into the slot for its expiry as seen from the current tick. */
+  void Insert (uint32_t index);
+  /** Spread the timeouts in the slot over the levels below. */
+  void Cascade (uint32_t level);
+  uint64_t GetNextTick (void) const;
+  void ScheduleNextTick (void);
+  void Expire (void);
+
+  Time m_tick;
+  uint32_t m_slotBits;
+  uint32_t m_levels;
+  /** the next tick to process */
+  uint64_t m_currentTick;
+  /** the tick m_event expires at, if it is running */
+  uint64_t m_nextTick;
+  EventId m_event;
+  uint32_t m_nPending;
+  /** head of the list of each slot of each level, followed by the list of those expiring now */
+  std::vector<uint32_t> m_slots;
+  std::vector<Entry> m_entries;
+  uint32_t m_free;
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+   Implementation of templates defined above
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename MEM, typename OBJ>
+TimerWheel::Id
+TimerWheel::Schedule (Time const &delay, MEM mem_ptr, OBJ obj)
+{
+  return Schedule (delay, MakeEvent (mem_ptr, obj));
+}
+
+template <typename MEM, typename OBJ, typename T1>
+TimerWheel::Id
+TimerWheel::Schedule (Time const &delay, MEM mem_ptr, OBJ obj, T1 a1)
+{
+  return Schedule (delay, MakeEvent (mem_ptr, obj, a1));
+}
+
+template <typename MEM, typename OBJ, typename T1, typename T2>
+TimerWheel::Id
+TimerWheel::Schedule (Time const &delay, MEM mem_ptr, OBJ obj, T1 a1, T2 a2)
+{
+  return Schedule (delay, MakeEvent (mem_ptr, obj, a1, a2));
+}
+
+template <typename U1, typename T1>
+TimerWheel::Id
+TimerWheel::Schedule (Time const &delay, void (*f)(U1), T1 a1)
+{
+  return Schedule (delay, MakeEvent (f, a1));
+}
+
+} // namespace ns3
+
+#endif /* TIMER_WHEEL_H */
@@ -23,6 +23,16 @@
 #include "ns3/heap-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/calendar-scheduler.h"
+#include "ns3/ladder-scheduler.h"
+#include "ns3/four-ary-heap-scheduler.h"
+#include "ns3/default-simulator-impl.h"
+#include "ns3/uinteger.h"
+#include "ns3/string.h"
+#include "ns3/make-event.h"
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <vector>
 
 using namespace ns3;
 
@@ -459,6 +469,400 @@ SimulatorTemplateTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+// Checks that a scheduler gives the same events in the same order as the
+// map scheduler when the timestamps are very unevenly spread: bursts of
+// events at the same time, events just ahead and events far ahead, with
+// some removed before they are due.
+class SchedulerOrderTestCase : public TestCase
+{
+public:
+  SchedulerOrderTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  uint32_t Random (void);
+  ObjectFactory m_schedulerFactory;
+  uint32_t m_seed;
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check the order of unevenly spread events with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory),
+    m_seed (1)
+{
+}
+uint32_t
+SchedulerOrderTestCase::Random (void)
+{
+  m_seed = m_seed * 1103515245 + 12345;
+  return m_seed >> 8;
+}
+void
+SchedulerOrderTestCase::DoRun (void)
+{
+  Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler> ();
+  Ptr<Scheduler> reference = CreateObject<MapScheduler> ();
+  std::vector<Scheduler::Event> pending;
+  uint64_t now = 0;
+  uint32_t uid = 0;
+  for (uint32_t step = 0; step < 5000; step++)
+    {
+      uint32_t action = Random () % 8;
+      if (action < 2 || reference->IsEmpty ())
+        {
+          uint32_t n = Random () % 4 == 0 ? 100 : 1;
+          for (uint32_t i = 0; i < n; i++)
+            {
+              uint64_t delay;
+              switch (Random () % 4)
+                {
+                case 0:
+                  delay = 0;
+                  break;
+                case 1:
+                  delay = Random () % 10;
+                  break;
+                case 2:
+                  delay = Random () % 100000;
+                  break;
+                default:
+                  delay = 1000000000 + Random () % 1000;
+                  break;
+                }
+              Scheduler::Event ev;
+              ev.impl = MakeEvent (&foo0);
+              ev.key.m_ts = now + delay;
+              ev.key.m_uid = uid++;
+              ev.key.m_context = 0;
+              scheduler->Insert (ev);
+              reference->Insert (ev);
+              pending.push_back (ev);
+            }
+        }
+      else if (action < 7)
+        {
+          Scheduler::Event expected = reference->RemoveNext ();
+          Scheduler::Event next = scheduler->PeekNext ();
+          NS_TEST_ASSERT_MSG_EQ (next.key.m_uid, expected.key.m_uid, "wrong next event at step " << step);
+          next = scheduler->RemoveNext ();
+          NS_TEST_ASSERT_MSG_EQ (next.key.m_uid, expected.key.m_uid, "wrong event removed at step " << step);
+          now = next.key.m_ts;
+          next.impl->Unref ();
+          for (std::vector<Scheduler::Event>::iterator i = pending.begin (); i != pending.end (); i++)
+            {
+              if (i->key.m_uid == next.key.m_uid)
+                {
+                  pending.erase (i);
+                  break;
+                }
+            }
+        }
+      else
+        {
+          uint32_t i = Random () % pending.size ();
+          scheduler->Remove (pending[i]);
+          reference->Remove (pending[i]);
+          pending[i].impl->Unref ();
+          pending.erase (pending.begin () + i);
+        }
+    }
+  // cancel a third of the events left and remove them together
+  uint32_t nCancelled = 0;
+  for (uint32_t i = 0; i < pending.size (); i += 3)
+    {
+      pending[i].impl->Cancel ();
+      reference->Remove (pending[i]);
+      nCancelled++;
+    }
+  std::vector<Scheduler::Event> cancelled;
+  scheduler->RemoveCancelled (cancelled);
+  NS_TEST_ASSERT_MSG_EQ (cancelled.size (), nCancelled, "wrong number of cancelled events removed");
+  for (std::vector<Scheduler::Event>::iterator i = cancelled.begin (); i != cancelled.end (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (i->impl->IsCancelled (), true, "event removed which wasn't cancelled");
+      i->impl->Unref ();
+    }
+  while (!reference->IsEmpty ())
+    {
+      NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), false, "scheduler emptied too soon");
+      Scheduler::Event next = scheduler->RemoveNext ();
+      NS_TEST_ASSERT_MSG_EQ (next.key.m_uid, reference->RemoveNext ().key.m_uid, "wrong event removed while draining");
+      next.impl->Unref ();
+    }
+  NS_TEST_ASSERT_MSG_EQ (scheduler->IsEmpty (), true, "scheduler not emptied");
+}
+
+// Checks that events are recycled through the event pools, and that events
+// too large for the pools are counted apart.
+struct LargeArgument
+{
+  char data[300];
+};
+
+static void
+LargeArgumentFunction (LargeArgument)
+{
+}
+
+class EventPoolTestCase : public TestCase
+{
+public:
+  EventPoolTestCase ();
+  virtual void DoRun (void);
+  void Schedule (uint32_t n);
+};
+
+EventPoolTestCase::EventPoolTestCase ()
+  : TestCase ("Check that events are recycled through the event pools")
+{
+}
+void
+EventPoolTestCase::Schedule (uint32_t n)
+{
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Simulator::Schedule (MicroSeconds (i), &foo0);
+      Simulator::Schedule (MicroSeconds (i), &EventPoolTestCase::Schedule, this, 0);
+    }
+}
+void
+EventPoolTestCase::DoRun (void)
+{
+  EventImpl::PoolStats before = EventImpl::GetPoolStats ();
+  Schedule (1000);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  EventImpl::PoolStats first = EventImpl::GetPoolStats ();
+  NS_TEST_ASSERT_MSG_EQ ((first.allocations - before.allocations >= 2000), true, "events not allocated from the pools");
+  NS_TEST_ASSERT_MSG_EQ (first.allocations - before.allocations, first.frees - before.frees, "events not returned to the pools");
+
+  // the blocks freed by the first run are enough for the second one
+  Schedule (1000);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  EventImpl::PoolStats second = EventImpl::GetPoolStats ();
+  NS_TEST_ASSERT_MSG_EQ (second.slabs, first.slabs, "events not recycled");
+  NS_TEST_ASSERT_MSG_EQ (second.allocations - first.allocations, second.frees - first.frees, "events not returned to the pools");
+
+  LargeArgument large;
+  Simulator::Schedule (Seconds (1), &LargeArgumentFunction, large);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  EventImpl::PoolStats third = EventImpl::GetPoolStats ();
+  NS_TEST_ASSERT_MSG_EQ (third.largeAllocations - second.largeAllocations, 1, "large event not counted");
+}
+
+// Checks that cancelled events are removed from the event list at once
+// when too many of them are left in it, or right away with schedulers
+// which remove events quickly.
+class CancelledEventsTestCase : public TestCase
+{
+public:
+  CancelledEventsTestCase (ObjectFactory schedulerFactory);
+  virtual void DoRun (void);
+  void Count (void);
+  ObjectFactory m_schedulerFactory;
+  uint32_t m_count;
+};
+
+CancelledEventsTestCase::CancelledEventsTestCase (ObjectFactory schedulerFactory)
+  : TestCase ("Check that cancelled events are removed with " +
+              schedulerFactory.GetTypeId ().GetName ()),
+    m_schedulerFactory (schedulerFactory),
+    m_count (0)
+{
+}
+void
+CancelledEventsTestCase::Count (void)
+{
+  m_count++;
+}
+void
+CancelledEventsTestCase::DoRun (void)
+{
+  Simulator::SetScheduler (m_schedulerFactory);
+  Ptr<DefaultSimulatorImpl> impl = DynamicCast<DefaultSimulatorImpl> (Simulator::GetImplementation ());
+  if (impl == 0)
+    {
+      Simulator::Destroy ();
+      return;
+    }
+  impl->SetAttribute ("CompactionMinEvents", UintegerValue (10));
+  bool fast = m_schedulerFactory.GetTypeId () == MapScheduler::GetTypeId ()
+    || m_schedulerFactory.GetTypeId () == FourAryHeapScheduler::GetTypeId ();
+
+  std::vector<EventId> ids;
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      ids.push_back (Simulator::Schedule (MicroSeconds (i), &CancelledEventsTestCase::Count, this));
+    }
+  for (uint32_t i = 0; i < 40; i++)
+    {
+      Simulator::Cancel (ids[i]);
+    }
+  NS_TEST_ASSERT_MSG_EQ (impl->GetCompactions (), 0, "compacted too soon");
+  if (fast)
+    {
+      NS_TEST_ASSERT_MSG_EQ (impl->GetCancelledRatio (), 0, "cancelled events left in the event list");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ_TOL (impl->GetCancelledRatio (), 0.4, 1e-9, "wrong cancelled ratio");
+    }
+  for (uint32_t i = 40; i < 60; i++)
+    {
+      Simulator::Cancel (ids[i]);
+    }
+  // the 51st cancelled event was more than half of the events, and 9 of
+  // the 49 events left have been cancelled since
+  NS_TEST_ASSERT_MSG_EQ (impl->GetCompactions (), (fast ? 0 : 1), "wrong number of compactions");
+  NS_TEST_ASSERT_MSG_EQ_TOL (impl->GetCancelledRatio (), (fast ? 0 : 9.0 / 49), 1e-9, "wrong cancelled ratio after compaction");
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (Simulator::IsExpired (ids[i]), (i < 60), "wrong expiry of event " << i);
+    }
+
+  EventId stale = Simulator::Schedule (Seconds (1), &CancelledEventsTestCase::Count, this);
+  Simulator::Stop (MicroSeconds (100));
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_count, 40, "wrong number of events run");
+  Simulator::Destroy ();
+
+  // an event left from an earlier simulation isn't in the event list
+  Simulator::SetScheduler (m_schedulerFactory);
+  Simulator::Schedule (Seconds (1), &CancelledEventsTestCase::Count, this);
+  Simulator::Cancel (stale);
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_count, 41, "wrong number of events run after an earlier simulation");
+  Simulator::Destroy ();
+}
+
+// Checks that the profiler attributes the events run to their type and
+// function and node, counts the events they schedule and skips cancelled
+// events.
+class EventProfilerTestCase : public TestCase
+{
+public:
+  EventProfilerTestCase ();
+  virtual void DoRun (void);
+  void Count (void);
+  void FanOut (void);
+  uint32_t m_count;
+};
+
+EventProfilerTestCase::EventProfilerTestCase ()
+  : TestCase ("Check that the event profiler attributes events to their function and node"),
+    m_count (0)
+{
+}
+void
+EventProfilerTestCase::Count (void)
+{
+  m_count++;
+}
+void
+EventProfilerTestCase::FanOut (void)
+{
+  Simulator::Schedule (MicroSeconds (1), &EventProfilerTestCase::Count, this);
+  Simulator::Schedule (MicroSeconds (2), &EventProfilerTestCase::Count, this);
+}
+void
+EventProfilerTestCase::DoRun (void)
+{
+  Ptr<DefaultSimulatorImpl> impl = DynamicCast<DefaultSimulatorImpl> (Simulator::GetImplementation ());
+  if (impl == 0)
+    {
+      Simulator::Destroy ();
+      return;
+    }
+  std::string filename = CreateTempDirFilename ("event-profile.txt");
+  impl->SetAttribute ("ProfileFile", StringValue (filename));
+
+  Simulator::ScheduleWithContext (7, MicroSeconds (1), &EventProfilerTestCase::FanOut, this);
+  Simulator::Schedule (MicroSeconds (2), &EventProfilerTestCase::Count, this);
+  EventId cancelled = Simulator::Schedule (MicroSeconds (3), &EventProfilerTestCase::Count, this);
+  Simulator::Cancel (cancelled);
+  NS_TEST_ASSERT_MSG_EQ ((impl->GetProfiler () == 0), true, "profiler created before Run");
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_count, 3, "wrong number of events run");
+
+  const EventProfiler *profiler = impl->GetProfiler ();
+  NS_TEST_ASSERT_MSG_NE (profiler, 0, "no profiler");
+  EventProfiler::Entry total = profiler->GetTotal ();
+  NS_TEST_ASSERT_MSG_EQ (total.count, 4, "wrong number of events profiled");
+  NS_TEST_ASSERT_MSG_EQ (total.fanOut, 2, "wrong number of events scheduled");
+  Simulator::Destroy ();
+
+  std::ifstream is (filename.c_str ());
+  NS_TEST_ASSERT_MSG_EQ (is.good (), true, "no profile written to " << filename);
+  std::ostringstream report;
+  report << is.rdbuf ();
+  std::string text = report.str ();
+  NS_TEST_ASSERT_MSG_NE (text.find ("# 4 events calling 2 functions"), std::string::npos, "wrong summary in " << text);
+  NS_TEST_ASSERT_MSG_NE (text.find ("# by node"), std::string::npos, "no by-node report in " << text);
+  NS_TEST_ASSERT_MSG_NE (text.find ("EventProfilerTestCase::FanOut"), std::string::npos, "no event type in " << text);
+  NS_TEST_ASSERT_MSG_NE (text.find ("\n         7"), std::string::npos, "node 7 missing in " << text);
+}
+
+// An object whose Run replaces it by another, whose Run differs, as if it
+// were deleted and its memory reused by the time Invoke returns.
+class ProfiledObject
+{
+public:
+  virtual ~ProfiledObject () {}
+  virtual void Run (void) = 0;
+};
+class ReplacedObject : public ProfiledObject
+{
+public:
+  virtual void Run (void) {}
+};
+class ReplacingObject : public ProfiledObject
+{
+public:
+  virtual void Run (void)
+  {
+    this->~ReplacingObject ();
+    new (this) ReplacedObject ();
+  }
+};
+
+// Checks that the profiler looks up the function of an event before running
+// it, as calling it may free the object a virtual function is looked up in.
+class EventProfilerLifetimeTestCase : public TestCase
+{
+public:
+  EventProfilerLifetimeTestCase ();
+  virtual void DoRun (void);
+};
+
+EventProfilerLifetimeTestCase::EventProfilerLifetimeTestCase ()
+  : TestCase ("Check that the event profiler looks up the function of an event before running it")
+{
+}
+void
+EventProfilerLifetimeTestCase::DoRun (void)
+{
+  Ptr<DefaultSimulatorImpl> impl = DynamicCast<DefaultSimulatorImpl> (Simulator::GetImplementation ());
+  if (impl == 0)
+    {
+      Simulator::Destroy ();
+      return;
+    }
+  impl->SetAttribute ("ProfileFile", StringValue (CreateTempDirFilename ("event-profile.txt")));
+
+  ProfiledObject *object = new ReplacingObject ();
+  Simulator::Schedule (MicroSeconds (1), &ProfiledObject::Run, object);
+  Simulator::Run ();
+
+  ReplacingObject probe;
+  EventImpl *event = MakeEvent (&ProfiledObject::Run, &probe);
+  NS_TEST_ASSERT_MSG_EQ (impl->GetProfiler ()->Get (event).count, 1,
+                         "event not profiled under the function it called");
+  event->Unref ();
+  delete object;
+  Simulator::Destroy ();
+}
+
 class SimulatorTestSuite : public TestSuite
 {
 public:
@@ -475,5 +879,22 @@ public:
     AddTestCase (new SimulatorEventsTestCase (factory));
     factory.SetTypeId (CalendarScheduler::GetTypeId ());
     AddTestCase (new SimulatorEventsTestCase (factory));
+    factory.SetTypeId (LadderScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory));
+    AddTestCase (new SchedulerOrderTestCase (factory));
+    factory.SetTypeId (FourAryHeapScheduler::GetTypeId ());
+    AddTestCase (new SimulatorEventsTestCase (factory));
+    AddTestCase (new SchedulerOrderTestCase (factory));
+    factory.SetTypeId (CalendarScheduler::GetTypeId ());
+    AddTestCase (new SchedulerOrderTestCase (factory));
+    AddTestCase (new EventPoolTestCase ());
+    factory.SetTypeId (ListScheduler::GetTypeId ());
+    AddTestCase (new CancelledEventsTestCase (factory));
+    factory.SetTypeId (MapScheduler::GetTypeId ());
+    AddTestCase (new CancelledEventsTestCase (factory));
+    factory.SetTypeId (FourAryHeapScheduler::GetTypeId ());
+    AddTestCase (new CancelledEventsTestCase (factory));
+    AddTestCase (new EventProfilerTestCase ());
+    AddTestCase (new EventProfilerLifetimeTestCase ());
   }
 } g_simulatorTestSuite;
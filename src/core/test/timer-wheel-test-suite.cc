@@ -0,0 +1,186 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ns3/timer-wheel.h"
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/random-variable.h"
+
+#include <vector>
+
+using namespace ns3;
+
+class TimerWheelExpireTestCase : public TestCase
+{
+public:
+  TimerWheelExpireTestCase ();
+  virtual void DoRun (void);
+  void Expire (uint32_t i);
+  void ScheduleMore (void);
+  void CancelOther (uint32_t i);
+
+  TimerWheel *m_wheel;
+  std::vector<Time> m_expected;
+  std::vector<Time> m_expired;
+  TimerWheel::Id m_ids[2];
+};
+
+TimerWheelExpireTestCase::TimerWheelExpireTestCase ()
+  : TestCase ("Check that timeouts expire at their next tick")
+{
+}
+
+void
+TimerWheelExpireTestCase::Expire (uint32_t i)
+{
+  m_expired[i] = Simulator::Now ();
+}
+
+void
+TimerWheelExpireTestCase::ScheduleMore (void)
+{
+  // while the wheel is busy expiring others
+  m_expected.push_back (MicroSeconds ((Simulator::Now ().GetMicroSeconds () + 9) / 10 * 10));
+  m_expired.push_back (Seconds (-1));
+  m_wheel->Schedule (MicroSeconds (0), &TimerWheelExpireTestCase::Expire, this, m_expected.size () - 1);
+}
+
+void
+TimerWheelExpireTestCase::CancelOther (uint32_t i)
+{
+  m_expired[i] = Simulator::Now ();
+  m_wheel->Cancel (m_ids[1 - i]);
+}
+
+void
+TimerWheelExpireTestCase::DoRun (void)
+{
+  // small enough that the timeouts are spread over all the levels and beyond
+  TimerWheel wheel (MicroSeconds (10), 2, 2);
+  m_wheel = &wheel;
+
+  UniformVariable random (0, 2000);
+  for (uint32_t i = 0; i < 200; i++)
+    {
+      Time delay = MicroSeconds (random.GetInteger (0, 2000));
+      m_expected.push_back (MicroSeconds ((delay.GetMicroSeconds () + 9) / 10 * 10));
+      m_expired.push_back (Seconds (-1));
+      wheel.Schedule (delay, &TimerWheelExpireTestCase::Expire, this, i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (wheel.GetN (), 200, "wrong number of pending timeouts");
+
+  // later timeouts, scheduled after the wheel moved on
+  Simulator::Schedule (MicroSeconds (125), &TimerWheelExpireTestCase::ScheduleMore, this);
+  Simulator::Schedule (MicroSeconds (777), &TimerWheelExpireTestCase::ScheduleMore, this);
+  Simulator::Run ();
+
+  for (uint32_t i = 0; i < m_expected.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_expired[i], m_expected[i], "timeout " << i << " expired at the wrong time");
+    }
+  NS_TEST_ASSERT_MSG_EQ (wheel.GetN (), 0, "timeouts still pending after they all expired");
+
+  // those due in the same tick may cancel each other
+  m_expected.clear ();
+  m_expired.clear ();
+  m_expired.resize (2, Seconds (-1));
+  m_ids[0] = wheel.Schedule (MicroSeconds (5), &TimerWheelExpireTestCase::CancelOther, this, 0);
+  m_ids[1] = wheel.Schedule (MicroSeconds (7), &TimerWheelExpireTestCase::CancelOther, this, 1);
+  Simulator::Run ();
+  bool one = m_expired[0].IsStrictlyPositive () != m_expired[1].IsStrictlyPositive ();
+  NS_TEST_ASSERT_MSG_EQ (one, true, "exactly one of the timeouts should have expired");
+
+  Simulator::Destroy ();
+}
+
+
+class TimerWheelCancelTestCase : public TestCase
+{
+public:
+  TimerWheelCancelTestCase ();
+  virtual void DoRun (void);
+  void Expire (void);
+  uint32_t m_nExpired;
+};
+
+TimerWheelCancelTestCase::TimerWheelCancelTestCase ()
+  : TestCase ("Check that cancelled timeouts don't expire")
+{
+}
+
+void
+TimerWheelCancelTestCase::Expire (void)
+{
+  m_nExpired++;
+}
+
+void
+TimerWheelCancelTestCase::DoRun (void)
+{
+  m_nExpired = 0;
+  TimerWheel wheel (MilliSeconds (1));
+
+  TimerWheel::Id none;
+  NS_TEST_ASSERT_MSG_EQ (wheel.IsRunning (none), false, "a default id shouldn't be running");
+
+  TimerWheel::Id first = wheel.Schedule (Seconds (1), &TimerWheelCancelTestCase::Expire, this);
+  TimerWheel::Id second = wheel.Schedule (Seconds (1), &TimerWheelCancelTestCase::Expire, this);
+  TimerWheel::Id third = wheel.Schedule (Seconds (100), &TimerWheelCancelTestCase::Expire, this);
+  NS_TEST_ASSERT_MSG_EQ (wheel.IsRunning (first), true, "scheduled timeout not running");
+
+  wheel.Cancel (first);
+  NS_TEST_ASSERT_MSG_EQ (wheel.IsRunning (first), false, "cancelled timeout still running");
+  NS_TEST_ASSERT_MSG_EQ (wheel.IsRunning (second), true, "cancelling one timeout cancelled another");
+  NS_TEST_ASSERT_MSG_EQ (wheel.GetN (), 2, "wrong number of pending timeouts after Cancel");
+
+  // the freed entry is reused, but the old id mustn't match it
+  TimerWheel::Id fourth = wheel.Schedule (Seconds (2), &TimerWheelCancelTestCase::Expire, this);
+  NS_TEST_ASSERT_MSG_EQ (wheel.IsRunning (first), false, "cancelled id matches a new timeout");
+  wheel.Cancel (first);
+  NS_TEST_ASSERT_MSG_EQ (wheel.IsRunning (fourth), true, "cancelling a stale id cancelled a new timeout");
+
+  wheel.Cancel (third);
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_nExpired, 2, "wrong number of timeouts expired");
+  NS_TEST_ASSERT_MSG_EQ (wheel.IsRunning (second), false, "expired timeout still running");
+
+  wheel.Schedule (Seconds (1), &TimerWheelCancelTestCase::Expire, this);
+  wheel.Schedule (Seconds (5), &TimerWheelCancelTestCase::Expire, this);
+  wheel.CancelAll ();
+  NS_TEST_ASSERT_MSG_EQ (wheel.GetN (), 0, "timeouts pending after CancelAll");
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_nExpired, 2, "timeouts expired after CancelAll");
+  Simulator::Destroy ();
+
+  // the next simulation starts from zero again, though the wheel went up to 2s
+  wheel.Schedule (Seconds (1), &TimerWheelCancelTestCase::Expire, this);
+  Simulator::Run ();
+  NS_TEST_ASSERT_MSG_EQ (m_nExpired, 3, "timeout lost after the simulator restarted");
+  NS_TEST_ASSERT_MSG_EQ (Simulator::Now (), Seconds (1), "timeout expired late after the simulator restarted");
+
+  Simulator::Destroy ();
+}
+
+
+static class TimerWheelTestSuite : public TestSuite
+{
+public:
+  TimerWheelTestSuite ()
+    : TestSuite ("timer-wheel", UNIT)
+  {
+    AddTestCase (new TimerWheelExpireTestCase ());
+    AddTestCase (new TimerWheelCancelTestCase ());
+  }
+} g_timerWheelTestSuite;
@@ -44,9 +44,13 @@ main (int argc, char *argv[])
   std::string heuristic = "0-1-2";
   std::string filename = "rocketfuel/maps/3356.cch";
   std::string latencyFile = "";
+  std::string latencyCacheFile = "";
   std::string locationFile = "";
   std::string disaster_location = "Los Angeles, CA";
   bool tracing = false;
+  std::string trace_format = "ascii";
+  std::string mode = "packet";
+  double oracle_check = 0.0;
   double timeout = 1.0;
 
   CommandLine cmd;
@@ -57,6 +61,7 @@ main (int argc, char *argv[])
   // cmd.AddValue ("boundary", "Length of (one side) of the square bounding box for the geographic region under study (in meters)", exp->boundaryLength);
 
   cmd.AddValue ("latencies", "File to read latencies from in Rocketfuel weights file format", latencyFile);
+  cmd.AddValue ("latency_cache", "Binary file to cache the parsed latencies in between runs (none if empty)", latencyCacheFile);
   cmd.AddValue ("locations", "File to read city locations from (used with Rocketfuel)", locationFile);
 
   // tracing/output
@@ -64,6 +69,7 @@ main (int argc, char *argv[])
   cmd.AddValue ("trace_acks", "Whether to print traces when a client receives an ACK from the server", trace_acks);
   cmd.AddValue ("trace_forwards", "Whether to print traces when a client forwards a packet", trace_forwards);
   cmd.AddValue ("trace_sends", "Whether to print traces when a client sends a packet initially", trace_sends);
+  cmd.AddValue ("trace_format", "Format of the trace files: ascii or binary (read with ron-trace-summary)", trace_format);
   cmd.AddValue ("verbose", "Whether to print verbose log info (1=INFO, 2=LOGIC, 3=FUNCTION)", verbose);
 
   // scenario parameters
@@ -74,9 +80,13 @@ main (int argc, char *argv[])
   cmd.AddValue ("heuristic", "Which heuristic(s) to use when choosing intermediate overlay nodes.", heuristic);
   cmd.AddValue ("runs", "Number of times to run simulation on given inputs.", exp->nruns);
   cmd.AddValue ("start_run", "Starting number to use for multiple runs when outputting files.", exp->start_run_number);
+  cmd.AddValue ("nprocs", "Number of worker processes to run the scenarios in concurrently (0 runs them all in this process).", exp->nprocs);
+  cmd.AddValue ("nthreads", "Number of threads to classify the topology's nodes in (0 uses one per processor on large topologies).", exp->nthreads);
   cmd.AddValue ("timeout", "Seconds to wait for server reply before attempting contact through the overlay.", timeout);
   cmd.AddValue ("contact_attempts", "Number of times a reporting node will attempt to contact the server "
                 "(it will use the overlay after the first attempt).  Default is 1 (no overlay).", exp->contactAttempts);
+  cmd.AddValue ("mode", "How to carry out each run: packet (full simulation) or oracle (reachability from the failed topology's graph)", mode);
+  cmd.AddValue ("oracle_check", "Fraction of oracle runs to also simulate to check the oracle against", oracle_check);
 
   cmd.Parse (argc,argv);
 
@@ -163,6 +173,10 @@ main (int argc, char *argv[])
   exp->disasterLocations = disasterLocations;
   exp->failureProbabilities = failureProbabilities;
   exp->SetTimeout (Seconds (timeout));
+  exp->SetAttribute ("TraceFormat", StringValue (trace_format));
+  exp->SetAttribute ("ExecutionMode", StringValue (mode));
+  exp->SetAttribute ("OracleCheckFraction", DoubleValue (oracle_check));
+  exp->SetAttribute ("LatencyCacheFile", StringValue (latencyCacheFile));
 
   /*exp->ReadLatencyFile (latencyFile);
   exp->ReadLocationFile (locationFile);
@@ -0,0 +1,47 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+/** Prints the summary metrics of binary RON trace files (those written with the
+    GeocronExperiment TraceFormat=binary), as ron_trace_analyzer.py --summary does for text traces.
+    Usage: ron-trace-summary [--resolution=0.1] [--time] file.bin... **/
+
+#include "ns3/geocron-module.h"
+
+#include <iostream>
+#include <iomanip>
+
+using namespace ns3;
+
+int
+main (int argc, char *argv[])
+{
+  double resolution = 0.1;
+  bool time = false;
+
+  CommandLine cmd;
+  cmd.AddValue ("resolution", "Time resolution (in seconds) for the ACK ratio over time", resolution);
+  cmd.AddValue ("time", "Whether to also print the cumulative ACK ratio over time", time);
+  cmd.Parse (argc, argv);
+
+  std::cout << "File\tNodes\tACKs\tDirect ACKs\tACK ratio\t% Improvement\tSends\tForwards" << std::endl;
+  std::cout << std::fixed << std::setprecision (2);
+
+  // CommandLine ignores the arguments not starting with '-', which are our files
+  for (int i = 1; i < argc; i++)
+    {
+      if (argv[i][0] == '-')
+        continue;
+
+      Ptr<RonTraceReader> reader = Create<RonTraceReader> (argv[i]);
+      RonTraceSummary summary = reader->Summarize (resolution);
+
+      std::cout << argv[i] << '\t' << summary.nNodes << '\t' << summary.nAcks << '\t' << summary.nDirectAcks
+                << '\t' << summary.GetAckRatio () << '\t' << summary.GetOverlayImprovement ()
+                << '\t' << summary.nSends << '\t' << summary.nForwards << std::endl;
+
+      if (time)
+        for (uint32_t t = 0; t < summary.ackTimes.size (); t++)
+          std::cout << "\t" << summary.ackTimes[t] << "s\t" << summary.ackRatios[t] << std::endl;
+    }
+
+  return 0;
+}
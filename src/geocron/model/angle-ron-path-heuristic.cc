@@ -160,6 +160,56 @@ double AngleRonPathHeuristic::GetLikelihood (Ptr<RonPath> path)
   return newLikelihood;
 }
 
+bool
+AngleRonPathHeuristic::GetLikelihoods (Ptr<RonPeerEntry> destination, const std::vector<Ptr<RonPath> > & paths,
+                                       const PeerLocations & peers, std::vector<double> & likelihoods)
+{
+  NS_ASSERT_MSG (m_source, "You must set the source peer(s) before using the heuristic!");
+
+  double pi = 3.14159265;
+  Vector3D va = m_source->location;
+  double ab_dist = CalculateDistance (va, destination->location);
+  std::vector<double> acDists, bcDists;
+  GetDistances (peers, va, acDists);
+  GetDistances (peers, destination->location, bcDists);
+
+  // GetDistance and GetInitialLikelihood for all the peers, without branches
+  likelihoods.resize (paths.size ());
+  const double * ac = &acDists[0];
+  const double * bc = &bcDists[0];
+  double * lh = &likelihoods[0];
+  uint32_t n = likelihoods.size ();
+  for (uint32_t i = 0; i < n; i++)
+    {
+      bool degenerate = ab_dist == 0 or ac[i] == 0 or bc[i] == 0;
+      double a_ang = degenerate ? 0.0 : acos ((ac[i] * ac[i] + ab_dist * ab_dist - bc[i] * bc[i]) /
+                                              (2.0 * ac[i] * ab_dist));
+      double acute = fabs(cos(a_ang - pi*0.25));
+      double reflex = fabs(cos(2*((pi*2 - a_ang) - pi*0.25)/3));
+      lh[i] = (a_ang == pi or a_ang == 0.0) ? 0.0 : (a_ang < pi ? acute : reflex);
+    }
+
+  // scale by the angle from each previous attempt, in the same order as GetLikelihood
+  for (PathsAttemptedIterator itr = m_pathsAttempted.begin();
+       itr != m_pathsAttempted.end (); itr++)
+    {
+      Vector3D vc = (*(*(*itr)->Begin ())->Begin ())->location;
+      double attemptDist = CalculateDistance (va, vc);
+      GetDistances (peers, vc, bcDists);
+      for (uint32_t i = 0; i < n; i++)
+        {
+          bool degenerate = ac[i] == 0 or attemptDist == 0 or bc[i] == 0;
+          double angle = degenerate ? 0.0 : acos ((attemptDist * attemptDist + ac[i] * ac[i] - bc[i] * bc[i]) /
+                                                  (2.0 * attemptDist * ac[i]));
+          lh[i] *= fabs(sin(angle/2.0));
+        }
+    }
+
+  ExcludeSameRegion (destination, paths, likelihoods);
+  return true;
+}
+
+
 double
 AngleRonPathHeuristic::GetAngleLikelihood (double ang)
 {
@@ -19,6 +19,8 @@ public:
   static TypeId GetTypeId (void);
 private:
   virtual double GetLikelihood (Ptr<RonPath> path);
+  virtual bool GetLikelihoods (Ptr<RonPeerEntry> destination, const std::vector<Ptr<RonPath> > & paths,
+                               const PeerLocations & peers, std::vector<double> & likelihoods);
   double GetDistance(double d1, double d2, double d3);
   double GetInitialLikelihood (double ang);
   double GetAngleLikelihood (double ang);
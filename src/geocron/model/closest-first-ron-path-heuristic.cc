@@ -70,3 +70,17 @@ ClosestFirstRonPathHeuristic::GetLikelihood (Ptr<RonPath> path)
   //TODO: transform to a LH
   return m_maxDistance - distance;
 }
+
+
+bool
+ClosestFirstRonPathHeuristic::GetLikelihoods (Ptr<RonPeerEntry> destination, const std::vector<Ptr<RonPath> > & paths,
+                                              const PeerLocations & peers, std::vector<double> & likelihoods)
+{
+  NS_ASSERT_MSG (m_source, "You must set the source peer before using the heuristic!");
+
+  GetDistances (peers, m_source->location, likelihoods);
+  double * lh = &likelihoods[0];
+  for (uint32_t i = 0; i < likelihoods.size (); i++)
+    lh[i] = lh[i] > m_maxDistance ? 0.0 : m_maxDistance - lh[i];
+  return true;
+}
@@ -0,0 +1,275 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "connectivity-oracle.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-nix-vector-routing.h"
+
+#include <algorithm>
+#include <queue>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ConnectivityOracle");
+
+// PPP header the point-to-point devices add to each IP packet
+static const uint32_t LINK_HEADER_SIZE = 2;
+
+ConnectivityOracle::ConnectivityOracle ()
+{
+  m_edges.resize (NodeList::GetNNodes ());
+  m_followDownEdges.resize (NodeList::GetNNodes (), false);
+  m_useDestinationTrees.resize (NodeList::GetNNodes (), false);
+  m_components.resize (NodeList::GetNNodes ());
+  // the device each edge arrives on, to find the edges back
+  std::vector<std::vector<uint32_t> > remoteDevices (NodeList::GetNNodes ());
+
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); node++)
+    {
+      Ptr<Ipv4> ipv4 = (*node)->GetObject<Ipv4> ();
+      std::vector<Edge> & edges = m_edges[(*node)->GetId ()];
+
+      Ptr<Ipv4NixVectorRouting> routing = (*node)->GetObject<Ipv4NixVectorRouting> ();
+      if (routing)
+        {
+          BooleanValue followDownEdges, useDestinationTrees;
+          routing->GetAttribute ("FollowDownEdges", followDownEdges);
+          routing->GetAttribute ("UseDestinationTrees", useDestinationTrees);
+          m_followDownEdges[(*node)->GetId ()] = followDownEdges.Get ();
+          m_useDestinationTrees[(*node)->GetId ()] = useDestinationTrees.Get ();
+        }
+
+      for (uint32_t i = 0; i < (*node)->GetNDevices (); i++)
+        {
+          Ptr<NetDevice> device = (*node)->GetDevice (i);
+          Ptr<Channel> channel = device->GetChannel ();
+          if (channel == 0)
+            continue;
+
+          TimeValue delay;
+          DataRateValue rate;
+          bool hasDelay = channel->GetAttributeFailSafe ("Delay", delay);
+          bool hasRate = device->GetAttributeFailSafe ("DataRate", rate);
+
+          for (uint32_t j = 0; j < channel->GetNDevices (); j++)
+            {
+              Ptr<NetDevice> remoteDevice = channel->GetDevice (j);
+              if (remoteDevice == device)
+                continue;
+              Ptr<Ipv4> remoteIpv4 = remoteDevice->GetNode ()->GetObject<Ipv4> ();
+
+              Edge edge;
+              edge.device = i;
+              edge.remote = remoteDevice->GetNode ()->GetId ();
+              edge.localIface = ipv4 ? ipv4->GetInterfaceForDevice (device) : -1;
+              edge.remoteIface = remoteIpv4 ? remoteIpv4->GetInterfaceForDevice (remoteDevice) : -1;
+              edge.delay = hasDelay ? delay.Get () : Seconds (0.0);
+              edge.bitRate = hasRate ? rate.Get ().GetBitRate () : 0.0;
+              edge.usable = edge.received = true;
+              edges.push_back (edge);
+              remoteDevices[(*node)->GetId ()].push_back (remoteDevice->GetIfIndex ());
+            }
+        }
+    }
+
+  for (uint32_t id = 0; id < m_edges.size (); id++)
+    for (uint32_t e = 0; e < m_edges[id].size (); e++)
+      {
+        Edge & edge = m_edges[id][e];
+        for (edge.reverse = 0; edge.reverse < m_edges[edge.remote].size (); edge.reverse++)
+          {
+            const Edge & back = m_edges[edge.remote][edge.reverse];
+            if (back.remote == id and back.device == remoteDevices[id][e])
+              break;
+          }
+        NS_ASSERT (edge.reverse < m_edges[edge.remote].size ());
+      }
+
+  Update ();
+}
+
+
+void
+ConnectivityOracle::Update ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  // trees following down edges don't depend on which are up
+  m_trees[false][false].clear ();
+  m_trees[false][true].clear ();
+  for (uint32_t i = 0; i < m_components.size (); i++)
+    m_components[i] = i;
+
+  for (uint32_t id = 0; id < m_edges.size (); id++)
+    {
+      Ptr<Node> node = NodeList::GetNode (id);
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      for (std::vector<Edge>::iterator edge = m_edges[id].begin (); edge != m_edges[id].end (); edge++)
+        {
+          Ptr<Ipv4> remoteIpv4 = NodeList::GetNode (edge->remote)->GetObject<Ipv4> ();
+          edge->usable = ((edge->localIface < 0 or ipv4->IsUp (edge->localIface)) and
+                          node->GetDevice (edge->device)->IsLinkUp ());
+          edge->received = (edge->remoteIface < 0 or remoteIpv4->IsUp (edge->remoteIface));
+          if (edge->usable and edge->received)
+            Union (id, edge->remote);
+        }
+    }
+}
+
+
+bool
+ConnectivityOracle::GetLatency (Ptr<Node> source, Ptr<Node> destination, uint32_t packetSize, Time & latency)
+{
+  if (!IsConnected (source, destination))
+    return false;
+
+  std::vector<uint32_t> path;
+  if (!GetPath (source->GetId (), destination->GetId (), path))
+    return false;
+
+  // walk down the path, checking the packet can be sent and isn't dropped where it arrives;
+  // summed per hop as the devices schedule them, to round the same way
+  latency = Seconds (0);
+  for (uint32_t hop = 0; hop + 1 < path.size (); hop++)
+    {
+      const Edge & edge = GetEdge (path[hop], path[hop + 1]);
+      if (!edge.usable or !edge.received)
+        return false;
+      latency += edge.delay;
+      if (edge.bitRate > 0.0)
+        latency += Seconds ((packetSize + LINK_HEADER_SIZE) * 8 / edge.bitRate);
+    }
+
+  return true;
+}
+
+
+bool
+ConnectivityOracle::IsReachable (Ptr<Node> source, Ptr<Node> destination)
+{
+  Time latency;
+  return GetLatency (source, destination, 0, latency);
+}
+
+
+bool
+ConnectivityOracle::IsConnected (Ptr<Node> node1, Ptr<Node> node2)
+{
+  return Find (node1->GetId ()) == Find (node2->GetId ());
+}
+
+
+bool
+ConnectivityOracle::GetPath (uint32_t source, uint32_t destination, std::vector<uint32_t> & path)
+{
+  path.clear ();
+  if (m_useDestinationTrees[source])
+    {
+      // each node's next hop towards the destination
+      const Tree & tree = GetTree (destination, m_followDownEdges[source], true);
+      if (tree[source] < 0)
+        return false;
+      for (uint32_t node = source; node != destination; node = tree[node])
+        path.push_back (node);
+      path.push_back (destination);
+    }
+  else
+    {
+      // each node's parent towards the source
+      const Tree & tree = GetTree (source, m_followDownEdges[source], false);
+      if (tree[destination] < 0)
+        return false;
+      for (uint32_t node = destination; node != source; node = tree[node])
+        path.push_back (node);
+      path.push_back (source);
+      std::reverse (path.begin (), path.end ());
+    }
+  return true;
+}
+
+
+const ConnectivityOracle::Tree &
+ConnectivityOracle::GetTree (uint32_t root, bool followDownEdges, bool destinationTree)
+{
+  TreeMap & trees = m_trees[followDownEdges][destinationTree];
+  TreeMap::iterator cached = trees.find (root);
+  if (cached != trees.end ())
+    return cached->second;
+
+  Tree & tree = trees[root];
+  tree.assign (m_edges.size (), -1);
+  tree[root] = root;
+
+  // same order as Ipv4NixVectorRouting::BFS, or GrowDestinationTree for a destination tree,
+  // so that ties between paths are broken the same way
+  std::queue<uint32_t> grey;
+  grey.push (root);
+  while (!grey.empty ())
+    {
+      uint32_t node = grey.front ();
+      grey.pop ();
+      for (uint32_t e = 0; e < m_edges[node].size (); e++)
+        {
+          const Edge & edge = m_edges[node][e];
+          // a destination tree is grown towards where the packets come from
+          const Edge & sent = destinationTree ? m_edges[edge.remote][edge.reverse] : edge;
+          if ((followDownEdges or sent.usable) and tree[edge.remote] < 0)
+            {
+              tree[edge.remote] = node;
+              grey.push (edge.remote);
+            }
+        }
+    }
+
+  return tree;
+}
+
+
+const ConnectivityOracle::Edge &
+ConnectivityOracle::GetEdge (uint32_t node, uint32_t neighbor)
+{
+  const Edge * last = NULL;
+  for (std::vector<Edge>::const_iterator edge = m_edges[node].begin (); edge != m_edges[node].end (); edge++)
+    if (edge->remote == neighbor)
+      last = &*edge;
+  NS_ASSERT (last != NULL);
+  return *last;
+}
+
+
+uint32_t
+ConnectivityOracle::Find (uint32_t node)
+{
+  while (m_components[node] != node)
+    {
+      // path halving
+      m_components[node] = m_components[m_components[node]];
+      node = m_components[node];
+    }
+  return node;
+}
+
+
+void
+ConnectivityOracle::Union (uint32_t node1, uint32_t node2)
+{
+  node1 = Find (node1);
+  node2 = Find (node2);
+  if (node1 != node2)
+    m_components[node1] = node2;
+}
+
+} //namespace ns3
@@ -0,0 +1,101 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef CONNECTIVITY_ORACLE_H
+#define CONNECTIVITY_ORACLE_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+#include <vector>
+#include "boost/unordered_map.hpp"
+
+namespace ns3 {
+
+/** Answers whether a packet sent from one node reaches another, and how long it takes,
+    from a graph of the links in the NodeList rather than by simulating the packet.
+    The answers follow what the packet-level model does with the source's nix-vector routing:
+    a packet takes the first shortest path (in hops) found by its BFS, from the source or,
+    with UseDestinationTrees, from the destination; with FollowDownEdges that BFS ignores
+    which interfaces are up, otherwise it only follows the links the packet can be sent on.
+    Either way the packet is lost at the first hop it can't be sent on or received from.
+    Queueing is ignored, so the latency is the propagation delay plus the time to
+    transmit the packet on each link.
+    Without FollowDownEdges, nix-vector routing repairs its destination trees after failures
+    rather than growing them again, which may break ties between paths differently than here. */
+class ConnectivityOracle : public SimpleRefCount<ConnectivityOracle>
+{
+public:
+  /** Builds the link graph of all the nodes in the NodeList, which must not change afterwards. */
+  ConnectivityOracle ();
+
+  /** Re-read which interfaces are up after nodes/links were failed or unfailed. */
+  void Update ();
+
+  /** Returns whether a packet of packetSize bytes (at the IP layer) sent from source
+      reaches destination and, if so, sets latency to its one-way delay. */
+  bool GetLatency (Ptr<Node> source, Ptr<Node> destination, uint32_t packetSize, Time & latency);
+  bool IsReachable (Ptr<Node> source, Ptr<Node> destination);
+
+  /** Returns whether the nodes are connected by links that are up at both ends;
+      if not, no packet can get from one to the other. */
+  bool IsConnected (Ptr<Node> node1, Ptr<Node> node2);
+
+private:
+  struct Edge
+  {
+    uint32_t device;      // index of the sending device on its node
+    uint32_t remote;      // node id at the other end
+    uint32_t reverse;     // index of the edge back among the remote node's
+    int32_t localIface;   // Ipv4 interfaces of each end, or -1 if none
+    int32_t remoteIface;
+    Time delay;
+    double bitRate;       // of the sending device, 0 if unknown
+    bool usable;          // sending interface and device are up
+    bool received;        // receiving interface is up
+  };
+
+  /** The next node on the way from each node to the root of a routing BFS: towards the source
+      if grown from it, towards the destination if grown from that; -1 if not reached. */
+  typedef std::vector<int32_t> Tree;
+  typedef boost::unordered_map<uint32_t, Tree> TreeMap;
+
+  /** Sets path to the nodes from source to destination that the source's routing picks;
+      returns false if it finds none. */
+  bool GetPath (uint32_t source, uint32_t destination, std::vector<uint32_t> & path);
+  /** Run the routing BFS from the root, if not already cached since the links it follows last changed.
+      A destination tree follows each edge backwards, as it is grown from where the packets go. */
+  const Tree & GetTree (uint32_t root, bool followDownEdges, bool destinationTree);
+  /** The edge nix-vector routing sends on from node to its neighbor: the last one to it, as
+      Ipv4NixVectorRouting::FindNeighborIndex picks. */
+  const Edge & GetEdge (uint32_t node, uint32_t neighbor);
+  uint32_t Find (uint32_t node);
+  void Union (uint32_t node1, uint32_t node2);
+
+  // edges of each node, in the order nix-vector routing scans its devices
+  std::vector<std::vector<Edge> > m_edges;
+  // the routing attributes of each node's Ipv4NixVectorRouting, false if it has none
+  std::vector<bool> m_followDownEdges;
+  std::vector<bool> m_useDestinationTrees;
+  // union-find forest of the nodes connected by links up at both ends
+  std::vector<uint32_t> m_components;
+  // routing BFS trees by root node, indexed by whether they follow down edges
+  // (which, as in nix-vector routing, are kept across updates) and whether they are destination trees
+  TreeMap m_trees[2][2];
+};
+
+} //namespace ns3
+#endif //CONNECTIVITY_ORACLE_H
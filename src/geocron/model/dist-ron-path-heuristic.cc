@@ -76,4 +76,26 @@ DistRonPathHeuristic::GetLikelihood (Ptr<RonPath> path)
 
   //TODO: transform to a LH
   //return distance - m_minDistance;
-}
\ No newline at end of file
+}
+
+
+bool
+DistRonPathHeuristic::GetLikelihoods (Ptr<RonPeerEntry> destination, const std::vector<Ptr<RonPath> > & paths,
+                                      const PeerLocations & peers, std::vector<double> & likelihoods)
+{
+  NS_ASSERT_MSG (m_source, "You must set the source peer before using the heuristic!");
+
+  double idealDistance = CalculateDistance (m_source->location, destination->location) / 2;
+  GetDistances (peers, m_source->location, likelihoods);
+
+  // same as GetLikelihood, but branch-free so it vectorizes
+  double * lh = &likelihoods[0];
+  for (uint32_t i = 0; i < likelihoods.size (); i++)
+    {
+      double distance = lh[i];
+      double closer = (distance * distance) / (idealDistance * idealDistance);
+      double further = idealDistance / distance;
+      lh[i] = distance <= m_minDistance ? 0.0 : (distance < idealDistance ? closer : further);
+    }
+  return true;
+}
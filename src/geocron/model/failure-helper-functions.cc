@@ -1,4 +1,5 @@
 #include "failure-helper-functions.h"
+#include "ns3/ipv4-nix-vector-routing.h"
 
 #ifndef nslog
 #define nslog(x) NS_LOG_UNCOND(x);
@@ -62,4 +63,79 @@ uint32_t GetNodeDegree(Ptr<Node> node)
   return node->GetNDevices() - 1; //assumes PPP links
 }
 
+////////////////////////////////////////////////////////////////////////////////
+////////////////////  FailureSet  //////////////////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+void
+FailureSet::AddNode (Ptr<Node> node)
+{
+  m_nodes.Add (node);
+}
+
+void
+FailureSet::AddIpv4 (Ptr<Ipv4> ipv4, uint32_t iface)
+{
+  m_ifaces.Add (ipv4, iface);
+}
+
+void
+FailureSet::Apply ()
+{
+  Ipv4NixVectorRouting::BeginTopologyChangeBatch ();
+
+  for (NodeContainer::Iterator node = m_nodes.Begin ();
+       node != m_nodes.End (); node++)
+    {
+      FailNode (*node);
+    }
+
+  for (Ipv4InterfaceContainer::Iterator iface = m_ifaces.Begin ();
+       iface != m_ifaces.End (); iface++)
+    {
+      FailIpv4 (iface->first, iface->second);
+    }
+
+  Ipv4NixVectorRouting::CommitTopologyChangeBatch ();
+}
+
+void
+FailureSet::Unapply (Time appStopTime)
+{
+  Ipv4NixVectorRouting::BeginTopologyChangeBatch ();
+
+  for (Ipv4InterfaceContainer::Iterator iface = m_ifaces.Begin ();
+       iface != m_ifaces.End (); iface++)
+    {
+      UnfailIpv4 (iface->first, iface->second);
+    }
+
+  for (NodeContainer::Iterator node = m_nodes.Begin ();
+       node != m_nodes.End (); node++)
+    {
+      UnfailNode (*node, appStopTime);
+    }
+
+  Ipv4NixVectorRouting::CommitTopologyChangeBatch ();
+}
+
+void
+FailureSet::Clear ()
+{
+  m_nodes = NodeContainer ();
+  m_ifaces = Ipv4InterfaceContainer ();
+}
+
+NodeContainer
+FailureSet::GetNodes () const
+{
+  return m_nodes;
+}
+
+Ipv4InterfaceContainer
+FailureSet::GetIpv4Interfaces () const
+{
+  return m_ifaces;
+}
+
 }//namespace
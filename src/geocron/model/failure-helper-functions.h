@@ -16,6 +16,30 @@ namespace ns3 {
 
   Ipv4Address GetNodeAddress(Ptr<Node> node);
   uint32_t GetNodeDegree(Ptr<Node> node);
+
+  /** A set of nodes and interfaces failed together, e.g. by one disaster.
+      The whole set is applied and reverted as a single transaction so that
+      routing caches are invalidated once at commit rather than once per interface. */
+  class FailureSet
+  {
+  public:
+    void AddNode (Ptr<Node> node);
+    void AddIpv4 (Ptr<Ipv4> ipv4, uint32_t iface);
+
+    /** Fail every node and interface in the set. */
+    void Apply ();
+    /** Unfail every node and interface in the set, restarting applications until appStopTime. */
+    void Unapply (Time appStopTime);
+    /** Forget all of the nodes and interfaces (does not unfail them!). */
+    void Clear ();
+
+    NodeContainer GetNodes () const;
+    Ipv4InterfaceContainer GetIpv4Interfaces () const;
+
+  private:
+    NodeContainer m_nodes;
+    Ipv4InterfaceContainer m_ifaces;
+  };
 } //namespace ns3
 
 
@@ -67,3 +67,17 @@ FurtherestFirstRonPathHeuristic::GetLikelihood (Ptr<RonPath> path)
   
   return likelihood;
 }
+
+
+bool
+FurtherestFirstRonPathHeuristic::GetLikelihoods (Ptr<RonPeerEntry> destination, const std::vector<Ptr<RonPath> > & paths,
+                                                 const PeerLocations & peers, std::vector<double> & likelihoods)
+{
+  NS_ASSERT_MSG (m_source, "You must set the source peer before using the heuristic!");
+
+  GetDistances (peers, m_source->location, likelihoods);
+  double * lh = &likelihoods[0];
+  for (uint32_t i = 0; i < likelihoods.size (); i++)
+    lh[i] = lh[i] < m_minDistance ? 0.0 : lh[i] - m_minDistance;
+  return true;
+}
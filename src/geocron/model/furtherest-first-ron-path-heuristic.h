@@ -22,6 +22,8 @@ private:
       Necessary for assigning a LH given the distance as we need a bound. */
   double m_minDistance;
   virtual double GetLikelihood (Ptr<RonPath> path);
+  virtual bool GetLikelihoods (Ptr<RonPeerEntry> destination, const std::vector<Ptr<RonPath> > & paths,
+                               const PeerLocations & peers, std::vector<double> & likelihoods);
 };
 
 } //namespace
@@ -14,13 +14,16 @@
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/classification.hpp>
-#include <boost/heap/priority_queue.hpp>
  
 #include <sstream>
 #include <iomanip>
+#include <algorithm>
 #include <fstream>
 #include <ctime>
+#include <cerrno>
 #include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 #include <boost/functional/hash.hpp>
 
 using namespace ns3;
@@ -28,6 +31,39 @@ using namespace ns3;
 NS_LOG_COMPONENT_DEFINE ("GeocronExperiment");
 NS_OBJECT_ENSURE_REGISTERED (GeocronExperiment);
 
+namespace {
+
+// not worth starting a thread to classify fewer nodes than this
+const uint32_t MIN_NODES_PER_THREAD = 1024;
+
+typedef std::pair<uint32_t/*degree*/, uint32_t/*index*/> DegreeIndex;
+
+bool
+HigherDegree (const DegreeIndex & a, const DegreeIndex & b)
+{
+  return a.first > b.first or (a.first == b.first and a.second < b.second);
+}
+
+/** Narrows the candidates down to those of at least the nth highest degree, highest degree first.
+    We'll allow more than n so as not to include some of degree d but exclude others of degree d. */
+void
+KeepServerCandidates (std::vector<DegreeIndex> & candidates, uint32_t n)
+{
+  if (candidates.size () > n and n > 0)
+    {
+      std::nth_element (candidates.begin (), candidates.begin () + n - 1, candidates.end (), HigherDegree);
+      uint32_t lowDegree = candidates[n - 1].first;
+      std::vector<DegreeIndex>::iterator end = candidates.begin () + n;
+      for (std::vector<DegreeIndex>::iterator itr = end; itr != candidates.end (); itr++)
+        if (itr->first == lowDegree)
+          *end++ = *itr;
+      candidates.erase (end, candidates.end ());
+    }
+  std::sort (candidates.begin (), candidates.end (), HigherDegree);
+}
+
+} //anonymous namespace
+
 TypeId
 GeocronExperiment::GetTypeId ()
 {
@@ -40,6 +76,41 @@ GeocronExperiment::GetTypeId ()
                    StringValue ("brite"),
                    MakeStringAccessor (&GeocronExperiment::topologyType),
                    MakeStringChecker ())
+    .AddAttribute ("DisasterRadius",
+                   "If positive, a disaster affects every node within this distance of its location "
+                   "(in the units of node positions) rather than only the nodes in its region.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&GeocronExperiment::disasterRadius),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("TraceFormat",
+                   "Format of the client trace files.  Supports: ascii (lines read by ron_trace_analyzer.py), "
+                   "binary (fixed-size records read by RonTraceReader).",
+                   StringValue ("ascii"),
+                   MakeStringAccessor (&GeocronExperiment::traceFormat),
+                   MakeStringChecker ())
+    .AddAttribute ("ExecutionMode",
+                   "How each run is carried out.  Supports: packet (simulates every packet), "
+                   "oracle (answers whether each path reaches the server, and when, from a graph of the failed topology).",
+                   StringValue ("packet"),
+                   MakeStringAccessor (&GeocronExperiment::executionMode),
+                   MakeStringChecker ())
+    .AddAttribute ("OracleCheckFraction",
+                   "Fraction of the oracle runs to also simulate, aborting if the clients ACKed directly differ from the oracle's.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&GeocronExperiment::oracleCheckFraction),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("LatencyCacheFile",
+                   "If not empty, a binary file to cache the latencies read by ReadLatencyFile in, "
+                   "which is read instead while the latency file's contents stay the same.",
+                   StringValue (""),
+                   MakeStringAccessor (&GeocronExperiment::latencyCacheFile),
+                   MakeStringChecker ())
+    .AddAttribute ("Seed",
+                   "RNG seed of the scenarios, which then give the same results on each invocation.  "
+                   "If 0, a seed is made from the clock and the process id so that simultaneously running experiments differ.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&GeocronExperiment::seed),
+                   MakeUintegerChecker<uint32_t> ())
   ;
   return tid;
 }
@@ -59,8 +130,18 @@ GeocronExperiment::GeocronExperiment ()
   currRun = 0;
   contactAttempts = 10;
   traceFile = "";
+  traceFormat = "ascii";
+  executionMode = "packet";
+  oracleCheckFraction = 0.0;
+  latencyCacheFile = "";
   nruns = 1;
+  start_run_number = 0;
+  nprocs = 0;
+  nthreads = 0;
   nServerChoices = 10;
+  disasterRadius = 0.0;
+  seed = 0;
+  firstStreamIndex = 0;
 
   regionHelper = NULL;
 }
@@ -164,6 +245,7 @@ void GeocronExperiment::ReadBriteTopology (std::string topologyFile)
   // need a list routing setup
   Ipv4NixVectorHelper nixRouting;
   nixRouting.SetAttribute("FollowDownEdges", BooleanValue (true));
+  nixRouting.SetAttribute ("UseDestinationTrees", BooleanValue (true));
   Ipv4StaticRoutingHelper staticRouting;
   Ipv4ListRoutingHelper routingList;
   routingList.Add (staticRouting, 0);
@@ -203,7 +285,7 @@ GeocronExperiment::ReadLatencyFile (std::string latencyFile)
           NS_LOG_ERROR("File does not exist: " + latencyFile);
           exit(-1);
         }
-      latencies = RocketfuelTopologyReader::ReadLatencies (latencyFile);
+      latencies = RocketfuelTopologyReader::ReadLatencies (latencyFile, latencyCacheFile);
     }
 }
 
@@ -257,9 +339,14 @@ GeocronExperiment::ReadRocketfuelTopology (std::string topologyFile)
     exit(-1);
   }
   
-  RocketfuelTopologyReader topo_reader;
-  topo_reader.SetFileName(topologyFile);
-  nodes = topo_reader.Read();
+  // maps converted by topology-convert load without parsing
+  Ptr<TopologyReader> topo_reader;
+  if (BinaryTopologyReader::IsBinaryTopology (topologyFile))
+    topo_reader = CreateObject<BinaryTopologyReader> ();
+  else
+    topo_reader = CreateObject<RocketfuelTopologyReader> ();
+  topo_reader->SetFileName(topologyFile);
+  nodes = topo_reader->Read();
   NS_LOG_INFO ("Nodes read from file: " + boost::lexical_cast<std::string> (nodes.GetN()));
 
   NS_LOG_INFO ("Assigning addresses and installing interfaces...");
@@ -271,6 +358,7 @@ GeocronExperiment::ReadRocketfuelTopology (std::string topologyFile)
   // NixHelper to install nix-vector routing
   Ipv4NixVectorHelper nixRouting;
   nixRouting.SetAttribute("FollowDownEdges", BooleanValue (true));
+  nixRouting.SetAttribute ("UseDestinationTrees", BooleanValue (true));
   Ipv4StaticRoutingHelper staticRouting;
   Ipv4ListRoutingHelper routingList;
   routingList.Add (staticRouting, 0);
@@ -288,29 +376,19 @@ GeocronExperiment::ReadRocketfuelTopology (std::string topologyFile)
 
   NS_LOG_INFO ("Generating links and checking failure model.");
 
-  for (TopologyReader::ConstLinksIterator iter = topo_reader.LinksBegin();
-       iter != topo_reader.LinksEnd(); iter++) {
+  for (TopologyReader::ConstLinksIterator iter = topo_reader->LinksBegin();
+       iter != topo_reader->LinksEnd(); iter++) {
     Location fromLocation = iter->GetAttribute ("From Location");
     Location toLocation = iter->GetAttribute ("To Location");
 
     // Set latency for this link if we loaded that information
-    if (latencies.size())
+    if (latencies.GetN ())
       {
-        RocketfuelTopologyReader::LatenciesMap::iterator latency = latencies.find (fromLocation + " -> " + toLocation);
-        //if (iter->GetAttributeFailSafe ("Latency", latency))
-        
-        if (latency != latencies.end())
-          {
-            pointToPoint.SetChannelAttribute ("Delay", StringValue (latency->second + "ms"));
-          }
+        Time latency;
+        if (latencies.GetLatency (fromLocation, toLocation, latency))
+          pointToPoint.SetChannelAttribute ("Delay", TimeValue (latency));
         else
-          {
-            latency = latencies.find (toLocation + " -> " + fromLocation);
-            if (latency != latencies.end())
-              pointToPoint.SetChannelAttribute ("Delay", StringValue (latency->second + "ms"));
-            else
-              pointToPoint.SetChannelAttribute ("Delay", StringValue ("2ms"));
-          }
+          pointToPoint.SetChannelAttribute ("Delay", StringValue ("2ms"));
       }
 
     // Nodes
@@ -405,13 +483,14 @@ GeocronExperiment::AutoSetTraceFile ()
   std::string fname = "run";
   fname += boost::lexical_cast<std::string> (outnum);
   newTraceFile /= (fname);
-  newTraceFile.replace_extension(".out");
+  std::string extension = (traceFormat == "binary" ? ".bin" : ".out");
+  newTraceFile.replace_extension(extension);
 
   // Change name to avoid overwriting
   uint32_t copy = 0;
   while (boost::filesystem::exists (newTraceFile))
     {
-      newTraceFile.replace_extension (".out(" + boost::lexical_cast<std::string> (copy++) + ")");
+      newTraceFile.replace_extension (extension + "(" + boost::lexical_cast<std::string> (copy++) + ")");
     }
 
   boost::filesystem::create_directories (newTraceFile.parent_path ());
@@ -425,36 +504,167 @@ GeocronExperiment::AutoSetTraceFile ()
 void
 GeocronExperiment::RunAllScenarios ()
 {
-  //set the seed using both clock and pid so that simultaneously running sims don't overlap
-  std::size_t seed = 0;
-  boost::hash_combine (seed, std::time (NULL));
-  boost::hash_combine (seed, getpid());
-  SeedManager::SetSeed(seed);
-  int runSeed = 0;
+  if (seed != 0)
+    {
+      SeedManager::SetSeed (seed);
+    }
+  else
+    {
+      //set the seed using both clock and pid so that simultaneously running sims don't overlap
+      std::size_t clockSeed = 0;
+      boost::hash_combine (clockSeed, std::time (NULL));
+      boost::hash_combine (clockSeed, getpid());
+      SeedManager::SetSeed(clockSeed);
+    }
+  // taken once, so running the scenarios again in this process starts them from the same streams
+  if (firstStreamIndex == 0)
+    {
+      firstStreamIndex = SeedManager::GetNextStreamIndex ();
+    }
+
+  std::vector<Scenario> scenarios = GetScenarios ();
+  if (nprocs > 0)
+    {
+      RunScenariosInWorkers (scenarios);
+      return;
+    }
+
+  // We want to compare each heuristic to each other for each configuration of failures,
+  // which each of them draws again from the same RNG run
+  for (std::vector<Scenario>::const_iterator scenario = scenarios.begin ();
+       scenario != scenarios.end (); scenario++)
+    {
+      RunScenario (*scenario);
+    }
+}
+
+
+/** Every scenario seeds its failure model and simulation from run numbers fixed by its
+    position in the parameter space, so the results do not depend on nprocs or on the
+    order in which the workers finish. */
+std::vector<GeocronExperiment::Scenario>
+GeocronExperiment::GetScenarios ()
+{
+  std::vector<Scenario> scenarios;
+  uint32_t nScenarios = disasterLocations->size () * failureProbabilities->size () * nruns * heuristics->size ();
+  uint32_t failureConfig = 0;
   for (std::vector<Location>::iterator disasterLocation = disasterLocations->begin ();
        disasterLocation != disasterLocations->end (); disasterLocation++)
     {
-      SetDisasterLocation (*disasterLocation); 
       for (std::vector<double>::iterator fprob = failureProbabilities->begin ();
            fprob != failureProbabilities->end (); fprob++)
         {
-          SetFailureProbability (*fprob);
-          for (currRun = 0; currRun < nruns; currRun++)
+          for (uint32_t run = 0; run < nruns; run++)
             {
-              // We want to compare each heuristic to each other for each configuration of failures
-              ApplyFailureModel ();
-              SetNextServers ();
+              // all heuristics are compared on the same failures,
+              // which are drawn from RNG runs after the simulations'
               for (uint32_t h = 0; h < heuristics->size (); h++)
                 {
-                  currHeuristic = heuristics->at (h);
-                  SeedManager::SetRun(runSeed++);
-                  AutoSetTraceFile ();
-                  Run ();
+                  Scenario scenario;
+                  scenario.location = *disasterLocation;
+                  scenario.fprob = *fprob;
+                  scenario.run = run;
+                  scenario.heuristic = h;
+                  scenario.failureRngRun = nScenarios + failureConfig;
+                  scenario.rngRun = scenarios.size ();
+                  scenarios.push_back (scenario);
                 }
-              UnapplyFailureModel ();
+              failureConfig++;
+            }
+        }
+    }
+  return scenarios;
+}
+
+
+/** Run each scenario in its own process forked from the topology built by this one. */
+void
+GeocronExperiment::RunScenariosInWorkers (const std::vector<Scenario> & scenarios)
+{
+  NS_LOG_INFO ("Running " << scenarios.size () << " scenarios in " << nprocs << " worker processes.");
+
+  std::map<pid_t, uint32_t> workers;
+  uint32_t nFailed = 0;
+  std::vector<Scenario>::const_iterator next = scenarios.begin ();
+  while (next != scenarios.end () or !workers.empty ())
+    {
+      // once a worker failed, only wait for the running ones to finish
+      if (next != scenarios.end () and workers.size () < nprocs and nFailed == 0)
+        {
+          // make sure buffered output isn't written once by each worker
+          std::cout.flush ();
+          std::cerr.flush ();
+
+          pid_t pid = fork ();
+          NS_ABORT_MSG_IF (pid < 0, "Could not fork a scenario worker");
+          if (pid == 0)
+            {
+              RunScenario (*next);
+              std::cout.flush ();
+              std::cerr.flush ();
+              // skip the exit handlers and static destructors, which belong to the parent
+              _exit (0);
             }
+          workers[pid] = next - scenarios.begin ();
+          next++;
+          continue;
+        }
+
+      if (workers.empty ())
+        {
+          break;
         }
+
+      int status;
+      pid_t pid = waitpid (-1, &status, 0);
+      if (pid < 0 and errno == EINTR)
+        {
+          continue;
+        }
+      NS_ABORT_MSG_IF (pid < 0 or !workers.count (pid), "Lost track of the scenario workers");
+      if (!WIFEXITED (status) or WEXITSTATUS (status) != 0)
+        {
+          const Scenario & failed = scenarios[workers[pid]];
+          NS_LOG_UNCOND ("Scenario worker for " << failed.location << ", fprob " << failed.fprob
+                         << ", run " << failed.run << ", heuristic " << failed.heuristic << " failed!");
+          nFailed++;
+        }
+      workers.erase (pid);
     }
+
+  NS_ABORT_MSG_IF (nFailed, nFailed << " scenario workers failed, "
+                   << scenarios.end () - next << " of " << scenarios.size () << " scenarios not run");
+}
+
+
+void
+GeocronExperiment::RunScenario (const Scenario & scenario)
+{
+  // rewind to the topology as built, before the last run's failures and server,
+  // which a worker forked after scenarios ran in this process would inherit
+  baseline->Restore ();
+
+  SetDisasterLocation (scenario.location);
+  SetFailureProbability (scenario.fprob);
+  currRun = scenario.run;
+
+  // a fresh random variable picks up the failure configuration's RNG run,
+  // and the simulation's variables the streams after it
+  SeedManager::ResetNextStreamIndex (firstStreamIndex);
+  SeedManager::SetRun (scenario.failureRngRun);
+  random = UniformVariable ();
+  ApplyFailureModel ();
+  SetNextServers ();
+  failures.Apply ();
+  InstallServers ();
+
+  currHeuristic = heuristics->at (scenario.heuristic);
+  SeedManager::SetRun (scenario.rngRun);
+  AutoSetTraceFile ();
+  Run ();
+
+  // the trace stream is never released by the apps, and a worker exits without destroying it
+  CloseTraceFile ();
 }
 
 
@@ -467,12 +677,19 @@ GeocronExperiment::ConnectAppTraces ()
   (void) PacketSent;
   (void) AckReceived;
 
-  if (traceFile != "")
+  OpenTraceFile ();
+
+  if (traceWriter)
+    {
+      for (ApplicationContainer::Iterator itr = clientApps.Begin ();
+           itr != clientApps.End (); itr++)
+        {
+          Ptr<RonClient> app = DynamicCast<RonClient> (*itr);
+          app->ConnectTraces (traceWriter);
+        }
+    }
+  else if (traceOutputStream)
     {
-      Ptr<OutputStreamWrapper> traceOutputStream;
-      AsciiTraceHelper asciiTraceHelper;
-      traceOutputStream = asciiTraceHelper.CreateFileStream (traceFile);
-  
       for (ApplicationContainer::Iterator itr = clientApps.Begin ();
            itr != clientApps.End (); itr++)
         {
@@ -483,6 +700,47 @@ GeocronExperiment::ConnectAppTraces ()
 }
 
 
+/** Open the current trace file in the current trace format, if there is one. */
+void
+GeocronExperiment::OpenTraceFile ()
+{
+  traceWriter = NULL;
+  traceOutputStream = NULL;
+
+  if (traceFile != "" and traceFormat == "binary")
+    {
+      traceWriter = Create<RonTraceWriter> (traceFile);
+    }
+  else if (traceFile != "")
+    {
+      AsciiTraceHelper asciiTraceHelper;
+      traceOutputStream = asciiTraceHelper.CreateFileStream (traceFile);
+    }
+}
+
+
+void
+GeocronExperiment::CloseTraceFile ()
+{
+  bool written = true;
+  if (traceWriter)
+    {
+      written = traceWriter->Close ();
+    }
+  else if (traceOutputStream)
+    {
+      std::ofstream * file = dynamic_cast<std::ofstream *> (traceOutputStream->GetStream ());
+      NS_ASSERT (file);
+      file->close ();
+      written = !file->fail ();
+    }
+  NS_ABORT_MSG_UNLESS (written, "Couldn't write trace file " << traceFile);
+
+  traceWriter = NULL;
+  traceOutputStream = NULL;
+}
+
+
 //////////////////////////////////////////////////////////////////////
 /////************************************************************/////
 ////////////////             FAILURE MODEL          //////////////////
@@ -490,43 +748,99 @@ GeocronExperiment::ConnectAppTraces ()
 //////////////////////////////////////////////////////////////////////
 
 
+void
+GeocronExperiment::NodeIndexJob::Run ()
+{
+  for (uint32_t i = begin; i < end; i++)
+    {
+      Ptr<Node> node = nodes->Get (i);
+      NodeIndexEntry & entry = (*entries)[i];
+      entry.degree = GetNodeDegree (node);
+      entry.hasLocation = false;
+      if (entry.degree <= 0)
+        continue;
+
+      entry.hasLocation = HasLocation (node);
+      entry.location = GetLocation (node);
+      entry.region = regionHelper->GetRegion (entry.location);
+
+      // ROUTING NODES (the opposite of IsOverlayNode) are potential servers
+      // must ignore if no location information, since clients expect server location info!
+      if (maxNDevs and entry.degree > maxNDevs and entry.hasLocation)
+        serverCandidates.push_back (DegreeIndex (entry.degree, i));
+    }
+  KeepServerCandidates (serverCandidates, nServerChoices);
+}
+
+
 void
 GeocronExperiment::IndexNodes () {
   NS_LOG_INFO ("Topology finished.  Choosing & installing clients.");
 
-  // We want to narrow down the number of server choices by picking about nServerChoices of the highest-degree
-  // nodes.  We want at least nServerChoices of them, but will allow more so as not to include some of degree d
-  // but exclude others of degree d.
-  //
-  // So we keep an ordered list of nodes and keep track of the sums
-  //
-  // invariant: if the group of smallest degree nodes were removed from the list,
-  // its size would be < nServerChoices
-  typedef std::pair<uint32_t/*degree*/, Ptr<Node> > DegreeType;
-  typedef boost::heap::priority_queue<DegreeType, boost::heap::compare<std::greater<DegreeType> > > DegreePriorityQueue;
-  DegreePriorityQueue potentialServerNodeCandidates;
-  uint32_t nLowestDegreeNodes = 0, lowDegree = 0;
+  // Look up the nodes' degrees, positions and regions and find the potential servers, splitting the nodes
+  // between the threads.  We want to narrow down the number of server choices by picking about nServerChoices of the highest-degree
+  // nodes; each thread keeps those of its nodes, and since they include all of the overall choices in its
+  // nodes, merging them and narrowing them down again gives the same choices however many threads there are.
+  uint32_t nNodes = nodes.GetN ();
+  uint32_t nThreads = nthreads;
+  if (!nThreads)
+    nThreads = std::min ((uint32_t)std::max (sysconf (_SC_NPROCESSORS_ONLN), 1L), nNodes / MIN_NODES_PER_THREAD);
+  nThreads = std::max (std::min (nThreads, nNodes), (uint32_t)1);
+
+  // each job only touches its own nodes, but objects may be shared between nodes, so reference
+  // counts must be atomic while the jobs run (which also stops GetObject reordering aggregates)
+  AtomicCount::SetThreaded (nThreads > 1);
+  std::vector<NodeIndexEntry> entries (nNodes);
+  std::vector<NodeIndexJob> jobs (nThreads);
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t t = 0; t < nThreads; t++)
+    {
+      jobs[t].nodes = &nodes;
+      jobs[t].entries = &entries;
+      jobs[t].begin = (uint64_t)nNodes * t / nThreads;
+      jobs[t].end = (uint64_t)nNodes * (t + 1) / nThreads;
+      jobs[t].regionHelper = PeekPointer (GetRegionHelper ());
+      jobs[t].maxNDevs = maxNDevs;
+      jobs[t].nServerChoices = nServerChoices;
+
+      // this thread does the first job itself
+      if (t > 0)
+        {
+          threads.push_back (Create<SystemThread> (MakeCallback (&NodeIndexJob::Run, &jobs[t])));
+          threads.back ()->Start ();
+        }
+    }
+  jobs[0].Run ();
+  for (std::vector<Ptr<SystemThread> >::iterator thread = threads.begin (); thread != threads.end (); thread++)
+    (*thread)->Join ();
+  AtomicCount::SetThreaded (false);
+
+  std::vector<DegreeIndex> potentialServerNodeCandidates;
+  for (std::vector<NodeIndexJob>::iterator job = jobs.begin (); job != jobs.end (); job++)
+    potentialServerNodeCandidates.insert (potentialServerNodeCandidates.end (),
+                                          job->serverCandidates.begin (), job->serverCandidates.end ());
+  KeepServerCandidates (potentialServerNodeCandidates, nServerChoices);
+  NS_LOG_DEBUG ("Classified " << nNodes << " nodes in " << nThreads << " threads.");
 
   // For finding all the overlay nodes, which must be done before installing applications since we need to specify the peers
   NodeContainer overlayNodes;
 
-  for (NodeContainer::Iterator node = nodes.Begin ();
-       node != nodes.End (); node++)
+  for (uint32_t i = 0; i < nNodes; i++)
     {
-      uint32_t degree = GetNodeDegree (*node);
+      Ptr<Node> node = nodes.Get (i);
+      const NodeIndexEntry & entry = entries[i];
 
       // Sanity check that a node has some actual links, otherwise remove it from the simulation
       // this happened with some disconnected Rocketfuel models and made null pointers
-      if (degree <= 0)
+      if (entry.degree <= 0)
         {
-          NS_LOG_LOGIC ("Node " << (*node)->GetId () << " has no links!");
-          //node.erase ();
-          disasterNodes[currLocation].erase ((*node)->GetId ());
+          NS_LOG_LOGIC ("Node " << node->GetId () << " has no links!");
+          disasterNodes[currLocation].erase (node->GetId ());
           continue;
         }
 
       // Aggregate RonPeerEntry objects for getting useful peering information later
-      Ptr<RonPeerEntry> thisPeer = (*node)->GetObject<RonPeerEntry> ();
+      Ptr<RonPeerEntry> thisPeer = node->GetObject<RonPeerEntry> ();
 
       // sanity check that this is the only place we set this info
 #ifdef NS3_LOG_ENABLE
@@ -534,143 +848,94 @@ GeocronExperiment::IndexNodes () {
         NS_ASSERT_MSG (false, "Where did this RonPeerEntry come from???");
 #endif
 
-      Location nodeRegion = GetRegionHelper ()->GetRegion(GetLocation(*node));
       // note that this swanky RonPeerEntry constructor handles the other attributes
-      thisPeer = CreateObject<RonPeerEntry> (*node);
-      thisPeer->region = nodeRegion;
-      (*node)->AggregateObject (thisPeer);
+      thisPeer = CreateObject<RonPeerEntry> (node);
+      thisPeer->region = entry.region;
+      node->AggregateObject (thisPeer);
 
-      // Build disaster node indexes
-      // If the node is in a disaster region, add it to the corresponding list
-
-      for (std::vector<Location>::iterator disasterLocation = disasterLocations->begin ();
-           // Only bother if the region is defined
-           disasterLocation != disasterLocations->end () and nodeRegion != NULL_REGION;
-           disasterLocation++)
+      // Index the node spatially so the disaster node lists can be built once all nodes are known
+      // Only bother if the region is defined
+      if (entry.region != NULL_REGION)
         {
-          if (nodeRegion == *disasterLocation)
-            {
-              disasterNodes[*disasterLocation].insert(std::pair<uint32_t, Ptr<Node> > ((*node)->GetId (), *node));
-            }
- 
+          GetRegionHelper ()->AddNode (node, entry.region);
+
           // Used for debugging to make sure locations are being found properly
-#ifdef NS3_LOG_ENABLE
-          if (!HasLocation (*node))
+          if (!entry.hasLocation)
             {
-              NS_LOG_DEBUG ("Node " << (*node)->GetId () << " has no position!");
+              NS_LOG_DEBUG ("Node " << node->GetId () << " has no position!");
             }
-#endif
-        } // end disaster location iteration
+        }
       
       // OVERLAY NODES
       //
       // We may only install the overlay application on clients attached to stub networks,
       // so we just choose the stub network nodes here
       // (note that all nodes have a loopback device)
-      if (IsOverlayNode (*node)) 
-        {
-          overlayNodes.Add (*node);
-          overlayPeers->AddPeer (*node);
-        }
-
-      // ROUTING NODES
-      // must ignore if no location information, since clients expect server location info!
-      else if (!IsOverlayNode (*node) and HasLocation (*node))
+      if (IsOverlayNode (node))
         {
-          //add potential server
-          if (degree >= lowDegree or potentialServerNodeCandidates.size () < nServerChoices)
-            potentialServerNodeCandidates.push (std::pair<uint32_t, Ptr<Node> > (degree, *node));
-          else
-            continue;
-
-          //base condition to set lowDegree the 1st time
-          if (!lowDegree)
-            lowDegree = degree;
-
-          if (degree == lowDegree)
-            nLowestDegreeNodes++;
-          else if (degree < lowDegree)
-            {
-              lowDegree = degree;
-              nLowestDegreeNodes = 1;
-            }
-
-          //remove group of lowest degree nodes if it's okay to do so
-          if (potentialServerNodeCandidates.size () - nLowestDegreeNodes >= nServerChoices)
-            {
-              #ifdef NS3_LOG_ENABLE
-              uint32_t nThrownAway = 0;
-              #endif
-              while (potentialServerNodeCandidates.top ().first == lowDegree)
-                {
-                  potentialServerNodeCandidates.pop ();
-                  #ifdef NS3_LOG_ENABLE
-                  nThrownAway++;
-                  #endif
-                }
-              NS_LOG_DEBUG ("Throwing away " << nThrownAway << " vertices of degree " << lowDegree);
-
-              // recalculate nLowestDegreeNodes
-              lowDegree = GetNodeDegree (potentialServerNodeCandidates.top ().second);
-              nLowestDegreeNodes = 0;
-              for (DegreePriorityQueue::iterator itr = potentialServerNodeCandidates.begin ();
-                   itr != potentialServerNodeCandidates.end () and (itr)->first == lowDegree; itr++)
-                nLowestDegreeNodes++;
-              NS_LOG_DEBUG (nLowestDegreeNodes << " nodes have new lowest degree = " << lowDegree);
-            }
+          overlayNodes.Add (node);
+          overlayPeers->AddPeer (node);
         }
     } // end node iteration
 
+  // Build disaster node indexes
+  // Each disaster affects the nodes in its region, or those within disasterRadius of its location
+  for (std::vector<Location>::iterator disasterLocation = disasterLocations->begin ();
+       disasterLocation != disasterLocations->end (); disasterLocation++)
+    {
+      NodeContainer affected;
+      if (disasterRadius > 0.0)
+        affected = GetRegionHelper ()->GetNodesInRadius (GetRegionHelper ()->GetLocation (*disasterLocation),
+                                                         disasterRadius);
+      else
+        affected = GetRegionHelper ()->GetNodesInRegion (*disasterLocation);
+
+      for (NodeContainer::Iterator node = affected.Begin (); node != affected.End (); node++)
+        disasterNodes[*disasterLocation].insert (std::pair<uint32_t, Ptr<Node> > ((*node)->GetId (), *node));
+    }
+
   // Install client applications
   // NOTE: this must be done after finding ALL the overlay nodes so that we can assign peers to each application
   RonClientHelper ronClient (9);
   ronClient.SetAttribute ("Interval", TimeValue (Seconds (1.)));
   ronClient.SetAttribute ("PacketSize", UintegerValue (1024));
   ronClient.SetAttribute ("Timeout", TimeValue (timeout));
+  ronClient.SetAttribute ("MaxPackets", UintegerValue (0)); //explicitly enable sensor reporting when disaster area set
   
-  // Install client app and set number of server contacts they make based on whether all nodes
-  // should report the disaster or only the ones in the disaster region.
-  for (NodeContainer::Iterator node = overlayNodes.Begin ();
-       node != overlayNodes.End (); node++)
-    {
-      ApplicationContainer newApp = ronClient.Install (*node);
-      clientApps.Add (newApp);
-      Ptr<RonClient> newClient = DynamicCast<RonClient> (newApp.Get (0));
-      newClient->SetAttribute ("MaxPackets", UintegerValue (0)); //explicitly enable sensor reporting when disaster area set
-      newClient->SetPeerTable (overlayPeers); //TODO: make this part of the helper?? or some p2p overlay algorithm? or the table itself? give out a callback function with that nodes peers?
-    }
+  // Install client apps on all the overlay nodes at once, sharing the overlay's peer table
+  ApplicationContainer newApps = ronClient.Install (overlayNodes, overlayPeers);
+  clientApps.Reserve (clientApps.GetN () + newApps.GetN ());
+  clientApps.Add (newApps);
   
   clientApps.Start (Seconds (2.0));
   clientApps.Stop (appStopTime);
 
+  baseline = Create<TopologySnapshot> (nodes);
+
   // Now cache the actual choices of server nodes for each disaster region
   NS_LOG_DEBUG (potentialServerNodeCandidates.size () << " total potentialServerNodeCandidates.");
-  for (DegreePriorityQueue::iterator itr = potentialServerNodeCandidates.begin ();
+  for (std::vector<DegreeIndex>::iterator itr = potentialServerNodeCandidates.begin ();
        itr != potentialServerNodeCandidates.end (); itr++)
     {
-      NS_LOG_DEBUG ("Node " << itr->second->GetId () << " has degree " << GetNodeDegree (itr->second));
-      Ptr<Node> serverCandidate = itr->second;
-      Ptr<RonPeerEntry> candidatePeer = serverCandidate->GetObject<RonPeerEntry> ();
-      NS_ASSERT_MSG (candidatePeer != NULL, "Server doesn't have a RonPeerEntry!");
-      Location loc = candidatePeer->region;
+      Ptr<Node> serverCandidate = nodes.Get (itr->second);
+      NS_LOG_DEBUG ("Node " << serverCandidate->GetId () << " has degree " << itr->first);
+      Location loc = entries[itr->second].region;
 
       for (std::vector<Location>::iterator disasterLocation = disasterLocations->begin ();
            disasterLocation != disasterLocations->end (); disasterLocation++)
         {
-          if (*disasterLocation != loc)
+          if (*disasterLocation != loc and !disasterNodes[*disasterLocation].count (serverCandidate->GetId ()))
             serverNodeCandidates[*disasterLocation].Add (serverCandidate);
         }
     }
 }
 
-/**   Fail the links that were chosen with given probability */
+/**   Choose the links that will fail with given probability */
 void
 GeocronExperiment::ApplyFailureModel () {
   NS_LOG_INFO ("Applying failure model.");
 
-  // Keep track of these and unfail them later
-  failNodes = NodeContainer ();
-  ifacesToKill = Ipv4InterfaceContainer ();
+  failures.Clear ();
 
   for (std::map<uint32_t, Ptr <Node> >::iterator nodeItr = disasterNodes[currLocation].begin ();
        nodeItr != disasterNodes[currLocation].end (); nodeItr++)
@@ -679,9 +944,8 @@ GeocronExperiment::ApplyFailureModel () {
       // Fail nodes within the disaster region with some probability
       if (random.GetValue () < currFprob)
         {
-          failNodes.Add (node);
+          failures.AddNode (node);
           NS_LOG_LOGIC ("Node " << (node)->GetId () << " failed.");
-          FailNode (node);
         }
 
       else {
@@ -694,8 +958,7 @@ GeocronExperiment::ApplyFailureModel () {
           {
             if (random.GetValue () < currFprob)
               {
-                ifacesToKill.Add(ipv4, i);
-                FailIpv4 (ipv4, i);
+                failures.AddIpv4 (ipv4, i);
               }
           }
       }
@@ -704,51 +967,47 @@ GeocronExperiment::ApplyFailureModel () {
 
 
 void
-GeocronExperiment::UnapplyFailureModel () {
-  // Unfail the links that were chosen
-  for (Ipv4InterfaceContainer::Iterator iface = ifacesToKill.Begin ();
-       iface != ifacesToKill.End (); iface++)
-    {
-      UnfailIpv4 (iface->first, iface->second);
-    }
+GeocronExperiment::SetNextServers () {
+  NS_LOG_LOGIC ("Choosing from " << serverNodeCandidates[currLocation].GetN () << " server provider candidates.");
 
-  // Unfail the nodes that were chosen
-  for (NodeContainer::Iterator node = failNodes.Begin ();
-       node != failNodes.End (); node++)
-    {
-      UnfailNode (*node, appStopTime);
-    }
+  serverNode = (serverNodeCandidates[currLocation].GetN () ?
+                serverNodeCandidates[currLocation].Get (random.GetInteger (0, serverNodeCandidates[currLocation].GetN () - 1)) :
+                nodes.Get (random.GetInteger (0, serverNodeCandidates[currLocation].GetN () - 1)));
 
+  serverPeers = Create<RonPeerTable> ();
+  serverPeers->AddPeer (serverNode);
+}
 
-  clientApps.Start (Seconds (2.0));
-  clientApps.Stop (appStopTime);
+
+Ptr<Node>
+GeocronExperiment::GetServerNode ()
+{
+  return serverNode;
 }
 
 
-void
-GeocronExperiment::SetNextServers () {
-  NS_LOG_LOGIC ("Choosing from " << serverNodeCandidates[currLocation].GetN () << " server provider candidates.");
+NodeContainer
+GeocronExperiment::GetServerCandidates (Location location)
+{
+  return serverNodeCandidates[location];
+}
 
-  Ptr<Node> serverNode = (serverNodeCandidates[currLocation].GetN () ?
-                          serverNodeCandidates[currLocation].Get (random.GetInteger (0, serverNodeCandidates[currLocation].GetN () - 1)) :
-                          nodes.Get (random.GetInteger (0, serverNodeCandidates[currLocation].GetN () - 1)));
 
+void
+GeocronExperiment::InstallServers () {
   //Application
   RonServerHelper ronServer (9);
 
   ApplicationContainer serverApps = ronServer.Install (serverNode);
   serverApps.Start (Seconds (1.0));
   serverApps.Stop (appStopTime);
-
-  serverPeers = Create<RonPeerTable> ();
-  serverPeers->AddPeer (serverNode);
 }
 
 
-void
-GeocronExperiment::Run ()
+uint32_t
+GeocronExperiment::SetUpClients ()
 {
-  int numDisasterPeers = 0;
+  uint32_t numDisasterPeers = 0;
 
   // Set up the proper heuristics, peer tables, and calculate the number of overlay nodes.
   for (std::map<uint32_t, Ptr <Node> >::iterator nodeItr = disasterNodes[currLocation].begin ();
@@ -790,6 +1049,45 @@ GeocronExperiment::Run ()
       }
     }
 
+  return numDisasterPeers;
+}
+
+
+void
+GeocronExperiment::RunSimulation ()
+{
+  Simulator::Stop (simulationLength);
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+
+void
+GeocronExperiment::Run ()
+{
+  if (executionMode == "oracle")
+    {
+      std::map<uint32_t, bool> acks = RunOracle ();
+
+      if (oracleCheckFraction > 0.0 and checkRandom.GetValue () < oracleCheckFraction)
+        {
+          CheckOracle (acks);
+        }
+      else
+        {
+          // start the nodes and applications as a simulation would,
+          // but drop all their events rather than run them
+          Simulator::Stop (Seconds (0.0));
+          Simulator::Run ();
+          Simulator::Destroy ();
+        }
+
+      NS_LOG_INFO ("Next oracle run...");
+      return;
+    }
+
+  uint32_t numDisasterPeers = SetUpClients ();
+
   //NS_LOG_INFO ("Populating routing tables; please be patient it takes a while...");
   //Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
 
@@ -805,22 +1103,266 @@ GeocronExperiment::Run ()
                  << disasterNodes[currLocation].size () << " nodes in " << currLocation << " total" << std::endl
                  << numDisasterPeers << " overlay nodes in " << currLocation << std::endl //TODO: get size from table
                  << std::endl << "Failure probability: " << currFprob << std::endl
-                 << failNodes.GetN () << " nodes failed" << std::endl
-                 << ifacesToKill.GetN () / 2 << " links failed");
+                 << failures.GetNodes ().GetN () << " nodes failed" << std::endl
+                 << failures.GetIpv4Interfaces ().GetN () / 2 << " links failed");
 
-  Simulator::Stop (simulationLength);
-  Simulator::Run ();
-  Simulator::Destroy ();
+  RunSimulation ();
 
   NS_LOG_INFO ("Next simulation run...");
+}
 
-  //serverNode->GetObject<Ipv4NixVectorRouting> ()->FlushGlobalNixRoutingCache ();
-  
-  // reset apps
-  for (ApplicationContainer::Iterator app = clientApps.Begin ();
-       app != clientApps.End (); app++)
+
+//////////////////////////////////////////////////////////////////////
+/////************************************************************/////
+////////////////           CONNECTIVITY ORACLE      //////////////////
+/////************************************************************/////
+//////////////////////////////////////////////////////////////////////
+
+
+static bool
+CompareRecordTimes (const RonTraceRecord & record1, const RonTraceRecord & record2)
+{
+  return record1.time < record2.time;
+}
+
+
+std::map<uint32_t, bool>
+GeocronExperiment::RunOracle ()
+{
+  if (oracle == NULL)
+    oracle = Create<ConnectivityOracle> ();
+  oracle->Update ();
+
+  std::vector<RonTraceRecord> records;
+  std::map<uint32_t, bool> acks;
+  uint32_t numDisasterPeers = 0;
+
+  for (std::map<uint32_t, Ptr <Node> >::iterator nodeItr = disasterNodes[currLocation].begin ();
+       nodeItr != disasterNodes[currLocation].end (); nodeItr++)
     {
-      Ptr<RonClient> ronClient = DynamicCast<RonClient> (*app);
-      ronClient->Reset ();
+      if (!IsOverlayNode (nodeItr->second))
+        continue;
+
+      for (uint32_t i = 0; i < nodeItr->second->GetNApplications (); i++)
+        {
+          Ptr<RonClient> ronClient = DynamicCast<RonClient> (nodeItr->second->GetApplication (i));
+          if (ronClient == NULL)
+            continue;
+
+          EmulateClient (nodeItr->second, ronClient, records, acks);
+          numDisasterPeers++;
+        }
+    }
+
+  NS_LOG_UNCOND ("Ran oracle on map file " << topologyFile << ": "
+                 << numDisasterPeers << " overlay nodes in " << currLocation << ", "
+                 << failures.GetNodes ().GetN () << " nodes failed, "
+                 << failures.GetIpv4Interfaces ().GetN () / 2 << " links failed, "
+                 << acks.size () << " ACKed");
+
+  // the simulation would have traced the clients' events interleaved in time
+  std::stable_sort (records.begin (), records.end (), CompareRecordTimes);
+
+  OpenTraceFile ();
+  for (std::vector<RonTraceRecord>::iterator record = records.begin (); record != records.end (); record++)
+    {
+      if (traceWriter)
+        traceWriter->Write (*record);
+      else if (traceOutputStream)
+        WriteTraceRecord (traceOutputStream, *record);
+    }
+
+  return acks;
+}
+
+
+void
+GeocronExperiment::EmulateClient (Ptr<Node> node, Ptr<RonClient> client, std::vector<RonTraceRecord> & records,
+                                  std::map<uint32_t, bool> & acks)
+{
+  TimeValue startTime, stopTime, clientTimeout, timeoutResolution;
+  UintegerValue dataSize;
+  client->GetAttribute ("StartTime", startTime);
+  client->GetAttribute ("StopTime", stopTime);
+  client->GetAttribute ("Timeout", clientTimeout);
+  client->GetAttribute ("TimeoutResolution", timeoutResolution);
+  client->GetAttribute ("PacketSize", dataSize);
+
+  // as in RonClient::StartApplication, e.g. for failed nodes
+  if (startTime.Get () >= stopTime.Get ())
+    return;
+
+  Ptr<RonPathHeuristic> heuristic = currHeuristic->Create<RonPathHeuristic> ();
+  heuristic->MakeTopLevel ();
+  heuristic->SetSourcePeer (Create<RonPeerEntry> (node));
+  heuristic->SetPeerTable (overlayPeers);
+  Ptr<RonPathHeuristic> randHeuristic = CreateObject<RandomRonPathHeuristic> ();
+  randHeuristic->SetAttribute ("Weight", DoubleValue (0.01));
+  heuristic->AddHeuristic (randHeuristic);
+
+  // as RonClient::Send, contact the first server directly but any of them through the overlay
+  Ptr<RonPeerEntry> serverPeer = *(serverPeers->Begin ());
+  Ptr<PeerDestination> destination = Create<PeerDestination> (serverPeer);
+  for (RonPeerTable::Iterator server = serverPeers->Begin (); server != serverPeers->End (); server++)
+    destination->AddPeer (*server);
+  Ipv4Address address = node->GetObject<Ipv4> ()->GetAddress (1,0).GetLocal ();
+  Time endTime = std::min (simulationLength, stopTime.Get ());
+  // UDP and IPv4 headers
+  uint32_t packetSize = dataSize.Get () + 8 + 20;
+
+  // Send directly first, then through the heuristic's best path each time the last
+  // attempt times out, until the first ACK comes back
+  Time now = startTime.Get ();
+  Time firstAck = endTime;
+  Ptr<RonPath> lastPath;
+  for (uint32_t sent = 0; sent < contactAttempts and now < endTime and now < firstAck; sent++)
+    {
+      RonHeader head;
+      std::vector<Ptr<Node> > hops;
+      Ptr<RonPath> path;
+
+      if (sent == 0)
+        {
+          head.SetDestination (serverPeer->address);
+          hops.push_back (serverNode);
+        }
+      else
+        {
+          if (lastPath)
+            heuristic->NotifyTimeout (lastPath, now);
+
+          try
+            {
+              path = heuristic->GetBestAnycastPath (destination);
+            }
+          catch (RonPathHeuristic::NoValidPeerException& e)
+            {
+              NS_LOG_LOGIC ("Node " << node->GetId () << " has no more overlay peers to choose.");
+              break;
+            }
+          head.SetPath (path);
+          // RonClient::Send notifies of the timeout up front
+          heuristic->NotifyTimeout (path, now);
+
+          for (RonPath::Iterator hop = path->Begin (); hop != path->End (); hop++)
+            hops.push_back ((*(*hop)->Begin ())->node);
+        }
+
+      head.SetSeq (sent);
+      head.SetOrigin (address);
+      records.push_back (RonTraceRecord::Create (RonTraceRecord::SEND, head, node->GetId (), now));
+
+      Time ackTime;
+      if (EmulateRoundTrip (node, head, hops, packetSize + head.GetSerializedSize (), now, endTime, records, ackTime))
+        {
+          if (path)
+            heuristic->NotifyAck (path, ackTime);
+          if (ackTime < firstAck)
+            firstAck = ackTime;
+          // a direct ACK counts for more than an indirect one
+          std::map<uint32_t, bool>::iterator ack = acks.find (node->GetId ());
+          if (ack == acks.end ())
+            acks[node->GetId ()] = (path != NULL);
+          else
+            ack->second = ack->second and (path != NULL);
+        }
+
+      // RonClient rounds its timeouts up to their resolution
+      lastPath = path;
+      int64_t resolution = timeoutResolution.Get ().GetTimeStep ();
+      now = TimeStep (((now + clientTimeout.Get ()).GetTimeStep () + resolution - 1) / resolution * resolution);
     }
+
+  heuristic->Clear ();
+}
+
+
+bool
+GeocronExperiment::EmulateRoundTrip (Ptr<Node> source, RonHeader head, std::vector<Ptr<Node> > hops, uint32_t packetSize,
+                                     Time sendTime, Time endTime, std::vector<RonTraceRecord> & records, Time & ackTime)
+{
+  // the server sends the ACK back the way the packet came
+  std::vector<Ptr<Node> > trip (1, source);
+  trip.insert (trip.end (), hops.begin (), hops.end ());
+  trip.insert (trip.end (), hops.rbegin () + 1, hops.rend ());
+  trip.push_back (source);
+
+  Time now = sendTime;
+  for (uint32_t i = 1; i < trip.size (); i++)
+    {
+      Time latency;
+      if (!oracle->GetLatency (trip[i - 1], trip[i], packetSize, latency))
+        return false;
+      now += latency;
+      if (now >= endTime)
+        return false;
+
+      if (i == trip.size () - 1)
+        {
+          records.push_back (RonTraceRecord::Create (RonTraceRecord::ACK, head, source->GetId (), now));
+          ackTime = now;
+        }
+      else if (trip[i] == serverNode)
+        {
+          head.ReversePath ();
+        }
+      else
+        {
+          head.IncrHops ();
+          records.push_back (RonTraceRecord::Create (RonTraceRecord::FORWARD, head, trip[i]->GetId (), now));
+        }
+    }
+
+  return true;
+}
+
+
+void
+GeocronExperiment::CheckOracle (const std::map<uint32_t, bool> & oracleAcks)
+{
+  SetUpClients ();
+
+  checkAcks.clear ();
+  for (ApplicationContainer::Iterator app = clientApps.Begin (); app != clientApps.End (); app++)
+    (*app)->TraceConnectWithoutContext ("Ack", MakeCallback (&GeocronExperiment::RecordCheckAck, this));
+
+  RunSimulation ();
+
+  for (ApplicationContainer::Iterator app = clientApps.Begin (); app != clientApps.End (); app++)
+    (*app)->TraceDisconnectWithoutContext ("Ack", MakeCallback (&GeocronExperiment::RecordCheckAck, this));
+
+  // which path a heuristic picks is random, but whether the server is reachable directly is not
+  uint32_t nDiffering = 0;
+  for (std::map<uint32_t, Ptr <Node> >::iterator nodeItr = disasterNodes[currLocation].begin ();
+       nodeItr != disasterNodes[currLocation].end (); nodeItr++)
+    {
+      std::map<uint32_t, bool>::const_iterator oracleAck = oracleAcks.find (nodeItr->first);
+      std::map<uint32_t, bool>::iterator checkAck = checkAcks.find (nodeItr->first);
+      bool oracleDirect = (oracleAck != oracleAcks.end () and !oracleAck->second);
+      bool checkDirect = (checkAck != checkAcks.end () and !checkAck->second);
+      if (oracleDirect != checkDirect)
+        {
+          NS_LOG_UNCOND ("Node " << nodeItr->first << (checkDirect ? " was" : " wasn't")
+                         << " ACKed directly in the simulation, but the oracle says it" << (oracleDirect ? " was" : " wasn't"));
+          nDiffering++;
+        }
+    }
+
+  NS_LOG_UNCOND ("Checked oracle against the simulation: " << oracleAcks.size () << " nodes ACKed by the oracle, "
+                 << checkAcks.size () << " in the simulation; " << nDiffering << " direct ACKs differ");
+  NS_ABORT_MSG_IF (nDiffering > 0, "The oracle's direct ACKs differ from the simulation's on map file " << topologyFile);
+}
+
+
+void
+GeocronExperiment::RecordCheckAck (Ptr<const Packet> packet, uint32_t nodeId)
+{
+  RonHeader head;
+  packet->PeekHeader (head);
+  // a direct ACK counts for more than an indirect one
+  std::map<uint32_t, bool>::iterator ack = checkAcks.find (nodeId);
+  if (ack == checkAcks.end ())
+    checkAcks[nodeId] = head.IsForward ();
+  else
+    ack->second = ack->second and head.IsForward ();
 }
@@ -24,6 +24,9 @@
 #include "ron-client.h"
 #include "ron-server.h"
 #include "region-helper.h"
+#include "failure-helper-functions.h"
+#include "topology-snapshot.h"
+#include "connectivity-oracle.h"
 
 #include <iostream>
 #include <sstream>
@@ -86,19 +89,102 @@ public:
   uint32_t contactAttempts;
   uint32_t nruns;
   uint32_t start_run_number;
+  /** Number of worker processes to run scenarios in concurrently.
+      If 0, all scenarios run one after another in this process. */
+  uint32_t nprocs;
+  /** Number of threads to classify the nodes in while indexing them.
+      If 0, one per processor, but only on topologies large enough to be worth it. */
+  uint32_t nthreads;
 
   /** Builds various indices for choosing different node types of interest.
       Chooses links/nodes that may be failed during disaster simulation.
       //TODO: build disaster nodes, servers index
   */
   void IndexNodes ();
+  /** The nodes IndexNodes found the server may be chosen from in a disaster at location. */
+  NodeContainer GetServerCandidates (Location location);
 
-private:
-  /** Sets the next server for the simulation. */
+  /** Chooses the next server for the simulation. */
   void SetNextServers ();
+  Ptr<Node> GetServerNode ();
 
+private:
+  /** What indexing needs to know about a node, looked up by the job whose range it's in. */
+  struct NodeIndexEntry
+  {
+    uint32_t degree;
+    bool hasLocation;
+    Vector location;
+    Location region;
+  };
+
+  /** Looks up and classifies a range of the nodes on a thread of its own, keeping the best
+      server candidates among them.  Only the job's own nodes and their aggregated objects
+      are touched, and the reference counts are atomic while the jobs run. */
+  struct NodeIndexJob
+  {
+    const NodeContainer * nodes;
+    std::vector<NodeIndexEntry> * entries;
+    uint32_t begin;
+    uint32_t end;
+    RegionHelper * regionHelper;
+    uint32_t maxNDevs;
+    uint32_t nServerChoices;
+    /** (degree, index in entries) of the candidates, highest degree first. */
+    std::vector<std::pair<uint32_t, uint32_t> > serverCandidates;
+
+    void Run ();
+  };
+
+  /** A single (disaster location, failure probability, run, heuristic) scenario
+      and the RNG run numbers for its failure model and its simulation. */
+  struct Scenario
+  {
+    Location location;
+    double fprob;
+    uint32_t run;
+    uint32_t heuristic;
+    uint32_t failureRngRun;
+    uint32_t rngRun;
+  };
+
+  /** Lists every scenario in the order they run in when run one after another. */
+  std::vector<Scenario> GetScenarios ();
+  /** Forks a worker process for each scenario from the already built topology,
+      keeping at most nprocs of them running at once. */
+  void RunScenariosInWorkers (const std::vector<Scenario> & scenarios);
+  /** Runs a single scenario on the topology as built, drawing its failures and
+      simulation from the same random streams whichever process runs it. */
+  void RunScenario (const Scenario & scenario);
+
+  /** Installs the RonServer on the chosen server node. */
+  void InstallServers ();
+
+  /** Chooses the nodes/links to fail in the current disaster; doesn't fail them yet. */
   void ApplyFailureModel ();
-  void UnapplyFailureModel ();
+
+  /** Sets up the heuristics of the clients in the disaster region; returns how many there are. */
+  uint32_t SetUpClients ();
+  void OpenTraceFile ();
+  /** Writes out and closes the current trace file, if there is one, failing if it couldn't be written. */
+  void CloseTraceFile ();
+  void RunSimulation ();
+
+  /** Runs the scenario with the connectivity oracle in place of the packet-level simulation.
+      Returns whether each client that got an ACK got it indirectly, by node id. */
+  std::map<uint32_t, bool> RunOracle ();
+  /** Makes the same contact attempts, heuristic calls and trace records for the client
+      as it would in the simulation, adding the ACKs it gets to acks. */
+  void EmulateClient (Ptr<Node> node, Ptr<RonClient> client, std::vector<RonTraceRecord> & records,
+                      std::map<uint32_t, bool> & acks);
+  /** Records the packet's trip through its path to the server and back, returning whether
+      it got back and, if so, setting ackTime to when. */
+  bool EmulateRoundTrip (Ptr<Node> source, RonHeader head, std::vector<Ptr<Node> > hops, uint32_t packetSize,
+                         Time sendTime, Time endTime, std::vector<RonTraceRecord> & records, Time & ackTime);
+  /** Runs the same scenario in the simulation and compares its ACKs to the oracle's,
+      aborting if any client is ACKed directly in one but not the other. */
+  void CheckOracle (const std::map<uint32_t, bool> & oracleAcks);
+  void RecordCheckAck (Ptr<const Packet> packet, uint32_t nodeId);
   bool IsOverlayNode (Ptr<Node> node);
   bool IsDisasterNode (Ptr<Node> node);
   void AutoSetTraceFile ();
@@ -115,19 +201,39 @@ private:
   ApplicationContainer clientApps;
   Ptr<RonPeerTable> overlayPeers;
   Ptr<RonPeerTable> serverPeers;
+  Ptr<Node> serverNode;
   std::string topologyFile;
 
   // name of topology generator/reader, and a helper for assigning regions
   std::string topologyType;
   Ptr<RegionHelper> regionHelper;
+  // if positive, disasters affect nodes within this distance of their location instead of their region
+  double disasterRadius;
 
-  RocketfuelTopologyReader::LatenciesMap latencies;
+  RocketfuelLatencies latencies;
+  // if not empty, the parsed latencies are cached here between runs
+  std::string latencyCacheFile;
 
   std::string traceFile;
+  Ptr<OutputStreamWrapper> traceOutputStream;
+  Ptr<RonTraceWriter> traceWriter;
+  // ascii or binary
+  std::string traceFormat;
+  // packet or oracle
+  std::string executionMode;
+  // fraction of oracle runs also simulated to check the oracle's answers
+  double oracleCheckFraction;
+  Ptr<ConnectivityOracle> oracle;
+  UniformVariable checkRandom;
+  std::map<uint32_t, bool> checkAcks;
   Time appStopTime;
 
   // Random variable for determining if links fail during the disaster
   UniformVariable random;
+  // if not 0, the RNG seed of all runs; otherwise one is made from the clock and pid
+  uint32_t seed;
+  // the RNG stream every scenario's random variables start from, or 0 until the scenarios first run
+  uint64_t firstStreamIndex;
 
   // These maps, indexed by disaster location name, hold nodes of interest for the associated disaster region
   std::map<Location, std::map<uint32_t, Ptr <Node> > > disasterNodes; //both random access AND iteration hmmm...
@@ -135,9 +241,10 @@ private:
   /** Number of nodes to collect as potential server choices. */
   uint32_t nServerChoices;
 
-  // Keep track of failed nodes/links to unfail them in between runs
-  Ipv4InterfaceContainer ifacesToKill;
-  NodeContainer failNodes;
+  // The failed nodes/links, applied again for each heuristic
+  FailureSet failures;
+  // The topology before any run, restored in between runs
+  Ptr<TopologySnapshot> baseline;
 };
 } //namespace ns3
 #endif //GEOCRON_EXPERIMENT_H
@@ -155,3 +155,47 @@ OrthogonalRonPathHeuristic::GetLikelihood (Ptr<RonPath> path)
 
   return newLikelihood;
 }
+
+
+bool
+OrthogonalRonPathHeuristic::GetLikelihoods (Ptr<RonPeerEntry> destination, const std::vector<Ptr<RonPath> > & paths,
+                                            const PeerLocations & peers, std::vector<double> & likelihoods)
+{
+  NS_ASSERT_MSG (m_source, "You must set the source peer(s) before using the heuristic!");
+
+  double pi = 3.14159265;
+  double orthogonal = pi/2.0;
+
+  // the same triangles as GetLikelihood, with the peers' legs computed all at once
+  double ab_dist = CalculateDistance (m_source->location, destination->location);
+  double ideal_dist = fabs(0.5*ab_dist);
+  std::vector<double> acDists, bcDists;
+  GetDistances (peers, m_source->location, acDists);
+  GetDistances (peers, destination->location, bcDists);
+
+  likelihoods.resize (paths.size ());
+  const double * ac = &acDists[0];
+  const double * bc = &bcDists[0];
+  double * lh = &likelihoods[0];
+  for (uint32_t i = 0; i < likelihoods.size (); i++)
+    {
+      double ac_dist = ac[i];
+      double bc_dist = bc[i];
+      double c_ang = acos ((ac_dist * ac_dist + bc_dist * bc_dist - ab_dist * ab_dist) /
+                           (2.0 * ac_dist * bc_dist));
+      double a_ang = acos ((ac_dist * ac_dist + ab_dist * ab_dist - bc_dist * bc_dist) /
+                           (2.0 * ac_dist * ab_dist));
+      double perpDist = fabs(ac_dist * sin (a_ang));
+
+      double norm_ang_err = fabs(orthogonal - c_ang) / orthogonal;
+      norm_ang_err = norm_ang_err * norm_ang_err;
+      double norm_dist_err = fabs(fabs(perpDist) - fabs(ideal_dist)) / ideal_dist;
+      norm_dist_err = norm_dist_err * norm_dist_err;
+
+      bool obtuse = a_ang > orthogonal or (c_ang + a_ang < orthogonal) or perpDist > ab_dist;
+      lh[i] = obtuse ? 0.0 : 0.5*((1.0 - norm_dist_err) + (1.0 - norm_ang_err));
+    }
+
+  ExcludeSameRegion (destination, paths, likelihoods);
+  return true;
+}
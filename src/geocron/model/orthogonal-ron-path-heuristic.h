@@ -30,6 +30,8 @@ public:
   static TypeId GetTypeId (void);
 private:
   virtual double GetLikelihood (Ptr<RonPath> path);
+  virtual bool GetLikelihoods (Ptr<RonPeerEntry> destination, const std::vector<Ptr<RonPath> > & paths,
+                               const PeerLocations & peers, std::vector<double> & likelihoods);
 };
 
 } //namespace
@@ -1,6 +1,7 @@
 /* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
 
 #include "region-helper.h"
+#include <cmath>
 
 namespace ns3 {
 
@@ -27,4 +28,93 @@ HasLocation (Ptr<Node> node)
   return true;
 }
 
+
+
+////////////////////////////////////////////////////////////////////////////////
+////////////////////  RegionHelper spatial index  //////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+
+RegionHelper::CellKey
+RegionHelper::GetCell (Vector loc) const
+{
+  return CellKey ((int64_t) std::floor (loc.x / cellSize), (int64_t) std::floor (loc.y / cellSize));
+}
+
+
+void
+RegionHelper::AddNode (Ptr<Node> node, Location region)
+{
+  if (cells.empty ())
+    cellSize = GetCellSize ();
+  NS_ASSERT_MSG (cellSize > 0.0, "RegionHelper needs a positive CellSize to index nodes!");
+
+  if (HasLocation (node))
+    cells[GetCell (ns3::GetLocation (node))].Add (node);
+  if (region != NULL_REGION)
+    regionNodes[region].Add (node);
+}
+
+
+NodeContainer
+RegionHelper::GetNodesInRegion (Location region) const
+{
+  std::map<Location, NodeContainer>::const_iterator nodes = regionNodes.find (region);
+  if (nodes == regionNodes.end ())
+    return NodeContainer ();
+  return nodes->second;
+}
+
+
+NodeContainer
+RegionHelper::GetNodesInRadius (Vector center, double radius) const
+{
+  NodeContainer found;
+  if (cells.empty () or radius < 0.0)
+    return found;
+
+  CellKey low = GetCell (Vector (center.x - radius, center.y - radius, 0.0)),
+    high = GetCell (Vector (center.x + radius, center.y + radius, 0.0));
+
+  // for a circle covering most of the topology it's cheaper to check every occupied cell
+  double nBoxCells = ((double)(high.first - low.first) + 1) * ((double)(high.second - low.second) + 1);
+  std::vector<const NodeContainer *> candidates;
+  if (nBoxCells > cells.size ())
+    {
+      for (CellMap::const_iterator cell = cells.begin (); cell != cells.end (); cell++)
+        if (low.first <= cell->first.first and cell->first.first <= high.first and
+            low.second <= cell->first.second and cell->first.second <= high.second)
+          candidates.push_back (&cell->second);
+    }
+  else
+    {
+      for (int64_t x = low.first; x <= high.first; x++)
+        for (int64_t y = low.second; y <= high.second; y++)
+          {
+            CellMap::const_iterator cell = cells.find (CellKey (x, y));
+            if (cell != cells.end ())
+              candidates.push_back (&cell->second);
+          }
+    }
+
+  for (std::vector<const NodeContainer *>::iterator cell = candidates.begin ();
+       cell != candidates.end (); cell++)
+    for (NodeContainer::Iterator node = (*cell)->Begin (); node != (*cell)->End (); node++)
+      {
+        Vector loc = ns3::GetLocation (*node);
+        double dx = loc.x - center.x, dy = loc.y - center.y;
+        if (dx * dx + dy * dy <= radius * radius)
+          found.Add (*node);
+      }
+  return found;
+}
+
+
+void
+RegionHelper::ClearNodes ()
+{
+  cells.clear ();
+  regionNodes.clear ();
+}
+
 } //namespace ns3
@@ -20,11 +20,13 @@
 #define REGION_HELPER_H
 
 #include "ns3/core-module.h"
+#include "ns3/node-container.h"
 #include "region.h"
 
 #include <boost/unordered_map.hpp>
 #include <boost/lexical_cast.hpp>
 #include <map>
+#include <utility>
 
 namespace ns3 {
 
@@ -44,23 +46,40 @@ bool HasLocation (Ptr<Node> node);
 
   //TODO: some real inheritance instead of this wasteful silliness
 
-/** Simple helper class for assigning Regions for specific location Vectors. */
+/** Simple helper class for assigning Regions for specific location Vectors.
+    It also keeps a spatial index of nodes, a grid of square cells over their locations,
+    for finding the nodes in a region or within some distance of a point. */
 class RegionHelper : public Object
 {
   //boost::unordered_map<Vector, Location> regions;
   typedef std::map<Vector, Location> UnderlyingMapType;
   UnderlyingMapType regions;
+
+  typedef std::pair<int64_t, int64_t> CellKey;
+  typedef boost::unordered_map<CellKey, NodeContainer> CellMap;
+  CellMap cells;
+  std::map<Location, NodeContainer> regionNodes;
+  double cellSize;
+
+  CellKey GetCell (Vector loc) const;
 public:
   typedef UnderlyingMapType::iterator Iterator;
 
   RegionHelper () {
     regions[NO_LOCATION_VECTOR] = NULL_REGION;
+    cellSize = 0.0;
   }
 
   static TypeId GetTypeId () {
     static TypeId tid = TypeId ("ns3::RegionHelper")
       .SetParent<Object> ()
       .AddConstructor<RegionHelper> ()
+      .AddAttribute ("CellSize",
+                     "Edge length of the grid cells indexing nodes by location, in the units of their positions "
+                     "(degrees for Rocketfuel).  Unused by helpers that define their own cells.",
+                     DoubleValue (1.0),
+                     MakeDoubleAccessor (&RegionHelper::cellSize),
+                     MakeDoubleChecker<double> (0.0))
       ;
     return tid;
   }
@@ -89,6 +108,23 @@ public:
       }
     return NO_LOCATION_VECTOR;
   }
+
+  // SPATIAL INDEX
+
+  /** Index the node by its location and under the given region. */
+  void AddNode (Ptr<Node> node, Location region);
+  /** Returns the indexed nodes in the region. */
+  NodeContainer GetNodesInRegion (Location region) const;
+  /** Returns the indexed nodes within radius of center, measured in the plane of the x and y coordinates.
+      Only the grid cells overlapping the circle are searched. */
+  NodeContainer GetNodesInRadius (Vector center, double radius) const;
+  /** Forget all indexed nodes. */
+  void ClearNodes ();
+
+  /** Edge length of the grid cells, fixed once the first node is indexed. */
+  virtual double GetCellSize () {
+    return cellSize;
+  }
 };  
 
 // For Rocketfuel topologies, we have to explicitly set Region info anyway so...
@@ -134,6 +170,23 @@ public:
     return reg;
   }
 
+  // region cells are centered on the location of their region
+  virtual Vector GetLocation (Location reg) {
+    std::string::size_type comma = reg.find (',');
+    if (comma == std::string::npos or GetRegionSize () <= 0.0)
+      return NO_LOCATION_VECTOR;
+    double x = boost::lexical_cast<double> (reg.substr (0, comma)),
+      y = boost::lexical_cast<double> (reg.substr (comma + 1));
+    return Vector ((x + 0.5) * GetRegionSize (), (y + 0.5) * GetRegionSize (), 0.0);
+  }
+
+  // index nodes in the same cells as the regions, when the topology size is known
+  virtual double GetCellSize () {
+    if (GetRegionSize () > 0.0)
+      return GetRegionSize ();
+    return RegionHelper::GetCellSize ();
+  }
+
   double GetRegionSize ()
   {
     //TODO: different region numbers
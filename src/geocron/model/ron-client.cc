@@ -56,6 +56,11 @@ RonClient::GetTypeId (void)
                    TimeValue (Seconds (3)),
                    MakeTimeAccessor (&RonClient::m_timeout),
                    MakeTimeChecker ())
+    .AddAttribute ("TimeoutResolution", "Timeouts are rounded up to a multiple of this, "
+                   "so that those of all the outstanding packets share a few simulator events.",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&RonClient::m_timeoutResolution),
+                   MakeTimeChecker ())
     .AddAttribute ("MaxPackets", 
                    "The maximum number of packets the application will send",
                    UintegerValue (100),
@@ -95,6 +100,12 @@ void
 RonClient::SetDefaults ()
 {
   m_sent = 0;
+  // close rather than just drop the socket, or it keeps our port bound into the next run
+  if (m_socket != 0)
+    {
+      m_socket->Close ();
+      m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+    }
   m_socket = 0;
   m_nextPeer = 0;
   m_count = 0;
@@ -191,6 +202,9 @@ RonClient::StartApplication (void)
 
   m_socket->SetRecvCallback (MakeCallback (&RonClient::HandleRead, this));
 
+  if (m_timeouts.GetTick () != m_timeoutResolution)
+    m_timeouts.SetTick (m_timeoutResolution);
+
   if (m_sent < m_count)
     ScheduleTransmit (Seconds (0.));
 }
@@ -216,11 +230,8 @@ RonClient::CancelEvents ()
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  for (std::list<EventId>::iterator itr = m_events.begin ();
-       itr != m_events.end (); itr++)
-    Simulator::Cancel (*itr);
-
-  m_events.clear ();
+  Simulator::Cancel (m_sendEvent);
+  m_timeouts.CancelAll ();
 }
 
 void 
@@ -331,7 +342,7 @@ void
 RonClient::ScheduleTransmit (Time dt, bool viaOverlay /*= false*/)
 {
   NS_LOG_FUNCTION_NOARGS ();
-  m_events.push_front (Simulator::Schedule (dt, &RonClient::Send, this, viaOverlay));
+  m_sendEvent = Simulator::Schedule (dt, &RonClient::Send, this, viaOverlay);
 }
 
 void 
@@ -366,11 +377,11 @@ RonClient::Send (bool viaOverlay)
       p = Create<Packet> (m_size);
     }
 
-  //TODO: handle choosing from multiple servers
+  // direct contact goes to the first server, while the overlay may reach any of them
   Ptr<RonPeerEntry> serverPeer = *(m_serverPeers->Begin ());
 
   // add RON header to packet
-  Ptr<RonHeader> head = Create<RonHeader> ();
+  RonHeader head;
   uint32_t seq = m_sent;
   Ptr<RonPath> overlayPeerChoices;
 
@@ -379,9 +390,8 @@ RonClient::Send (bool viaOverlay)
     {
       try
         {
-          overlayPeerChoices = m_heuristic->GetBestPath (Create<PeerDestination> (serverPeer));
-          head = Create<RonHeader> ();
-          head->SetPath (overlayPeerChoices);
+          overlayPeerChoices = m_heuristic->GetBestAnycastPath (GetServerDestinations ());
+          head.SetPath (overlayPeerChoices);
           //TODO: FIX THIS BUG!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!
           //for whatever reason, it doesn't work in the CheckTimeout function... something wrong with the way we reverse the header and send it back?  looks like it's because the server pops the header, reverses it, and puts it in the packet for the way back.  this will erase a lot of information about the peers so we should really just get around to actually to storing the entire peer entry (at least const parts of them) in the header path...
 m_heuristic->NotifyTimeout (overlayPeerChoices, Simulator::Now ());
@@ -395,16 +405,16 @@ m_heuristic->NotifyTimeout (overlayPeerChoices, Simulator::Now ());
         }
     }
   else
-    head->SetDestination (serverPeer->address);
+    head.SetDestination (serverPeer->address);
 
-  head->SetSeq (seq);
-  head->SetOrigin (m_address);
-  p->AddHeader (*head);
+  head.SetSeq (seq);
+  head.SetOrigin (m_address);
+  p->AddHeader (head);
 
   // call to the trace sinks before the packet is actually sent,
   // so that tags added to the packet can be sent as well
   m_sendTrace (p, GetNode ()->GetId ());
-  m_socket->SendTo (p, 0, InetSocketAddress(head->GetNextDest (), m_port));
+  m_socket->SendTo (p, 0, InetSocketAddress(head.GetNextDest (), m_port));
   ScheduleTimeout (head);
   m_sent++;
 
@@ -489,30 +499,35 @@ RonClient::ProcessAck (Ptr<Packet> packet, Ipv4Address source)
   uint32_t seq = head.GetSeq ();
   
   m_ackTrace (packet, GetNode ()-> GetId ());
-  m_outstandingSeqs.erase (seq);
+  std::map<uint32_t, TimerWheel::Id>::iterator outstanding = m_outstandingSeqs.find (seq);
+  if (outstanding != m_outstandingSeqs.end ())
+    {
+      m_timeouts.Cancel (outstanding->second);
+      m_outstandingSeqs.erase (outstanding);
+    }
   //TODO: handle an ack from an old seq number
 
-  Time time = Simulator::Now ();
-  head.ReversePath ();//currently in order from dest
-  Ptr<RonPath> path = head.GetPath ();
-
-  NS_ASSERT_MSG (path->GetN () > 0, "got 0 length path from Header in ProcessAck");
+  // the heuristic only chooses overlay paths, so it needn't hear about direct contact
+  if (head.IsForward ())
+    {
+      Time time = Simulator::Now ();
+      head.ReversePath ();//currently in order from dest
+      // the server isn't in the master table, so look for it among ours
+      Ptr<RonPath> path = head.GetPath (m_serverPeers);
 
-  //need to set destination's address explicitly as we currently don't have everything in the master table
-  //TODO: fix this
-  (*path->GetDestination ()->Begin ())->address = source;
+      NS_ASSERT_MSG (path->GetN () > 0, "got 0 length path from Header in ProcessAck");
 
-  m_heuristic->NotifyAck (path, time);
+      m_heuristic->NotifyAck (path, time);
+    }
 
   CancelEvents ();
   //TODO: store path? send more data?
 }
 
 void
-RonClient::ScheduleTimeout (Ptr<RonHeader> head)
+RonClient::ScheduleTimeout (const RonHeader & head)
 {
-  m_events.push_front (Simulator::Schedule (m_timeout, &RonClient::CheckTimeout, this, head));
-  m_outstandingSeqs.insert (head->GetSeq ());
+  m_outstandingSeqs[head.GetSeq ()] = m_timeouts.Schedule (m_timeout, &RonClient::CheckTimeout, this, head);
 }
 
 void
@@ -527,7 +542,8 @@ RonClient::AddPeer (Ptr<Node> node)
 void
 RonClient::SetPeerTable (Ptr<RonPeerTable> peers)
 {
-  m_peers = peers;
+  // a mirror costs nothing until AddPeer changes it, and then doesn't change everyone else's table
+  m_peers = peers->Mirror ();
 }
 
 
@@ -546,6 +562,17 @@ RonClient::AddServerPeer (Ptr<RonPeerEntry> peer)
 }
 
 
+Ptr<PeerDestination>
+RonClient::GetServerDestinations () const
+{
+  RonPeerTable::Iterator server = m_serverPeers->Begin ();
+  Ptr<PeerDestination> destinations = Create<PeerDestination> (*server);
+  for (server++; server != m_serverPeers->End (); server++)
+    destinations->AddPeer (*server);
+  return destinations;
+}
+
+
 void
 RonClient::SetHeuristic (Ptr<RonPathHeuristic> heuristic)
 {
@@ -561,10 +588,10 @@ RonClient::GetAddress () const
 }
 
 void
-RonClient::CheckTimeout (Ptr<RonHeader> head)
+RonClient::CheckTimeout (RonHeader head)
 {
-  uint32_t seq = head->GetSeq ();
-  std::set<uint32_t>::iterator itr = m_outstandingSeqs.find (seq);
+  uint32_t seq = head.GetSeq ();
+  std::map<uint32_t, TimerWheel::Id>::iterator itr = m_outstandingSeqs.find (seq);
 
   // If it's timed out, we should try a different path to the server
   if (itr != m_outstandingSeqs.end ())
@@ -572,14 +599,13 @@ RonClient::CheckTimeout (Ptr<RonHeader> head)
       NS_LOG_LOGIC ("Packet with seq# " << seq << " timed out.");
       m_outstandingSeqs.erase (itr);
 
-      Time time = Simulator::Now ();
-      Ptr<RonPath> path = head->GetPath ();
-
-      //need to set destination's address explicitly as we currently don't have everything in the master table
-      //TODO: fix this
-      (*path->GetDestination ()->Begin ())->address = m_serverPeers->GetPeerByAddress (head->GetFinalDest ())->address;
+      if (head.IsForward ())
+        {
+          Time time = Simulator::Now ();
+          Ptr<RonPath> path = head.GetPath (m_serverPeers);
 
-      m_heuristic->NotifyTimeout (path, time);
+          m_heuristic->NotifyTimeout (path, time);
+        }
       
       // try again?
       if (m_sent < m_count)
@@ -590,14 +616,32 @@ RonClient::CheckTimeout (Ptr<RonHeader> head)
 
 void
 RonClient::ConnectTraces (Ptr<OutputStreamWrapper> traceOutputStream)
+{
+  DoConnectTraces (MakeBoundCallback (&AckReceived, traceOutputStream),
+                   MakeBoundCallback (&PacketSent, traceOutputStream),
+                   MakeBoundCallback (&PacketForwarded, traceOutputStream));
+}
+
+
+void
+RonClient::ConnectTraces (Ptr<RonTraceWriter> traceWriter)
+{
+  DoConnectTraces (MakeBoundCallback (&AckReceivedRecord, traceWriter),
+                   MakeBoundCallback (&PacketSentRecord, traceWriter),
+                   MakeBoundCallback (&PacketForwardedRecord, traceWriter));
+}
+
+
+void
+RonClient::DoConnectTraces (CallbackBase ackcb, CallbackBase sendcb, CallbackBase forwardcb)
 {
   this->TraceDisconnectWithoutContext ("Ack", m_ackcb);
   this->TraceDisconnectWithoutContext ("Send", m_sendcb);
   this->TraceDisconnectWithoutContext ("Forward", m_forwardcb);
   
-  m_ackcb = MakeBoundCallback (&AckReceived, traceOutputStream);
-  m_sendcb = MakeBoundCallback (&PacketSent, traceOutputStream);
-  m_forwardcb = MakeBoundCallback (&PacketForwarded, traceOutputStream);
+  m_ackcb = ackcb;
+  m_sendcb = sendcb;
+  m_forwardcb = forwardcb;
 
   this->TraceConnectWithoutContext ("Ack", m_ackcb);
   this->TraceConnectWithoutContext ("Forward", m_forwardcb);
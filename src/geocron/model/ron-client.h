@@ -21,6 +21,7 @@
 
 #include "ns3/application.h"
 #include "ns3/event-id.h"
+#include "ns3/timer-wheel.h"
 #include "ns3/ptr.h"
 #include "ns3/address.h"
 #include "ns3/traced-callback.h"
@@ -28,9 +29,10 @@
 #include "ron-header.h"
 #include "ron-peer-table.h"
 #include "ron-path-heuristic.h"
+#include "ron-trace-file.h"
 
 #include <list>
-#include <set>
+#include <map>
 #include <vector>
 
 namespace ns3 {
@@ -131,6 +133,7 @@ public:
 
   /**
    * Use the specified peer list for this client.  Useful for sharing them among several clients to save memory.
+   * The client keeps a copy-on-write mirror of the table, so peers it adds later are its own.
    *
    * \param peers Smart Pointer to the RonPeerTable to be used.
    */
@@ -152,6 +155,8 @@ public:
 
   Ipv4Address GetAddress () const;
   void ConnectTraces (Ptr<OutputStreamWrapper> traceOutputStream);
+  /** Record the traces as fixed-size binary records rather than lines of text. */
+  void ConnectTraces (Ptr<RonTraceWriter> traceWriter);
 
 protected:
   virtual void DoDispose (void);
@@ -171,8 +176,10 @@ private:
 
   void ForwardPacket (Ptr<Packet> packet, Ipv4Address source);
   void ProcessAck (Ptr<Packet> packet, Ipv4Address source);
-  void CheckTimeout (Ptr<RonHeader> head);
-  void ScheduleTimeout (Ptr<RonHeader> head);
+  void CheckTimeout (RonHeader head);
+  void ScheduleTimeout (const RonHeader & head);
+  /** All the servers as one anycast destination for the heuristic. */
+  Ptr<PeerDestination> GetServerDestinations () const;
 
   uint32_t m_count;
   Time m_interval;
@@ -188,8 +195,13 @@ private:
   Ipv4Address m_address;
   Ptr<Socket> m_socket;
   uint16_t m_port;
-  std::list<EventId> m_events;
-  std::set<uint32_t> m_outstandingSeqs;
+  /** the next transmission */
+  EventId m_sendEvent;
+  /** the timeouts of the outstanding packets, most of which get cancelled by their ACK */
+  TimerWheel m_timeouts;
+  Time m_timeoutResolution;
+  /** the timeout of each outstanding packet, by seq */
+  std::map<uint32_t, TimerWheel::Id> m_outstandingSeqs;
   int m_nextPeer;
 
   Ptr<RonPeerTable> m_peers;
@@ -203,6 +215,8 @@ private:
   CallbackBase m_ackcb;
   CallbackBase m_forwardcb;
   CallbackBase m_sendcb;
+
+  void DoConnectTraces (CallbackBase ackcb, CallbackBase sendcb, CallbackBase forwardcb);
 };
 
 } // namespace ns3
@@ -2,6 +2,7 @@
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
 #include "ns3/log.h"
+#include "ns3/abort.h"
 #include "ns3/uinteger.h"
 #include "ron-header.h"
 
@@ -16,6 +17,7 @@ RonHeader::RonHeader ()
 
   m_forward = false;
   m_nHops = 0;
+  m_nIps = 0;
   m_origin = 0;
   m_seq = 0;
 
@@ -23,7 +25,7 @@ RonHeader::RonHeader ()
 }
 
 RonHeader::RonHeader (Ipv4Address destination, Ipv4Address intermediate /*= Ipv4Address((uint32_t)0)*/)
-  : m_nHops (0), m_seq (0), m_origin (0)
+  : m_nHops (0), m_seq (0), m_origin (0), m_nIps (0)
 {
   NS_LOG_FUNCTION (destination << " and " << intermediate);
 
@@ -63,23 +65,6 @@ RonHeader::RonHeader (Ipv4Address destination, Ipv4Address intermediate /*= Ipv4
     }
     }*/
 
-RonHeader&
-RonHeader::operator=(const RonHeader& original)
-{
-  NS_LOG_FUNCTION_NOARGS ();
-
-  RonHeader temp ((const RonHeader)original);
-
-  std::swap(m_forward, temp.m_forward);
-  std::swap(m_nHops, temp.m_nHops);
-  std::swap(m_seq, temp.m_seq);
-  std::swap(m_dest, temp.m_dest);
-  std::swap(m_origin, temp.m_origin);
-  std::swap(m_ips, temp.m_ips);
-
-  return *this;
-}
-
 /*
 RonHeader::RonHeader (Ipv4Address destination, 
 {
@@ -123,7 +108,7 @@ RonHeader::GetNextDest (void) const
 {
   NS_LOG_FUNCTION_NOARGS ();
 
-  if (m_nHops < m_ips.size ())
+  if (m_nHops < m_nIps)
     {
       uint32_t next = m_ips[m_nHops];
       return Ipv4Address (next);
@@ -169,8 +154,9 @@ RonHeader::AddDest (Ipv4Address addr)
   if (!m_forward)
     m_forward = true;
 
-  uint32_t next = addr.Get ();
-  m_ips.push_back (next);
+  // checked in optimized builds too, as it would write past m_ips
+  NS_ABORT_MSG_IF (m_nIps >= RON_HEADER_MAX_HOPS, "RonHeader can't hold more than " << RON_HEADER_MAX_HOPS << " hops!");
+  m_ips[m_nIps++] = addr.Get ();
 }
 
 void
@@ -188,33 +174,51 @@ RonHeader::SetOrigin (Ipv4Address origin)
 RonHeader::PathIterator
 RonHeader::GetPathBegin () const
 {
-  return m_ips.begin ();
+  return m_ips;
 }
 
 RonHeader::PathIterator
 RonHeader::GetPathEnd () const
 {
-  return m_ips.end ();
+  return m_ips + m_nIps;
 }
 
 Ptr<RonPath>
-RonHeader::GetPath () const
+RonHeader::GetPath (Ptr<RonPeerTable> destinations) const
 {
+  Ptr<RonPeerTable> master = RonPeerTable::GetMaster ();
+
+  //TODO: properly get the right destination peer
+  Ptr<RonPeerEntry> destination = master->GetPeerByAddress (GetFinalDest ());
+  if (destination == NULL and destinations != NULL)
+    destination = destinations->GetPeerByAddress (GetFinalDest ());
+
+  if (destination != NULL and m_nIps <= 1)
+    {
+      if (m_nIps == 0)
+        return master->GetDirectPath (destination);
+
+      Ptr<RonPeerEntry> intermediate = master->GetPeerByAddress (Ipv4Address (m_ips[0]));
+      NS_ASSERT_MSG (intermediate != NULL, "null peer in master table with address " << Ipv4Address (m_ips[0]));
+      return master->GetOneHopPath (intermediate, destination);
+    }
+
   Ptr<RonPath> path = Create<RonPath> ();
   Ptr<RonPeerEntry> peer;
   for (PathIterator addrItr = GetPathBegin ();
        addrItr != GetPathEnd (); addrItr++)
     {
-      peer = RonPeerTable::GetMaster ()->GetPeerByAddress ((Ipv4Address)*addrItr);
+      peer = master->GetPeerByAddress ((Ipv4Address)*addrItr);
       NS_ASSERT_MSG (peer != NULL, "null peer in master table with address " << *addrItr);
       path->AddHop (peer);
     }
-  //TODO: properly get the right destination peer
-  peer = RonPeerTable::GetMaster ()->GetPeerByAddress ((Ipv4Address)GetFinalDest ());
 
-  if (peer == NULL)
-    peer = Create<RonPeerEntry> ();
-  path->AddHop (peer);
+  if (destination == NULL)
+    {
+      destination = Create<RonPeerEntry> ();
+      destination->address = GetFinalDest ();
+    }
+  path->AddHop (destination);
   return path;
 }
 
@@ -236,7 +240,7 @@ RonHeader::SetPath (Ptr<RonPath> path)
   SetDestination ((*(*itr)->Begin ())->address);
 
   //ensure correct path size, which should include the Destination
-  NS_ASSERT (path->GetN () == m_ips.size () + 1);
+  NS_ASSERT (path->GetN () == (uint32_t)m_nIps + 1);
 }
 
 void
@@ -245,11 +249,11 @@ RonHeader::ReversePath (void)
   NS_LOG_FUNCTION_NOARGS ();
 
   // Iterate over buffer and swap elements
-  for (uint8_t i = 0; i < m_ips.size ()/2; i++)
+  for (uint8_t i = 0; i < m_nIps/2; i++)
     {
       uint32_t tmp = m_ips[i];
-      m_ips[i] = m_ips[m_ips.size () - 1 - i];
-      m_ips[m_ips.size () - 1 - i] = tmp;
+      m_ips[i] = m_ips[m_nIps - 1 - i];
+      m_ips[m_nIps - 1 - i] = tmp;
     }
 
   uint32_t oldDest = m_dest;
@@ -275,7 +279,7 @@ uint32_t
 RonHeader::GetSerializedSize (void) const
 {
   // we reserve 2 bytes for our header.
-  return RON_HEADER_SIZE(m_ips.size ());
+  return RON_HEADER_SIZE(m_nIps);
 }
 
 void
@@ -285,7 +289,7 @@ RonHeader::Serialize (Buffer::Iterator start) const
 
   start.WriteU8 (m_forward);
   start.WriteU8 (m_nHops);
-  start.WriteU8 ((unsigned char)m_ips.size ());
+  start.WriteU8 (m_nIps);
   start.WriteU32 (m_seq);
   start.WriteU32 (m_dest);
   start.WriteU32 (m_origin);
@@ -303,23 +307,21 @@ RonHeader::Deserialize (Buffer::Iterator start)
 
   m_forward = (bool)start.ReadU8 ();
   m_nHops = start.ReadU8 ();
-  uint8_t nIps = start.ReadU8 ();
+  m_nIps = start.ReadU8 ();
   m_seq = start.ReadU32 ();
   m_dest = start.ReadU32 ();
   m_origin = start.ReadU32 ();
 
-  if (m_ips.size ())
-    m_ips.clear ();
-  
-  for (uint32_t i = 0; i < (uint32_t)nIps; i++)
+  // the count comes off the wire, so check it in optimized builds too before filling m_ips
+  NS_ABORT_MSG_IF (m_nIps > RON_HEADER_MAX_HOPS, "RonHeader can't hold " << (uint32_t)m_nIps << " hops, only "
+                   << RON_HEADER_MAX_HOPS << "!");
+  for (uint8_t i = 0; i < m_nIps; i++)
     {
-      m_ips.push_back (start.ReadU32 ());
+      m_ips[i] = start.ReadU32 ();
     }
 
-  NS_ASSERT (nIps == m_ips.size ());
-
   // we return the number of bytes effectively read.
-  return RON_HEADER_SIZE(m_ips.size ());
+  return RON_HEADER_SIZE(m_nIps);
 }
 
 } //namespace ns3
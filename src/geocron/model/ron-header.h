@@ -8,13 +8,17 @@
 #include "ns3/ipv4-address.h"
 #include "ns3/address.h"
 #include <iostream>
-#include <vector>
 
 #include "ron-path.h"
 
 namespace ns3 {
 
+#define RON_HEADER_SIZE(n) (15 + (n) * 4)
+#define RON_HEADER_MAX_HOPS 8
+
 /* A Header for the Resilient Overlay Network (RON) client and server.
+   The path is kept inline, up to RON_HEADER_MAX_HOPS intermediate hops, so that
+   building, (de)serializing, and reversing headers never touches the heap.
  */
 class RonHeader : public SimpleRefCount<RonHeader, Header>
 {
@@ -22,8 +26,6 @@ public:
   explicit RonHeader ();
   //RonHeader (Ipv4Address destination);
   explicit RonHeader (Ipv4Address destination, Ipv4Address intermediate = Ipv4Address((uint32_t)0));
-  //RonHeader (const RonHeader& original);
-  RonHeader& operator=(const RonHeader& original);
 
   static TypeId GetTypeId (void);
   virtual TypeId GetInstanceTypeId (void) const;
@@ -49,15 +51,15 @@ public:
   virtual uint32_t Deserialize (Buffer::Iterator start);
   virtual uint32_t GetSerializedSize (void) const;
 
-private:
-  typedef std::vector<uint32_t> UnderlyingPathContainer;
-public:
-  typedef UnderlyingPathContainer::const_iterator PathIterator;
+  typedef const uint32_t * PathIterator;
 
   /** Returns the path represented in the RonHeader as a sequence of IP addresses. */
   PathIterator GetPathBegin () const;
   PathIterator GetPathEnd () const;
-  Ptr<RonPath> GetPath () const;
+  /** Returns the path of peers the header's addresses belong to, looking for the final destination
+      in the master RonPeerTable and then in destinations.  Paths with at most one intermediate hop
+      whose peers are all known come from the master table's catalog rather than being built. */
+  Ptr<RonPath> GetPath (Ptr<RonPeerTable> destinations = NULL) const;
   void SetPath (Ptr<RonPath> path);
 
 private:
@@ -67,11 +69,10 @@ private:
   uint32_t m_seq;
   uint32_t m_dest;
   uint32_t m_origin;
-  std::vector<uint32_t> m_ips;
+  uint8_t m_nIps;
+  uint32_t m_ips[RON_HEADER_MAX_HOPS];
 };
 
-#define RON_HEADER_SIZE(n) 15 + n*4
-
 } //namespace ns3
 
 #endif
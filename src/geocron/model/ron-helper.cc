@@ -145,6 +145,21 @@ RonClientHelper::Install (NodeContainer c) const
   return apps;
 }
 
+ApplicationContainer
+RonClientHelper::Install (NodeContainer c, Ptr<RonPeerTable> peers) const
+{
+  ApplicationContainer apps;
+  apps.Reserve (c.GetN ());
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<Application> app = InstallPriv (*i);
+      DynamicCast<RonClient> (app)->SetPeerTable (peers);
+      apps.Add (app);
+    }
+
+  return apps;
+}
+
 Ptr<Application>
 RonClientHelper::InstallPriv (Ptr<Node> node) const
 {
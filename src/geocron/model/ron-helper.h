@@ -28,6 +28,8 @@
 
 namespace ns3 {
 
+class RonPeerTable;
+
 /**
  * \brief Create a server application which waits for input udp packets
  *        and sends them back to the original sender.
@@ -198,6 +200,18 @@ public:
    */
   ApplicationContainer Install (NodeContainer c) const;
 
+  /**
+   * \param c the nodes
+   * \param peers the peer table to give each of the clients
+   *
+   * Create one RON client application on each of the input nodes, all
+   * sharing the same peer table.  Meant for installing the clients on a
+   * whole topology at once, so the container is sized up front.
+   *
+   * \returns the applications created, one application per input node.
+   */
+  ApplicationContainer Install (NodeContainer c, Ptr<RonPeerTable> peers) const;
+
   /**
    * \param peersBegin A forward iterator for the beginning of the Ipv4Addresses of the peers to be added.
    * \param peersBegin The end iterator over Ipv4Addresses of the peers to be added.
@@ -17,8 +17,11 @@
  */
 
 #include "ron-path-heuristic.h"
+#include "ron-header.h"
 //#include "boost/bind.hpp"
 #include <cmath>
+#include <algorithm>
+#include <functional>
 
 using namespace ns3;
 
@@ -27,7 +30,7 @@ NS_OBJECT_ENSURE_REGISTERED (RonPathHeuristic);
 
 RonPathHeuristic::RonPathHeuristic ()
 {
-  m_masterLikelihoods = NULL;
+  m_column = 0;
 }
 
 TypeId
@@ -44,6 +47,19 @@ RonPathHeuristic::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&RonPathHeuristic::m_updatedOnce),
                    MakeBooleanChecker ())
+    .AddAttribute ("MaxHops", "Most overlay peers a path may go through.  "
+                   "Paths with more than one are only built as those with fewer time out.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&RonPathHeuristic::m_maxHops),
+                   MakeUintegerChecker<uint32_t> (1, RON_HEADER_MAX_HOPS))
+    .AddAttribute ("BeamWidth", "Most paths with one more overlay peer to build each time a path times out.",
+                   UintegerValue (4),
+                   MakeUintegerAccessor (&RonPathHeuristic::m_beamWidth),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("PathBudget", "Most paths with more than one overlay peer to build to each destination.",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&RonPathHeuristic::m_pathBudget),
+                   MakeUintegerChecker<uint32_t> ())
     /*.AddAttribute ("SummaryName", "Short name that summarizes parameters, aggregations, etc. to be used when creating filenames",
                    StringValue ("base"),
                    MakeStringAccessor (&RonPathHeuristic::m_summaryName),
@@ -67,44 +83,20 @@ RonPathHeuristic::MakeTopLevel ()
   NS_ASSERT_MSG (m_topLevel == NULL or m_topLevel == this,
                  "You can't make an already-aggregated heuristic into a top-level one!");
   m_topLevel = this;
-  if (m_masterLikelihoods == NULL)
-    m_masterLikelihoods = new MasterPathLikelihoodTable ();
+  if (m_table == NULL)
+    {
+      m_table = Create<LikelihoodTable> ();
+      m_column = m_table->AddHeuristic (m_weight);
+    }
 }
 
 
 void
 RonPathHeuristic::AddPath (Ptr<RonPath> path)
 {
-  Ptr<PeerDestination> dest = path->GetDestination ();
-  // If we are not top-level and the top-level has not been notified of this path,
-  // we need to start at the top and work our way down, notifying along the way.
-  if ((m_topLevel != (RonPathHeuristic*)this) and
-      (m_masterLikelihoods->at (dest)[path] == NULL))
-    m_topLevel->AddPath (path);
-
-  // We need to add a new likelihood value to the Likelihood object in the master table,
-  // then add the reference to this value to our table.
-  else
-    {
-      Ptr<Likelihood> lh = (*m_masterLikelihoods)[dest][path], newLh;
-      if (lh == NULL)
-        {
-          //this should only happen if we are top-level
-          NS_ASSERT_MSG (m_topLevel == (RonPathHeuristic*)this,
-                         "NULL Likelihood object (initial Create<> needed), but not at top-level!");
-          newLh = Create<Likelihood> ();
-          (*m_masterLikelihoods)[dest][path] = newLh;
-        }
-      else
-        {
-          newLh = lh->AddLh (0.0);
-        }
-      m_likelihoods[dest][path] = newLh;
-      // Then recurse to the lower-level heuristics
-      for (AggregateHeuristics::iterator others = m_aggregateHeuristics.begin ();
-           others != m_aggregateHeuristics.end (); others++)
-        (*others)->AddPath (path);
-    }
+  // All heuristics in the group share the table, which gives the path a
+  // likelihood of 0 for each of them.
+  m_table->AddPath (path);
 }
 
 
@@ -113,8 +105,7 @@ RonPathHeuristic::EnsurePathRegistered (Ptr<RonPath> path)
 {
   NS_ASSERT_MSG (path->GetN () > 0, "got 0-length path in EnsurePathRegistered");
 
-  Ptr<PeerDestination> dest = path->GetDestination ();
-  if (m_likelihoods[dest].count (path) == 0)
+  if (!m_table->HasPath (path))
     AddPath (path);
 }
 
@@ -134,21 +125,28 @@ RonPathHeuristic::DoBuildPaths (Ptr<PeerDestination> destination)
 {
   // All aggregate heuristics should know about the peer table, so we only need
   // to check if any one heuristic has built paths once, i.e. if the table contains anything.
-  PathLikelihoodInnerTable * table = &(m_likelihoods[destination]);
-  if (table->size ())
+  if (m_table->GetNPaths (destination))
     return;
   
-  RonPeerEntry sourcePeer = *GetSourcePeer ();
+  // one-hop paths are the same for every client, so share them through the master's catalog
+  Ptr<RonPeerTable> master = RonPeerTable::GetMaster ();
+  Ptr<RonPeerEntry> sourcePeer = GetSourcePeer ();
   for (RonPeerTable::Iterator peerItr = m_peers->Begin ();
        peerItr != m_peers->End (); peerItr++)
     {
       //make sure not to have loops!
       //TODO: check all pieces of destination
-      if (*(*peerItr) == *(*destination->Begin ()) or *(*peerItr) == sourcePeer)
+      if (*(*peerItr) == *(*destination->Begin ()) or *(*peerItr) == *sourcePeer)
         continue;
-      Ptr<RonPath> path = Create<RonPath> ();
-      path->AddHop (Create<PeerDestination> (*peerItr));
-      path->AddHop (destination);
+      Ptr<RonPath> path;
+      if (destination->GetN () == 1)
+        path = master->GetOneHopPath (*peerItr, *destination->Begin ());
+      else
+        {
+          path = Create<RonPath> ();
+          path->AddHop (Create<PeerDestination> (*peerItr));
+          path->AddHop (destination);
+        }
       AddPath (path);
     }
   /*NS_ASSERT_MSG (m_likelihoods[destination].size () == m_peers->GetN () - 2,
@@ -163,6 +161,48 @@ RonPathHeuristic::GetLikelihood (Ptr<RonPath> path)
 }
 
 
+double
+RonPathHeuristic::GetMultiHopLikelihood (Ptr<RonPath> path)
+{
+  Ptr<RonPeerTable> master = RonPeerTable::GetMaster ();
+  Ptr<RonPeerEntry> destination = *path->GetDestination ()->Begin ();
+  double lh = 1.0;
+  for (RonPath::Iterator hop = path->Begin (); hop + 1 != path->End (); hop++)
+    lh *= GetLikelihood (master->GetOneHopPath (*(*hop)->Begin (), destination));
+  return lh;
+}
+
+
+bool
+RonPathHeuristic::GetLikelihoods (Ptr<RonPeerEntry> destination, const std::vector<Ptr<RonPath> > & paths,
+                                  const PeerLocations & peers, std::vector<double> & likelihoods)
+{
+  return false;
+}
+
+
+void
+RonPathHeuristic::GetDistances (const PeerLocations & peers, Vector point, std::vector<double> & distances)
+{
+  uint32_t n = peers.x.size ();
+  distances.resize (n);
+  if (!n)
+    return;
+
+  const double * x = &peers.x[0];
+  const double * y = &peers.y[0];
+  const double * z = &peers.z[0];
+  double * out = &distances[0];
+  for (uint32_t i = 0; i < n; i++)
+    {
+      double dx = x[i] - point.x;
+      double dy = y[i] - point.y;
+      double dz = z[i] - point.z;
+      out[i] = std::sqrt (dx * dx + dy * dy + dz * dz);
+    }
+}
+
+
 void
 RonPathHeuristic::UpdateLikelihoods (const Ptr<PeerDestination> destination)
 {
@@ -178,10 +218,31 @@ void
 RonPathHeuristic::DoUpdateLikelihoods (const Ptr<PeerDestination> destination)
 {
   if (!m_updatedOnce)
+    m_updatedDestinations.clear ();
+
+  // each destination's paths need likelihoods the first time it's asked for
+  if (m_updatedDestinations.insert (destination).second)
     {
-      for (PathLikelihoodInnerTable::iterator path = m_likelihoods.at (destination).begin ();
-           path != m_likelihoods[destination].end (); path++)
-        SetLikelihood (path->first, GetLikelihood (path->first));
+      const std::vector<Ptr<RonPath> > & paths = m_table->GetPaths (destination);
+      std::vector<double> likelihoods;
+      if (!paths.empty () and
+          GetLikelihoods (*destination->Begin (), paths, m_table->GetPeerLocations (destination), likelihoods))
+        {
+          NS_ASSERT_MSG (likelihoods.size () == paths.size (), "batch computed the wrong number of likelihoods!");
+          m_table->SetWeight (m_column, m_weight);
+          m_table->SetLhs (destination, m_column, likelihoods);
+        }
+      else
+        for (uint32_t i = 0; i < paths.size (); i++)
+          {
+            Ptr<RonPath> path = paths[i];
+            SetLikelihood (path, GetLikelihood (path));
+          }
+
+      // those likelihoods only account for the first peer, and timeouts of expanded paths must stick
+      for (uint32_t i = 0; i < paths.size (); i++)
+        if (paths[i]->GetN () > 2)
+          SetLikelihood (paths[i], m_topLevel->PathAttempted (paths[i]) ? 0.0 : GetMultiHopLikelihood (paths[i]));
       m_updatedOnce = true;
     }
 }
@@ -192,43 +253,129 @@ RonPathHeuristic::GetBestPath (Ptr<PeerDestination> destination)
 {
   NS_ASSERT_MSG (m_source, "You must set the source peer before using the heuristic!");
   NS_ASSERT_MSG (destination, "You must specify a valid server to use the heuristic!");
-  NS_ASSERT_MSG (m_masterLikelihoods, "Master likelihood table missing!  " \
+  NS_ASSERT_MSG (m_table, "Likelihood table missing!  " \
                  "Make sure you aggregate heuristics to the top-level one first (before lower-levels) " \
                  "so that the shared data structures are properly organized.");
 
-  //TODO: multiple servers
+  Ptr<RonPath> bestPath = FindBestPath (destination);
+
+  NS_ASSERT_MSG (m_table->GetNPaths (destination) > 0, "empty likelihood table!");
+
+  if (bestPath == NULL)
+    throw NoValidPeerException();
 
+  m_pathsAttempted.insert (bestPath);
+  return (bestPath);
+}
+
+
+Ptr<RonPath>
+RonPathHeuristic::FindBestPath (Ptr<PeerDestination> destination)
+{
   // ensure paths built
   BuildPaths (destination);
 
-  NS_ASSERT_MSG ((*m_masterLikelihoods)[destination].size () > 0, "empty master likelihood table!");
-
   //find the path with highest likelihood
   //TODO: cache up to MaxAttempts of them
-  //TODO: check for valid size
-  if ((*m_masterLikelihoods)[destination].size () == 0)
-    throw NoValidPeerException();
+  if (m_table->GetNPaths (destination) == 0)
+    return NULL;
 
   UpdateLikelihoods (destination);
 
-  MasterPathLikelihoodInnerTable::iterator probs = (*m_masterLikelihoods)[destination].begin ();
-  Ptr<RonPath> bestPath = probs->first;
-  double bestLikelihood = probs->second->GetLh ();
-  for (; probs != (*m_masterLikelihoods)[destination].end (); probs++)
+  Ptr<RonPath> bestPath = m_table->GetBestPath (destination);
+  if (m_table->GetAggregateLh (bestPath) <= 0.0)
+    return NULL;
+  return bestPath;
+}
+
+
+Ptr<RonPath>
+RonPathHeuristic::GetBestAnycastPath (Ptr<PeerDestination> destinations)
+{
+  NS_ASSERT_MSG (m_source, "You must set the source peer before using the heuristic!");
+  NS_ASSERT_MSG (destinations and destinations->GetN (), "You must specify valid servers to use the heuristic!");
+  NS_ASSERT_MSG (m_table, "Likelihood table missing!  " \
+                 "Make sure you aggregate heuristics to the top-level one first (before lower-levels) " \
+                 "so that the shared data structures are properly organized.");
+
+  // reaching any one of them will do, so take the single most likely path
+  Ptr<RonPeerTable> master = RonPeerTable::GetMaster ();
+  Ptr<RonPath> bestPath;
+  double bestLh = 0.0;
+  for (PeerDestination::Iterator peer = destinations->Begin (); peer != destinations->End (); peer++)
     {
-      double nextLh = probs->second->GetLh ();
-      if (nextLh > bestLikelihood)
+      Ptr<RonPath> path = FindBestPath (master->GetDestination (*peer));
+      if (path != NULL and m_table->GetAggregateLh (path) > bestLh)
         {
-          bestPath = probs->first;
-          bestLikelihood = nextLh;
+          bestPath = path;
+          bestLh = m_table->GetAggregateLh (path);
         }
     }
-  
-  if (bestLikelihood <= 0.0)
+
+  if (bestPath == NULL)
     throw NoValidPeerException();
 
   m_pathsAttempted.insert (bestPath);
-  return (bestPath);
+  return bestPath;
+}
+
+
+Ptr<RonPath>
+RonPathHeuristic::GetBestMulticastPath (Ptr<PeerDestination> destinations)
+{
+  NS_ASSERT_MSG (m_source, "You must set the source peer before using the heuristic!");
+  NS_ASSERT_MSG (destinations and destinations->GetN (), "You must specify valid servers to use the heuristic!");
+  NS_ASSERT_MSG (m_table, "Likelihood table missing!  " \
+                 "Make sure you aggregate heuristics to the top-level one first (before lower-levels) " \
+                 "so that the shared data structures are properly organized.");
+
+  // the peer's path to each destination is scored like a unicast one
+  Ptr<RonPeerTable> master = RonPeerTable::GetMaster ();
+  std::vector<Ptr<PeerDestination> > members;
+  for (PeerDestination::Iterator peer = destinations->Begin (); peer != destinations->End (); peer++)
+    {
+      members.push_back (master->GetDestination (*peer));
+      BuildPaths (members.back ());
+      UpdateLikelihoods (members.back ());
+    }
+
+  // a peer must have a path to every destination, so the first one's paths are the candidates
+  Ptr<RonPath> bestPath;
+  double bestLh = 0.0;
+  const std::vector<Ptr<RonPath> > & candidates = m_table->GetPaths (members.front ());
+  for (uint32_t i = 0; i < candidates.size (); i++)
+    {
+      if (candidates[i]->GetN () != 2)
+        continue;
+      Ptr<RonPeerEntry> peer = *(*candidates[i]->Begin ())->Begin ();
+      if (destinations->HasPeer (peer))
+        continue;
+
+      double lh = m_table->GetAggregateLh (candidates[i]);
+      for (uint32_t m = 1; m < members.size () and lh > 0.0; m++)
+        {
+          Ptr<RonPath> leg = master->GetOneHopPath (peer, *members[m]->Begin ());
+          lh *= m_table->HasPath (leg) ? m_table->GetAggregateLh (leg) : 0.0;
+        }
+      if (lh <= bestLh)
+        continue;
+
+      // timeouts only tell us the multicast path as a whole failed
+      Ptr<RonPath> path = Create<RonPath> ();
+      path->AddHop (master->GetDestination (peer));
+      path->AddHop (destinations);
+      if (m_table->HasPath (path) and m_table->GetAggregateLh (path) <= 0.0)
+        continue;
+
+      bestPath = path;
+      bestLh = lh;
+    }
+
+  if (bestPath == NULL)
+    throw NoValidPeerException();
+
+  m_pathsAttempted.insert (bestPath);
+  return bestPath;
 }
 
 
@@ -269,10 +416,103 @@ RonPathHeuristic::NotifyTimeout (Ptr<RonPath> path, Time time)
       (*heuristic)->NotifyTimeout (path, time);
     }
   
-  NS_ASSERT_MSG (m_masterLikelihoods->at (path->GetDestination ())[path]->GetLh () == 0.0,
-                 "m_masterLikelihoods Likelihood != 0 after timeout notification!");
-  NS_ASSERT_MSG (m_likelihoods.at (path->GetDestination ())[path]->GetLh () == 0.0,
-  "m_masterLikelihoods Likelihood != 0 after timeout notification!");
+  NS_ASSERT_MSG (m_table->GetAggregateLh (path) == 0.0,
+                 "aggregate likelihood != 0 after timeout notification!");
+  NS_ASSERT_MSG (m_table->GetLh (path, m_column) == 0.0,
+                 "likelihood != 0 after timeout notification!");
+
+  if (m_topLevel == this)
+    ExpandPath (path);
+}
+
+
+void
+RonPathHeuristic::ExpandPath (Ptr<RonPath> path)
+{
+  Ptr<PeerDestination> destination = path->GetDestination ();
+  if (path->GetN () > m_maxHops or destination->GetN () != 1)
+    return;
+  uint32_t & nExpanded = m_expandedPaths[destination];
+  if (nExpanded >= m_pathBudget)
+    return;
+
+  // the one-hop paths to the destination are the ones through every candidate peer
+  const std::vector<Ptr<RonPath> > & paths = m_table->GetPaths (destination);
+  std::vector<double> scores (paths.size (), 0.0);
+  ScoreExpansions (path, scores);
+
+  std::vector<std::pair<double, uint32_t> > candidates;
+  for (uint32_t i = 0; i < paths.size (); i++)
+    {
+      if (paths[i]->GetN () != 2 or scores[i] <= 0.0)
+        continue;
+      Ptr<RonPeerEntry> peer = *(*paths[i]->Begin ())->Begin ();
+      bool onPath = false;
+      for (RonPath::Iterator hop = path->Begin (); hop != path->End () and !onPath; hop++)
+        onPath = (*hop)->HasPeer (peer);
+      if (!onPath)
+        candidates.push_back (std::make_pair (scores[i], i));
+    }
+
+  uint32_t nChildren = std::min (std::min (m_beamWidth, m_pathBudget - nExpanded), (uint32_t)candidates.size ());
+  std::partial_sort (candidates.begin (), candidates.begin () + nChildren, candidates.end (),
+                     std::greater<std::pair<double, uint32_t> > ());
+
+  // adding paths may reallocate those to the destination, so pick the peers first
+  std::vector<Ptr<PeerDestination> > relays;
+  for (uint32_t c = 0; c < nChildren; c++)
+    relays.push_back (*paths[candidates[c].second]->Begin ());
+
+  for (uint32_t c = 0; c < relays.size (); c++)
+    {
+      Ptr<RonPath> child = Create<RonPath> ();
+      for (RonPath::Iterator hop = path->Begin (); hop + 1 != path->End (); hop++)
+        child->AddHop (*hop);
+      child->AddHop (relays[c]);
+      child->AddHop (destination);
+      if (m_table->HasPath (child))
+        continue;
+
+      AddPath (child);
+      SetMultiHopLikelihoods (child);
+      nExpanded++;
+    }
+}
+
+
+void
+RonPathHeuristic::ScoreExpansions (Ptr<RonPath> path, std::vector<double> & scores)
+{
+  Ptr<PeerDestination> destination = path->GetDestination ();
+  const std::vector<Ptr<RonPath> > & paths = m_table->GetPaths (destination);
+  double pathLh = GetMultiHopLikelihood (path);
+
+  if (pathLh != 0.0)
+    {
+      std::vector<double> relayLhs;
+      if (!GetLikelihoods (*destination->Begin (), paths, m_table->GetPeerLocations (destination), relayLhs))
+        {
+          relayLhs.resize (paths.size ());
+          for (uint32_t i = 0; i < paths.size (); i++)
+            relayLhs[i] = paths[i]->GetN () == 2 ? GetLikelihood (paths[i]) : 0.0;
+        }
+      for (uint32_t i = 0; i < paths.size (); i++)
+        scores[i] += m_weight * pathLh * relayLhs[i];
+    }
+
+  for (AggregateHeuristics::iterator others = m_aggregateHeuristics.begin ();
+       others != m_aggregateHeuristics.end (); others++)
+    (*others)->ScoreExpansions (path, scores);
+}
+
+
+void
+RonPathHeuristic::SetMultiHopLikelihoods (Ptr<RonPath> path)
+{
+  SetLikelihood (path, GetMultiHopLikelihood (path));
+  for (AggregateHeuristics::iterator others = m_aggregateHeuristics.begin ();
+       others != m_aggregateHeuristics.end (); others++)
+    (*others)->SetMultiHopLikelihoods (path);
 }
 
 
@@ -296,23 +536,10 @@ RonPathHeuristic::AddHeuristic (Ptr<RonPathHeuristic> other)
   NS_ASSERT_MSG (this != other, "What are you doing? You can't aggregate a heuristic to itself...");
 
   other->m_topLevel = m_topLevel;
-  other->m_masterLikelihoods = m_topLevel->m_masterLikelihoods;
+  other->m_table = m_topLevel->m_table;
+  //new heuristic gets a 0 likelihood for current paths
+  other->m_column = m_table->AddHeuristic (other->m_weight);
   m_aggregateHeuristics.push_back (other);
-
-  //give new heuristic likelihoods for current paths
-  for (MasterPathLikelihoodTable::iterator tables = m_masterLikelihoods->begin ();
-       tables != m_masterLikelihoods->end (); tables++)
-    {
-      PathLikelihoodInnerTable * newTable = &(other->m_likelihoods[tables->first]);
-      for (MasterPathLikelihoodInnerTable::iterator pathLh = tables->second.begin ();
-           pathLh != tables->second.end (); pathLh++)
-        {
-          Ptr<RonPath> path = pathLh->first;
-          Ptr<Likelihood> lh = (pathLh->second);
-          Ptr<Likelihood> newLh = lh->AddLh ();
-          (*newTable)[path] = newLh;
-        }
-    }
 }
 
 
@@ -321,8 +548,10 @@ RonPathHeuristic::Clear ()
 {
   m_topLevel = NULL;
   m_aggregateHeuristics.clear ();
-  m_likelihoods.clear ();
-  m_masterLikelihoods->clear ();
+  m_updatedDestinations.clear ();
+  m_expandedPaths.clear ();
+  if (m_table)
+    m_table->Clear ();
 }
 
 void
@@ -346,14 +575,12 @@ RonPathHeuristic::SetLikelihood (Ptr<RonPath> path, double lh)
 
   EnsurePathRegistered (path);
 
-  Ptr<PeerDestination> dest = path->GetDestination ();
   //NS_ASSERT (0.0 <= lh and lh <= 1.0);
   NS_LOG_LOGIC ("Path " << path << " has LH " << lh);
   //m_peers.SetLikelihood (peer, 
-  PathLikelihoodInnerTable * inner = &(m_likelihoods[dest]);
-  NS_ASSERT_MSG (inner->size () > 0, "setting likelhiood but inner table is empty!");
-  double realLh = lh*m_weight;
-  (*inner)[path]->SetLh (realLh);
+  // the table weights the likelihood for us when aggregating
+  m_table->SetWeight (m_column, m_weight);
+  m_table->SetLh (path, m_column, lh);
 }
 
 
@@ -388,6 +615,19 @@ RonPathHeuristic::SameRegion (Ptr<RonPeerEntry> peer1, Ptr<RonPeerEntry> peer2)
 }
 
 
+void
+RonPathHeuristic::ExcludeSameRegion (Ptr<RonPeerEntry> destination, const std::vector<Ptr<RonPath> > & paths,
+                                     std::vector<double> & likelihoods)
+{
+  for (uint32_t i = 0; i < paths.size (); i++)
+    {
+      Ptr<RonPeerEntry> peer = *(*paths[i]->Begin ())->Begin ();
+      if (SameRegion (m_source, peer) or SameRegion (destination, peer))
+        likelihoods[i] = 0.0;
+    }
+}
+
+
 bool
 RonPathHeuristic::PathAttempted (Ptr<RonPath> path, bool recordPath)
 {
@@ -403,49 +643,207 @@ RonPathHeuristic::PathAttempted (Ptr<RonPath> path, bool recordPath)
 }
 
 
-////////////////////////////// Likelihood object //////////////////////////////
-RonPathHeuristic::Likelihood::Likelihood ()
+////////////////////////////// LikelihoodTable //////////////////////////////
+RonPathHeuristic::LikelihoodTable::RowCompare::RowCompare (const std::vector<double> * aggregate)
+  : m_aggregate (aggregate)
 {
-  m_likelihood = 0.0;
 }
 
-RonPathHeuristic::Likelihood::Likelihood (double lh)
+bool
+RonPathHeuristic::LikelihoodTable::RowCompare::operator() (uint32_t row1, uint32_t row2) const
 {
-  m_likelihood = lh;
+  return (*m_aggregate)[row1] < (*m_aggregate)[row2];
 }
 
-Ptr<RonPathHeuristic::Likelihood>
-RonPathHeuristic::Likelihood::AddLh (double lh)
+RonPathHeuristic::LikelihoodTable::DestinationTable::DestinationTable ()
+  : m_heap (RowCompare (&m_aggregate))
 {
-  Ptr<RonPathHeuristic::Likelihood> newLh = Create<RonPathHeuristic::Likelihood> ();
-  newLh->SetLh (lh);
-  m_otherLikelihoods.push_back (newLh);
-  return newLh;
 }
 
-double
-RonPathHeuristic::Likelihood::GetLh ()
+uint32_t
+RonPathHeuristic::LikelihoodTable::AddHeuristic (double weight)
+{
+  uint32_t oldStride = m_weights.size ();
+  m_weights.push_back (weight);
+
+  // widen every row by one column
+  for (DestinationTables::iterator itr = m_destinations.begin ();
+       itr != m_destinations.end (); itr++)
+    {
+      DestinationTable * table = PeekPointer (itr->second);
+      std::vector<double> likelihoods (table->m_paths.size () * m_weights.size (), 0.0);
+      for (uint32_t row = 0; row < table->m_paths.size (); row++)
+        std::copy (table->m_likelihoods.begin () + row * oldStride,
+                   table->m_likelihoods.begin () + (row + 1) * oldStride,
+                   likelihoods.begin () + row * m_weights.size ());
+      table->m_likelihoods.swap (likelihoods);
+    }
+
+  return oldStride;
+}
+
+uint32_t
+RonPathHeuristic::LikelihoodTable::GetNHeuristics () const
+{
+  return m_weights.size ();
+}
+
+void
+RonPathHeuristic::LikelihoodTable::SetWeight (uint32_t heuristic, double weight)
 {
-  double total = m_likelihood;
-  for (UnderlyingContainer::iterator itr = m_otherLikelihoods.begin ();
-       itr != m_otherLikelihoods.end (); itr++)
-    total += (*itr)->GetLh ();
+  NS_ASSERT_MSG (heuristic < m_weights.size (), "no such heuristic in the likelihood table!");
+  if (m_weights[heuristic] == weight)
+    return;
 
-  return total;
+  m_weights[heuristic] = weight;
+  for (DestinationTables::iterator itr = m_destinations.begin ();
+       itr != m_destinations.end (); itr++)
+    for (uint32_t row = 0; row < itr->second->m_paths.size (); row++)
+      UpdateAggregate (PeekPointer (itr->second), row);
 }
 
 void
-RonPathHeuristic::Likelihood::SetLh (double newLh)
+RonPathHeuristic::LikelihoodTable::AddPath (Ptr<RonPath> path)
+{
+  NS_ASSERT_MSG (path->GetN () > 0, "got 0-length path in AddPath");
+
+  DestinationTable * table = GetTable (path->GetDestination ());
+  if (table->m_rows.count (path))
+    return;
+
+  uint32_t row = table->m_paths.size ();
+  table->m_rows[path] = row;
+  table->m_paths.push_back (path);
+  Vector location = (*(*path->Begin ())->Begin ())->location;
+  table->m_locations.x.push_back (location.x);
+  table->m_locations.y.push_back (location.y);
+  table->m_locations.z.push_back (location.z);
+  table->m_likelihoods.resize (table->m_likelihoods.size () + m_weights.size (), 0.0);
+  table->m_aggregate.push_back (0.0);
+  table->m_handles.push_back (table->m_heap.push (row));
+}
+
+bool
+RonPathHeuristic::LikelihoodTable::HasPath (Ptr<RonPath> path) const
+{
+  uint32_t row;
+  return Find (path, row) != NULL;
+}
+
+const std::vector<Ptr<RonPath> > &
+RonPathHeuristic::LikelihoodTable::GetPaths (Ptr<PeerDestination> destination)
+{
+  return GetTable (destination)->m_paths;
+}
+
+const RonPathHeuristic::PeerLocations &
+RonPathHeuristic::LikelihoodTable::GetPeerLocations (Ptr<PeerDestination> destination)
 {
-  m_likelihood = newLh;
+  return GetTable (destination)->m_locations;
 }
 
 uint32_t
-RonPathHeuristic::Likelihood::GetN ()
+RonPathHeuristic::LikelihoodTable::GetNPaths (Ptr<PeerDestination> destination) const
+{
+  DestinationTables::const_iterator itr = m_destinations.find (destination);
+  if (itr == m_destinations.end ())
+    return 0;
+  return itr->second->m_paths.size ();
+}
+
+void
+RonPathHeuristic::LikelihoodTable::SetLh (Ptr<RonPath> path, uint32_t heuristic, double lh)
+{
+  NS_ASSERT_MSG (heuristic < m_weights.size (), "no such heuristic in the likelihood table!");
+  uint32_t row;
+  DestinationTable * table = Find (path, row);
+  NS_ASSERT_MSG (table, "setting likelihood of a path not in the table!");
+
+  table->m_likelihoods[row * m_weights.size () + heuristic] = lh;
+  UpdateAggregate (table, row);
+}
+
+void
+RonPathHeuristic::LikelihoodTable::SetLhs (Ptr<PeerDestination> destination, uint32_t heuristic,
+                                           const std::vector<double> & lhs)
+{
+  NS_ASSERT_MSG (heuristic < m_weights.size (), "no such heuristic in the likelihood table!");
+  DestinationTable * table = GetTable (destination);
+  NS_ASSERT_MSG (lhs.size () == table->m_paths.size (), "need exactly one likelihood per path!");
+
+  uint32_t stride = m_weights.size ();
+  for (uint32_t row = 0; row < lhs.size (); row++)
+    table->m_likelihoods[row * stride + heuristic] = lhs[row];
+  for (uint32_t row = 0; row < lhs.size (); row++)
+    UpdateAggregate (table, row);
+}
+
+double
+RonPathHeuristic::LikelihoodTable::GetLh (Ptr<RonPath> path, uint32_t heuristic) const
+{
+  NS_ASSERT_MSG (heuristic < m_weights.size (), "no such heuristic in the likelihood table!");
+  uint32_t row;
+  DestinationTable * table = Find (path, row);
+  NS_ASSERT_MSG (table, "getting likelihood of a path not in the table!");
+
+  return table->m_likelihoods[row * m_weights.size () + heuristic] * m_weights[heuristic];
+}
+
+double
+RonPathHeuristic::LikelihoodTable::GetAggregateLh (Ptr<RonPath> path) const
+{
+  uint32_t row;
+  DestinationTable * table = Find (path, row);
+  NS_ASSERT_MSG (table, "getting likelihood of a path not in the table!");
+
+  return table->m_aggregate[row];
+}
+
+Ptr<RonPath>
+RonPathHeuristic::LikelihoodTable::GetBestPath (Ptr<PeerDestination> destination) const
+{
+  DestinationTables::const_iterator itr = m_destinations.find (destination);
+  if (itr == m_destinations.end () or itr->second->m_heap.empty ())
+    return NULL;
+  return itr->second->m_paths[itr->second->m_heap.top ()];
+}
+
+void
+RonPathHeuristic::LikelihoodTable::Clear ()
+{
+  m_destinations.clear ();
+}
+
+void
+RonPathHeuristic::LikelihoodTable::UpdateAggregate (DestinationTable * table, uint32_t row)
+{
+  const double * lhs = &table->m_likelihoods[row * m_weights.size ()];
+  double total = 0.0;
+  for (uint32_t h = 0; h < m_weights.size (); h++)
+    total += m_weights[h] * lhs[h];
+
+  table->m_aggregate[row] = total;
+  table->m_heap.update (table->m_handles[row]);
+}
+
+RonPathHeuristic::LikelihoodTable::DestinationTable *
+RonPathHeuristic::LikelihoodTable::GetTable (Ptr<PeerDestination> destination)
+{
+  Ptr<DestinationTable> & table = m_destinations[destination];
+  if (table == NULL)
+    table = Create<DestinationTable> ();
+  return PeekPointer (table);
+}
+
+RonPathHeuristic::LikelihoodTable::DestinationTable *
+RonPathHeuristic::LikelihoodTable::Find (Ptr<RonPath> path, uint32_t & row) const
 {
-  uint32_t total = 1;
-  for (UnderlyingContainer::iterator itr = m_otherLikelihoods.begin ();
-       itr != m_otherLikelihoods.end (); itr++)
-    total += (*itr)->GetN ();
-  return total;
+  DestinationTables::const_iterator itr = m_destinations.find (path->GetDestination ());
+  if (itr == m_destinations.end ())
+    return NULL;
+  RowIndex::const_iterator rowItr = itr->second->m_rows.find (path);
+  if (rowItr == itr->second->m_rows.end ())
+    return NULL;
+  row = rowItr->second;
+  return PeekPointer (itr->second);
 }
@@ -32,6 +32,7 @@
 #include <boost/unordered_map.hpp>
 #include <boost/unordered_set.hpp>
 #include <boost/functional/hash.hpp>
+#include <boost/heap/d_ary_heap.hpp>
 //#include "boost/function.hpp"
 
 #include <set>
@@ -53,11 +54,15 @@ public:
   /** Return the best path, according to the aggregate heuristics, to the destination. */
   Ptr<RonPath> GetBestPath (Ptr<PeerDestination> destination);
 
-  /** Return the best multicast path, according to the aggregate heuristics, to the destinations. */
-  //TODO: Ptr<RonPath> GetBestMulticastPath (itr<Ptr<RonPeerEntry???> destinations);
+  /** Return the best multicast path, according to the aggregate heuristics, to all the destinations' peers:
+      a one-hop path through the peer that then sends a copy to each of them.
+      The peer whose one-hop paths to the destinations have the highest product of aggregate
+      likelihoods is chosen, skipping those whose multicast path already timed out. */
+  Ptr<RonPath> GetBestMulticastPath (Ptr<PeerDestination> destinations);
 
-  /** Return the best anycast path, according to the aggregate heuristics, to the destination. */
-  //TODO: Ptr<RonPath> GetBestAnycastPath (itr<Ptr<RonPeerEntry???> destinations);
+  /** Return the best anycast path, according to the aggregate heuristics, to any one of the destinations' peers:
+      the most likely of the best paths to each of them. */
+  Ptr<RonPath> GetBestAnycastPath (Ptr<PeerDestination> destinations);
 
   /** Inform this heuristic that it will be the top-level for an aggregate heuristic group. */
   void MakeTopLevel ();
@@ -111,13 +116,53 @@ public:
    Can be chained together for multiple-hop overlays. */
   virtual double GetLikelihood (Ptr<RonPath> path);
 
+  /** Get the likelihood of a path with any number of overlay peers: the product of the
+      likelihoods of the one-hop paths through each of them to the destination. */
+  double GetMultiHopLikelihood (Ptr<RonPath> path);
+
+  /** Locations of the first peer on each path to a destination, kept as one array
+      per coordinate so batch likelihood computations can loop over them with SIMD. */
+  struct PeerLocations
+  {
+    std::vector<double> x;
+    std::vector<double> y;
+    std::vector<double> z;
+  };
+
+  /** Compute the likelihoods GetLikelihood would give each of the paths to destination
+      in one pass over their first peers' locations, which are in the same order.
+      Geometric heuristics override this for speed; by default it returns false
+      so that GetLikelihood is called for each path instead. */
+  virtual bool GetLikelihoods (Ptr<RonPeerEntry> destination, const std::vector<Ptr<RonPath> > & paths,
+                               const PeerLocations & peers, std::vector<double> & likelihoods);
+
+  /** Set distances[i] to the distance from point to the i-th peer, as CalculateDistance would. */
+  static void GetDistances (const PeerLocations & peers, Vector point, std::vector<double> & distances);
+
   /** Adds the given path to the master likelihood table of the top-level heuristic,
       updates all of the other likelhood tables. */
   void AddPath (Ptr<RonPath> path);
 
+  /** Builds and updates the paths to the destination, returning the one with the highest
+      aggregate likelihood, or NULL if there are none or none has a positive likelihood. */
+  Ptr<RonPath> FindBestPath (Ptr<PeerDestination> destination);
+
   /** Runs DoBuildPaths on all heuristics. */
   void BuildPaths (Ptr<PeerDestination> destination);
 
+  /** Once a path times out, add up to BeamWidth paths that go through one more peer before
+      the destination, choosing the peers whose paths have the highest aggregate likelihood.
+      Paths never get more than MaxHops overlay peers, nor a destination more than PathBudget
+      of these paths, so multi-hop paths are only built as the one-hop ones fail. */
+  void ExpandPath (Ptr<RonPath> path);
+
+  /** Add this heuristic's weighted likelihood for each expansion of path through the first peer
+      of the i-th path to its destination to scores[i], and have the aggregate heuristics do the same. */
+  void ScoreExpansions (Ptr<RonPath> path, std::vector<double> & scores);
+
+  /** Set each heuristic's likelihood of the multi-hop path. */
+  void SetMultiHopLikelihoods (Ptr<RonPath> path);
+
   /** Generate enough paths for the heuristics to use.
       By default, it will generate all possible one-hop paths to the destination the first
       time it sees that destination.  It will NOT generate duplicates.
@@ -144,6 +189,9 @@ public:
   void UpdateLikelihoods (Ptr<PeerDestination> destination);
 
   bool SameRegion (Ptr<RonPeerEntry> peer1, Ptr<RonPeerEntry> peer2);
+  /** Zero the likelihoods of the paths whose first peer is in the source's or destination's region. */
+  void ExcludeSameRegion (Ptr<RonPeerEntry> destination, const std::vector<Ptr<RonPath> > & paths,
+                          std::vector<double> & likelihoods);
 
   /** Returns true if the given path has been attempted, false otherwise.
       Specifying the recordPath argument will add the given path to the set of
@@ -151,8 +199,12 @@ public:
   bool PathAttempted (Ptr<RonPath> path, bool recordPath=false);
 
   /** May only need to assign likelihoods once.
-      Set this to true to avoid clearing LHs after each newly chosen peer. */
+      Set this to true to avoid clearing LHs after each newly chosen peer.
+      Setting it back to false has them assigned again for every destination. */
   bool m_updatedOnce;
+  uint32_t m_maxHops;
+  uint32_t m_beamWidth;
+  uint32_t m_pathBudget;
   Ptr<RonPeerTable> m_peers;
   UniformVariable random; //for random decisions
   Ptr<RonPeerEntry> m_source;
@@ -160,24 +212,6 @@ public:
   std::string m_shortName;
   double m_weight;
 
-  /** This  helps us aggregate the likelihoods together from each of the
-      aggregate heuristics. */
-  class Likelihood : public SimpleRefCount<Likelihood>
-  {
-  private:
-    double m_likelihood;
-    typedef std::list<Ptr<Likelihood> > UnderlyingContainer;
-    UnderlyingContainer m_otherLikelihoods;
-
-  public:
-    Likelihood ();
-    Likelihood (double lh);
-    Ptr<Likelihood> AddLh (double lh = 0.0);
-    double GetLh ();
-    void SetLh (double newLh);
-    uint32_t GetN ();
-  };
-
   typedef std::list<Ptr<RonPathHeuristic> > AggregateHeuristics;
   AggregateHeuristics m_aggregateHeuristics;
 
@@ -187,7 +221,8 @@ public:
   {
     inline bool operator() (const Ptr<RonPath> path1, const Ptr<RonPath> path2) const
     {
-      return *path1 == *path2;
+      //paths from the RonPeerTable's catalog are shared, so usually the pointers match
+      return path1 == path2 or *path1 == *path2;
     }
   };
 
@@ -195,17 +230,7 @@ public:
   {
     inline size_t operator()(const Ptr<PeerDestination> hop) const
     {
-      //TODO: combine all peers on a destination and whatever else makes it unique....
-      NS_ASSERT_MSG (hop->GetN (), "can't hash an empty destination!");
-      boost::hash<uint32_t> hasher;
-      Ptr<RonPeerEntry> firstPeer = (*hop->Begin ());
-      //uint32_t uniqueValue = firstPeer->id;
-      uint32_t uniqueValue = firstPeer->address.Get ();
-
-      //TODO: because we currently don't store the full peer inside headers, we don't always have the id
-      //and so we're using the address for now instead.... id would be more robust for multiple interfaces
-      //but we currently don't have that feature so no worries... for now
-      return hasher (uniqueValue);
+      return hop->GetHash ();
     }
   };
 
@@ -214,14 +239,7 @@ public:
     inline size_t operator()(const Ptr<RonPath> path) const
     {
       NS_ASSERT_MSG (path->GetN (), "can't hash an empty path!");
-      PeerDestinationHasher hasher;
-
-      std::size_t hashValue = 0;
-      for (RonPath::Iterator itr = path->Begin ();
-           itr != path->End (); itr++)
-        boost::hash_combine (hashValue, hasher (*itr));
-
-      return hashValue;
+      return path->GetHash ();
     }
   };
 
@@ -230,10 +248,6 @@ public:
   //typedef std::set<Ptr<RonPath>> PathsAttempted;
   PathsAttempted m_pathsAttempted;
 
-  typedef Ptr<RonPath> PathLikelihoodInnerTableKey;
-  typedef PathTestEqual PathLikelihoodInnerTableTestEqual;
-  typedef PathHasher PathLikelihoodInnerTableHasher;
-
   //outer table
   
   typedef Ptr<PeerDestination> PathLikelihoodTableKey;
@@ -242,7 +256,7 @@ public:
   {
     bool operator() (const PathLikelihoodTableKey key1, const PathLikelihoodTableKey key2) const
     {
-      return (*key1->Begin ())->id == (*key2->Begin ())->id;
+      return key1 == key2 or *key1 == *key2;
     }
   };
 
@@ -251,23 +265,90 @@ public:
 
   //table definitions
 
-  typedef boost::unordered_map<PathLikelihoodInnerTableKey, Ptr<Likelihood>,
-                               PathLikelihoodInnerTableHasher, PathLikelihoodInnerTableTestEqual> PathLikelihoodInnerTable;
-
-  //typedef std::map<RonPath, double *> PathLikelihoodInnerTable;
-  typedef boost::unordered_map<PathLikelihoodTableKey, PathLikelihoodInnerTable,
-                               PathLikelihoodTableHasher, PathLikelihoodTableTestEqual> PathLikelihoodTable;
-  //typedef std::map<Ptr<PeerDestination>, PathLikelihoodInnerTable> PathLikelihoodTable;
-  PathLikelihoodTable m_likelihoods;
-
-  /** Only the top-level of a group of aggregate heuristics should manage this. */
-  typedef boost::unordered_map<PathLikelihoodInnerTableKey, Ptr<Likelihood>,
-                               PathLikelihoodInnerTableHasher, PathLikelihoodInnerTableTestEqual> MasterPathLikelihoodInnerTable;
-  //typedef std::map<RonPath, std::list<double> > MasterPathLikelihoodInnerTable;
-  typedef boost::unordered_map<PathLikelihoodTableKey, MasterPathLikelihoodInnerTable,
-                               PathLikelihoodTableHasher, PathLikelihoodTableTestEqual> MasterPathLikelihoodTable;
-  //typedef std::map<Ptr<PeerDestination>, MasterPathLikelihoodInnerTable> MasterPathLikelihoodTable;
-  MasterPathLikelihoodTable * m_masterLikelihoods;
+  /** The likelihoods of every path known to a group of aggregate heuristics.
+      Only the top-level of the group creates it; the others share it.
+      The paths to each destination are rows of one contiguous matrix with a column
+      per heuristic, so a path's aggregate likelihood is the dot product of its row
+      with the heuristics' weights.  A max-heap over the rows is re-ordered whenever
+      a likelihood changes so that the best path can be found in O(1). */
+  class LikelihoodTable : public SimpleRefCount<LikelihoodTable>
+  {
+  public:
+    /** Add a column for another heuristic, returning its index. */
+    uint32_t AddHeuristic (double weight);
+    uint32_t GetNHeuristics () const;
+    void SetWeight (uint32_t heuristic, double weight);
+
+    /** Add a row for the path, unless it already has one. */
+    void AddPath (Ptr<RonPath> path);
+    bool HasPath (Ptr<RonPath> path) const;
+    /** Return the paths to the destination in the order they were added. */
+    const std::vector<Ptr<RonPath> > & GetPaths (Ptr<PeerDestination> destination);
+    /** Return the locations of the first peer of each path to the destination, in the same order. */
+    const PeerLocations & GetPeerLocations (Ptr<PeerDestination> destination);
+    uint32_t GetNPaths (Ptr<PeerDestination> destination) const;
+
+    /** Set the (unweighted) likelihood the heuristic assigns to the path. */
+    void SetLh (Ptr<RonPath> path, uint32_t heuristic, double lh);
+    /** Set the (unweighted) likelihoods the heuristic assigns to all the paths to the destination,
+        in the order they were added. */
+    void SetLhs (Ptr<PeerDestination> destination, uint32_t heuristic, const std::vector<double> & lhs);
+    /** Get the weighted likelihood the heuristic assigns to the path. */
+    double GetLh (Ptr<RonPath> path, uint32_t heuristic) const;
+    /** Get the weighted sum of the likelihoods all heuristics assign to the path. */
+    double GetAggregateLh (Ptr<RonPath> path) const;
+    /** Return the path to the destination with the highest aggregate likelihood,
+        or NULL if there are none. */
+    Ptr<RonPath> GetBestPath (Ptr<PeerDestination> destination) const;
+
+    /** Forget all paths, keeping the heuristics' columns. */
+    void Clear ();
+
+  private:
+    /** Orders rows by their aggregate likelihood. */
+    struct RowCompare
+    {
+      RowCompare (const std::vector<double> * aggregate = NULL);
+      bool operator() (uint32_t row1, uint32_t row2) const;
+      const std::vector<double> * m_aggregate;
+    };
+
+    typedef boost::heap::d_ary_heap<uint32_t, boost::heap::arity<4>, boost::heap::mutable_<true>,
+                                    boost::heap::stable<false>, boost::heap::compare<RowCompare> > RowHeap;
+    typedef boost::unordered_map<Ptr<RonPath>, uint32_t, PathHasher, PathTestEqual> RowIndex;
+
+    /** All the paths to one destination. */
+    class DestinationTable : public SimpleRefCount<DestinationTable>
+    {
+    public:
+      DestinationTable ();
+      RowIndex m_rows;
+      std::vector<Ptr<RonPath> > m_paths;
+      PeerLocations m_locations;
+      /** m_paths.size () rows of one likelihood per heuristic */
+      std::vector<double> m_likelihoods;
+      std::vector<double> m_aggregate;
+      RowHeap m_heap;
+      std::vector<RowHeap::handle_type> m_handles;
+    };
+
+    void UpdateAggregate (DestinationTable * table, uint32_t row);
+    DestinationTable * GetTable (Ptr<PeerDestination> destination);
+    DestinationTable * Find (Ptr<RonPath> path, uint32_t & row) const;
+
+    typedef boost::unordered_map<PathLikelihoodTableKey, Ptr<DestinationTable>,
+                                 PathLikelihoodTableHasher, PathLikelihoodTableTestEqual> DestinationTables;
+    DestinationTables m_destinations;
+    std::vector<double> m_weights;
+  };
+
+  Ptr<LikelihoodTable> m_table;
+  /** Our column in m_table */
+  uint32_t m_column;
+  /** Destinations whose likelihoods we assigned since m_updatedOnce was last false. */
+  boost::unordered_set<PathLikelihoodTableKey, PathLikelihoodTableHasher, PathLikelihoodTableTestEqual> m_updatedDestinations;
+  /** How many multi-hop paths ExpandPath built to each destination. */
+  boost::unordered_map<PathLikelihoodTableKey, uint32_t, PathLikelihoodTableHasher, PathLikelihoodTableTestEqual> m_expandedPaths;
 
   Ptr<RonPathHeuristic> m_topLevel;
 
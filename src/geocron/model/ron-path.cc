@@ -17,35 +17,59 @@
  */
 
 #include "ron-path.h"
+#include <algorithm>
+#include <boost/functional/hash.hpp>
 
 using namespace ns3;
 
 RonPath::RonPath()
+  : m_immutable (false),
+    m_hashValid (false)
 {}
 
 RonPath::RonPath(Ptr<RonPeerEntry> peer)
+  : m_immutable (false),
+    m_hashValid (false)
 {
   AddHop (Create<PeerDestination> (peer));
 }
 
 
 RonPath::RonPath (Ptr<PeerDestination> dest)
+  : m_immutable (false),
+    m_hashValid (false)
 {
   AddHop (dest);
 }
 
 
+void
+RonPath::AddHop (Ptr<PeerDestination> dest)
+{
+  NS_ASSERT_MSG (!m_immutable, "You can't change a path shared through the catalog.");
+  // the cached hash covers the hop's peers, so they can't change from now on
+  dest->MakeImmutable ();
+  m_path.push_back (dest);
+  m_hashValid = false;
+}
+
+
+void
+RonPath::AddHop (Ptr<RonPeerEntry> dest)
+{
+  AddHop (Create<PeerDestination> (dest));
+}
+
+
 void
 RonPath::AddHop (Ptr<PeerDestination> dest, RonPath::Iterator index)
 {
-  if (index != (Iterator)NULL)
-    {
-      if (index != Begin ())
-        NS_ASSERT_MSG (false, "You can't specify an index other than Begin() for inserting hops yet.");
-      m_path.push_front (dest);
-    }
-  else
-    m_path.push_back (dest);
+  NS_ASSERT_MSG (!m_immutable, "You can't change a path shared through the catalog.");
+  if (index != Begin ())
+    NS_ASSERT_MSG (false, "You can't specify an index other than Begin() for inserting hops yet.");
+  dest->MakeImmutable ();
+  m_path.insert (m_path.begin (), dest);
+  m_hashValid = false;
 }
 
 
@@ -59,7 +83,39 @@ RonPath::AddHop (Ptr<RonPeerEntry> dest, RonPath::Iterator index)
 void
 RonPath::Reverse ()
 {
-  m_path.reverse ();
+  NS_ASSERT_MSG (!m_immutable, "You can't change a path shared through the catalog.");
+  std::reverse (m_path.begin (), m_path.end ());
+  m_hashValid = false;
+}
+
+
+std::size_t
+RonPath::GetHash () const
+{
+  if (!m_hashValid)
+    {
+      m_hash = 0;
+      for (ConstIterator itr = Begin (); itr != End (); itr++)
+        boost::hash_combine (m_hash, (*itr)->GetHash ());
+      m_hashValid = true;
+    }
+  return m_hash;
+}
+
+
+void
+RonPath::MakeImmutable ()
+{
+  m_immutable = true;
+  for (Iterator itr = Begin (); itr != End (); itr++)
+    (*itr)->MakeImmutable ();
+}
+
+
+bool
+RonPath::IsImmutable () const
+{
+  return m_immutable;
 }
 
 
@@ -106,8 +162,10 @@ RonPath::GetDestination () const
 
 
 bool
-RonPath::operator== (const RonPath rhs) const
+RonPath::operator== (const RonPath & rhs) const
 {
+  if (this == &rhs)
+    return true;
   if (GetN () != rhs.GetN ())
     return false;
   for (RonPath::ConstIterator itr1 = Begin (), itr2 = rhs.Begin ();
@@ -122,14 +180,14 @@ RonPath::operator== (const RonPath rhs) const
 
 
 bool
-RonPath::operator!=(const RonPath rhs) const
+RonPath::operator!=(const RonPath & rhs) const
 {
   return !(*this == rhs);
 }
 
 
 bool
-RonPath::operator< (const RonPath rhs) const
+RonPath::operator< (const RonPath & rhs) const
 {
   RonPath::ConstIterator itr1 = Begin (), itr2 = rhs.Begin ();
   for (; itr1 != End () and itr2 != rhs.End (); itr1++,itr2++)
@@ -151,6 +209,7 @@ RonPath::operator< (const RonPath rhs) const
 
 
 PeerDestination::PeerDestination (Ptr<RonPeerEntry> peer/*, flags = 0*/)
+  : m_immutable (false)
 {
   AddPeer (peer);
 }
@@ -158,7 +217,46 @@ PeerDestination::PeerDestination (Ptr<RonPeerEntry> peer/*, flags = 0*/)
 void
 PeerDestination::AddPeer (Ptr<RonPeerEntry> peer/*, flags = 0*/)
 {
-  m_peers.push_back (peer);
+  NS_ASSERT_MSG (!m_immutable, "You can't change a destination in a path or shared through the catalog.");
+  if (!HasPeer (peer))
+    m_peers.push_back (peer);
+}
+
+bool
+PeerDestination::HasPeer (Ptr<RonPeerEntry> peer) const
+{
+  for (ConstIterator itr = Begin (); itr != End (); itr++)
+    if (*(*itr) == *peer)
+      return true;
+  return false;
+}
+
+std::size_t
+PeerDestination::GetHash () const
+{
+  NS_ASSERT_MSG (GetN (), "can't hash an empty destination!");
+  boost::hash<uint32_t> hasher;
+
+  //TODO: because we currently don't store the full peer inside headers, we don't always have the id
+  //and so we're using the address for now instead.... id would be more robust for multiple interfaces
+  //but we currently don't have that feature so no worries... for now
+  //summing keeps the hash independent of the peers' order, and that of a single peer unchanged
+  std::size_t hash = 0;
+  for (ConstIterator itr = Begin (); itr != End (); itr++)
+    hash += hasher ((*itr)->address.Get ());
+  return hash;
+}
+
+void
+PeerDestination::MakeImmutable ()
+{
+  m_immutable = true;
+}
+
+bool
+PeerDestination::IsImmutable () const
+{
+  return m_immutable;
 }
 
 uint32_t
@@ -194,16 +292,17 @@ PeerDestination::End () const
 
 
 bool
-PeerDestination::operator==(const PeerDestination rhs) const
+PeerDestination::operator==(const PeerDestination & rhs) const
 {
+  if (this == &rhs)
+    return true;
   if (GetN () != rhs.GetN ())
     return false;
 
-  for (ConstIterator itr1 = Begin (), itr2 = rhs.Begin ();
-       itr1 != End () and itr2 != rhs.End (); itr1++, itr2++)
+  //neither has duplicates, so the same number of peers that are all in rhs means the same set
+  for (ConstIterator itr = Begin (); itr != End (); itr++)
     {
-      //compare the objects inside the pointers inside the iterators
-      if (((*(*itr1)) != (*(*itr2))))
+      if (!rhs.HasPeer (*itr))
         return false;
     }
   return true;
@@ -211,7 +310,7 @@ PeerDestination::operator==(const PeerDestination rhs) const
 
 
 bool
-PeerDestination::operator!=(const PeerDestination rhs) const
+PeerDestination::operator!=(const PeerDestination & rhs) const
 {
   return !(*this == rhs);
 }
@@ -21,26 +21,39 @@
 
 #include "ron-peer-table.h"
 #include "ns3/core-module.h"
-#include <list>
+#include <vector>
 
 namespace ns3 {
 
   /** This subclass represents a single hop along the overlay path,
       which may be unicast, multicast, or broadcast and holds some other parameters
-      related to that particular hop, such as probabilities for probabilistic algorithms, etc. */
+      related to that particular hop, such as probabilities for probabilistic algorithms, etc.
+      Its peers form a set: their order doesn't matter to equality or the hash. */
 class PeerDestination : public SimpleRefCount<PeerDestination>
 {
 private:
-  typedef std::list<Ptr<RonPeerEntry> > DestinationContainer;
+  //almost always a single peer, so avoid a node allocation per peer
+  typedef std::vector<Ptr<RonPeerEntry> > DestinationContainer;
   DestinationContainer m_peers;
+  bool m_immutable;
 public:
   PeerDestination (Ptr<RonPeerEntry> peer/*, flags = 0*/);
   //TODO: flags for diff casts
+  /** Adds the peer, unless it's already one of the destination's. */
   void AddPeer (Ptr<RonPeerEntry> peer/*, flags = 0*/);
+  bool HasPeer (Ptr<RonPeerEntry> peer) const;
   uint32_t GetN () const;
 
-  bool operator==(const PeerDestination rhs) const;
-  bool operator!=(const PeerDestination rhs) const;
+  /** Hash of the destination, consistent with operator==. */
+  std::size_t GetHash () const;
+
+  /** Forbid further changes, as the destination is a hop of a path, which caches its hash,
+      or is shared through the RonPeerTable's catalog. */
+  void MakeImmutable ();
+  bool IsImmutable () const;
+
+  bool operator==(const PeerDestination & rhs) const;
+  bool operator!=(const PeerDestination & rhs) const;
   
   typedef DestinationContainer::iterator Iterator;
   typedef DestinationContainer::const_iterator ConstIterator;
@@ -54,8 +67,12 @@ public:
 class RonPath : public SimpleRefCount<RonPath>
 {
 private:
-  typedef std::list<Ptr<PeerDestination> > underlyingContainer;
+  //paths are short, so a vector keeps them in one allocation
+  typedef std::vector<Ptr<PeerDestination> > underlyingContainer;
   underlyingContainer m_path;
+  bool m_immutable;
+  mutable bool m_hashValid;
+  mutable std::size_t m_hash;
 
 public:
   RonPath();
@@ -65,10 +82,12 @@ public:
   typedef underlyingContainer::iterator Iterator;
   typedef underlyingContainer::const_iterator ConstIterator;
 
-  /** Adds a PeerDestination at the point in the path pointed to by index,
-      which defaults to the end of the path. */
-  void AddHop (Ptr<PeerDestination> dest, Iterator index = (Iterator)NULL);
-  void AddHop (Ptr<RonPeerEntry> dest, Iterator index = (Iterator)NULL);
+  /** Adds a PeerDestination at the end of the path, making it immutable. */
+  void AddHop (Ptr<PeerDestination> dest);
+  void AddHop (Ptr<RonPeerEntry> dest);
+  /** Adds a PeerDestination at the point in the path pointed to by index. */
+  void AddHop (Ptr<PeerDestination> dest, Iterator index);
+  void AddHop (Ptr<RonPeerEntry> dest, Iterator index);
 
   /** Returns the final destination peer(s), which is currently just the last added destination. */
   //TODO: labels to identify which hop... or is that just peerID?
@@ -83,15 +102,23 @@ public:
   /** Reverses the ordering of the path. */
   void Reverse ();
 
+  /** Hash of the path, consistent with operator==.
+      It is computed once and cached until the path changes. */
+  std::size_t GetHash () const;
+
+  /** Forbid further changes, as the path is shared through the RonPeerTable's catalog. */
+  void MakeImmutable ();
+  bool IsImmutable () const;
+
   /** Compare paths based on the contents of the pointers they contain,
       in case there exist multiple references to the same RonPeerEntry. */
-  bool operator== (const RonPath rhs) const;
-  bool operator!=(const RonPath rhs) const;
+  bool operator== (const RonPath & rhs) const;
+  bool operator!=(const RonPath & rhs) const;
 
   /** Compare paths based on the contents of the pointers they contain,
       in case there exist multiple references to the same RonPeerEntry.
       In the event of a tie, the shorter path is considered less. */
-  bool operator< (RonPath  rhs) const;
+  bool operator< (const RonPath & rhs) const;
 
   ConstIterator Begin () const;
   ConstIterator End () const;
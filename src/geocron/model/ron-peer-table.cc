@@ -17,6 +17,7 @@
  */
 
 #include "ron-peer-table.h"
+#include "ron-path.h"
 #include "failure-helper-functions.h"
 #include "geocron-experiment.h"
 
@@ -55,20 +56,20 @@ RonPeerEntry::GetTypeId ()
 
 
 bool
-RonPeerEntry::operator== (const RonPeerEntry rhs) const
+RonPeerEntry::operator== (const RonPeerEntry & rhs) const
 {
   return id == rhs.id;
 }
 
 
 bool
-RonPeerEntry::operator!= (const RonPeerEntry rhs) const
+RonPeerEntry::operator!= (const RonPeerEntry & rhs) const
 {
   return !(*this == rhs);
 }
 
 bool
-RonPeerEntry::operator< (RonPeerEntry rhs) const
+RonPeerEntry::operator< (const RonPeerEntry & rhs) const
 {
   return id < rhs.id;
 }
@@ -86,16 +87,28 @@ RonPeerTable::GetMaster ()
 }
 
 
+RonPeerTable::RonPeerTable ()
+  : m_storage (Create<PeerStorage> ())
+{
+}
+
+
+//defined here, where the catalog's element types are complete
+RonPeerTable::~RonPeerTable ()
+{
+}
+
+
 uint32_t
 RonPeerTable::GetN () const
 {
-  NS_ASSERT_MSG (m_peersByAddress.size () == m_peers.size (), "Corrupted peer table (sizes not same)!");
-  return m_peers.size ();
+  NS_ASSERT_MSG (m_storage->m_peersByAddress.size () == m_storage->m_peers.size (), "Corrupted peer table (sizes not same)!");
+  return m_storage->m_peers.size ();
 }
 
 
 bool
-RonPeerTable::operator== (const RonPeerTable rhs) const
+RonPeerTable::operator== (const RonPeerTable & rhs) const
 {
   // if they're same size, all from one must be in the other (order not mattering)
   if (GetN () != rhs.GetN ())
@@ -114,27 +127,109 @@ RonPeerTable::operator== (const RonPeerTable rhs) const
 
 
 bool
-RonPeerTable::operator!= (const RonPeerTable rhs) const
+RonPeerTable::operator!= (const RonPeerTable & rhs) const
 {
   return !(*this == rhs);
 }
 
 
 
+Ptr<RonPeerTable>
+RonPeerTable::Mirror () const
+{
+  Ptr<RonPeerTable> mirror = Create<RonPeerTable> ();
+  mirror->m_storage = m_storage;
+  // the mirror sees our entries, so we must copy them before changing them too
+  m_ownEntries.clear ();
+  return mirror;
+}
+
+
+Ptr<RonPeerTable>
+RonPeerTable::GetSubset (const std::vector<uint32_t> & ids) const
+{
+  Ptr<RonPeerTable> subset = Create<RonPeerTable> ();
+  m_ownEntries.clear ();
+  for (std::vector<uint32_t>::const_iterator id = ids.begin ();
+       id != ids.end (); id++)
+    {
+      Ptr<RonPeerEntry> peer = GetPeer (*id);
+      if (peer != NULL)
+        {
+          subset->m_storage->m_peers[peer->id] = peer;
+          subset->m_storage->m_peersByAddress[peer->address.Get ()] = peer;
+        }
+    }
+  return subset;
+}
+
+
+Ptr<RonPeerTable>
+RonPeerTable::GetSubset (Callback<bool, Ptr<RonPeerEntry> > filter) const
+{
+  Ptr<RonPeerTable> subset = Create<RonPeerTable> ();
+  m_ownEntries.clear ();
+  for (ConstIterator peer = Begin (); peer != End (); peer++)
+    {
+      if (filter (*peer))
+        {
+          subset->m_storage->m_peers[(*peer)->id] = *peer;
+          subset->m_storage->m_peersByAddress[(*peer)->address.Get ()] = *peer;
+        }
+    }
+  return subset;
+}
+
+
+bool
+RonPeerTable::IsShared () const
+{
+  return m_storage->GetReferenceCount () > 1;
+}
+
+
+void
+RonPeerTable::MakeStorageUnique ()
+{
+  if (IsShared ())
+    m_storage = Create<PeerStorage> (*m_storage);
+}
+
+
+Ptr<RonPeerEntry>
+RonPeerTable::GetPeerForWrite (uint32_t id)
+{
+  Ptr<RonPeerEntry> peer = GetPeer (id);
+  if (peer == NULL or m_ownEntries.count (id))
+    return peer;
+
+  MakeStorageUnique ();
+  peer = CopyObject<RonPeerEntry> (peer);
+  m_storage->m_peers[id] = peer;
+  m_storage->m_peersByAddress[peer->address.Get ()] = peer;
+  m_ownEntries.insert (id);
+  return peer;
+}
+
+
 Ptr<RonPeerEntry>
 RonPeerTable::AddPeer (Ptr<RonPeerEntry> entry)
 {
+  MakeStorageUnique ();
+  // the caller, or another table, may hold the entry too, so it's copied before being written to
+  m_ownEntries.erase (entry->id);
+
   Ptr<RonPeerEntry> returnValue;
-  if (m_peers.count (entry->id) != 0)
+  if (m_storage->m_peers.count (entry->id) != 0)
     {
-      Ptr<RonPeerEntry> temp = (*(m_peers.find (entry->id))).second;
-      m_peers[entry->id] = entry;
+      Ptr<RonPeerEntry> temp = (*(m_storage->m_peers.find (entry->id))).second;
+      m_storage->m_peers[entry->id] = entry;
       returnValue = temp;
     }
   else
-    returnValue = m_peers[entry->id] = entry;
+    returnValue = m_storage->m_peers[entry->id] = entry;
   
-  m_peersByAddress[(entry->address.Get ())] = entry;
+  m_storage->m_peersByAddress[(entry->address.Get ())] = entry;
 
   return returnValue;
 }
@@ -144,28 +239,34 @@ Ptr<RonPeerEntry>
 RonPeerTable::AddPeer (Ptr<Node> node)
 {
   Ptr<RonPeerEntry> newEntry = Create<RonPeerEntry> (node);
-  return AddPeer (newEntry);
+  Ptr<RonPeerEntry> returnValue = AddPeer (newEntry);
+  // only this table has the entry it created
+  m_ownEntries.insert (newEntry->id);
+  return returnValue;
 }
 
 
 bool
 RonPeerTable::RemovePeer (uint32_t id)
 {
-  bool retValue = false;
-  if (m_peers.count (id))
-    retValue = true;
+  if (!m_storage->m_peers.count (id))
+    return false;
+
+  MakeStorageUnique ();
+  m_ownEntries.erase (id);
+
   Ipv4Address addr = GetPeer (id)->address;
-  m_peers.erase (m_peers.find (id));
-  m_peersByAddress.erase (m_peersByAddress.find (addr.Get ()));
-  return retValue;
+  m_storage->m_peers.erase (m_storage->m_peers.find (id));
+  m_storage->m_peersByAddress.erase (addr.Get ());
+  return true;
 }
 
 
 Ptr<RonPeerEntry>
 RonPeerTable::GetPeer (uint32_t id) const
 {
-  if (m_peers.count (id))
-    return  ((*(m_peers.find (id))).second);
+  if (m_storage->m_peers.count (id))
+    return  ((*(m_storage->m_peers.find (id))).second);
   else
     return NULL;
 }
@@ -174,18 +275,23 @@ RonPeerTable::GetPeer (uint32_t id) const
 Ptr<RonPeerEntry>
 RonPeerTable::GetPeerByAddress (Ipv4Address address) const
 {
-  if (m_peersByAddress.count (address.Get ()))
+  if (m_storage->m_peersByAddress.count (address.Get ()))
     //bracket operator isn't const
-    return m_peersByAddress.at (address.Get ());
-  else
-    return NULL;
+    return m_storage->m_peersByAddress.at (address.Get ());
+
+  // peers are keyed by their node's primary address, so fall back to
+  // the global index to resolve any other interface address of the node
+  Ptr<Node> node = Ipv4AddressNodeIndex::GetNode (address);
+  if (node != NULL)
+    return GetPeer (node->GetId ());
+  return NULL;
 }
 
 
 bool
 RonPeerTable::IsInTable (uint32_t id) const
 {
-  return m_peers.count (id);
+  return m_storage->m_peers.count (id);
 }
 
 
@@ -196,18 +302,80 @@ RonPeerTable::IsInTable (Iterator itr) const
 }
 
 
+Ptr<PeerDestination>
+RonPeerTable::GetDestination (Ptr<RonPeerEntry> peer)
+{
+  CriticalSection cs (m_catalogMutex);
+  return DoGetDestination (peer);
+}
+
+
+Ptr<PeerDestination>
+RonPeerTable::DoGetDestination (Ptr<RonPeerEntry> peer)
+{
+  Ptr<PeerDestination> dest = m_destinations[peer->id];
+  if (dest == NULL)
+    {
+      dest = Create<PeerDestination> (peer);
+      dest->MakeImmutable ();
+      m_destinations[peer->id] = dest;
+    }
+  return dest;
+}
+
+
+Ptr<RonPath>
+RonPeerTable::GetOneHopPath (Ptr<RonPeerEntry> intermediate, Ptr<RonPeerEntry> destination)
+{
+  CriticalSection cs (m_catalogMutex);
+  Ptr<RonPath> path = m_oneHopPaths[std::make_pair (intermediate->id, destination->id)];
+  if (path == NULL)
+    {
+      path = Create<RonPath> ();
+      path->AddHop (DoGetDestination (intermediate));
+      path->AddHop (DoGetDestination (destination));
+      path->MakeImmutable ();
+      m_oneHopPaths[std::make_pair (intermediate->id, destination->id)] = path;
+    }
+  return path;
+}
+
+
+Ptr<RonPath>
+RonPeerTable::GetDirectPath (Ptr<RonPeerEntry> destination)
+{
+  CriticalSection cs (m_catalogMutex);
+  Ptr<RonPath> path = m_directPaths[destination->id];
+  if (path == NULL)
+    {
+      path = Create<RonPath> ();
+      path->AddHop (DoGetDestination (destination));
+      path->MakeImmutable ();
+      m_directPaths[destination->id] = path;
+    }
+  return path;
+}
+
+
 void
 RonPeerTable::Clear ()
 {
-  m_peers.clear ();
-  m_peersByAddress.clear ();
+  // just let go of shared storage rather than copying it
+  if (IsShared ())
+    m_storage = Create<PeerStorage> ();
+  m_ownEntries.clear ();
+  m_storage->m_peers.clear ();
+  m_storage->m_peersByAddress.clear ();
+  m_destinations.clear ();
+  m_oneHopPaths.clear ();
+  m_directPaths.clear ();
 }
 
 
 RonPeerTable::Iterator
 RonPeerTable::Begin ()
 {
-  return boost::begin (boost::adaptors::values (m_peers));
+  return boost::begin (boost::adaptors::values (m_storage->m_peers));
 /*template<typename T1, typename T2> T2& take_second(const std::pair<T1, T2> &a_pair)
 {
   return a_pair.second;
@@ -219,19 +387,21 @@ boost::make_transform_iterator(a_map.begin(), take_second<int, string>),*/
 RonPeerTable::Iterator
 RonPeerTable::End ()
 {
-  return boost::end (boost::adaptors::values (m_peers));
+  return boost::end (boost::adaptors::values (m_storage->m_peers));
 }
 
 
 RonPeerTable::ConstIterator
 RonPeerTable::Begin () const
 {
-  return boost::begin (boost::adaptors::values (m_peers));
+  const underlyingMapType & peers = m_storage->m_peers;
+  return boost::begin (boost::adaptors::values (peers));
 }
 
 
 RonPeerTable::ConstIterator
 RonPeerTable::End () const
 {
-  return boost::end (boost::adaptors::values (m_peers));
+  const underlyingMapType & peers = m_storage->m_peers;
+  return boost::end (boost::adaptors::values (peers));
 }
@@ -27,7 +27,10 @@
 
 #include <boost/range/adaptor/map.hpp>
 #include <boost/unordered_map.hpp>
+#include <boost/unordered_set.hpp>
+#include <boost/functional/hash.hpp>
 #include <map>
+#include <utility>
 
 //TODO: enum for choosing which heuristic?
 
@@ -41,9 +44,9 @@ public:
   RonPeerEntry (Ptr<Node> node);
   static TypeId GetTypeId ();
 
-  bool operator== (RonPeerEntry rhs) const;
-  bool operator!= (RonPeerEntry rhs) const;
-  bool operator< (RonPeerEntry rhs) const;
+  bool operator== (const RonPeerEntry & rhs) const;
+  bool operator!= (const RonPeerEntry & rhs) const;
+  bool operator< (const RonPeerEntry & rhs) const;
 
   //Ron Attributes
   uint32_t id;
@@ -58,6 +61,9 @@ public:
   //TODO: failures reported counter / timer
 };  
 
+class PeerDestination;
+class RonPath;
+
 class RonPeerTable : public SimpleRefCount<RonPeerTable>
 {
  private:
@@ -70,13 +76,34 @@ class RonPeerTable : public SimpleRefCount<RonPeerTable>
   typedef boost::range_iterator<underlyingConstIterator>::type ConstIterator;
 
   /** We store all of the peers in a single master peer table for efficiency purposes.
-      This should save a lot on memory and
-      TODO will incorporate a 'mirroring' feature
-      in which subsets are generated efficiently and contain copy-on-write peer entries. */
+      This should save a lot on memory, and per-client views of it should be
+      made with Mirror or GetSubset, which share the master's RonPeerEntry objects. */
   static Ptr<RonPeerTable> GetMaster ();
 
-  bool operator== (const RonPeerTable rhs) const;
-  bool operator!= (const RonPeerTable rhs) const;
+  RonPeerTable ();
+  ~RonPeerTable ();
+
+  /** Returns a table with the same peers, sharing this table's storage until
+      either table adds or removes a peer, at which point the changed one copies it.
+      Creating a mirror is O(1). */
+  Ptr<RonPeerTable> Mirror () const;
+  /** Returns a table with only the given peers, sharing this table's RonPeerEntry objects.
+      Ids not in this table are ignored.  Costs O(subset). */
+  Ptr<RonPeerTable> GetSubset (const std::vector<uint32_t> & ids) const;
+  /** Returns a table with only the peers for which filter returns true,
+      sharing this table's RonPeerEntry objects. */
+  Ptr<RonPeerTable> GetSubset (Callback<bool, Ptr<RonPeerEntry> > filter) const;
+  /** Returns true if this table currently shares its storage with another table. */
+  bool IsShared () const;
+
+  /** Returns the requested entry for modification, NULL if unavailable.
+      An entry this table shares with a mirror or subset, whichever of them
+      made the other, is first replaced by a private copy, so the change is
+      not seen by other tables. */
+  Ptr<RonPeerEntry> GetPeerForWrite (uint32_t id);
+
+  bool operator== (const RonPeerTable & rhs) const;
+  bool operator!= (const RonPeerTable & rhs) const;
 
   uint32_t GetN () const;
 
@@ -88,12 +115,21 @@ class RonPeerTable : public SimpleRefCount<RonPeerTable>
   bool RemovePeer (uint32_t id);
   /** Returns requested entry, NULL if unavailable. Use IsInTable to verify its prescence in the table. */
   Ptr<RonPeerEntry> GetPeer (uint32_t id) const;
-  /** Returns requested entry, NULL if unavailable. Use IsInTable to verify its prescence in the table. */
+  /** Returns requested entry, NULL if unavailable. Any interface address of the peer's node may be used. */
   Ptr<RonPeerEntry> GetPeerByAddress (Ipv4Address address) const;
 
   bool IsInTable (uint32_t id) const;
   bool IsInTable (Iterator itr) const;
 
+  /** Returns the immutable PeerDestination for the peer, shared by everyone asking this table for it. */
+  Ptr<PeerDestination> GetDestination (Ptr<RonPeerEntry> peer);
+  /** Returns the immutable one-hop path through intermediate to destination.
+      Paths are interned by peer id, so every client asking for the same path
+      shares one object and comparing such paths is a pointer comparison. */
+  Ptr<RonPath> GetOneHopPath (Ptr<RonPeerEntry> intermediate, Ptr<RonPeerEntry> destination);
+  /** Returns the immutable path straight to destination, interned like the one-hop paths. */
+  Ptr<RonPath> GetDirectPath (Ptr<RonPeerEntry> destination);
+
   /** Drop all RonPeerEntry entries from the table, updating all data structures in the table accordingly. */
   void Clear ();
 
@@ -105,8 +141,29 @@ class RonPeerTable : public SimpleRefCount<RonPeerTable>
   static Ptr<RonPeerTable> m_master;
 
  private:
-  underlyingMapType m_peers;
-  boost::unordered_map<uint32_t, Ptr<RonPeerEntry> > m_peersByAddress;
+  /** The peers themselves, shared between mirrors until one of them changes. */
+  class PeerStorage : public SimpleRefCount<PeerStorage>
+  {
+  public:
+    underlyingMapType m_peers;
+    boost::unordered_map<uint32_t, Ptr<RonPeerEntry> > m_peersByAddress;
+  };
+  Ptr<PeerStorage> m_storage;
+  /** Ids of the entries this table may modify in place: those it added or copied
+      since it last shared its entries with a mirror or subset. */
+  mutable boost::unordered_set<uint32_t> m_ownEntries;
+
+  /** Copy the storage if other tables share it, before we change it. */
+  void MakeStorageUnique ();
+
+  // catalog of shared destinations and paths, keyed by peer ids
+  boost::unordered_map<uint32_t, Ptr<PeerDestination> > m_destinations;
+  boost::unordered_map<std::pair<uint32_t, uint32_t>, Ptr<RonPath> > m_oneHopPaths;
+  boost::unordered_map<uint32_t, Ptr<RonPath> > m_directPaths;
+  /** Clients run by a multithreaded simulator may fill the master's catalog at the same time. */
+  SystemMutex m_catalogMutex;
+
+  Ptr<PeerDestination> DoGetDestination (Ptr<RonPeerEntry> peer);
 };
 
 } //namespace
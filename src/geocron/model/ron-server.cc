@@ -65,6 +65,12 @@ void
 RonServer::DoDispose (void)
 {
   NS_LOG_FUNCTION_NOARGS ();
+  if (m_socket != 0)
+    {
+      m_socket->Close ();
+      m_socket->SetRecvCallback (MakeNullCallback<void, Ptr<Socket> > ());
+      m_socket = 0;
+    }
   Application::DoDispose ();
 }
 
@@ -0,0 +1,320 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ron-trace-file.h"
+#include "ron-header.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <map>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("RonTraceFile");
+
+namespace {
+
+struct RonTraceFileHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t recordSize;
+};
+
+const char RON_TRACE_MAGIC[8] = {'R', 'O', 'N', 'T', 'R', 'A', 'C', 'E'};
+const uint32_t RON_TRACE_VERSION = 1;
+
+} //anonymous namespace
+
+
+////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////  RonTraceRecord  ////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+
+RonTraceRecord
+RonTraceRecord::Create (EventType event, Ptr<const Packet> p, uint32_t nodeId)
+{
+  RonHeader head;
+  p->PeekHeader (head);
+  return Create (event, head, nodeId, Simulator::Now ());
+}
+
+
+RonTraceRecord
+RonTraceRecord::Create (EventType event, const RonHeader & head, uint32_t nodeId, Time time)
+{
+  RonTraceRecord record;
+  record.event = event;
+  record.indirect = head.IsForward ();
+  record.hop = head.GetHop ();
+  record.reserved = 0;
+  record.node = nodeId;
+  record.time = time.GetNanoSeconds ();
+  record.origin = head.GetOrigin ().Get ();
+  record.nextDest = head.GetNextDest ().Get ();
+  record.finalDest = head.GetFinalDest ().Get ();
+  record.seq = head.GetSeq ();
+  return record;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////  RonTraceWriter  ////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+
+RonTraceWriter::RonTraceWriter (std::string filename, uint32_t bufferedRecords)
+  : m_bufferedRecords (bufferedRecords), m_nRecords (0)
+{
+  NS_ASSERT_MSG (bufferedRecords > 0, "RonTraceWriter must buffer at least one record!");
+
+  m_file.open (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_file)
+    NS_FATAL_ERROR ("Couldn't open trace file " << filename);
+
+  RonTraceFileHeader header;
+  std::memcpy (header.magic, RON_TRACE_MAGIC, sizeof (header.magic));
+  header.version = RON_TRACE_VERSION;
+  header.recordSize = sizeof (RonTraceRecord);
+  m_file.write ((const char *)&header, sizeof (header));
+
+  m_buffer.reserve (m_bufferedRecords);
+}
+
+
+RonTraceWriter::~RonTraceWriter ()
+{
+  if (m_file.is_open ())
+    Flush ();
+}
+
+
+void
+RonTraceWriter::Write (RonTraceRecord::EventType event, Ptr<const Packet> p, uint32_t nodeId)
+{
+  Write (RonTraceRecord::Create (event, p, nodeId));
+}
+
+
+void
+RonTraceWriter::Write (const RonTraceRecord & record)
+{
+  CriticalSection cs (m_mutex);
+  std::ostream *partition = SimulationPartition::GetStream (&m_file);
+  if (partition != &m_file)
+    {
+      // the node's records are written after those buffered before the
+      // window, in the order of the nodes, once all of them ran it
+      if (!m_buffer.empty ())
+        Flush ();
+      partition->write ((const char *)&record, sizeof (record));
+      m_nRecords++;
+      return;
+    }
+  m_buffer.push_back (record);
+  m_nRecords++;
+  if (m_buffer.size () >= m_bufferedRecords)
+    Flush ();
+}
+
+
+void
+RonTraceWriter::Flush ()
+{
+  if (!m_buffer.empty ())
+    {
+      m_file.write ((const char *)&m_buffer[0], m_buffer.size () * sizeof (RonTraceRecord));
+      m_buffer.clear ();
+    }
+  m_file.flush ();
+}
+
+
+bool
+RonTraceWriter::Close ()
+{
+  Flush ();
+  m_file.close ();
+  return !m_file.fail ();
+}
+
+
+uint64_t
+RonTraceWriter::GetNRecords () const
+{
+  return m_nRecords;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////  RonTraceSummary  ///////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+
+double
+RonTraceSummary::GetAckRatio () const
+{
+  if (!nNodes)
+    return 0.0;
+  return (double)nAcks / nNodes;
+}
+
+
+double
+RonTraceSummary::GetOverlayImprovement () const
+{
+  if (!nDirectAcks)
+    return std::numeric_limits<double>::infinity ();
+  return ((double)nAcks - nDirectAcks) / nDirectAcks * 100;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+//////////////////////////////  RonTraceReader  ////////////////////////////////
+////////////////////////////////////////////////////////////////////////////////
+
+
+RonTraceReader::RonTraceReader (std::string filename)
+  : m_map (NULL), m_mapLength (0), m_records (NULL), m_nRecords (0)
+{
+  int fd = open (filename.c_str (), O_RDONLY);
+  if (fd < 0)
+    NS_FATAL_ERROR ("Couldn't open trace file " << filename);
+
+  struct stat info;
+  if (fstat (fd, &info) < 0 or (size_t)info.st_size < sizeof (RonTraceFileHeader))
+    {
+      close (fd);
+      NS_FATAL_ERROR ("Trace file " << filename << " is too short to be a binary RON trace");
+    }
+
+  m_mapLength = info.st_size;
+  m_map = mmap (NULL, m_mapLength, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (m_map == MAP_FAILED)
+    {
+      m_map = NULL;
+      NS_FATAL_ERROR ("Couldn't map trace file " << filename);
+    }
+
+  const RonTraceFileHeader * header = (const RonTraceFileHeader *)m_map;
+  if (std::memcmp (header->magic, RON_TRACE_MAGIC, sizeof (header->magic)) or
+      header->version != RON_TRACE_VERSION or header->recordSize != sizeof (RonTraceRecord))
+    NS_FATAL_ERROR ("Trace file " << filename << " isn't a binary RON trace of this version");
+
+  // a trailing partial record means the writer didn't finish, so ignore it
+  m_records = (const RonTraceRecord *)((const char *)m_map + sizeof (RonTraceFileHeader));
+  m_nRecords = (m_mapLength - sizeof (RonTraceFileHeader)) / sizeof (RonTraceRecord);
+}
+
+
+RonTraceReader::~RonTraceReader ()
+{
+  if (m_map)
+    munmap (m_map, m_mapLength);
+}
+
+
+RonTraceReader::Iterator
+RonTraceReader::Begin () const
+{
+  return m_records;
+}
+
+
+RonTraceReader::Iterator
+RonTraceReader::End () const
+{
+  return m_records + m_nRecords;
+}
+
+
+uint64_t
+RonTraceReader::GetNRecords () const
+{
+  return m_nRecords;
+}
+
+
+const RonTraceRecord &
+RonTraceReader::GetRecord (uint64_t i) const
+{
+  NS_ASSERT_MSG (i < m_nRecords, "Trace record index out of range!");
+  return m_records[i];
+}
+
+
+RonTraceSummary
+RonTraceReader::Summarize (double resolution) const
+{
+  NS_ASSERT_MSG (resolution > 0.0, "Summary resolution must be positive!");
+
+  enum {SENT = 1, ACKED = 2, DIRECTLY_ACKED = 4};
+  std::map<uint32_t, uint8_t> nodes;
+  std::map<int64_t, uint32_t> acksPerSlice;
+
+  RonTraceSummary summary;
+  summary.nNodes = summary.nAcks = summary.nDirectAcks = 0;
+  summary.nSends = summary.nForwards = 0;
+
+  for (Iterator record = Begin (); record != End (); record++)
+    {
+      uint8_t & flags = nodes[record->node];
+      switch (record->event)
+        {
+        case RonTraceRecord::SEND:
+          flags |= SENT;
+          summary.nSends++;
+          break;
+        case RonTraceRecord::FORWARD:
+          summary.nForwards++;
+          break;
+        case RonTraceRecord::ACK:
+          flags |= ACKED;
+          if (!record->indirect)
+            flags |= DIRECTLY_ACKED;
+          acksPerSlice[(int64_t) std::floor (record->time / 1e9 / resolution + 0.5)]++;
+          break;
+        default:
+          NS_LOG_WARN ("Unknown trace event type " << (int)record->event);
+        }
+    }
+
+  for (std::map<uint32_t, uint8_t>::iterator node = nodes.begin (); node != nodes.end (); node++)
+    {
+      summary.nNodes += (node->second & SENT) != 0;
+      summary.nAcks += (node->second & ACKED) != 0;
+      summary.nDirectAcks += (node->second & DIRECTLY_ACKED) != 0;
+    }
+
+  uint64_t total = 0;
+  for (std::map<int64_t, uint32_t>::iterator slice = acksPerSlice.begin (); slice != acksPerSlice.end (); slice++)
+    {
+      total += slice->second;
+      summary.ackTimes.push_back (slice->first * resolution);
+      summary.ackRatios.push_back (summary.nNodes ? (double)total / summary.nNodes : 0.0);
+    }
+
+  return summary;
+}
+
+} //namespace ns3
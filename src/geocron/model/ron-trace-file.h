@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef RON_TRACE_FILE_H
+#define RON_TRACE_FILE_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+class RonHeader;
+
+/** One RonClient trace event as stored in a binary trace file.
+    Files are a 16 byte header ("RONTRACE", format version, record size) followed by
+    these fixed-size records in native byte order, so a reader can map the file and
+    index the records directly. */
+struct RonTraceRecord
+{
+  enum EventType
+  {
+    SEND = 0,
+    FORWARD = 1,
+    ACK = 2
+  };
+
+  uint8_t event;
+  uint8_t indirect; // whether the packet went (or the ACK came back) through the overlay
+  uint8_t hop;
+  uint8_t reserved;
+  uint32_t node;
+  int64_t time; // nanoseconds
+  uint32_t origin;
+  uint32_t nextDest;
+  uint32_t finalDest;
+  uint32_t seq;
+
+  /** The record of the event for the packet, which must start with a RonHeader, at the current time. */
+  static RonTraceRecord Create (EventType event, Ptr<const Packet> p, uint32_t nodeId);
+  static RonTraceRecord Create (EventType event, const RonHeader & head, uint32_t nodeId, Time time);
+};
+
+
+/** Buffers trace records and appends them to a binary trace file in large writes. */
+class RonTraceWriter : public SimpleRefCount<RonTraceWriter>
+{
+public:
+  RonTraceWriter (std::string filename, uint32_t bufferedRecords = 4096);
+  ~RonTraceWriter ();
+
+  /** Record the event for the packet, which must start with a RonHeader, at the current time. */
+  void Write (RonTraceRecord::EventType event, Ptr<const Packet> p, uint32_t nodeId);
+  void Write (const RonTraceRecord & record);
+  /** Write out all buffered records. */
+  void Flush ();
+  /** Write out all buffered records and close the file, returning whether they were all written. */
+  bool Close ();
+  uint64_t GetNRecords () const;
+
+private:
+  RonTraceWriter (const RonTraceWriter &);
+  RonTraceWriter & operator= (const RonTraceWriter &);
+
+  std::ofstream m_file;
+  std::vector<RonTraceRecord> m_buffer;
+  uint32_t m_bufferedRecords;
+  uint64_t m_nRecords;
+  /** Clients run by a multithreaded simulator may write at the same time:
+      their records go to the SimulationPartition of their node. */
+  SystemMutex m_mutex;
+};
+
+
+/** The summary metrics of one run, as computed by ron_trace_analyzer.py. */
+struct RonTraceSummary
+{
+  uint32_t nNodes;      // nodes that sent at least one packet
+  uint32_t nAcks;       // nodes that received at least one ACK
+  uint32_t nDirectAcks; // nodes that received at least one direct ACK
+  uint64_t nSends;
+  uint64_t nForwards;
+
+  /** Cumulative ACKs received by the end of each time slice that had any, per node. */
+  std::vector<double> ackTimes;
+  std::vector<double> ackRatios;
+
+  /** Fraction of the nodes that got an ACK. */
+  double GetAckRatio () const;
+  /** Percent more nodes reached the server than would have without the overlay (infinite if none did directly). */
+  double GetOverlayImprovement () const;
+};
+
+
+/** Maps a binary trace file into memory for reading its records in place. */
+class RonTraceReader : public SimpleRefCount<RonTraceReader>
+{
+public:
+  /** Fails fatally if the file can't be mapped or isn't a RonClient binary trace. */
+  RonTraceReader (std::string filename);
+  ~RonTraceReader ();
+
+  typedef const RonTraceRecord * Iterator;
+  Iterator Begin () const;
+  Iterator End () const;
+  uint64_t GetNRecords () const;
+  const RonTraceRecord & GetRecord (uint64_t i) const;
+
+  /** Summarize the run, rounding event times to the nearest resolution seconds. */
+  RonTraceSummary Summarize (double resolution = 0.1) const;
+
+private:
+  RonTraceReader (const RonTraceReader &);
+  RonTraceReader & operator= (const RonTraceReader &);
+
+  void * m_map;
+  size_t m_mapLength;
+  const RonTraceRecord * m_records;
+  uint64_t m_nRecords;
+};
+
+} //namespace ns3
+#endif //RON_TRACE_FILE_H
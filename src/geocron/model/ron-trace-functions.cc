@@ -6,43 +6,65 @@ NS_LOG_COMPONENT_DEFINE ("RonTracers");
 
 void AckReceived (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p, uint32_t nodeId)
 {
-  RonHeader head;
-  p->PeekHeader (head);
-  bool usedOverlay = head.IsForward ();
-  
-  std::stringstream s;
-  s << "Node " << nodeId << " received " << (usedOverlay ? "indirect" : "direct") << " ACK at " << Simulator::Now ().GetSeconds ();
-
-  NS_LOG_INFO (s.str ());
-  *stream->GetStream () << s.str() << std::endl;
+  WriteTraceRecord (stream, RonTraceRecord::Create (RonTraceRecord::ACK, p, nodeId));
 }
 
 
 void PacketForwarded (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p, uint32_t nodeId) 
 {
-  RonHeader head;
-  p->PeekHeader (head);
-  
-  std::stringstream s;
-  s << "Node " << nodeId << " forwarded packet (hop=" << (int)head.GetHop () << ") at " << Simulator::Now ().GetSeconds ()
-    << " from " << head.GetOrigin () << " to " << head.GetNextDest () << " and eventually " << head.GetFinalDest ();
-
-  NS_LOG_INFO (s.str ());
-  *stream->GetStream () << s.str() << std::endl;
+  WriteTraceRecord (stream, RonTraceRecord::Create (RonTraceRecord::FORWARD, p, nodeId));
 }
 
 
 void PacketSent (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p, uint32_t nodeId)
 {
-  RonHeader head;
-  p->PeekHeader (head);
-  bool usedOverlay = head.IsForward ();
-  
+  WriteTraceRecord (stream, RonTraceRecord::Create (RonTraceRecord::SEND, p, nodeId));
+}
+
+
+void WriteTraceRecord (Ptr<OutputStreamWrapper> stream, const RonTraceRecord & record)
+{
   std::stringstream s;
-  s << "Node " << nodeId << " sent " << (usedOverlay ? "indirect" : "direct")
-    << " packet at " << Simulator::Now ().GetSeconds ();
-  
+  double time = NanoSeconds (record.time).GetSeconds ();
+
+  switch (record.event)
+    {
+    case RonTraceRecord::ACK:
+      s << "Node " << record.node << " received " << (record.indirect ? "indirect" : "direct") << " ACK at " << time;
+      break;
+    case RonTraceRecord::FORWARD:
+      s << "Node " << record.node << " forwarded packet (hop=" << (int)record.hop << ") at " << time
+        << " from " << Ipv4Address (record.origin) << " to " << Ipv4Address (record.nextDest)
+        << " and eventually " << Ipv4Address (record.finalDest);
+      break;
+    case RonTraceRecord::SEND:
+      s << "Node " << record.node << " sent " << (record.indirect ? "indirect" : "direct")
+        << " packet at " << time;
+      break;
+    default:
+      NS_LOG_WARN ("Unknown trace event type " << (int)record.event);
+      return;
+    }
+
   NS_LOG_INFO (s.str ());
-  *stream->GetStream () << s.str() << std::endl;
+  *stream->GetStream () << s.str() << '\n';
+}
+
+
+void AckReceivedRecord (Ptr<RonTraceWriter> writer, Ptr<const Packet> p, uint32_t nodeId)
+{
+  writer->Write (RonTraceRecord::ACK, p, nodeId);
+}
+
+
+void PacketForwardedRecord (Ptr<RonTraceWriter> writer, Ptr<const Packet> p, uint32_t nodeId)
+{
+  writer->Write (RonTraceRecord::FORWARD, p, nodeId);
+}
+
+
+void PacketSentRecord (Ptr<RonTraceWriter> writer, Ptr<const Packet> p, uint32_t nodeId)
+{
+  writer->Write (RonTraceRecord::SEND, p, nodeId);
 }
 } //ns3 namespace
@@ -11,6 +11,7 @@
 #include "ron-helper.h"
 #include "ron-client.h"
 #include "ron-server.h"
+#include "ron-trace-file.h"
 
 #ifndef RON_TRACE_FUNCTIONS_H
 #define RON_TRACE_FUNCTIONS_H
@@ -22,6 +23,13 @@ namespace ns3 {
 void AckReceived (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p, uint32_t nodeId);
 void PacketForwarded (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p, uint32_t nodeId);
 void PacketSent (Ptr<OutputStreamWrapper> stream, Ptr<const Packet> p, uint32_t nodeId);
+/** Write the record as the line the text tracers above write for its event. */
+void WriteTraceRecord (Ptr<OutputStreamWrapper> stream, const RonTraceRecord & record);
+
+// binary versions, one fixed-size record per event
+void AckReceivedRecord (Ptr<RonTraceWriter> writer, Ptr<const Packet> p, uint32_t nodeId);
+void PacketForwardedRecord (Ptr<RonTraceWriter> writer, Ptr<const Packet> p, uint32_t nodeId);
+void PacketSentRecord (Ptr<RonTraceWriter> writer, Ptr<const Packet> p, uint32_t nodeId);
   
   //}; //class
 
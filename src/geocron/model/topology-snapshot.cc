@@ -0,0 +1,145 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "topology-snapshot.h"
+#include "ns3/ipv4-nix-vector-routing.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TopologySnapshot");
+
+TopologySnapshot::TopologySnapshot (NodeContainer nodes)
+{
+  m_nodes.reserve (nodes.GetN ());
+  for (NodeContainer::Iterator node = nodes.Begin (); node != nodes.End (); node++)
+    {
+      NodeState state;
+      state.node = *node;
+
+      for (uint32_t i = 0; i < (*node)->GetNApplications (); i++)
+        {
+          AppState app;
+          app.app = (*node)->GetApplication (i);
+          TimeValue time;
+          app.app->GetAttribute ("StartTime", time);
+          app.start = time.Get ();
+          app.app->GetAttribute ("StopTime", time);
+          app.stop = time.Get ();
+          state.apps.push_back (app);
+        }
+
+      Ptr<Ipv4> ipv4 = (*node)->GetObject<Ipv4> ();
+      if (ipv4)
+        {
+          for (uint32_t i = 0; i < ipv4->GetNInterfaces (); i++)
+            {
+              InterfaceState iface;
+              iface.up = ipv4->IsUp (i);
+              iface.forwarding = ipv4->IsForwarding (i);
+              iface.metric = ipv4->GetMetric (i);
+              state.interfaces.push_back (iface);
+            }
+        }
+
+      state.mobility = (*node)->GetObject<MobilityModel> ();
+      if (state.mobility)
+        {
+          state.position = state.mobility->GetPosition ();
+        }
+
+      m_nodes.push_back (state);
+    }
+
+  NS_LOG_INFO ("Took snapshot of " << m_nodes.size () << " nodes");
+}
+
+
+void
+TopologySnapshot::Restore ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  // restore all the interfaces at once so routing caches are only invalidated once
+  Ipv4NixVectorRouting::BeginTopologyChangeBatch ();
+
+  for (std::vector<NodeState>::iterator state = m_nodes.begin (); state != m_nodes.end (); state++)
+    {
+      Ptr<Node> node = state->node;
+
+      // applications are only ever appended, so everything after the snapshot's ones is new
+      while (node->GetNApplications () > state->apps.size ())
+        {
+          node->RemoveApplication (node->GetNApplications () - 1);
+        }
+      NS_ASSERT_MSG (node->GetNApplications () == state->apps.size (),
+                     "Node " << node->GetId () << " lost applications since the snapshot!");
+
+      for (std::vector<AppState>::iterator app = state->apps.begin (); app != state->apps.end (); app++)
+        {
+          NS_ASSERT_MSG (node->GetApplication (app - state->apps.begin ()) == app->app,
+                         "Node " << node->GetId () << " applications changed since the snapshot!");
+          app->app->SetStartTime (app->start);
+          app->app->SetStopTime (app->stop);
+          // Start does nothing until a started application has been Reset
+          app->app->Reset ();
+          Simulator::ScheduleWithContext (node->GetId (), Seconds (0.0), &Application::Start, app->app);
+        }
+
+      // drop any packets still queued or in flight when the last run stopped
+      for (uint32_t i = 0; i < node->GetNDevices (); i++)
+        {
+          node->GetDevice (i)->Reset ();
+        }
+
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      for (uint32_t i = 0; i < state->interfaces.size (); i++)
+        {
+          const InterfaceState & iface = state->interfaces[i];
+          if (ipv4->IsUp (i) != iface.up)
+            {
+              if (iface.up)
+                ipv4->SetUp (i);
+              else
+                ipv4->SetDown (i);
+            }
+          if (ipv4->IsForwarding (i) != iface.forwarding)
+            ipv4->SetForwarding (i, iface.forwarding);
+          if (ipv4->GetMetric (i) != iface.metric)
+            ipv4->SetMetric (i, iface.metric);
+        }
+
+      if (state->mobility)
+        {
+          state->mobility->SetPosition (state->position);
+        }
+    }
+
+  Ipv4NixVectorRouting::CommitTopologyChangeBatch ();
+}
+
+
+NodeContainer
+TopologySnapshot::GetNodes () const
+{
+  NodeContainer nodes;
+  for (std::vector<NodeState>::const_iterator state = m_nodes.begin (); state != m_nodes.end (); state++)
+    {
+      nodes.Add (state->node);
+    }
+  return nodes;
+}
+
+} //namespace ns3
@@ -0,0 +1,75 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef TOPOLOGY_SNAPSHOT_H
+#define TOPOLOGY_SNAPSHOT_H
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/mobility-module.h"
+
+#include <vector>
+
+namespace ns3 {
+
+/** The mutable state of a built topology that simulation runs change: which applications
+    each node has and their start/stop times, whether each Ipv4 interface is up and forwarding
+    (and its metric), and where each node is.
+    Restoring a snapshot taken before the first run rewinds the nodes to it between runs,
+    replacing resetting each application and unfailing each link by hand.
+    The nodes, devices, stacks and routes themselves are kept, as no run creates or destroys them. */
+class TopologySnapshot : public SimpleRefCount<TopologySnapshot>
+{
+public:
+  TopologySnapshot (NodeContainer nodes);
+
+  /** Remove the applications installed since the snapshot, reset the others and their
+      net devices so they start afresh in the next run, and restore the interfaces and positions.
+      Must not be called while the simulation runs, i.e. only before the first run or after Simulator::Destroy. */
+  void Restore ();
+
+  NodeContainer GetNodes () const;
+
+private:
+  struct AppState
+  {
+    Ptr<Application> app;
+    Time start;
+    Time stop;
+  };
+
+  struct InterfaceState
+  {
+    bool up;
+    bool forwarding;
+    uint16_t metric;
+  };
+
+  struct NodeState
+  {
+    Ptr<Node> node;
+    std::vector<AppState> apps;
+    std::vector<InterfaceState> interfaces;
+    Ptr<MobilityModel> mobility;
+    Vector position;
+  };
+
+  std::vector<NodeState> m_nodes;
+};
+
+} //namespace ns3
+#endif //TOPOLOGY_SNAPSHOT_H
@@ -11,6 +11,14 @@
 #include <iostream>
 #include <ctime>
 #include <map>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <unistd.h>
+
+#include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
 
 // Do not put your test classes in namespace ns3.  You may find it useful
 // to use the using directive to access the ns3 namespace directly
@@ -387,6 +395,64 @@ TestPeerTable::DoRun (void)
   table->RemovePeer ((*table->Begin ())->id);
   NS_TEST_ASSERT_MSG_EQ (table->IsInTable (table0->Begin ()), false, "testing IsInTable with Iterator false positive after removal");
 
+  //test copy-on-write mirrors
+  Ptr<RonPeerTable> mirror = newTable->Mirror ();
+  NS_TEST_ASSERT_MSG_EQ (mirror->IsShared (), true, "mirror should share the original's storage");
+  equality = *mirror == *newTable;
+  NS_TEST_ASSERT_MSG_EQ (equality, true, "mirror should have the original's peers");
+
+  mirror->RemovePeer (nodes.Get (0)->GetId ());
+  NS_TEST_ASSERT_MSG_EQ (mirror->IsShared (), false, "mirror should copy its storage when changed");
+  NS_TEST_ASSERT_MSG_EQ (newTable->IsInTable (nodes.Get (0)->GetId ()), true, "changing a mirror should not change the original");
+  NS_TEST_ASSERT_MSG_EQ (mirror->GetN (), newTable->GetN () - 1, "testing mirror size after removal");
+
+  //test subsets
+  std::vector<uint32_t> ids;
+  ids.push_back (nodes.Get (1)->GetId ());
+  ids.push_back (nodes.Get (2)->GetId ());
+  Ptr<RonPeerTable> subset = newTable->GetSubset (ids);
+  NS_TEST_ASSERT_MSG_EQ (subset->GetN (), 2, "testing subset size");
+  NS_TEST_ASSERT_MSG_EQ (subset->GetPeer (nodes.Get (1)->GetId ()), newTable->GetPeer (nodes.Get (1)->GetId ()),
+                         "subset should share the original's entries");
+
+  Ptr<RonPeerEntry> written = subset->GetPeerForWrite (nodes.Get (1)->GetId ());
+  written->lastContact = Seconds (42.0);
+  NS_TEST_ASSERT_MSG_NE (newTable->GetPeer (nodes.Get (1)->GetId ())->lastContact, Seconds (42.0),
+                         "writing the subset's entry should not change the original's");
+  NS_TEST_ASSERT_MSG_EQ (subset->GetPeerForWrite (nodes.Get (1)->GetId ()), written, "entry should only be copied once");
+
+  //entries a table added itself are shared once it's mirrored, as the master's are with the clients'
+  Ptr<RonPeerTable> original = Create<RonPeerTable> ();
+  uint32_t id4 = nodes.Get (4)->GetId ();
+  original->AddPeer (nodes.Get (4));
+  Ptr<RonPeerTable> clientView = original->Mirror ();
+  written = original->GetPeerForWrite (id4);
+  written->lastContact = Seconds (43.0);
+  NS_TEST_ASSERT_MSG_EQ (original->GetPeer (id4)->lastContact, Seconds (43.0), "writing an entry should change the table's");
+  NS_TEST_ASSERT_MSG_NE (clientView->GetPeer (id4)->lastContact, Seconds (43.0),
+                         "writing the original's entry should not change its mirror's");
+  NS_TEST_ASSERT_MSG_EQ (original->GetPeerForWrite (id4), written, "entry should only be copied once after mirroring");
+
+  //an entry added to two tables is shared by them, so writing through one mustn't change the other's
+  uint32_t id5 = nodes.Get (5)->GetId ();
+  Ptr<RonPeerEntry> sharedEntry = Create<RonPeerEntry> (nodes.Get (5));
+  Ptr<RonPeerTable> first = Create<RonPeerTable> ();
+  Ptr<RonPeerTable> second = Create<RonPeerTable> ();
+  first->AddPeer (sharedEntry);
+  second->AddPeer (sharedEntry);
+  written = first->GetPeerForWrite (id5);
+  written->lastContact = Seconds (44.0);
+  NS_TEST_ASSERT_MSG_EQ (first->GetPeer (id5)->lastContact, Seconds (44.0), "writing an added entry should change the table's");
+  NS_TEST_ASSERT_MSG_NE (second->GetPeer (id5)->lastContact, Seconds (44.0),
+                         "writing an entry added to two tables through one should not change the other's");
+  NS_TEST_ASSERT_MSG_NE (sharedEntry->lastContact, Seconds (44.0), "writing an added entry should not change the caller's");
+
+  //removing a peer that isn't there
+  NS_TEST_ASSERT_MSG_EQ (second->RemovePeer (nodes.Get (6)->GetId ()), false, "removing an absent peer should return false");
+  NS_TEST_ASSERT_MSG_EQ (second->GetN (), 1, "removing an absent peer should not change the table");
+  NS_TEST_ASSERT_MSG_EQ (second->RemovePeer (id5), true, "removing a present peer should return true");
+  NS_TEST_ASSERT_MSG_EQ (second->GetN (), 0, "testing table size after removal");
+
 
   /*TODO: test removal
   equality = table->RemovePeer (nodes.Get (4)->GetId ());
@@ -451,6 +517,23 @@ TestRonPath::DoRun (void)
   equality = *(*end->Begin ()) == (*(*Create<PeerDestination> (peers[0])->Begin ()));
   NS_TEST_ASSERT_MSG_EQ (equality, false, "testing PeerDestination Iterator false positive equality new copy");
 
+  //multiple peers form a set
+  Ptr<PeerDestination> both = Create<PeerDestination> (peers[0]);
+  both->AddPeer (peers[3]);
+  Ptr<PeerDestination> bothReversed = Create<PeerDestination> (peers[3]);
+  bothReversed->AddPeer (peers[0]);
+  bothReversed->AddPeer (peers[3]);
+  NS_TEST_ASSERT_MSG_EQ (bothReversed->GetN (), 2, "PeerDestination should ignore duplicate peers");
+  NS_TEST_ASSERT_MSG_EQ (both->HasPeer (peers[3]), true, "PeerDestination should have an added peer");
+  NS_TEST_ASSERT_MSG_EQ (both->HasPeer (peers.back ()), false, "PeerDestination has a peer never added");
+
+  equality = *both == *bothReversed;
+  NS_TEST_ASSERT_MSG_EQ (equality, true, "PeerDestination equality shouldn't depend on the order of its peers");
+  NS_TEST_ASSERT_MSG_EQ (both->GetHash (), bothReversed->GetHash (), "PeerDestination hash shouldn't depend on the order of its peers");
+
+  equality = *both == *start;
+  NS_TEST_ASSERT_MSG_EQ (equality, false, "PeerDestination equality false positive for a subset");
+
   equality = *(*start->Begin ()) == (*(*Create<PeerDestination> (peers[0])->Begin ()));
   NS_TEST_ASSERT_MSG_EQ (equality, true, "testing PeerDestination Iterator equality new copy");
 
@@ -467,6 +550,10 @@ TestRonPath::DoRun (void)
   Ptr<RonPath> path3 = Create<RonPath> (Create<RonPeerEntry> (nodes.Get (0)));
   Ptr<RonPath> path4 = Create<RonPath> (peers.back());
 
+  //a path caches its hash, so its hops can no longer gain peers
+  NS_TEST_ASSERT_MSG_EQ (start->IsImmutable (), true, "a destination added to a path should be immutable");
+  NS_TEST_ASSERT_MSG_EQ (both->IsImmutable (), false, "a destination outside of any path should be mutable");
+
   equality = *path0 == *path0;
   NS_TEST_ASSERT_MSG_EQ (equality, true, "testing RonPath equality with self");
 
@@ -615,6 +702,18 @@ TestRonPath::DoRun (void)
   equality = *path1 == *path2;
   NS_TEST_ASSERT_MSG_EQ (equality, true, "testing proper equality for reverse on separately built paths");
 
+  //one-hop paths from the master table's catalog are shared and immutable
+  Ptr<RonPath> shared0 = RonPeerTable::GetMaster ()->GetOneHopPath (peers[3], peers.back ());
+  Ptr<RonPath> shared1 = RonPeerTable::GetMaster ()->GetOneHopPath (peers[3], peers.back ());
+  NS_TEST_ASSERT_MSG_EQ (shared0, shared1, "catalog should return the same path object for the same peers");
+  NS_TEST_ASSERT_MSG_EQ (shared0->IsImmutable (), true, "catalog paths should be immutable");
+
+  Ptr<RonPath> built = Create<RonPath> (peers[3]);
+  built->AddHop (peers.back ());
+  equality = *shared0 == *built;
+  NS_TEST_ASSERT_MSG_EQ (equality, true, "catalog path should equal a separately built path");
+  NS_TEST_ASSERT_MSG_EQ (shared0->GetHash (), built->GetHash (), "catalog path should hash like a separately built path");
+
   //TODO: check reversing with complex paths
   //TODO: catting paths together
 }
@@ -664,17 +763,17 @@ TestRonPathHeuristic::DoRun (void)
 
   //we need to call GetBestPath before anything else as it will build all the available paths
   h0->BuildPaths (dest);
-  NS_TEST_ASSERT_MSG_NE (h0->m_masterLikelihoods->at (dest).size (), 0,
+  NS_TEST_ASSERT_MSG_NE (h0->m_table->GetNPaths (dest), 0,
                          "inner master likelihood table empty after BuildPaths");
 
-  NS_TEST_ASSERT_MSG_EQ (h0->m_masterLikelihoods->at (dest).size (), peers.size () - 2,
+  NS_TEST_ASSERT_MSG_EQ (h0->m_table->GetNPaths (dest), peers.size () - 2,
                          "testing size of inner master likelihood table after BuildPaths");
 
-  NS_TEST_ASSERT_MSG_EQ (h0->m_likelihoods.at (dest).size (), peers.size () - 2,
+  NS_TEST_ASSERT_MSG_EQ (h0->m_table->GetPaths (dest).size (), peers.size () - 2,
                          "testing size of inner likelihood table after BuildPaths");
 
-  NS_TEST_ASSERT_MSG_EQ ((*h0->m_masterLikelihoods)[dest][path]->GetN (), 1,
-                         "testing size of Likelihood object in m_masterLikelihoods");
+  NS_TEST_ASSERT_MSG_EQ (h0->m_table->GetNHeuristics (), 1,
+                         "testing number of heuristics in m_table");
 
   NS_TEST_ASSERT_MSG_EQ (h0->PathAttempted (path), false, "testing PathAttempted before GetBestPath");
 
@@ -684,23 +783,31 @@ TestRonPathHeuristic::DoRun (void)
   //set this path's LH to 2 and we should get it back
   h0->SetLikelihood (path, 2.0);
 
-  NS_TEST_ASSERT_MSG_EQ_TOL ((*h0->m_masterLikelihoods)[dest][path]->GetLh (), 2.0, 0.001,
-                             "m_masterLikelihoods was not set properly by SetLikelihood");
-  NS_TEST_ASSERT_MSG_EQ_TOL (h0->m_likelihoods[dest][path]->GetLh (), 2.0, 0.001,
-                             "m_likelihoods was not set properly by SetLikelihood");
+  NS_TEST_ASSERT_MSG_EQ_TOL (h0->m_table->GetAggregateLh (path), 2.0, 0.001,
+                             "aggregate likelihood was not set properly by SetLikelihood");
+  NS_TEST_ASSERT_MSG_EQ_TOL (h0->m_table->GetLh (path, h0->m_column), 2.0, 0.001,
+                             "heuristic likelihood was not set properly by SetLikelihood");
 
   Ptr<RonPath> path2 = h0->GetBestPath (dest);
 
-  NS_TEST_ASSERT_MSG_EQ_TOL (h0->m_likelihoods[dest][path]->GetLh (), 2.0, 0.001,
-                             "m_likelihoods should not be changed by GetBestPath");
-  NS_TEST_ASSERT_MSG_EQ_TOL ((*h0->m_masterLikelihoods)[dest][path]->GetLh (), 2.0, 0.001,
-                             "m_masterLikelihoods should not be changed by GetBestPath");
+  NS_TEST_ASSERT_MSG_EQ_TOL (h0->m_table->GetLh (path, h0->m_column), 2.0, 0.001,
+                             "heuristic likelihood should not be changed by GetBestPath");
+  NS_TEST_ASSERT_MSG_EQ_TOL (h0->m_table->GetAggregateLh (path), 2.0, 0.001,
+                             "aggregate likelihood should not be changed by GetBestPath");
 
   equality = *path == *path2;
-  NS_TEST_ASSERT_MSG_EQ (equality, true, "should have gotten back highest likelihood path we just set, but instead got LH=" << h0->m_likelihoods[dest][path2]->GetLh ());
+  NS_TEST_ASSERT_MSG_EQ (equality, true, "should have gotten back highest likelihood path we just set, but instead got LH=" << h0->m_table->GetLh (path2, h0->m_column));
 
   NS_TEST_ASSERT_MSG_EQ (h0->PathAttempted (path), true, "testing PathAttempted after GetBestPath");
 
+  //lowering the best path's LH should move it off the top of the path heap
+  h0->SetLikelihood (path, 0.5);
+  path2 = h0->GetBestPath (dest);
+  equality = *path == *path2;
+  NS_TEST_ASSERT_MSG_EQ (equality, false, "GetBestPath returned a path whose LH was just lowered");
+  NS_TEST_ASSERT_MSG_EQ_TOL (h0->m_table->GetAggregateLh (path2), 1.0, 0.001,
+                             "GetBestPath should return one of the remaining LH 1 paths");
+
   equality = *path->GetDestination () == *dest;
   NS_TEST_ASSERT_MSG_EQ (equality, true, "testing GetBestPath with basic path");
 
@@ -708,12 +815,12 @@ TestRonPathHeuristic::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (h0->GetLikelihood (path), 1.0, 0.01, "testing GetLikelihood before any feedback");
 
   h0->NotifyTimeout (path, Simulator::Now ());
-  NS_TEST_ASSERT_MSG_EQ_TOL (h0->m_likelihoods[dest][path]->GetLh (), 0.0, 0.01, "testing m_likelihoods after timeout feedback");
+  NS_TEST_ASSERT_MSG_EQ_TOL (h0->m_table->GetLh (path, h0->m_column), 0.0, 0.01, "testing heuristic likelihood after timeout feedback");
 
-  NS_TEST_ASSERT_MSG_EQ_TOL ((*h0->m_masterLikelihoods)[dest][path]->GetLh (), 0.0, 0.01, "testing m_masterLikelihoods after timeout feedback");
+  NS_TEST_ASSERT_MSG_EQ_TOL (h0->m_table->GetAggregateLh (path), 0.0, 0.01, "testing aggregate likelihood after timeout feedback");
 
   h0->NotifyAck (path, Simulator::Now ());
-  NS_TEST_ASSERT_MSG_EQ_TOL (h0->m_likelihoods[dest][path]->GetLh (), 1.0, 0.01, "testing m_likelihoods after ACK feedback");
+  NS_TEST_ASSERT_MSG_EQ_TOL (h0->m_table->GetLh (path, h0->m_column), 1.0, 0.01, "testing heuristic likelihood after ACK feedback");
 
   ////////////////////////////////////////////////////////////////////////////////
   //we check to make sure that we actually get some peers from the heuristic
@@ -736,9 +843,9 @@ TestRonPathHeuristic::DoRun (void)
 
           //assert that none of the paths are exactly LH 1 since we're also using h0
           totalLh = 0;
-          totalLh += (*h0->m_masterLikelihoods)[dest][path]->GetLh ();
+          totalLh += h0->m_table->GetAggregateLh (path);
 
-          //totalLh += h0->m_likelihoods[dest][path]->GetLh ();
+          //totalLh += h0->m_table->GetLh (path, h0->m_column);
 
           NS_TEST_ASSERT_MSG_GT (totalLh, 0.99, /*0.01,*/ "likelihood should be 1");
 
@@ -774,19 +881,19 @@ TestRonPathHeuristic::DoRun (void)
                          pathHasher (Create<RonPath> (Create<PeerDestination> (Create<RonPeerEntry> (nodes.Get (0))))),
                          "testing PathHasher false positive new copy");
 
-  RonPathHeuristic::MasterPathLikelihoodInnerTable * masterInner = &(*h0->m_masterLikelihoods)[dest];
-  
-  NS_ASSERT_MSG (masterInner == &(*h0->m_masterLikelihoods)[dest], "why aren't the inner tables in the same location?");
+  uint32_t nPaths = h0->m_table->GetNPaths (path->GetDestination ());
+  h0->m_table->AddPath (path);
+  h0->m_table->AddPath (Create<RonPath> (Create<PeerDestination> (Create<RonPeerEntry> (nodes.Get (nodes.GetN () - 1)))));
+  NS_TEST_ASSERT_MSG_EQ (h0->m_table->GetNPaths (path->GetDestination ()), nPaths + 1,
+                         "adding a fresh copy of a path should not add another row to m_table");
 
-  Ptr<RonPathHeuristic::Likelihood> lh = Create<RonPathHeuristic::Likelihood> ();
-  (*masterInner)[path] = lh;
-  lh->AddLh (0.5);
+  h0->m_table->SetLh (path, h0->m_column, 0.5);
 
-  NS_TEST_ASSERT_MSG_EQ_TOL ((*h0->m_masterLikelihoods)[dest][path]->GetLh (), 0.5,
-                             0.01, "testing m_masterLikelihoods accessing with same keys");
+  NS_TEST_ASSERT_MSG_EQ_TOL (h0->m_table->GetAggregateLh (path), 0.5,
+                             0.01, "testing m_table accessing with same keys");
 
-  NS_TEST_ASSERT_MSG_EQ_TOL ((*h0->m_masterLikelihoods)[Create<PeerDestination> (peers.back())][path]->GetLh (), 0.5,
-                             0.01, "testing m_masterLikelihoods accessing with fresh copies of keys");
+  NS_TEST_ASSERT_MSG_EQ_TOL (h0->m_table->GetAggregateLh (Create<RonPath> (Create<PeerDestination> (peers.back()))), 0.5,
+                             0.01, "testing m_table accessing with fresh copies of keys");
   //path->AddHop (
 
   //TODO: multiple destinations
@@ -841,12 +948,10 @@ TestAggregateRonPathHeuristic::DoRun (void)
   random->BuildPaths (dest);
   random->UpdateLikelihoods (dest);
 
-  NS_TEST_ASSERT_MSG_EQ ((*random->m_masterLikelihoods)[dest][path]->GetN (), 2,
-                         "aggregate heuristic should have two entries in m_masterLikelihoods Likelihood");
-  equality = NULL != random->m_likelihoods[dest][path];
-  NS_TEST_ASSERT_MSG_EQ (equality, true,
-                         "aggregate heuristic should have non-null entry in m_likelihoods");
-  //TODO: look at the m_masterLikelihoods
+  NS_TEST_ASSERT_MSG_EQ (random->m_table->GetNHeuristics (), 2,
+                         "aggregate heuristic should have two columns in m_table");
+  NS_TEST_ASSERT_MSG_EQ (random->m_table->HasPath (path), true,
+                         "aggregate heuristic should have an entry in m_table");
 
   //If we tell the heuristics that some region failed to work, we should never see any
   //peers from that region since we only have one there.
@@ -854,30 +959,29 @@ TestAggregateRonPathHeuristic::DoRun (void)
 
   //we want to check with a different path to make sure that it affected both peers
 
-  //as random is top-level, its m_likelihoods Likelihood aggregates all the others
-  double oldLh = random->m_likelihoods[dest][path]->GetLh ();
+  //the aggregate likelihood sums random's and newreg's
+  double oldLh = random->m_table->GetAggregateLh (path);
   NS_TEST_ASSERT_MSG_GT (oldLh, 1.0, "checking range of random's assigned LH, though this could theoretically happen once in a blue moon?");
   NS_TEST_ASSERT_MSG_LT (oldLh, 2.0, "checking range of random's assigned LH");
   
-  NS_TEST_ASSERT_MSG_EQ_TOL (newreg->m_likelihoods[dest][path]->GetLh (), 1.0, 0.01,
-                             "m_likelihoods should be 1.0 for new region");
+  NS_TEST_ASSERT_MSG_EQ_TOL (newreg->m_table->GetLh (path, newreg->m_column), 1.0, 0.01,
+                             "heuristic likelihood should be 1.0 for new region");
   
   //get master likelihood and verify before and after timeout
   double totalLh = 0;
-  Ptr<RonPathHeuristic::Likelihood> lh = (*random->m_masterLikelihoods)[dest][path];
-
-  NS_TEST_ASSERT_MSG_EQ_TOL (lh->GetLh (), oldLh, 0.01, "testing master LH before NotifyTimeout");
+  NS_TEST_ASSERT_MSG_EQ_TOL (random->m_table->GetLh (path, random->m_column) +
+                             newreg->m_table->GetLh (path, newreg->m_column), oldLh, 0.01, "testing master LH before NotifyTimeout");
 
   // TIMEOUT
   random->NotifyTimeout (path, Simulator::Now ());
 
-  NS_TEST_ASSERT_MSG_EQ_TOL (newreg->m_likelihoods[dest][path]->GetLh (), 0.0, 0.01,
-                             "m_likelihoods should now be 0.0 for target region");
+  NS_TEST_ASSERT_MSG_EQ_TOL (newreg->m_table->GetLh (path, newreg->m_column), 0.0, 0.01,
+                             "heuristic likelihood should now be 0.0 for target region");
 
-  NS_TEST_ASSERT_MSG_EQ (random->m_likelihoods[dest][path]->GetLh (), 0,
+  NS_TEST_ASSERT_MSG_EQ (random->m_table->GetAggregateLh (path), 0,
                              "random's LH, which is whole aggregate's, should be 0 after NotifyTimeout");
 
-  NS_TEST_ASSERT_MSG_EQ (lh->GetLh (), 0, "testing master LH after NotifyTimeout");
+  NS_TEST_ASSERT_MSG_EQ (random->m_table->GetAggregateLh (path), 0, "testing aggregate LH after NotifyTimeout");
 
   uint32_t npaths = 0, nExpectedPeers = GridGenerator::GetNodes ().GetN () - 3;
   Ptr<RonPath> lastPath = path;
@@ -897,15 +1001,15 @@ TestAggregateRonPathHeuristic::DoRun (void)
           //check that NewRegion worked properly
           if ((*(*path->Begin ())->Begin ())->region == "BL")
             {
-              NS_TEST_ASSERT_MSG_EQ (newreg->m_likelihoods[dest][path]->GetLh (), 0.0,
+              NS_TEST_ASSERT_MSG_EQ (newreg->m_table->GetLh (path, newreg->m_column), 0.0,
                                      "we got a path using the NotifyTimeout region and LH != 0");
-              NS_TEST_ASSERT_MSG_LT ((*newreg->m_masterLikelihoods)[dest][path]->GetLh (), 1.0,
+              NS_TEST_ASSERT_MSG_LT (newreg->m_table->GetAggregateLh (path), 1.0,
                                      "we got a path using the NotifyTimeout region and master LH >= 1.0");
             }
 
           //assert that none of the paths are exactly LH 1 since we're also using random
-          totalLh = (*random->m_masterLikelihoods)[dest][path]->GetLh ();
-          double regLh = (newreg->m_likelihoods)[dest][path]->GetLh ();
+          totalLh = random->m_table->GetAggregateLh (path);
+          double regLh = newreg->m_table->GetLh (path, newreg->m_column);
 
           NS_TEST_ASSERT_MSG_GT (totalLh, 0.0 + regLh, /*0.01,*/ "likelihood should be an aggregate and features random");
           NS_TEST_ASSERT_MSG_LT (totalLh, 1.0 + regLh, /*0.01,*/ "likelihood should be < 2 as 2 heuristics");
@@ -1148,6 +1252,25 @@ TestRonHeader::DoRun (void)
   equality = *head2->GetPath () == *path;
   NS_TEST_ASSERT_MSG_EQ (equality, true, "Checking GetPath equality");
 
+  //short paths of known peers come from the master table's catalog instead of being rebuilt
+  Ptr<RonPeerTable> master = RonPeerTable::GetMaster ();
+  NS_TEST_ASSERT_MSG_EQ (head2->GetPath (), master->GetOneHopPath (master->GetPeerByAddress (addr1), master->GetPeerByAddress (addr2)),
+                         "one-hop path from header should be the catalog's");
+  NS_TEST_ASSERT_MSG_EQ (head1->GetPath (), master->GetDirectPath (master->GetPeerByAddress (addr1)),
+                         "direct path from header should be the catalog's");
+
+  //destinations outside the master table can be found in another table
+  Ptr<RonPeerEntry> outsider = Create<RonPeerEntry> ();
+  outsider->id = 12345;
+  outsider->address = Ipv4Address ("233.233.233.233");
+  Ptr<RonPeerTable> outsiders = Create<RonPeerTable> ();
+  outsiders->AddPeer (outsider);
+  RonHeader outsiderHead (outsider->address, addr1);
+  NS_TEST_ASSERT_MSG_EQ ((*outsiderHead.GetPath (outsiders)->GetDestination ()->Begin ())->id, outsider->id,
+                         "GetPath should find the destination in the given table");
+  NS_TEST_ASSERT_MSG_EQ ((*outsiderHead.GetPath ()->GetDestination ()->Begin ())->address, outsider->address,
+                         "unknown destination should still have the header's address");
+
   equality = *head0->GetPath () == *head2->GetPath ();
   NS_TEST_ASSERT_MSG_EQ (equality, false, "Checking GetPath inequality");
 
@@ -1186,6 +1309,99 @@ TestRonHeader::DoRun (void)
 }
 
 
+////////////////////////////////////////////////////////////////////////////////
+class TestRonTraceFile : public TestCase
+{
+public:
+  TestRonTraceFile ();
+  virtual ~TestRonTraceFile ();
+
+private:
+  virtual void DoRun (void);
+  void AddRecord (Ptr<RonTraceWriter> writer, RonTraceRecord::EventType event, uint32_t node, bool indirect, double time);
+};
+
+
+TestRonTraceFile::TestRonTraceFile ()
+  : TestCase ("Test writing, reading, and summarizing binary RON traces")
+{
+}
+
+
+TestRonTraceFile::~TestRonTraceFile ()
+{}
+
+
+void
+TestRonTraceFile::AddRecord (Ptr<RonTraceWriter> writer, RonTraceRecord::EventType event, uint32_t node, bool indirect, double time)
+{
+  RonTraceRecord record;
+  std::memset (&record, 0, sizeof (record));
+  record.event = event;
+  record.node = node;
+  record.indirect = indirect;
+  record.time = Seconds (time).GetNanoSeconds ();
+  writer->Write (record);
+}
+
+
+void
+TestRonTraceFile::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("ron-trace-test.bin");
+
+  // buffer fewer records than we write so that the buffer is flushed midway
+  Ptr<RonTraceWriter> writer = Create<RonTraceWriter> (filename, 3);
+
+  Ptr<Packet> packet = Create<Packet> ();
+  RonHeader head (Ipv4Address ("10.0.0.2"), Ipv4Address ("10.0.0.3"));
+  head.SetOrigin (Ipv4Address ("10.0.0.1"));
+  head.SetSeq (7);
+  packet->AddHeader (head);
+  writer->Write (RonTraceRecord::FORWARD, packet, 5);
+
+  // node 1 reaches the server directly, node 2 only through the overlay, node 3 not at all
+  AddRecord (writer, RonTraceRecord::SEND, 1, false, 2.0);
+  AddRecord (writer, RonTraceRecord::SEND, 2, false, 2.0);
+  AddRecord (writer, RonTraceRecord::SEND, 3, false, 2.0);
+  AddRecord (writer, RonTraceRecord::ACK, 1, false, 2.12);
+  AddRecord (writer, RonTraceRecord::SEND, 2, true, 3.0);
+  AddRecord (writer, RonTraceRecord::ACK, 2, true, 3.34);
+  NS_TEST_ASSERT_MSG_EQ (writer->GetNRecords (), 7, "writer lost count of its records");
+  writer->Flush ();
+
+  Ptr<RonTraceReader> reader = Create<RonTraceReader> (filename);
+  NS_TEST_ASSERT_MSG_EQ (reader->GetNRecords (), 7, "reader found wrong number of records");
+
+  const RonTraceRecord & forward = reader->GetRecord (0);
+  NS_TEST_ASSERT_MSG_EQ ((int)forward.event, (int)RonTraceRecord::FORWARD, "wrong event type read back");
+  NS_TEST_ASSERT_MSG_EQ (forward.node, 5, "wrong node read back");
+  NS_TEST_ASSERT_MSG_EQ ((bool)forward.indirect, true, "forwarded packet should be indirect");
+  NS_TEST_ASSERT_MSG_EQ (Ipv4Address (forward.origin), Ipv4Address ("10.0.0.1"), "wrong origin read back");
+  NS_TEST_ASSERT_MSG_EQ (Ipv4Address (forward.finalDest), Ipv4Address ("10.0.0.2"), "wrong final destination read back");
+  NS_TEST_ASSERT_MSG_EQ (Ipv4Address (forward.nextDest), Ipv4Address ("10.0.0.3"), "wrong next destination read back");
+  NS_TEST_ASSERT_MSG_EQ (forward.seq, 7, "wrong sequence number read back");
+  NS_TEST_ASSERT_MSG_EQ (reader->GetRecord (6).time, Seconds (3.34).GetNanoSeconds (), "wrong time read back");
+
+  RonTraceSummary summary = reader->Summarize (0.1);
+  NS_TEST_ASSERT_MSG_EQ (summary.nNodes, 3, "wrong number of reporting nodes");
+  NS_TEST_ASSERT_MSG_EQ (summary.nAcks, 2, "wrong number of ACKed nodes");
+  NS_TEST_ASSERT_MSG_EQ (summary.nDirectAcks, 1, "wrong number of directly ACKed nodes");
+  NS_TEST_ASSERT_MSG_EQ (summary.nSends, 4, "wrong number of sends");
+  NS_TEST_ASSERT_MSG_EQ (summary.nForwards, 1, "wrong number of forwards");
+  NS_TEST_ASSERT_MSG_EQ_TOL (summary.GetAckRatio (), 2.0 / 3, 0.0001, "wrong ACK ratio");
+  NS_TEST_ASSERT_MSG_EQ_TOL (summary.GetOverlayImprovement (), 100.0, 0.0001, "wrong overlay improvement");
+
+  NS_TEST_ASSERT_MSG_EQ (summary.ackTimes.size (), 2, "should have one time slice per ACK");
+  NS_TEST_ASSERT_MSG_EQ_TOL (summary.ackTimes[0], 2.1, 0.0001, "ACK time not rounded to resolution");
+  NS_TEST_ASSERT_MSG_EQ_TOL (summary.ackTimes[1], 3.3, 0.0001, "ACK time not rounded to resolution");
+  NS_TEST_ASSERT_MSG_EQ_TOL (summary.ackRatios[0], 1.0 / 3, 0.0001, "wrong ACK ratio over time");
+  NS_TEST_ASSERT_MSG_EQ_TOL (summary.ackRatios[1], 2.0 / 3, 0.0001, "ACK ratio over time not cumulative");
+
+  std::remove (filename.c_str ());
+}
+
+
 ////////////////////////////////////////////////////////////////////////////////
 
 class TestAngleRonPathHeuristic : public TestCase
@@ -1461,6 +1677,206 @@ TestDistRonPathHeuristic::DoRun (void)
 }
 
 
+class TestBatchLikelihoods : public TestCase
+{
+public:
+  TestBatchLikelihoods ();
+  virtual ~TestBatchLikelihoods ();
+
+private:
+  virtual void DoRun (void);
+};
+
+
+TestBatchLikelihoods::TestBatchLikelihoods ()
+  : TestCase ("Test batch likelihoods of geometric heuristics against their per-path ones")
+{
+}
+
+TestBatchLikelihoods::~TestBatchLikelihoods ()
+{
+}
+
+void
+TestBatchLikelihoods::DoRun (void)
+{
+  const char * heuristicNames[] = {"ns3::AngleRonPathHeuristic", "ns3::OrthogonalRonPathHeuristic",
+                                   "ns3::DistRonPathHeuristic", "ns3::ClosestFirstRonPathHeuristic",
+                                   "ns3::FurtherestFirstRonPathHeuristic"};
+  Ptr<PeerDestination> dest = Create<PeerDestination> (GridGenerator::GetPeer (4, 4));
+
+  for (uint32_t h = 0; h < sizeof (heuristicNames) / sizeof (heuristicNames[0]); h++)
+    {
+      ObjectFactory factory;
+      factory.SetTypeId (heuristicNames[h]);
+      Ptr<RonPathHeuristic> heuristic = factory.Create<RonPathHeuristic> ();
+      heuristic->SetPeerTable (GridGenerator::GetAllPeers ());
+      heuristic->SetSourcePeer (GridGenerator::GetPeer (0, 0));
+      heuristic->MakeTopLevel ();
+      heuristic->BuildPaths (dest);
+
+      // previous attempts change the likelihoods of some heuristics
+      heuristic->NotifyTimeout (heuristic->GetBestPath (dest), Simulator::Now ());
+
+      const std::vector<Ptr<RonPath> > & paths = heuristic->m_table->GetPaths (dest);
+      std::vector<double> likelihoods;
+      bool batched = heuristic->GetLikelihoods (*dest->Begin (), paths, heuristic->m_table->GetPeerLocations (dest),
+                                                likelihoods);
+      NS_TEST_ASSERT_MSG_EQ (batched, true, heuristicNames[h] << " should compute likelihoods in batches");
+      NS_TEST_ASSERT_MSG_EQ (likelihoods.size (), paths.size (), "need one batch likelihood per path");
+
+      for (uint32_t i = 0; i < paths.size (); i++)
+        NS_TEST_ASSERT_MSG_EQ_TOL (likelihoods[i], heuristic->GetLikelihood (paths[i]), 1e-12,
+                                   heuristicNames[h] << " batch likelihood differs for path " << i);
+      heuristic->Clear ();
+    }
+}
+
+
+class TestCastRonPathHeuristic : public TestCase
+{
+public:
+  TestCastRonPathHeuristic ();
+  virtual ~TestCastRonPathHeuristic ();
+
+private:
+  virtual void DoRun (void);
+};
+
+
+TestCastRonPathHeuristic::TestCastRonPathHeuristic ()
+  : TestCase ("Test anycast and multicast path selection of RonPathHeuristic")
+{
+}
+
+TestCastRonPathHeuristic::~TestCastRonPathHeuristic ()
+{
+}
+
+void
+TestCastRonPathHeuristic::DoRun (void)
+{
+  Ptr<RonPathHeuristic> heuristic = CreateObject<DistRonPathHeuristic> ();
+  heuristic->SetPeerTable (GridGenerator::GetAllPeers ());
+  heuristic->SetSourcePeer (GridGenerator::GetPeer (0, 0));
+  heuristic->MakeTopLevel ();
+
+  Ptr<RonPeerEntry> server0 = GridGenerator::GetPeer (4, 4);
+  Ptr<RonPeerEntry> server1 = GridGenerator::GetPeer (0, 4);
+  Ptr<PeerDestination> servers = Create<PeerDestination> (server0);
+  servers->AddPeer (server1);
+
+  //anycast takes the better of the best paths to each server
+  Ptr<RonPath> anycast = heuristic->GetBestAnycastPath (servers);
+  Ptr<PeerDestination> reached = anycast->GetDestination ();
+  NS_TEST_ASSERT_MSG_EQ (reached->GetN (), 1, "anycast path should end at a single server");
+  NS_TEST_ASSERT_MSG_EQ (servers->HasPeer (*reached->Begin ()), true, "anycast path should end at one of the servers");
+
+  Ptr<RonPeerTable> master = RonPeerTable::GetMaster ();
+  double bestLh0 = heuristic->m_table->GetAggregateLh (heuristic->FindBestPath (master->GetDestination (server0)));
+  double bestLh1 = heuristic->m_table->GetAggregateLh (heuristic->FindBestPath (master->GetDestination (server1)));
+  NS_TEST_ASSERT_MSG_EQ_TOL (heuristic->m_table->GetAggregateLh (anycast), std::max (bestLh0, bestLh1), 1e-12,
+                             "anycast path should be the most likely of the servers' best paths");
+
+  heuristic->NotifyTimeout (anycast, Simulator::Now ());
+  Ptr<RonPath> nextAnycast = heuristic->GetBestAnycastPath (servers);
+  bool equality = *nextAnycast == *anycast;
+  NS_TEST_ASSERT_MSG_EQ (equality, false, "anycast shouldn't choose a path that timed out");
+
+  //multicast goes through one peer that sends to every server
+  Ptr<RonPath> multicast = heuristic->GetBestMulticastPath (servers);
+  NS_TEST_ASSERT_MSG_EQ (multicast->GetN (), 2, "multicast path should have one overlay hop");
+  equality = *multicast->GetDestination () == *servers;
+  NS_TEST_ASSERT_MSG_EQ (equality, true, "multicast path should end at all the servers");
+  Ptr<RonPeerEntry> forwarder = *(*multicast->Begin ())->Begin ();
+  NS_TEST_ASSERT_MSG_EQ (servers->HasPeer (forwarder), false, "multicast shouldn't forward through a server");
+
+  heuristic->NotifyTimeout (multicast, Simulator::Now ());
+  Ptr<RonPath> nextMulticast = heuristic->GetBestMulticastPath (servers);
+  equality = *nextMulticast == *multicast;
+  NS_TEST_ASSERT_MSG_EQ (equality, false, "multicast shouldn't choose a path that timed out");
+
+  heuristic->Clear ();
+}
+
+
+class TestMultiHopRonPathHeuristic : public TestCase
+{
+public:
+  TestMultiHopRonPathHeuristic ();
+  virtual ~TestMultiHopRonPathHeuristic ();
+
+private:
+  virtual void DoRun (void);
+};
+
+
+TestMultiHopRonPathHeuristic::TestMultiHopRonPathHeuristic ()
+  : TestCase ("Test building multi-hop paths as others time out")
+{
+}
+
+TestMultiHopRonPathHeuristic::~TestMultiHopRonPathHeuristic ()
+{
+}
+
+void
+TestMultiHopRonPathHeuristic::DoRun (void)
+{
+  Ptr<PeerDestination> dest = Create<PeerDestination> (GridGenerator::GetPeer (4, 4));
+  Ptr<RonPathHeuristic> heuristic = CreateObject<DistRonPathHeuristic> ();
+  heuristic->SetPeerTable (GridGenerator::GetAllPeers ());
+  heuristic->SetSourcePeer (GridGenerator::GetPeer (0, 0));
+  heuristic->MakeTopLevel ();
+
+  //only one-hop paths by default
+  Ptr<RonPath> path = heuristic->GetBestPath (dest);
+  uint32_t nOneHop = heuristic->m_table->GetNPaths (dest);
+  heuristic->NotifyTimeout (path, Simulator::Now ());
+  NS_TEST_ASSERT_MSG_EQ (heuristic->m_table->GetNPaths (dest), nOneHop, "paths expanded with MaxHops of 1");
+  heuristic->Clear ();
+
+  heuristic = CreateObject<DistRonPathHeuristic> ();
+  heuristic->SetAttribute ("MaxHops", UintegerValue (2));
+  heuristic->SetAttribute ("BeamWidth", UintegerValue (2));
+  heuristic->SetAttribute ("PathBudget", UintegerValue (3));
+  heuristic->SetPeerTable (GridGenerator::GetAllPeers ());
+  heuristic->SetSourcePeer (GridGenerator::GetPeer (0, 0));
+  heuristic->MakeTopLevel ();
+
+  path = heuristic->GetBestPath (dest);
+  heuristic->NotifyTimeout (path, Simulator::Now ());
+  const std::vector<Ptr<RonPath> > & paths = heuristic->m_table->GetPaths (dest);
+  NS_TEST_ASSERT_MSG_EQ (paths.size (), nOneHop + 2, "timeout should add BeamWidth two-hop paths");
+
+  for (uint32_t i = nOneHop; i < paths.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (paths[i]->GetN (), 3, "expanded path should go through one more peer");
+      bool equality = **paths[i]->Begin () == **path->Begin ();
+      NS_TEST_ASSERT_MSG_EQ (equality, true, "expanded path should start like the one that timed out");
+      Ptr<RonPeerEntry> relay = *(*(paths[i]->Begin () + 1))->Begin ();
+      NS_TEST_ASSERT_MSG_EQ ((*path->Begin ())->HasPeer (relay) or dest->HasPeer (relay), false,
+                             "expanded path shouldn't revisit a peer");
+      NS_TEST_ASSERT_MSG_EQ_TOL (heuristic->m_table->GetAggregateLh (paths[i]),
+                                 heuristic->GetMultiHopLikelihood (paths[i]), 1e-12,
+                                 "expanded path should have the product of its peers' likelihoods");
+      NS_TEST_ASSERT_MSG_GT (heuristic->m_table->GetAggregateLh (paths[i]), 0.0,
+                             "expanded path should be worth trying");
+    }
+
+  //two-hop paths have the most peers allowed, and the budget runs out
+  Ptr<RonPath> twoHop = paths[nOneHop];
+  heuristic->NotifyTimeout (twoHop, Simulator::Now ());
+  NS_TEST_ASSERT_MSG_EQ (heuristic->m_table->GetNPaths (dest), nOneHop + 2, "path expanded past MaxHops");
+
+  heuristic->NotifyTimeout (heuristic->GetBestPath (dest), Simulator::Now ());
+  heuristic->NotifyTimeout (heuristic->GetBestPath (dest), Simulator::Now ());
+  NS_TEST_ASSERT_MSG_EQ (heuristic->m_table->GetNPaths (dest), nOneHop + 3, "paths expanded past PathBudget");
+
+  heuristic->Clear ();
+}
+
+
 class TestGeocronExperiment : public TestCase
 {
 public:
@@ -1487,6 +1903,471 @@ void TestGeocronExperiment::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ (GetNodeDegree (nodes.Get (0)), 2, "corner node doesn't have degree 2!");
   NS_TEST_ASSERT_MSG_EQ (GetNodeDegree (nodes.Get (1)), 4, "interior node doesn't have degree 4!");
   NS_TEST_ASSERT_MSG_EQ (GetNodeDegree (nodes.Get (2)), 3, "edge node doesn't have degree 3!");
+
+  //test failing and unfailing a batch of nodes/links
+  FailureSet failures;
+  Ptr<Ipv4> failedNodeIpv4 = nodes.Get (0)->GetObject<Ipv4> ();
+  Ptr<Ipv4> failedIfaceIpv4 = nodes.Get (1)->GetObject<Ipv4> ();
+  failures.AddNode (nodes.Get (0));
+  failures.AddIpv4 (failedIfaceIpv4, 1);
+
+  failures.Apply ();
+  NS_TEST_ASSERT_MSG_EQ (failedNodeIpv4->IsUp (1), false, "failed node's interface still up after Apply");
+  NS_TEST_ASSERT_MSG_EQ (failedIfaceIpv4->IsUp (1), false, "failed interface still up after Apply");
+  NS_TEST_ASSERT_MSG_EQ (failedIfaceIpv4->IsUp (2), true, "non-failed interface went down after Apply");
+
+  failures.Unapply (Seconds (30.0));
+  NS_TEST_ASSERT_MSG_EQ (failedNodeIpv4->IsUp (1), true, "failed node's interface still down after Unapply");
+  NS_TEST_ASSERT_MSG_EQ (failedIfaceIpv4->IsUp (1), true, "failed interface still down after Unapply");
+  NS_TEST_ASSERT_MSG_EQ (failures.GetNodes ().GetN (), 1, "FailureSet should remember its nodes after Unapply");
+  NS_TEST_ASSERT_MSG_EQ (failures.GetIpv4Interfaces ().GetN (), 1, "FailureSet should remember its interfaces after Unapply");
+
+  //test the spatial index of nodes used to find disaster nodes
+  Ptr<RegionHelper> regionHelper = CreateObject<RegionHelper> ();
+  NodeContainer gridNodes;
+  for (uint32_t i = 0; i < 5; i++)
+    for (uint32_t j = 0; j < 5; j++)
+      {
+        gridNodes.Add (GridGenerator::GetNode (i, j));
+        regionHelper->AddNode (GridGenerator::GetNode (i, j), GridGenerator::GetPeer (i, j)->region);
+      }
+
+  NS_TEST_ASSERT_MSG_EQ (regionHelper->GetNodesInRegion ("TL").GetN (), 4, "wrong number of nodes in region TL");
+  NS_TEST_ASSERT_MSG_EQ (regionHelper->GetNodesInRegion ("BR").GetN (), 9, "wrong number of nodes in region BR");
+  NS_TEST_ASSERT_MSG_EQ (regionHelper->GetNodesInRegion ("nowhere").GetN (), 0, "found nodes in unknown region");
+
+  Vector center = GetLocation (GridGenerator::GetNode (2, 2));
+  NS_TEST_ASSERT_MSG_EQ (regionHelper->GetNodesInRadius (center, 0.0).Get (0), GridGenerator::GetNode (2, 2),
+                         "zero radius should only find the node at the center");
+
+  // compare against a linear scan for radii smaller and larger than the cells
+  double radii[] = {0.0, 0.5, 1.3, 2.0, 3.7, 100.0};
+  for (uint32_t r = 0; r < sizeof (radii) / sizeof (double); r++)
+    {
+      uint32_t expected = 0;
+      for (NodeContainer::Iterator node = gridNodes.Begin (); node != gridNodes.End (); node++)
+        if (CalculateDistance (GetLocation (*node), center) <= radii[r])
+          expected++;
+      NS_TEST_ASSERT_MSG_EQ (regionHelper->GetNodesInRadius (center, radii[r]).GetN (), expected,
+                             "spatial index disagrees with linear scan for radius " << radii[r]);
+    }
+  NS_TEST_ASSERT_MSG_EQ (regionHelper->GetNodesInRadius (center, 100.0).GetN (), 25, "huge radius should find all nodes");
+
+  //test rewinding the nodes to a snapshot after failing some and installing a server
+  Ptr<TopologySnapshot> snapshot = Create<TopologySnapshot> (gridNodes);
+  NS_TEST_ASSERT_MSG_EQ (snapshot->GetNodes ().GetN (), 25, "snapshot should have all the nodes");
+
+  Ptr<Node> serverNode = GridGenerator::GetNode (1, 1);
+  uint32_t nApps = serverNode->GetNApplications ();
+  RonServerHelper ronServer (9);
+  ronServer.Install (serverNode);
+  failures.Apply ();
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  snapshot->Restore ();
+  NS_TEST_ASSERT_MSG_EQ (failedNodeIpv4->IsUp (1), true, "failed node's interface still down after Restore");
+  NS_TEST_ASSERT_MSG_EQ (failedIfaceIpv4->IsUp (1), true, "failed interface still down after Restore");
+  NS_TEST_ASSERT_MSG_EQ (failedIfaceIpv4->IsForwarding (1), true, "failed interface still not forwarding after Restore");
+  NS_TEST_ASSERT_MSG_EQ (serverNode->GetNApplications (), nApps, "server installed after the snapshot not removed by Restore");
+
+  // the removed server's port should be free again
+  Ptr<Socket> socket = Socket::CreateSocket (serverNode, UdpSocketFactory::GetTypeId ());
+  NS_TEST_ASSERT_MSG_EQ (socket->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9)), 0,
+                         "removed server's port still bound after Restore");
+  socket->Close ();
+
+  //test the oracle's answers without simulating any packets
+  Ptr<ConnectivityOracle> oracle = Create<ConnectivityOracle> ();
+  oracle->Update ();
+  Ptr<Node> corner = GridGenerator::GetNode (0, 0);
+  Time oneHop, twoHops;
+  NS_TEST_ASSERT_MSG_EQ (oracle->GetLatency (corner, GridGenerator::GetNode (0, 1), 1000, oneHop), true,
+                         "neighbor should be reachable");
+  NS_TEST_ASSERT_MSG_EQ (oracle->GetLatency (corner, GridGenerator::GetNode (0, 2), 1000, twoHops), true,
+                         "node two hops away should be reachable");
+  NS_TEST_ASSERT_MSG_EQ (twoHops, oneHop + oneHop, "identical links should add up to twice the latency");
+  NS_TEST_ASSERT_MSG_EQ_TOL (oneHop.GetSeconds (), 0.002 + 1002 * 8 / 5e6, 1e-9,
+                             "latency should be the link delay plus the transmission time");
+
+  FailureSet cornerFailures;
+  cornerFailures.AddNode (GridGenerator::GetNode (0, 1));
+  cornerFailures.AddNode (GridGenerator::GetNode (1, 0));
+  cornerFailures.Apply ();
+  oracle->Update ();
+  NS_TEST_ASSERT_MSG_EQ (oracle->IsConnected (corner, GridGenerator::GetNode (4, 4)), false,
+                         "corner cut off by its failed neighbors still connected");
+  NS_TEST_ASSERT_MSG_EQ (oracle->IsReachable (corner, GridGenerator::GetNode (4, 4)), false,
+                         "corner cut off by its failed neighbors still reachable");
+  NS_TEST_ASSERT_MSG_EQ (oracle->IsReachable (GridGenerator::GetNode (1, 1), GridGenerator::GetNode (4, 4)), true,
+                         "failing the corner's neighbors shouldn't cut off the rest of the grid");
+
+  cornerFailures.Unapply (Seconds (30.0));
+  oracle->Update ();
+  NS_TEST_ASSERT_MSG_EQ (oracle->IsReachable (corner, GridGenerator::GetNode (4, 4)), true,
+                         "corner still unreachable after unfailing its neighbors");
+}
+
+
+class TestConnectivityOracle : public TestCase
+{
+public:
+  TestConnectivityOracle ();
+  virtual ~TestConnectivityOracle ();
+
+private:
+  virtual void DoRun (void);
+  /** Sends a packet from source to destination in the simulation and checks the oracle agrees on its fate. */
+  void CheckAgainstSimulation (Ptr<ConnectivityOracle> oracle, Ptr<Node> source, Ptr<Node> destination,
+                               Ipv4Address address, std::string what);
+  void Send (Ptr<Socket> socket, uint32_t dataSize, Ipv4Address address);
+  void Receive (Ptr<Socket> socket);
+
+  Time m_received;
+};
+
+TestConnectivityOracle::TestConnectivityOracle ()
+  : TestCase ("Test the connectivity oracle against packets routed by nix-vector routing")
+{}
+
+TestConnectivityOracle::~TestConnectivityOracle ()
+{}
+
+void
+TestConnectivityOracle::Send (Ptr<Socket> socket, uint32_t dataSize, Ipv4Address address)
+{
+  socket->SendTo (Create<Packet> (dataSize), 0, InetSocketAddress (address, 9));
+}
+
+void
+TestConnectivityOracle::Receive (Ptr<Socket> socket)
+{
+  while (socket->Recv ())
+    m_received = Simulator::Now ();
+}
+
+void
+TestConnectivityOracle::CheckAgainstSimulation (Ptr<ConnectivityOracle> oracle, Ptr<Node> source, Ptr<Node> destination,
+                                                Ipv4Address address, std::string what)
+{
+  const uint32_t dataSize = 100;
+  Ptr<Socket> sink = Socket::CreateSocket (destination, UdpSocketFactory::GetTypeId ());
+  sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+  sink->SetRecvCallback (MakeCallback (&TestConnectivityOracle::Receive, this));
+  Ptr<Socket> socket = Socket::CreateSocket (source, UdpSocketFactory::GetTypeId ());
+  Simulator::Schedule (Seconds (1.0), &TestConnectivityOracle::Send, this, socket, dataSize, address);
+
+  m_received = Seconds (0.0);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  sink->Close ();
+  socket->Close ();
+
+  Time latency;
+  bool reachable = oracle->GetLatency (source, destination, dataSize + 8 + 20, latency);
+  bool received = m_received > Seconds (0.0);
+  NS_TEST_ASSERT_MSG_EQ (reachable, received, "oracle disagrees with the simulation " << what);
+  if (reachable)
+    NS_TEST_ASSERT_MSG_EQ (latency, m_received - Seconds (1.0), "oracle's latency differs from the simulation's " << what);
+}
+
+void
+TestConnectivityOracle::DoRun (void)
+{
+  // a square whose corners 0 and 3 are two hops apart either way; a BFS from 0 goes through 1,
+  // but the one from 3, which nix-vector routing grows for destination trees, goes through 2
+  NodeContainer square;
+  square.Create (4);
+  Ipv4NixVectorHelper nixRouting;
+  nixRouting.SetAttribute ("FollowDownEdges", BooleanValue (true));
+  nixRouting.SetAttribute ("UseDestinationTrees", BooleanValue (true));
+  // as GeocronExperiment, with static routing to deliver the packets locally
+  Ipv4StaticRoutingHelper staticRouting;
+  Ipv4ListRoutingHelper routingList;
+  routingList.Add (staticRouting, 0);
+  routingList.Add (nixRouting, 10);
+  InternetStackHelper stack;
+  stack.SetRoutingHelper (routingList);
+  stack.Install (square);
+
+  PointToPointHelper pointToPoint;
+  pointToPoint.SetDeviceAttribute ("DataRate", StringValue ("5Mbps"));
+  pointToPoint.SetChannelAttribute ("Delay", StringValue ("2ms"));
+  Ipv4AddressHelper address ("10.250.0.0", "255.255.255.0");
+  uint32_t links[][2] = {{0, 1}, {0, 2}, {2, 3}, {1, 3}};
+  std::vector<Ipv4InterfaceContainer> interfaces;
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      interfaces.push_back (address.Assign (pointToPoint.Install (square.Get (links[i][0]), square.Get (links[i][1]))));
+      address.NewNetwork ();
+    }
+
+  Ptr<Node> source = square.Get (0), destination = square.Get (3);
+  Ipv4Address destinationAddress = interfaces[2].GetAddress (1);
+  Ptr<ConnectivityOracle> oracle = Create<ConnectivityOracle> ();
+  CheckAgainstSimulation (oracle, source, destination, destinationAddress, "with no failures");
+
+  // the packet follows the failed link through 2 rather than routing around it through 1
+  Ptr<Ipv4> ipv4 = square.Get (2)->GetObject<Ipv4> ();
+  uint32_t iface = interfaces[2].Get (0).second;
+  ipv4->SetDown (iface);
+  oracle->Update ();
+  NS_TEST_ASSERT_MSG_EQ (oracle->IsConnected (source, destination), true, "square shouldn't be cut by one failed link");
+  NS_TEST_ASSERT_MSG_EQ (oracle->IsReachable (source, destination), false,
+                         "packets following down edges should be lost on the failed link");
+  CheckAgainstSimulation (oracle, source, destination, destinationAddress, "with the link on the path failed");
+  ipv4->SetUp (iface);
+
+  // while a failure on the path through 1 doesn't matter
+  ipv4 = destination->GetObject<Ipv4> ();
+  iface = interfaces[3].Get (1).second;
+  ipv4->SetDown (iface);
+  oracle->Update ();
+  NS_TEST_ASSERT_MSG_EQ (oracle->IsReachable (source, destination), true,
+                         "a failure off the destination tree's path shouldn't matter");
+  CheckAgainstSimulation (oracle, source, destination, destinationAddress, "with the link off the path failed");
+  ipv4->SetUp (iface);
+  oracle->Update ();
+}
+
+
+/** Writes the small Rocketfuel map used by the experiment tests as a binary topology to filename.
+    The Rocketfuel reader only creates a map's nodes once per process, so it's only read the first time. */
+bool
+ConvertMap (std::string filename)
+{
+  static Ptr<RocketfuelTopologyReader> reader;
+  static NodeContainer mapNodes;
+  if (!reader)
+    {
+      reader = CreateObject<RocketfuelTopologyReader> ();
+      reader->SetFileName ("rocketfuel/maps/6461.r0.cch");
+      mapNodes = reader->Read ();
+    }
+  return BinaryTopologyReader::Write (filename, mapNodes, reader);
+}
+
+
+class TestIndexNodesThreads : public TestCase
+{
+public:
+  TestIndexNodesThreads ();
+  virtual ~TestIndexNodesThreads ();
+
+private:
+  virtual void DoRun (void);
+  /** Reads a small Rocketfuel map into a new experiment and indexes its nodes in nThreads threads,
+      setting firstNodeId to the id of the map's first node. */
+  Ptr<GeocronExperiment> IndexMap (uint32_t nThreads, uint32_t & firstNodeId);
+
+  std::vector<Location> m_locations;
+  std::string m_mapFile;
+};
+
+TestIndexNodesThreads::TestIndexNodesThreads ()
+  : TestCase ("Test GeocronExperiment chooses the same servers however many threads index the nodes")
+{
+  m_locations.push_back ("Atlanta, GA");
+}
+
+TestIndexNodesThreads::~TestIndexNodesThreads ()
+{}
+
+Ptr<GeocronExperiment>
+TestIndexNodesThreads::IndexMap (uint32_t nThreads, uint32_t & firstNodeId)
+{
+  // the map gets the same addresses each time it's read
+  Ipv4AddressGenerator::Reset ();
+  firstNodeId = NodeList::GetNNodes ();
+
+  Ptr<GeocronExperiment> experiment = CreateObject<GeocronExperiment> ();
+  experiment->SetAttribute ("TopologyType", StringValue ("rocketfuel"));
+  experiment->disasterLocations = &m_locations;
+  experiment->nthreads = nThreads;
+  experiment->ReadLocationFile ("rocketfuel/city_locations.txt");
+  experiment->ReadRocketfuelTopology (m_mapFile);
+  experiment->IndexNodes ();
+  return experiment;
+}
+
+void
+TestIndexNodesThreads::DoRun (void)
+{
+  // the Rocketfuel reader only creates a map's nodes once, so convert it to be read by each experiment
+  m_mapFile = CreateTempDirFilename ("6461.r0.topo");
+  NS_TEST_ASSERT_MSG_EQ (ConvertMap (m_mapFile), true, "couldn't convert the map");
+
+  uint32_t serialFirstId, threadedFirstId;
+  Ptr<GeocronExperiment> serial = IndexMap (1, serialFirstId);
+  Ptr<GeocronExperiment> threaded = IndexMap (4, threadedFirstId);
+
+  NodeContainer serialCandidates = serial->GetServerCandidates (m_locations[0]);
+  NodeContainer threadedCandidates = threaded->GetServerCandidates (m_locations[0]);
+  NS_TEST_ASSERT_MSG_NE (serialCandidates.GetN (), 0, "no server candidates found");
+  NS_TEST_ASSERT_MSG_EQ (threadedCandidates.GetN (), serialCandidates.GetN (),
+                         "different numbers of server candidates in 1 and 4 threads");
+  for (uint32_t i = 0; i < serialCandidates.GetN () and i < threadedCandidates.GetN (); i++)
+    NS_TEST_ASSERT_MSG_EQ (threadedCandidates.Get (i)->GetId () - threadedFirstId,
+                           serialCandidates.Get (i)->GetId () - serialFirstId,
+                           "server candidate " << i << " differs in 1 and 4 threads");
+
+  // and so, from the same random stream, the same servers
+  uint64_t stream = SeedManager::GetNextStreamIndex ();
+  std::vector<uint32_t> serialServers;
+  serial->SetDisasterLocation (m_locations[0]);
+  SeedManager::ResetNextStreamIndex (stream);
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      serial->SetNextServers ();
+      serialServers.push_back (serial->GetServerNode ()->GetId () - serialFirstId);
+    }
+  threaded->SetDisasterLocation (m_locations[0]);
+  SeedManager::ResetNextStreamIndex (stream);
+  for (uint32_t i = 0; i < 5; i++)
+    {
+      threaded->SetNextServers ();
+      NS_TEST_ASSERT_MSG_EQ (threaded->GetServerNode ()->GetId () - threadedFirstId, serialServers[i],
+                             "server " << i << " chosen differs in 1 and 4 threads");
+    }
+
+  std::remove (m_mapFile.c_str ());
+}
+
+
+class TestScenarioWorkers : public TestCase
+{
+public:
+  TestScenarioWorkers ();
+  virtual ~TestScenarioWorkers ();
+
+private:
+  virtual void DoRun (void);
+  /** Runs all the scenarios in nprocs worker processes, writing their traces under dir. */
+  void RunScenarios (uint32_t nprocs, std::string dir);
+  /** Checks each trace file under expectedDir has a byte for byte copy under dir, and nothing else is there. */
+  void CompareTraces (std::string expectedDir, std::string dir, std::string what);
+
+  Ptr<GeocronExperiment> m_experiment;
+  std::vector<Location> m_locations;
+  std::vector<double> m_fprobs;
+  std::vector<ObjectFactory*> m_heuristics;
+  ObjectFactory m_angle;
+  ObjectFactory m_closest;
+};
+
+TestScenarioWorkers::TestScenarioWorkers ()
+  : TestCase ("Test GeocronExperiment writes the same traces in any number of worker processes")
+{
+  m_locations.push_back ("Atlanta, GA");
+  m_fprobs.push_back (0.3);
+  m_fprobs.push_back (0.6);
+  m_angle.SetTypeId ("ns3::AngleRonPathHeuristic");
+  m_closest.SetTypeId ("ns3::ClosestFirstRonPathHeuristic");
+  m_heuristics.push_back (&m_angle);
+  m_heuristics.push_back (&m_closest);
+}
+
+TestScenarioWorkers::~TestScenarioWorkers ()
+{}
+
+void
+TestScenarioWorkers::RunScenarios (uint32_t nprocs, std::string dir)
+{
+  // the trace files go under the working directory
+  char cwd[4096];
+  NS_ASSERT (getcwd (cwd, sizeof (cwd)));
+  boost::filesystem::create_directories (dir);
+  NS_ASSERT (chdir (dir.c_str ()) == 0);
+  m_experiment->nprocs = nprocs;
+  m_experiment->RunAllScenarios ();
+  NS_ASSERT (chdir (cwd) == 0);
+}
+
+void
+TestScenarioWorkers::CompareTraces (std::string expectedDir, std::string dir, std::string what)
+{
+  uint32_t nExpected = 0;
+  for (boost::filesystem::recursive_directory_iterator file (expectedDir);
+       file != boost::filesystem::recursive_directory_iterator (); file++)
+    {
+      if (!boost::filesystem::is_regular_file (file->path ()))
+        continue;
+      nExpected++;
+      std::string name = file->path ().string ().substr (expectedDir.size ());
+      std::ifstream expected (file->path ().string ().c_str (), std::ios::binary);
+      std::ifstream actual ((dir + name).c_str (), std::ios::binary);
+      bool found = actual.is_open ();
+      NS_TEST_ASSERT_MSG_EQ (found, true, "trace file " << name << " missing " << what);
+      std::string expectedBytes ((std::istreambuf_iterator<char> (expected)), std::istreambuf_iterator<char> ());
+      std::string actualBytes ((std::istreambuf_iterator<char> (actual)), std::istreambuf_iterator<char> ());
+      NS_TEST_ASSERT_MSG_NE (expectedBytes.size (), 0, "trace file " << name << " empty");
+      bool equal = actualBytes == expectedBytes;
+      NS_TEST_ASSERT_MSG_EQ (equal, true, "trace file " << name << " differs " << what);
+    }
+
+  uint32_t nFiles = 0;
+  for (boost::filesystem::recursive_directory_iterator file (dir);
+       file != boost::filesystem::recursive_directory_iterator (); file++)
+    if (boost::filesystem::is_regular_file (file->path ()))
+      nFiles++;
+  NS_TEST_ASSERT_MSG_EQ (nFiles, nExpected, "extra trace files " << what);
+}
+
+void
+TestScenarioWorkers::DoRun (void)
+{
+  std::string mapFile = CreateTempDirFilename ("6461.r0.topo");
+  NS_TEST_ASSERT_MSG_EQ (ConvertMap (mapFile), true, "couldn't convert the map");
+
+  // the map gets the same addresses each time it's read, so clear
+  // the overlay peers of the experiments on it before this one
+  Ipv4AddressGenerator::Reset ();
+  RonPeerTable::GetMaster ()->Clear ();
+  m_experiment = CreateObject<GeocronExperiment> ();
+  m_experiment->SetAttribute ("TopologyType", StringValue ("rocketfuel"));
+  m_experiment->SetAttribute ("Seed", UintegerValue (7));
+  m_experiment->disasterLocations = &m_locations;
+  m_experiment->failureProbabilities = &m_fprobs;
+  m_experiment->heuristics = &m_heuristics;
+  m_experiment->nruns = 2;
+  m_experiment->contactAttempts = 5;
+  m_experiment->SetTimeout (Seconds (0.5));
+  m_experiment->ReadLocationFile ("rocketfuel/city_locations.txt");
+  m_experiment->ReadRocketfuelTopology (mapFile);
+  m_experiment->IndexNodes ();
+
+  // every (location, fprob, run, heuristic) is seeded by its place among the
+  // scenarios, so neither the order they run in nor the process matters
+  std::string serialDir = CreateTempDirFilename ("serial");
+  RunScenarios (0, serialDir);
+  uint32_t nprocs[] = {1, 2, 3};
+  for (uint32_t i = 0; i < sizeof (nprocs) / sizeof (uint32_t); i++)
+    {
+      std::string dir = CreateTempDirFilename ("nprocs" + boost::lexical_cast<std::string> (nprocs[i]));
+      RunScenarios (nprocs[i], dir);
+      CompareTraces (serialDir, dir, "in " + boost::lexical_cast<std::string> (nprocs[i]) + " workers");
+    }
+
+  // and running them again in this process starts each from the same streams
+  std::string againDir = CreateTempDirFilename ("serial-again");
+  RunScenarios (0, againDir);
+  CompareTraces (serialDir, againDir, "when run serially again");
+
+  // binary traces are written by a RonTraceWriter which the workers must close
+  m_experiment->SetAttribute ("TraceFormat", StringValue ("binary"));
+  std::string binarySerialDir = CreateTempDirFilename ("binary-serial");
+  std::string binaryWorkersDir = CreateTempDirFilename ("binary-nprocs2");
+  RunScenarios (0, binarySerialDir);
+  RunScenarios (2, binaryWorkersDir);
+  CompareTraces (binarySerialDir, binaryWorkersDir, "in binary in 2 workers");
+
+  boost::filesystem::remove_all (serialDir);
+  for (uint32_t i = 0; i < sizeof (nprocs) / sizeof (uint32_t); i++)
+    boost::filesystem::remove_all (CreateTempDirFilename ("nprocs" + boost::lexical_cast<std::string> (nprocs[i])));
+  boost::filesystem::remove_all (againDir);
+  boost::filesystem::remove_all (binarySerialDir);
+  boost::filesystem::remove_all (binaryWorkersDir);
+  std::remove (mapFile.c_str ());
 }
 
 
@@ -1522,10 +2403,17 @@ GeocronTestSuite::GeocronTestSuite ()
   AddTestCase (new TestOrthogonalRonPathHeuristic);
   AddTestCase (new TestDistRonPathHeuristic);
   AddTestCase (new TestFurtherestFirstRonPathHeuristic);
+  AddTestCase (new TestBatchLikelihoods);
+  AddTestCase (new TestCastRonPathHeuristic);
+  AddTestCase (new TestMultiHopRonPathHeuristic);
 
   //network application / experiment stuff
   AddTestCase (new TestRonHeader);
+  AddTestCase (new TestRonTraceFile);
   AddTestCase (new TestGeocronExperiment);
+  AddTestCase (new TestConnectivityOracle);
+  AddTestCase (new TestIndexNodesThreads);
+  AddTestCase (new TestScenarioWorkers);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -0,0 +1,120 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <map>
+#include <set>
+#include "ns3/log.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ipv4-address-node-index.h"
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4AddressNodeIndex");
+
+namespace ns3 {
+
+class Ipv4AddressNodeIndexImpl
+{
+public:
+  void Add (Ipv4Address address, uint32_t nodeId);
+  void Remove (Ipv4Address address, uint32_t nodeId);
+  Ptr<Node> GetNode (Ipv4Address address) const;
+  uint32_t GetN (void) const;
+private:
+  /* ordered so that the lowest node id owning an address, which is
+   * the one a scan of the NodeList would find first, is at begin () */
+  typedef std::map<Ipv4Address, std::multiset<uint32_t> > AddressMap_t;
+  AddressMap_t m_nodes;
+};
+
+void
+Ipv4AddressNodeIndexImpl::Add (Ipv4Address address, uint32_t nodeId)
+{
+  m_nodes[address].insert (nodeId);
+}
+
+void
+Ipv4AddressNodeIndexImpl::Remove (Ipv4Address address, uint32_t nodeId)
+{
+  AddressMap_t::iterator i = m_nodes.find (address);
+  if (i == m_nodes.end ())
+    {
+      return;
+    }
+  std::multiset<uint32_t>::iterator j = i->second.find (nodeId);
+  if (j != i->second.end ())
+    {
+      i->second.erase (j);
+    }
+  if (i->second.empty ())
+    {
+      m_nodes.erase (i);
+    }
+}
+
+Ptr<Node>
+Ipv4AddressNodeIndexImpl::GetNode (Ipv4Address address) const
+{
+  AddressMap_t::const_iterator i = m_nodes.find (address);
+  if (i == m_nodes.end ())
+    {
+      return 0;
+    }
+  return NodeList::GetNode (*i->second.begin ());
+}
+
+uint32_t
+Ipv4AddressNodeIndexImpl::GetN (void) const
+{
+  return m_nodes.size ();
+}
+
+/* The NodeList is not deleted by Simulator::Destroy, so that a topology
+ * can be reused for several simulations, and neither is this index. */
+static Ipv4AddressNodeIndexImpl *
+GetImpl (void)
+{
+  static Ipv4AddressNodeIndexImpl impl;
+  return &impl;
+}
+
+void
+Ipv4AddressNodeIndex::Add (Ipv4Address address, uint32_t nodeId)
+{
+  NS_LOG_FUNCTION (address << nodeId);
+  GetImpl ()->Add (address, nodeId);
+}
+
+void
+Ipv4AddressNodeIndex::Remove (Ipv4Address address, uint32_t nodeId)
+{
+  NS_LOG_FUNCTION (address << nodeId);
+  GetImpl ()->Remove (address, nodeId);
+}
+
+Ptr<Node>
+Ipv4AddressNodeIndex::GetNode (Ipv4Address address)
+{
+  NS_LOG_FUNCTION (address);
+  return GetImpl ()->GetNode (address);
+}
+
+uint32_t
+Ipv4AddressNodeIndex::GetN (void)
+{
+  return GetImpl ()->GetN ();
+}
+
+} // namespace ns3
@@ -0,0 +1,66 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_ADDRESS_NODE_INDEX_H
+#define IPV4_ADDRESS_NODE_INDEX_H
+
+#include <stdint.h>
+#include "ns3/ipv4-address.h"
+#include "ns3/ptr.h"
+
+namespace ns3 {
+
+class Node;
+
+/**
+ * \ingroup ipv4
+ *
+ * \brief Global index from the Ipv4Address assigned to an interface to
+ * the Node owning that interface.
+ *
+ * Ipv4L3Protocol keeps the index up to date as addresses are added to
+ * and removed from its interfaces, so that finding the node owning an
+ * address does not require scanning every interface of every node.
+ * Like the NodeList, the index outlives Simulator::Destroy.
+ */
+class Ipv4AddressNodeIndex
+{
+public:
+  /**
+   * \brief Record that the node with the given id owns the address.
+   *
+   * An address may be owned by several nodes (e.g. the loopback
+   * address) or several times by the same node.
+   */
+  static void Add (Ipv4Address address, uint32_t nodeId);
+  /**
+   * \brief Forget one ownership of the address by the given node.
+   */
+  static void Remove (Ipv4Address address, uint32_t nodeId);
+  /**
+   * \returns the node with the lowest id owning the address, or
+   * 0 if no node owns it.
+   */
+  static Ptr<Node> GetNode (Ipv4Address address);
+  /**
+   * \returns the number of distinct addresses in the index
+   */
+  static uint32_t GetN (void);
+};
+
+} // namespace ns3
+
+#endif /* IPV4_ADDRESS_NODE_INDEX_H */
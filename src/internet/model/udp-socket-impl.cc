@@ -175,6 +175,24 @@ UdpSocketImpl::Destroy6 (void)
   m_endPoint6 = 0;
 }
 
+void
+UdpSocketImpl::DeallocateEndPoint (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  if (m_endPoint != 0)
+    {
+      m_endPoint->SetDestroyCallback (MakeNullCallback<void> ());
+      m_udp->DeAllocate (m_endPoint);
+      m_endPoint = 0;
+    }
+  if (m_endPoint6 != 0)
+    {
+      m_endPoint6->SetDestroyCallback (MakeNullCallback<void> ());
+      m_udp->DeAllocate (m_endPoint6);
+      m_endPoint6 = 0;
+    }
+}
+
 int
 UdpSocketImpl::FinishBind (void)
 {
@@ -303,6 +321,8 @@ UdpSocketImpl::Close (void)
     }
   m_shutdownRecv = true;
   m_shutdownSend = true;
+  // free the port for other sockets; the endpoint also holds the last reference to us
+  DeallocateEndPoint ();
   return 0;
 }
 
@@ -107,6 +107,7 @@ private:
   void ForwardUp6 (Ptr<Packet> p, Ipv6Header header, uint16_t port);
   void Destroy (void);
   void Destroy6 (void);
+  void DeallocateEndPoint (void);
   int DoSend (Ptr<Packet> p);
   int DoSendTo (Ptr<Packet> p, const Address &daddr);
   int DoSendTo (Ptr<Packet> p, Ipv4Address daddr, uint16_t dport);
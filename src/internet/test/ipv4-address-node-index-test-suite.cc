@@ -0,0 +1,87 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-address-node-index.h"
+
+using namespace ns3;
+
+class Ipv4AddressNodeIndexTestCase : public TestCase
+{
+public:
+  Ipv4AddressNodeIndexTestCase ();
+  virtual void DoRun (void);
+  virtual void DoTeardown (void);
+};
+
+Ipv4AddressNodeIndexTestCase::Ipv4AddressNodeIndexTestCase ()
+  : TestCase ("Make sure the address to node index follows AddAddress and RemoveAddress.")
+{
+}
+void
+Ipv4AddressNodeIndexTestCase::DoTeardown (void)
+{
+  Simulator::Destroy ();
+}
+void
+Ipv4AddressNodeIndexTestCase::DoRun (void)
+{
+  Ptr<Node> nodeA = CreateObject<Node> ();
+  Ptr<Node> nodeB = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (nodeA);
+  internet.Install (nodeB);
+
+  Ptr<Ipv4> ipv4A = nodeA->GetObject<Ipv4> ();
+  Ptr<Ipv4> ipv4B = nodeB->GetObject<Ipv4> ();
+  Ptr<SimpleNetDevice> deviceA = CreateObject<SimpleNetDevice> ();
+  nodeA->AddDevice (deviceA);
+  Ptr<SimpleNetDevice> deviceB = CreateObject<SimpleNetDevice> ();
+  nodeB->AddDevice (deviceB);
+  uint32_t ifA = ipv4A->AddInterface (deviceA);
+  uint32_t ifB = ipv4B->AddInterface (deviceB);
+
+  NS_TEST_EXPECT_MSG_EQ (Ipv4AddressNodeIndex::GetNode ("192.0.2.1"), 0, "Address not assigned yet");
+
+  ipv4A->AddAddress (ifA, Ipv4InterfaceAddress ("192.0.2.1", "255.255.255.0"));
+  ipv4A->AddAddress (ifA, Ipv4InterfaceAddress ("198.51.100.1", "255.255.255.0"));
+  ipv4B->AddAddress (ifB, Ipv4InterfaceAddress ("192.0.2.2", "255.255.255.0"));
+
+  NS_TEST_EXPECT_MSG_EQ (Ipv4AddressNodeIndex::GetNode ("192.0.2.1"), nodeA, "Wrong node for first address");
+  NS_TEST_EXPECT_MSG_EQ (Ipv4AddressNodeIndex::GetNode ("198.51.100.1"), nodeA, "Wrong node for second address");
+  NS_TEST_EXPECT_MSG_EQ (Ipv4AddressNodeIndex::GetNode ("192.0.2.2"), nodeB, "Wrong node for peer address");
+  NS_TEST_EXPECT_MSG_NE (Ipv4AddressNodeIndex::GetNode (Ipv4Address::GetLoopback ()), 0, "Loopback not indexed");
+
+  ipv4A->RemoveAddress (ifA, 0);
+  NS_TEST_EXPECT_MSG_EQ (Ipv4AddressNodeIndex::GetNode ("192.0.2.1"), 0, "Removed address still indexed");
+  NS_TEST_EXPECT_MSG_EQ (Ipv4AddressNodeIndex::GetNode ("198.51.100.1"), nodeA, "Remaining address lost");
+}
+
+
+static class Ipv4AddressNodeIndexTestSuite : public TestSuite
+{
+public:
+  Ipv4AddressNodeIndexTestSuite ()
+    : TestSuite ("ipv4-address-node-index")
+  {
+    AddTestCase (new Ipv4AddressNodeIndexTestCase ());
+  }
+} g_ipv4AddressNodeIndexTestSuite;
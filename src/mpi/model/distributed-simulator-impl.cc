@@ -26,10 +26,12 @@
 #include "ns3/node-container.h"
 #include "ns3/ptr.h"
 #include "ns3/pointer.h"
+#include "ns3/string.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
 
 #include <cmath>
+#include <sstream>
 
 #ifdef NS3_MPI
 #include <mpi.h>
@@ -76,6 +78,14 @@ DistributedSimulatorImpl::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::DistributedSimulatorImpl")
     .SetParent<Object> ()
     .AddConstructor<DistributedSimulatorImpl> ()
+    .AddAttribute ("ProfileFile",
+                   "Name of the file, followed by a dot and the rank, to which the time "
+                   "taken and the events scheduled by each type of event, in total and "
+                   "for each node, are written at Simulator::Destroy.  Events are not "
+                   "profiled if it is empty.",
+                   StringValue (""),
+                   MakeStringAccessor (&DistributedSimulatorImpl::m_profileFile),
+                   MakeStringChecker ())
   ;
   return tid;
 }
@@ -105,10 +115,12 @@ DistributedSimulatorImpl::DistributedSimulatorImpl ()
   m_currentContext = 0xffffffff;
   m_unscheduledEvents = 0;
   m_events = 0;
+  m_profiler = 0;
 }
 
 DistributedSimulatorImpl::~DistributedSimulatorImpl ()
 {
+  delete m_profiler;
 }
 
 void
@@ -137,6 +149,15 @@ DistributedSimulatorImpl::Destroy ()
           ev->Invoke ();
         }
     }
+  if (m_profiler != 0)
+    {
+      // each rank writes its own profile
+      std::ostringstream filename;
+      filename << m_profileFile << "." << m_myId;
+      m_profiler->Write (filename.str ());
+      delete m_profiler;
+      m_profiler = 0;
+    }
 
   MpiInterface::Destroy ();
 }
@@ -243,7 +264,18 @@ DistributedSimulatorImpl::ProcessOneEvent (void)
   m_currentTs = next.key.m_ts;
   m_currentContext = next.key.m_context;
   m_currentUid = next.key.m_uid;
-  next.impl->Invoke ();
+  if (m_profiler == 0 || next.impl->IsCancelled ())
+    {
+      next.impl->Invoke ();
+    }
+  else
+    {
+      uint32_t uid = m_uid;
+      EventProfiler::Function function = EventProfiler::GetFunction (next.impl);
+      uint64_t start = EventProfiler::GetTimeNs ();
+      next.impl->Invoke ();
+      m_profiler->Record (function, next.key.m_context, EventProfiler::GetTimeNs () - start, m_uid - uid);
+    }
   next.impl->Unref ();
 }
 
@@ -272,6 +304,10 @@ DistributedSimulatorImpl::Run (void)
 {
 #ifdef NS3_MPI
   CalculateLookAhead ();
+  if (m_profiler == 0 && !m_profileFile.empty ())
+    {
+      m_profiler = new EventProfiler ();
+    }
   m_stop = false;
   while (!m_events->IsEmpty () && !m_stop)
     {
@@ -22,9 +22,11 @@
 #include "ns3/simulator-impl.h"
 #include "ns3/scheduler.h"
 #include "ns3/event-impl.h"
+#include "ns3/event-profiler.h"
 #include "ns3/ptr.h"
 
 #include <list>
+#include <string>
 
 namespace ns3 {
 
@@ -142,6 +144,10 @@ private:
   Time         m_grantedTime; // Last LBTS
   static Time  m_lookAhead;   // Lookahead value
 
+  // created by Run if m_profileFile is set, written and deleted by Destroy
+  EventProfiler *m_profiler;
+  std::string m_profileFile;
+
 };
 
 } // namespace ns3
@@ -0,0 +1,821 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "ns3/simulator.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/atomic-count.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/assert.h"
+#include "ns3/fatal-error.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <limits>
+#include <unistd.h>
+
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+namespace ns3 {
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+namespace {
+
+const uint32_t NO_CONTEXT = 0xffffffff;
+const uint64_t NO_EVENT = std::numeric_limits<uint64_t>::max ();
+
+} // anonymous namespace
+
+__thread MultithreadedSimulatorImpl::Partition *MultithreadedSimulatorImpl::m_current = 0;
+__thread uint32_t MultithreadedSimulatorImpl::m_thread = 0;
+
+MultithreadedSimulatorImpl::Partition::Partition (uint32_t context)
+  : context (context),
+    // uids are allocated from 4.
+    // uid 0 is "invalid" events
+    // uid 1 is "now" events
+    // uid 2 is "destroy" events
+    uid (4),
+    // before ::Run is entered, the m_currentUid will be zero
+    currentUid (0),
+    currentTs (0),
+    unscheduledEvents (0),
+    scheduled (0),
+    nextTs (NO_EVENT),
+    // the packet uids of the node are prefixed by its context plus one, the
+    // global ones, of the packets created without context, by zero
+    local (context + 1)
+{
+}
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<Object> ()
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+    .AddAttribute ("ThreadCount",
+                   "Number of threads running the events of the nodes, the main one "
+                   "included.  Zero uses one thread per online processor.  The results "
+                   "don't depend on it, but unlike DefaultSimulatorImpl, events of "
+                   "different nodes with the same timestamp don't run in the order they "
+                   "were scheduled in, but at the same time, writing their output in the "
+                   "order of the nodes.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MultithreadedSimulatorImpl::m_threadCount),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("ProfileFile",
+                   "Name of the file to which the time taken and the events scheduled "
+                   "by each type of event, in total and for each node, are written "
+                   "at Simulator::Destroy.  Events are not profiled if it is empty.",
+                   StringValue (""),
+                   MakeStringAccessor (&MultithreadedSimulatorImpl::m_profileFile),
+                   MakeStringChecker ())
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+  m_stop = false;
+  m_global = new Partition (NO_CONTEXT);
+  m_lookahead = 0;
+  m_threads = 1;
+  m_windows = 0;
+  m_windowEnd = 0;
+  m_nextPartition = 0;
+  m_inWindow = false;
+  pthread_mutex_init (&m_mutex, 0);
+  pthread_cond_init (&m_start, 0);
+  pthread_cond_init (&m_done, 0);
+  m_generation = 0;
+  m_working = 0;
+  m_started = 0;
+  m_quit = false;
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i < m_partitions.size (); i++)
+    {
+      delete m_partitions[i];
+    }
+  delete m_global;
+  for (uint32_t i = 0; i < m_profilers.size (); i++)
+    {
+      delete m_profilers[i];
+    }
+  pthread_cond_destroy (&m_done);
+  pthread_cond_destroy (&m_start);
+  pthread_mutex_destroy (&m_mutex);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t i = 0; i <= m_partitions.size (); i++)
+    {
+      Partition *partition = i < m_partitions.size () ? m_partitions[i] : m_global;
+      if (partition == 0 || partition->events == 0)
+        {
+          continue;
+        }
+      while (!partition->events->IsEmpty ())
+        {
+          Scheduler::Event next = partition->events->RemoveNext ();
+          next.impl->Unref ();
+        }
+      partition->events = 0;
+      if (partition != m_global)
+        {
+          delete partition;
+        }
+    }
+  m_partitions.clear ();
+  m_pending.clear ();
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+  if (!m_profilers.empty ())
+    {
+      for (uint32_t i = 1; i < m_profilers.size (); i++)
+        {
+          m_profilers[0]->Merge (*m_profilers[i]);
+          delete m_profilers[i];
+        }
+      m_profilers[0]->Write (m_profileFile);
+      delete m_profilers[0];
+      m_profilers.clear ();
+    }
+}
+
+void
+MultithreadedSimulatorImpl::CalculateLookahead (void)
+{
+  NS_LOG_FUNCTION (this);
+  // the smallest delay of the channels between two nodes, or zero if
+  // one of them has no delay to tell
+  bool found = false;
+  m_lookahead = 0;
+  for (NodeList::Iterator node = NodeList::Begin (); node != NodeList::End (); node++)
+    {
+      for (uint32_t i = 0; i < (*node)->GetNDevices (); i++)
+        {
+          Ptr<Channel> channel = (*node)->GetDevice (i)->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+          bool remote = false;
+          for (uint32_t j = 0; j < channel->GetNDevices () && !remote; j++)
+            {
+              Ptr<NetDevice> device = channel->GetDevice (j);
+              remote = device != 0 && device->GetNode () != 0 && device->GetNode () != *node;
+            }
+          if (!remote)
+            {
+              continue;
+            }
+          TimeValue delay;
+          uint64_t ts = 0;
+          if (channel->GetAttributeFailSafe ("Delay", delay) && delay.Get ().IsStrictlyPositive ())
+            {
+              ts = delay.Get ().GetTimeStep ();
+            }
+          if (!found || ts < m_lookahead)
+            {
+              m_lookahead = ts;
+              found = true;
+            }
+        }
+    }
+  NS_LOG_LOGIC ("lookahead " << m_lookahead);
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetCurrent (void) const
+{
+  return m_current != 0 ? m_current : m_global;
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::GetPartition (uint32_t context)
+{
+  if (context == NO_CONTEXT)
+    {
+      return m_global;
+    }
+  if (context >= m_partitions.size ())
+    {
+      NS_ASSERT (!m_inWindow);
+      m_partitions.resize (context + 1, 0);
+    }
+  Partition *partition = m_partitions[context];
+  if (partition == 0)
+    {
+      NS_ASSERT (!m_inWindow);
+      partition = new Partition (context);
+      partition->events = m_schedulerFactory.Create<Scheduler> ();
+      m_partitions[context] = partition;
+    }
+  return partition;
+}
+
+const MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::PeekPartition (uint32_t context) const
+{
+  if (context == NO_CONTEXT)
+    {
+      return m_global;
+    }
+  if (context >= m_partitions.size ())
+    {
+      return 0;
+    }
+  return m_partitions[context];
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  m_schedulerFactory = schedulerFactory;
+  for (uint32_t i = 0; i <= m_partitions.size (); i++)
+    {
+      Partition *partition = i < m_partitions.size () ? m_partitions[i] : m_global;
+      if (partition == 0)
+        {
+          continue;
+        }
+      Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler> ();
+      if (partition->events != 0)
+        {
+          while (!partition->events->IsEmpty ())
+            {
+              Scheduler::Event next = partition->events->RemoveNext ();
+              scheduler->Insert (next);
+            }
+        }
+      partition->events = scheduler;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Insert (Partition *partition, Scheduler::Event &ev)
+{
+  ev.key.m_uid = partition->uid;
+  partition->uid++;
+  partition->unscheduledEvents++;
+  partition->events->Insert (ev);
+}
+
+void
+MultithreadedSimulatorImpl::Update (Partition *partition)
+{
+  if (partition == m_global)
+    {
+      return;
+    }
+  uint64_t nextTs = partition->events->IsEmpty () ? NO_EVENT : partition->events->PeekNext ().key.m_ts;
+  if (nextTs == partition->nextTs)
+    {
+      return;
+    }
+  if (partition->nextTs != NO_EVENT)
+    {
+      m_pending.erase (std::make_pair (partition->nextTs, partition->context));
+    }
+  if (nextTs != NO_EVENT)
+    {
+      m_pending.insert (std::make_pair (nextTs, partition->context));
+    }
+  partition->nextTs = nextTs;
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent (Partition *partition)
+{
+  Scheduler::Event next = partition->events->RemoveNext ();
+
+  NS_ASSERT (next.key.m_ts >= partition->currentTs);
+  partition->unscheduledEvents--;
+
+  NS_LOG_LOGIC ("handle " << next.key.m_ts);
+  partition->currentTs = next.key.m_ts;
+  partition->currentUid = next.key.m_uid;
+  if (m_profilers.empty () || next.impl->IsCancelled ())
+    {
+      next.impl->Invoke ();
+    }
+  else
+    {
+      uint64_t scheduled = partition->scheduled;
+      EventProfiler::Function function = EventProfiler::GetFunction (next.impl);
+      uint64_t start = EventProfiler::GetTimeNs ();
+      next.impl->Invoke ();
+      m_profilers[m_thread]->Record (function, next.key.m_context, EventProfiler::GetTimeNs () - start,
+                                     partition->scheduled - scheduled);
+    }
+  next.impl->Unref ();
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  return m_stop || (m_pending.empty () && m_global->events->IsEmpty ());
+}
+
+void
+MultithreadedSimulatorImpl::RunWindow (void)
+{
+  for (;;)
+    {
+      uint32_t i = __sync_fetch_and_add (&m_nextPartition, 1);
+      if (i >= m_window.size ())
+        {
+          break;
+        }
+      Partition *partition = m_window[i];
+      m_current = partition;
+      SimulationPartition::SetCurrent (&partition->local);
+      while (!partition->events->IsEmpty ()
+             && partition->events->PeekNext ().key.m_ts <= m_windowEnd)
+        {
+          ProcessOneEvent (partition);
+        }
+    }
+  m_current = 0;
+  SimulationPartition::SetCurrent (0);
+}
+
+void
+MultithreadedSimulatorImpl::Deliver (void)
+{
+  // in the order of the partitions of the window, which doesn't depend on
+  // the threads, so that neither do the uids of the events delivered nor
+  // the output
+  for (uint32_t i = 0; i < m_window.size (); i++)
+    {
+      m_window[i]->local.Flush ();
+      std::vector<Scheduler::Event> &outbox = m_window[i]->outbox;
+      for (uint32_t j = 0; j < outbox.size (); j++)
+        {
+          Partition *partition = GetPartition (outbox[j].key.m_context);
+          Insert (partition, outbox[j]);
+          Update (partition);
+        }
+      outbox.clear ();
+    }
+  m_window.clear ();
+}
+
+void
+MultithreadedSimulatorImpl::StartThreads (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_generation = 0;
+  m_started = 0;
+  m_quit = false;
+  if (m_threads > 1)
+    {
+      AtomicCount::SetThreaded (true);
+    }
+  for (uint32_t i = 1; i < m_threads; i++)
+    {
+      Ptr<SystemThread> thread = Create<SystemThread> (MakeCallback (&MultithreadedSimulatorImpl::Work, this));
+      thread->Start ();
+      m_workers.push_back (thread);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::StopThreads (void)
+{
+  NS_LOG_FUNCTION (this);
+  pthread_mutex_lock (&m_mutex);
+  m_quit = true;
+  pthread_cond_broadcast (&m_start);
+  pthread_mutex_unlock (&m_mutex);
+  for (uint32_t i = 0; i < m_workers.size (); i++)
+    {
+      m_workers[i]->Join ();
+    }
+  m_workers.clear ();
+  AtomicCount::SetThreaded (false);
+}
+
+void
+MultithreadedSimulatorImpl::Work (void)
+{
+  pthread_mutex_lock (&m_mutex);
+  m_started++;
+  m_thread = m_started;
+  // StartThreads reset the generation before starting this thread
+  uint32_t generation = 0;
+  for (;;)
+    {
+      while (m_generation == generation && !m_quit)
+        {
+          pthread_cond_wait (&m_start, &m_mutex);
+        }
+      if (m_quit)
+        {
+          break;
+        }
+      generation = m_generation;
+      pthread_mutex_unlock (&m_mutex);
+      RunWindow ();
+      pthread_mutex_lock (&m_mutex);
+      m_working--;
+      if (m_working == 0)
+        {
+          pthread_cond_signal (&m_done);
+        }
+    }
+  pthread_mutex_unlock (&m_mutex);
+}
+
+void
+MultithreadedSimulatorImpl::RunWindowOnThreads (void)
+{
+  pthread_mutex_lock (&m_mutex);
+  m_nextPartition = 0;
+  m_working = m_workers.size ();
+  m_generation++;
+  pthread_cond_broadcast (&m_start);
+  pthread_mutex_unlock (&m_mutex);
+
+  RunWindow ();
+
+  pthread_mutex_lock (&m_mutex);
+  while (m_working > 0)
+    {
+      pthread_cond_wait (&m_done, &m_mutex);
+    }
+  pthread_mutex_unlock (&m_mutex);
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+  CalculateLookahead ();
+  m_threads = m_threadCount;
+  if (m_threads == 0)
+    {
+      long processors = sysconf (_SC_NPROCESSORS_ONLN);
+      m_threads = processors > 0 ? processors : 1;
+    }
+  if (!m_profileFile.empty ())
+    {
+      while (m_profilers.size () < m_threads)
+        {
+          m_profilers.push_back (new EventProfiler ());
+        }
+    }
+  // a window spans the timestamps the nodes may run before any event
+  // scheduled by another node during it can be due
+  uint64_t width = std::max (m_lookahead, (uint64_t)1);
+
+  m_stop = false;
+  StartThreads ();
+  for (;;)
+    {
+      Deliver ();
+      if (m_stop)
+        {
+          break;
+        }
+      uint64_t nodeTs = m_pending.empty () ? NO_EVENT : m_pending.begin ()->first;
+      uint64_t globalTs = m_global->events->IsEmpty () ? NO_EVENT : m_global->events->PeekNext ().key.m_ts;
+      if (nodeTs == NO_EVENT && globalTs == NO_EVENT)
+        {
+          break;
+        }
+      if (globalTs <= nodeTs)
+        {
+          // the events without context run alone, as they may touch any node
+          m_current = m_global;
+          while (!m_stop && !m_global->events->IsEmpty ()
+                 && m_global->events->PeekNext ().key.m_ts == globalTs)
+            {
+              ProcessOneEvent (m_global);
+            }
+          m_current = 0;
+          continue;
+        }
+
+      m_windowEnd = std::min (nodeTs + width - 1, globalTs - 1);
+      for (std::set<std::pair<uint64_t, uint32_t> >::const_iterator i = m_pending.begin ();
+           i != m_pending.end () && i->first <= m_windowEnd; i++)
+        {
+          m_window.push_back (m_partitions[i->second]);
+        }
+      NS_LOG_LOGIC ("window " << nodeTs << " to " << m_windowEnd << " over " << m_window.size () << " nodes");
+      m_windows++;
+      m_inWindow = true;
+      if (m_workers.empty () || m_window.size () == 1)
+        {
+          m_nextPartition = 0;
+          RunWindow ();
+        }
+      else
+        {
+          RunWindowOnThreads ();
+        }
+      m_inWindow = false;
+      for (uint32_t i = 0; i < m_window.size (); i++)
+        {
+          Update (m_window[i]);
+        }
+    }
+  StopThreads ();
+
+  // leave Now at the last event run, as the other simulators do
+  int unscheduledEvents = m_global->unscheduledEvents;
+  for (uint32_t i = 0; i < m_partitions.size (); i++)
+    {
+      if (m_partitions[i] != 0)
+        {
+          m_global->currentTs = std::max (m_global->currentTs, m_partitions[i]->currentTs);
+          unscheduledEvents += m_partitions[i]->unscheduledEvents;
+        }
+    }
+  // If the simulator stopped naturally by lack of events, make a
+  // consistency test to check that we didn't lose any events along the way.
+  NS_ASSERT (!m_pending.empty () || !m_global->events->IsEmpty () || unscheduledEvents == 0);
+  (void) unscheduledEvents;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return 0;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  m_stop = true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &time)
+{
+  Simulator::Schedule (time, &Simulator::Stop);
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &time, EventImpl *event)
+{
+  Partition *current = GetCurrent ();
+  Time tAbsolute = time + TimeStep (current->currentTs);
+
+  NS_ASSERT (tAbsolute.IsPositive ());
+  NS_ASSERT (tAbsolute >= TimeStep (current->currentTs));
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = static_cast<uint64_t> (tAbsolute.GetTimeStep ());
+  ev.key.m_context = current->context;
+  Insert (current, ev);
+  current->scheduled++;
+  if (!m_inWindow)
+    {
+      Update (current);
+    }
+  return EventId (event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << context << time.GetTimeStep () << event);
+
+  Partition *current = GetCurrent ();
+  Scheduler::Event ev;
+  ev.impl = event;
+  ev.key.m_ts = current->currentTs + time.GetTimeStep ();
+  ev.key.m_context = context;
+  current->scheduled++;
+  if (context == current->context)
+    {
+      Insert (current, ev);
+      if (!m_inWindow)
+        {
+          Update (current);
+        }
+    }
+  else if (!m_inWindow)
+    {
+      Partition *partition = GetPartition (context);
+      Insert (partition, ev);
+      Update (partition);
+    }
+  else
+    {
+      // the other node may already have run events past an earlier one
+      if (ev.key.m_ts < m_windowEnd)
+        {
+          NS_FATAL_ERROR ("Event scheduled by node " << current->context << " in context " << context
+                          << " after " << time << ", less than the lookahead " << TimeStep (m_lookahead)
+                          << " of the channels between the nodes");
+        }
+      current->outbox.push_back (ev);
+    }
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  return Schedule (TimeStep (0), event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  CriticalSection cs (m_destroyEventsMutex);
+  EventId id (Ptr<EventImpl> (event, false), GetCurrent ()->currentTs, NO_CONTEXT, 2);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  return TimeStep (GetCurrent ()->currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs () - GetCurrent ()->currentTs);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      CriticalSection cs (m_destroyEventsMutex);
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  Partition *partition = GetPartition (id.GetContext ());
+  Scheduler::Event event;
+  event.impl = id.PeekEventImpl ();
+  event.key.m_ts = id.GetTs ();
+  event.key.m_context = id.GetContext ();
+  event.key.m_uid = id.GetUid ();
+  partition->events->Remove (event);
+  event.impl->Cancel ();
+  // whenever we remove an event from the event list, we have to unref it.
+  event.impl->Unref ();
+
+  partition->unscheduledEvents--;
+  if (!m_inWindow)
+    {
+      Update (partition);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &ev) const
+{
+  if (ev.GetUid () == 2)
+    {
+      if (ev.PeekEventImpl () == 0
+          || ev.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      CriticalSection cs (const_cast<SystemMutex &> (m_destroyEventsMutex));
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == ev)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  const Partition *partition = PeekPartition (ev.GetContext ());
+  if (ev.PeekEventImpl () == 0
+      || partition == 0
+      || ev.GetTs () < partition->currentTs
+      || (ev.GetTs () == partition->currentTs
+          && ev.GetUid () <= partition->currentUid)
+      || ev.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  else
+    {
+      return false;
+    }
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  // XXX: I am fairly certain other compilers use other non-standard
+  // post-fixes to indicate 64 bit constants.
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  return GetCurrent ()->context;
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookahead (void) const
+{
+  return TimeStep (m_lookahead);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetThreads (void) const
+{
+  return m_threads;
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetWindows (void) const
+{
+  return m_windows;
+}
+
+} // namespace ns3
@@ -0,0 +1,219 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MULTITHREADED_SIMULATOR_IMPL_H
+#define MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/simulator-impl.h"
+#include "ns3/scheduler.h"
+#include "ns3/event-impl.h"
+#include "ns3/event-profiler.h"
+#include "ns3/simulation-partition.h"
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ns3/ptr.h"
+
+#include <pthread.h>
+#include <list>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup mpi
+ *
+ * \brief conservative parallel simulator running the nodes on several threads
+ *
+ * Each context, that is each node, has its own event list, and the events
+ * without a context (0xffffffff), such as those scheduled from main, have
+ * another one.  The simulation advances in windows: all the events of the
+ * nodes whose timestamp is less than the earliest one of any node plus the
+ * lookahead run in parallel, the nodes being spread over the threads, and
+ * the threads then wait for each other before the next window.  The
+ * lookahead is the smallest "Delay" attribute of the channels between two
+ * nodes, like the one DistributedSimulatorImpl computes between ranks, so
+ * that no event scheduled in another node during a window can fall into
+ * it.  The events scheduled in other nodes are delivered at the end of the
+ * window, and the events without a context run alone, between windows.
+ *
+ * Because the windows, and the order in which the events of each node run,
+ * don't depend on the threads, the results don't depend on ThreadCount.
+ * They are those of DefaultSimulatorImpl but for the order of simultaneous
+ * events, which this simulator deliberately doesn't reproduce:
+ * DefaultSimulatorImpl runs the events with the same timestamp in the
+ * order they were scheduled in, across all the nodes, which would make
+ * each node wait for the others to schedule theirs.  Here, the events of
+ * different nodes with the same timestamp run at the same time, their
+ * output being written in the order of the nodes.  Those of one node run
+ * in the order the node scheduled them in, those scheduled by other nodes
+ * coming after the ones the node scheduled up to the end of the same
+ * window, in the order of the scheduling nodes.  A model whose results
+ * depend on the order of simultaneous events may therefore give other
+ * results than with DefaultSimulatorImpl.
+ *
+ * Each node also has a SimulationPartition, from which the packets its
+ * events create draw their uids, and in which the output they write
+ * through an OutputStreamWrapper is kept until the end of the window, to
+ * be written in the order of the nodes, so that neither depends on
+ * ThreadCount.
+ *
+ * The events of a node may only touch the state of that node, the channels
+ * excepted, and objects made safe for threads: reference counts, packets
+ * and the shared nix-vector routing trees are.  An event may only schedule
+ * an event in another node at least the lookahead later, cancel, remove or
+ * test the events of its own node, and its Simulator::Stop takes effect at
+ * the end of its window.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  static TypeId GetTypeId (void);
+
+  MultithreadedSimulatorImpl ();
+  ~MultithreadedSimulatorImpl ();
+
+  // virtual from SimulatorImpl
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &time);
+  virtual EventId Schedule (Time const &time, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &time, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &ev);
+  virtual void Cancel (const EventId &ev);
+  virtual bool IsExpired (const EventId &ev) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+
+  /**
+   * \returns the lookahead computed by the last Run
+   */
+  Time GetLookahead (void) const;
+  /**
+   * \returns the number of threads the last Run used
+   */
+  uint32_t GetThreads (void) const;
+  /**
+   * \returns the number of windows of node events run so far
+   */
+  uint64_t GetWindows (void) const;
+
+private:
+  /** The events of one context, and the state of the event running in it. */
+  struct Partition
+  {
+    Partition (uint32_t context);
+
+    uint32_t context;
+    Ptr<Scheduler> events;
+    uint32_t uid;
+    uint32_t currentUid;
+    uint64_t currentTs;
+    // number of events that have been inserted but not yet scheduled,
+    // not counting the "destroy" events; this is used for validation
+    int unscheduledEvents;
+    // events scheduled by this partition, for the profiler
+    uint64_t scheduled;
+    // timestamp under which the partition is in m_pending
+    uint64_t nextTs;
+    // events scheduled in other partitions during the current window,
+    // with their context in their key
+    std::vector<Scheduler::Event> outbox;
+    // the packet uids and the output of the events of the partition,
+    // written out in the order of the partitions of the window
+    SimulationPartition local;
+  };
+
+  virtual void DoDispose (void);
+  void CalculateLookahead (void);
+  /** Returns the partition of the running event, or the one without context. */
+  Partition *GetCurrent (void) const;
+  /** Returns the partition of context, creating it: only between windows. */
+  Partition *GetPartition (uint32_t context);
+  const Partition *PeekPartition (uint32_t context) const;
+  void Insert (Partition *partition, Scheduler::Event &ev);
+  /** Files a node partition in m_pending under the timestamp of its next event. */
+  void Update (Partition *partition);
+  void ProcessOneEvent (Partition *partition);
+  /** Runs the events of the partitions of m_window, as long as some are left. */
+  void RunWindow (void);
+  void Deliver (void);
+  void StartThreads (void);
+  void StopThreads (void);
+  /** Entry point of the threads, but the main one. */
+  void Work (void);
+  /** Tells the threads to run the window, runs it too, and waits for them. */
+  void RunWindowOnThreads (void);
+
+  typedef std::list<EventId> DestroyEvents;
+
+  // the partition whose events the thread is running, if any
+  static __thread Partition *m_current;
+  // the index of the thread, which selects its profiler
+  static __thread uint32_t m_thread;
+
+  DestroyEvents m_destroyEvents;
+  SystemMutex m_destroyEventsMutex;
+  bool m_stop;
+  ObjectFactory m_schedulerFactory;
+  // the partitions of the node contexts, indexed by context, and the
+  // partition of the events without context
+  std::vector<Partition *> m_partitions;
+  Partition *m_global;
+  // node partitions with events, by the timestamp of their next one
+  std::set<std::pair<uint64_t, uint32_t> > m_pending;
+
+  uint64_t m_lookahead;
+  uint32_t m_threadCount;
+  uint32_t m_threads;
+  uint64_t m_windows;
+
+  // the current window: its last timestamp, its partitions and the next
+  // of them for a thread to run
+  uint64_t m_windowEnd;
+  std::vector<Partition *> m_window;
+  uint32_t m_nextPartition;
+  bool m_inWindow;
+
+  // the threads wait on m_start for m_generation to change, and the main
+  // thread waits on m_done for m_working to reach zero
+  std::vector<Ptr<SystemThread> > m_workers;
+  pthread_mutex_t m_mutex;
+  pthread_cond_t m_start;
+  pthread_cond_t m_done;
+  uint32_t m_generation;
+  uint32_t m_working;
+  uint32_t m_started;
+  bool m_quit;
+
+  // one profiler per thread, created by Run if m_profileFile is set,
+  // merged, written and deleted by Destroy
+  std::vector<EventProfiler *> m_profilers;
+  std::string m_profileFile;
+};
+
+} // namespace ns3
+
+#endif /* MULTITHREADED_SIMULATOR_IMPL_H */
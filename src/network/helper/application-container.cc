@@ -79,6 +79,11 @@ ApplicationContainer::Add (std::string name)
   Ptr<Application> application = Names::Find<Application> (name);
   m_applications.push_back (application);
 }
+void
+ApplicationContainer::Reserve (uint32_t n)
+{
+  m_applications.reserve (n);
+}
 
 void 
 ApplicationContainer::Start (Time start)
@@ -176,6 +176,14 @@ public:
    */
   void Add (std::string name);
 
+  /**
+   * \brief Make room for at least n Applications in this container, so that
+   * adding them one at a time doesn't reallocate it over and over.
+   *
+   * \param n The number of Applications the container will hold.
+   */
+  void Reserve (uint32_t n);
+
   /**
    * \brief Arrange for all of the Applications in this container to Start()
    * at the Time given as a parameter.
@@ -258,15 +258,17 @@ Buffer::operator = (Buffer const&o)
   if (m_data != o.m_data) 
     {
       // not assignment to self.
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (AtomicCount::Decrement (m_data->m_count) == 0)
         {
           Recycle (m_data);
         }
       m_data = o.m_data;
-      m_data->m_count++;
+      AtomicCount::Increment (m_data->m_count);
+    }
+  if (!AtomicCount::IsThreaded ())
+    {
+      g_recommendedStart = std::max (g_recommendedStart, m_maxZeroAreaStart);
     }
-  g_recommendedStart = std::max (g_recommendedStart, m_maxZeroAreaStart);
   m_maxZeroAreaStart = o.m_maxZeroAreaStart;
   m_zeroAreaStart = o.m_zeroAreaStart;
   m_zeroAreaEnd = o.m_zeroAreaEnd;
@@ -280,9 +282,11 @@ Buffer::~Buffer ()
 {
   NS_LOG_FUNCTION (this);
   NS_ASSERT (CheckInternalState ());
-  g_recommendedStart = std::max (g_recommendedStart, m_maxZeroAreaStart);
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  if (!AtomicCount::IsThreaded ())
+    {
+      g_recommendedStart = std::max (g_recommendedStart, m_maxZeroAreaStart);
+    }
+  if (AtomicCount::Decrement (m_data->m_count) == 0)
     {
       Recycle (m_data);
     }
@@ -307,7 +311,8 @@ Buffer::AddAtStart (uint32_t start)
   NS_LOG_FUNCTION (this << start);
   bool dirty;
   NS_ASSERT (CheckInternalState ());
-  bool isDirty = m_data->m_count > 1 && m_start > m_data->m_dirtyStart;
+  // copies on other threads may extend the dirty area at the same time
+  bool isDirty = m_data->m_count > 1 && (m_start > m_data->m_dirtyStart || AtomicCount::IsThreaded ());
   if (m_start >= start && !isDirty)
     {
       /* enough space in the buffer and not dirty. 
@@ -326,8 +331,7 @@ Buffer::AddAtStart (uint32_t start)
       uint32_t newSize = GetInternalSize () + start;
       struct Buffer::Data *newData = Buffer::Create (newSize);
       memcpy (newData->m_data + start, m_data->m_data + m_start, GetInternalSize ());
-      m_data->m_count--;
-      if (m_data->m_count == 0)
+      if (AtomicCount::Decrement (m_data->m_count) == 0)
         {
           Buffer::Recycle (m_data);
         }
@@ -358,7 +362,7 @@ Buffer::AddAtEnd (uint32_t end)
   NS_LOG_FUNCTION (this << end);
   bool dirty;
   NS_ASSERT (CheckInternalState ());
-  bool isDirty = m_data->m_count > 1 && m_end < m_data->m_dirtyEnd;
+  bool isDirty = m_data->m_count > 1 && (m_end < m_data->m_dirtyEnd || AtomicCount::IsThreaded ());
   if (GetInternalEnd () + end <= m_data->m_size && !isDirty)
     {
       /* enough space in buffer and not dirty
@@ -379,8 +383,7 @@ Buffer::AddAtEnd (uint32_t end)
       uint32_t newSize = GetInternalSize () + end;
       struct Buffer::Data *newData = Buffer::Create (newSize);
       memcpy (newData->m_data, m_data->m_data + m_start, GetInternalSize ());
-      m_data->m_count--;
-      if (m_data->m_count == 0) 
+      if (AtomicCount::Decrement (m_data->m_count) == 0)
         {
           Buffer::Recycle (m_data);
         }
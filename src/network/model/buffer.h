@@ -24,6 +24,7 @@
 #include <vector>
 #include <ostream>
 #include "ns3/assert.h"
+#include "ns3/atomic-count.h"
 
 #define noBUFFER_FREE_LIST 1
 
@@ -592,7 +593,8 @@ private:
   /**
    * location in a newly-allocated buffer where you should start
    * writing data. i.e., m_start should be initialized to this 
-   * value.
+   * value.  Shared by all the threads of a parallel simulation, so
+   * only raised while AtomicCount::IsThreaded is false.
    */
   static uint32_t g_recommendedStart;
 
@@ -861,7 +863,7 @@ Buffer::Buffer (Buffer const&o)
     m_start (o.m_start),
     m_end (o.m_end)
 {
-  m_data->m_count++;
+  AtomicCount::Increment (m_data->m_count);
   NS_ASSERT (CheckInternalState ());
 }
 
@@ -19,6 +19,7 @@
  */
 #include "byte-tag-list.h"
 #include "ns3/log.h"
+#include "ns3/atomic-count.h"
 #include <vector>
 #include <cstring>
 
@@ -135,7 +136,7 @@ ByteTagList::ByteTagList (const ByteTagList &o)
   NS_LOG_FUNCTION (this << &o);
   if (m_data != 0)
     {
-      m_data->count++;
+      AtomicCount::Increment (m_data->count);
     }
 }
 ByteTagList &
@@ -151,7 +152,7 @@ ByteTagList::operator = (const ByteTagList &o)
   m_used = o.m_used;
   if (m_data != 0)
     {
-      m_data->count++;
+      AtomicCount::Increment (m_data->count);
     }
   return *this;
 }
@@ -175,7 +176,8 @@ ByteTagList::Add (TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
       m_used = 0;
     } 
   else if (m_data->size < spaceNeeded ||
-           (m_data->count != 1 && m_data->dirty != m_used))
+           (m_data->count != 1 &&
+            (m_data->dirty != m_used || AtomicCount::IsThreaded ())))
     {
       struct ByteTagListData *newData = Allocate (spaceNeeded);
       std::memcpy (&newData->data, &m_data->data, m_used);
@@ -344,7 +346,7 @@ struct ByteTagListData *
 ByteTagList::Allocate (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  while (!g_freeList.empty ())
+  while (!AtomicCount::IsThreaded () && !g_freeList.empty ())
     {
       struct ByteTagListData *data = g_freeList.back ();
       g_freeList.pop_back ();
@@ -374,9 +376,18 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
     {
       return;
     }
+  if (AtomicCount::IsThreaded ())
+    {
+      // the free list is shared by all the threads
+      if (AtomicCount::Decrement (data->count) == 0)
+        {
+          uint8_t *buffer = (uint8_t *)data;
+          delete [] buffer;
+        }
+      return;
+    }
   g_maxSize = std::max (g_maxSize, data->size);
-  data->count--;
-  if (data->count == 0)
+  if (AtomicCount::Decrement (data->count) == 0)
     {
       if (g_freeList.size () > FREE_LIST_SIZE ||
           data->size < g_maxSize)
@@ -413,8 +424,7 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
     {
       return;
     }
-  data->count--;
-  if (data->count == 0)
+  if (AtomicCount::Decrement (data->count) == 0)
     {
       uint8_t *buffer = (uint8_t *)data;
       delete [] buffer;
@@ -162,6 +162,16 @@ Node::GetNApplications (void) const
   NS_LOG_FUNCTION (this);
   return m_applications.size ();
 }
+void
+Node::RemoveApplication (uint32_t index)
+{
+  NS_LOG_FUNCTION (this << index);
+  NS_ASSERT_MSG (index < m_applications.size (), "Application index " << index <<
+                 " is out of range (only have " << m_applications.size () << " applications).");
+  Ptr<Application> application = m_applications[index];
+  m_applications.erase (m_applications.begin () + index);
+  application->Dispose ();
+}
 
 void 
 Node::DoDispose ()
@@ -120,6 +120,18 @@ public:
    * \returns the number of applications associated to this Node.
    */
   uint32_t GetNApplications (void) const;
+  /**
+   * \param index index of the Application to remove
+   *
+   * Dispose of the Application and remove it from this Node.
+   * The Applications after it move down by one index.
+   * Disposing of the Application cancels its scheduled start and stop,
+   * but not the events it scheduled itself once started.  So it is safe
+   * to call after Simulator::Destroy, as TopologySnapshot::Restore does,
+   * before the Application has started, or once it has stopped; not
+   * while it is running.
+   */
+  void RemoveApplication (uint32_t index);
 
   /**
    * A protocol handler
@@ -77,8 +77,7 @@ PacketMetadata::ReserveCopy (uint32_t size)
   struct PacketMetadata::Data *newData = PacketMetadata::Create (m_used + size);
   memcpy (newData->m_data, m_data->m_data, m_used);
   newData->m_dirtyEnd = m_used;
-  m_data->m_count--;
-  if (m_data->m_count == 0) 
+  if (AtomicCount::Decrement (m_data->m_count) == 0) 
     {
       PacketMetadata::Recycle (m_data);
     }
@@ -100,10 +99,11 @@ PacketMetadata::Reserve (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
   NS_ASSERT (m_data != 0);
+  // copies on other threads may move the dirty end at the same time
   if (m_data->m_size >= m_used + size &&
       (m_head == 0xffff ||
        m_data->m_count == 1 ||
-       m_data->m_dirtyEnd == m_used))
+       (m_data->m_dirtyEnd == m_used && !AtomicCount::IsThreaded ())))
     {
       /* enough room, not dirty. */
     }
@@ -383,7 +383,7 @@ PacketMetadata::AddSmall (const struct PacketMetadata::SmallItem *item)
   if (m_used + n > m_data->m_size ||
       (m_head != 0xffff &&
        m_data->m_count != 1 &&
-       m_used != m_data->m_dirtyEnd))
+       (m_used != m_data->m_dirtyEnd || AtomicCount::IsThreaded ())))
     {
       ReserveCopy (n);
     }
@@ -421,7 +421,7 @@ PacketMetadata::AddBig (uint32_t next, uint32_t prev,
   if (m_used + n > m_data->m_size ||
       (m_head != 0xffff &&
        m_data->m_count != 1 &&
-       m_used != m_data->m_dirtyEnd))
+       (m_used != m_data->m_dirtyEnd || AtomicCount::IsThreaded ())))
     {
       ReserveCopy (n);
     }
@@ -582,6 +582,11 @@ struct PacketMetadata::Data *
 PacketMetadata::Create (uint32_t size)
 {
   NS_LOG_FUNCTION (size);
+  if (AtomicCount::IsThreaded ())
+    {
+      // the free list and the maximum size are shared by all the threads
+      return PacketMetadata::Allocate (size);
+    }
   NS_LOG_LOGIC ("create size="<<size<<", max="<<m_maxSize);
   if (size > m_maxSize)
     {
@@ -608,7 +613,7 @@ void
 PacketMetadata::Recycle (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
-  if (!m_enable)
+  if (!m_enable || AtomicCount::IsThreaded ())
     {
       PacketMetadata::Deallocate (data);
       return;
@@ -38,7 +38,8 @@ PacketTagList::AllocData (void) const
 {
   NS_LOG_FUNCTION_NOARGS ();
   struct PacketTagList::TagData *retval;
-  if (g_free != 0) 
+  // the free list is shared by all the threads
+  if (g_free != 0 && !AtomicCount::IsThreaded ()) 
     {
       retval = g_free;
       g_free = g_free->m_next;
@@ -55,7 +56,7 @@ void
 PacketTagList::FreeData (struct TagData *data) const
 {
   NS_LOG_FUNCTION (data);
-  if (g_nfree > 1000) 
+  if (g_nfree > 1000 || AtomicCount::IsThreaded ()) 
     {
       delete data;
       return;
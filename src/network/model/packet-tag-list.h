@@ -23,6 +23,7 @@
 #include <stdint.h>
 #include <ostream>
 #include "ns3/type-id.h"
+#include "ns3/atomic-count.h"
 
 namespace ns3 {
 
@@ -88,7 +89,7 @@ PacketTagList::PacketTagList (PacketTagList const &o)
 {
   if (m_next != 0)
     {
-      m_next->count++;
+      AtomicCount::Increment (m_next->count);
     }
 }
 
@@ -104,7 +105,7 @@ PacketTagList::operator = (PacketTagList const &o)
   m_next = o.m_next;
   if (m_next != 0) 
     {
-      m_next->count++;
+      AtomicCount::Increment (m_next->count);
     }
   return *this;
 }
@@ -120,8 +121,7 @@ PacketTagList::RemoveAll (void)
   struct TagData *prev = 0;
   for (struct TagData *cur = m_next; cur != 0; cur = cur->next) 
     {
-      cur->count--;
-      if (cur->count > 0) 
+      if (AtomicCount::Decrement (cur->count) > 0) 
         {
           break;
         }
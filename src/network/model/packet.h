@@ -378,6 +378,10 @@ public:
    * A packet is allocated a new uid when it is created
    * empty or with zero-filled payload.
    *
+   * While a parallel simulator runs the events of a node, the uid
+   * is drawn from the SimulationPartition of the node, so it
+   * doesn't depend on the threads.
+   *
    * Note: This uid is an internal uid and cannot be counted on to
    * provide an accurate counter of how many "simulated packets" of a
    * particular protocol are in the system. It is not trivial to make
@@ -558,6 +562,8 @@ private:
           const PacketTagList &packetTagList, const PacketMetadata &metadata);
 
   uint32_t Deserialize (uint8_t const*buffer, uint32_t size);
+  /** Returns the uid of a new packet, from the SimulationPartition running if any. */
+  static uint64_t AllocateUid (void);
 
   Buffer m_buffer;
   ByteTagList m_byteTagList;
@@ -20,6 +20,7 @@
 #include "ns3/log.h"
 #include "ns3/fatal-impl.h"
 #include "ns3/abort.h"
+#include "ns3/simulation-partition.h"
 #include <fstream>
 
 NS_LOG_COMPONENT_DEFINE ("OutputStreamWrapper");
@@ -58,7 +59,7 @@ std::ostream *
 OutputStreamWrapper::GetStream (void)
 {
   NS_LOG_FUNCTION (this);
-  return m_ostream;
+  return SimulationPartition::GetStream (m_ostream);
 }
 
 } // namespace ns3
@@ -77,6 +77,11 @@ public:
   /**
    * Return a pointer to an ostream previously set in the wrapper.
    *
+   * While a parallel simulator runs the events of a node, this is the
+   * buffer of the SimulationPartition of the node for the ostream, which
+   * the simulator writes out when the other nodes are done, so the
+   * wrapper must outlive the events which write to it.
+   *
    * \see SetStream
    *
    * \returns a pointer to the encapsulated std::ostream
@@ -20,12 +20,17 @@
 
 #include <queue>
 #include <iomanip>
+#include <algorithm>
+#include <functional>
+#include <limits>
 
 #include "ns3/log.h"
 #include "ns3/abort.h"
 #include "ns3/names.h"
 #include "ns3/ipv4-list-routing.h"
+#include "ns3/ipv4-address-node-index.h"
 #include "ns3/boolean.h"
+#include "ns3/system-mutex.h"
 
 #include "ipv4-nix-vector-routing.h"
 
@@ -35,6 +40,20 @@ namespace ns3 {
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv4NixVectorRouting);
 
+// State of the currently open topology change batch, which is
+// shared by the nix-vector routing protocols of all nodes
+static uint32_t g_batchDepth = 0;
+static bool g_batchFlushAll = false;
+static std::set<uint32_t> g_batchDownNodes;
+
+// Destination trees shared by the nix-vector routing protocols of
+// all nodes, indexed by their FollowDownEdges setting.  Like the
+// NodeList, they are kept across Simulator::Destroy
+static NixDestinationTreeMap_t g_destinationTrees[2];
+// Guards the destination trees, which nodes run by a multithreaded
+// simulator may grow at the same time
+static SystemMutex g_destinationTreesMutex;
+
 TypeId 
 Ipv4NixVectorRouting::GetTypeId (void)
 {
@@ -46,12 +65,18 @@ Ipv4NixVectorRouting::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&Ipv4NixVectorRouting::m_followDownEdges),
                    MakeBooleanChecker ())
+    .AddAttribute ("UseDestinationTrees",
+                   "If true, paths are looked up in shortest-path trees built once per destination "
+                   "and shared by all source nodes, instead of running a BFS per source",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&Ipv4NixVectorRouting::m_useDestinationTrees),
+                   MakeBooleanChecker ())
   ;
   return tid;
 }
 
 Ipv4NixVectorRouting::Ipv4NixVectorRouting ()
-  : m_totalNeighbors (0), m_followDownEdges(false)
+  : m_totalNeighbors (0), m_followDownEdges(false), m_useDestinationTrees (false)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -102,6 +127,8 @@ Ipv4NixVectorRouting::FlushGlobalNixRoutingCache ()
       return;
     }
 
+  FlushDestinationTrees ();
+
   NodeList::Iterator listEnd = NodeList::End ();
   for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
     {
@@ -117,11 +144,128 @@ Ipv4NixVectorRouting::FlushGlobalNixRoutingCache ()
     }
 }
 
+void
+Ipv4NixVectorRouting::BeginTopologyChangeBatch ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  g_batchDepth++;
+}
+
+void
+Ipv4NixVectorRouting::CommitTopologyChangeBatch ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  NS_ASSERT_MSG (g_batchDepth > 0, "No topology change batch to commit");
+
+  if (--g_batchDepth > 0)
+    {
+      return;
+    }
+
+  bool flushAll = g_batchFlushAll;
+  std::set<uint32_t> downNodes;
+  downNodes.swap (g_batchDownNodes);
+  g_batchFlushAll = false;
+
+  if (!flushAll && downNodes.empty ())
+    {
+      return;
+    }
+
+  if (flushAll)
+    {
+      FlushDestinationTrees ();
+    }
+  else
+    {
+      RepairDestinationTrees (downNodes);
+    }
+
+  NodeList::Iterator listEnd = NodeList::End ();
+  for (NodeList::Iterator i = NodeList::Begin (); i != listEnd; i++)
+    {
+      Ptr<Node> node = *i;
+      Ptr<Ipv4NixVectorRouting> rp = node->GetObject<Ipv4NixVectorRouting> ();
+      if (!rp || rp->m_followDownEdges)
+        {
+          continue;
+        }
+      if (flushAll)
+        {
+          NS_LOG_LOGIC ("Flushing Nix caches.");
+          rp->FlushNixCache ();
+        }
+      else
+        {
+          NS_LOG_LOGIC ("Flushing Nix caches traversing " << downNodes.size () << " nodes.");
+          rp->FlushNixCacheForNodes (downNodes);
+        }
+      // Ipv4Routes are cheap to rebuild from the nix-vectors,
+      // but any of them may now point at a different next hop
+      rp->FlushIpv4RouteCache ();
+    }
+}
+
 void
 Ipv4NixVectorRouting::FlushNixCache ()
 {
   NS_LOG_FUNCTION_NOARGS ();
   m_nixCache.clear ();
+  m_nixCachePaths.clear ();
+}
+
+void
+Ipv4NixVectorRouting::FlushNixCacheForNodes (const std::set<uint32_t> & nodeIds)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  // Only cached paths can be broken by an interface going down;
+  // cached misses (null nix-vectors) remain misses.
+  NixPathMap_t::iterator iter = m_nixCachePaths.begin ();
+  while (iter != m_nixCachePaths.end ())
+    {
+      bool traversesDownNode = false;
+      for (std::vector<uint32_t>::const_iterator id = iter->second.begin ();
+           id != iter->second.end (); id++)
+        {
+          if (nodeIds.count (*id))
+            {
+              traversesDownNode = true;
+              break;
+            }
+        }
+
+      if (traversesDownNode)
+        {
+          NS_LOG_LOGIC ("Flushing Nix-vector to " << iter->first);
+          m_nixCache.erase (iter->first);
+          m_nixCachePaths.erase (iter++);
+        }
+      else
+        {
+          iter++;
+        }
+    }
+}
+
+void
+Ipv4NixVectorRouting::NotifyTopologyChange (bool interfaceDown)
+{
+  if (g_batchDepth == 0)
+    {
+      FlushGlobalNixRoutingCache ();
+      return;
+    }
+
+  NS_LOG_LOGIC ("Deferring Nix cache flush until the topology change batch is committed");
+  if (interfaceDown && m_node)
+    {
+      g_batchDownNodes.insert (m_node->GetId ());
+    }
+  else
+    {
+      g_batchFlushAll = true;
+    }
 }
 
 void
@@ -131,8 +275,308 @@ Ipv4NixVectorRouting::FlushIpv4RouteCache ()
   m_ipv4RouteCache.clear ();
 }
 
+NixDestinationTreeMap_t &
+Ipv4NixVectorRouting::GetDestinationTrees (bool followDownEdges)
+{
+  return g_destinationTrees[followDownEdges ? 1 : 0];
+}
+
+void
+Ipv4NixVectorRouting::FlushDestinationTrees ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  // trees following down edges never depend on link state
+  GetDestinationTrees (false).clear ();
+}
+
+void
+Ipv4NixVectorRouting::RepairDestinationTrees (const std::set<uint32_t> & nodeIds)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  NixDestinationTreeMap_t & trees = GetDestinationTrees (false);
+  NixDestinationTreeMap_t::iterator iter = trees.begin ();
+  while (iter != trees.end ())
+    {
+      NixDestinationTree & tree = iter->second;
+
+      // Only the outgoing edges of the given nodes may have gone
+      // down, so only their tree edges need to be checked
+      std::vector<uint32_t> brokenNodes;
+      for (std::set<uint32_t>::const_iterator id = nodeIds.begin (); id != nodeIds.end (); id++)
+        {
+          if (*id >= tree.parent.size () || tree.parent[*id] < 0 || tree.parent[*id] == (int32_t)*id)
+            {
+              continue;
+            }
+          std::vector<uint32_t> downstream;
+          GetDownstreamNeighbors (NodeList::GetNode (*id), false, downstream);
+          if (std::find (downstream.begin (), downstream.end (), (uint32_t)tree.parent[*id]) == downstream.end ())
+            {
+              brokenNodes.push_back (*id);
+            }
+        }
+
+      if (brokenNodes.empty ())
+        {
+          iter++;
+        }
+      else if (!tree.frontier.empty ())
+        {
+          NS_LOG_LOGIC ("Dropping partial tree towards node " << iter->first);
+          trees.erase (iter++);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("Repairing tree towards node " << iter->first);
+          RepairDestinationTree (tree, brokenNodes);
+          iter++;
+        }
+    }
+}
+
+void
+Ipv4NixVectorRouting::RepairDestinationTree (NixDestinationTree & tree, const std::vector<uint32_t> & brokenNodes)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  enum { UNKNOWN, ATTACHED, ORPHANED };
+  uint32_t numberOfNodes = tree.parent.size ();
+  std::vector<uint8_t> state (numberOfNodes, UNKNOWN);
+  for (std::vector<uint32_t>::const_iterator id = brokenNodes.begin (); id != brokenNodes.end (); id++)
+    {
+      state[*id] = ORPHANED;
+    }
+
+  // a node is orphaned iff its path to the root goes through a broken node
+  std::vector<uint32_t> orphans;
+  std::vector<uint32_t> chain;
+  for (uint32_t i = 0; i < numberOfNodes; i++)
+    {
+      if (tree.parent[i] < 0)
+        {
+          continue;
+        }
+      chain.clear ();
+      uint32_t j = i;
+      while (state[j] == UNKNOWN && tree.parent[j] != (int32_t)j)
+        {
+          chain.push_back (j);
+          j = tree.parent[j];
+        }
+      if (state[j] == UNKNOWN)
+        {
+          state[j] = ATTACHED;
+        }
+      for (std::vector<uint32_t>::const_iterator k = chain.begin (); k != chain.end (); k++)
+        {
+          state[*k] = state[j];
+        }
+    }
+
+  // distances to the root can only have grown, so reattach the orphans
+  // in order of their new distance, starting from the attached nodes
+  typedef std::pair<uint32_t, uint32_t> DepthNode_t;
+  std::priority_queue<DepthNode_t, std::vector<DepthNode_t>, std::greater<DepthNode_t> > queue;
+  for (uint32_t i = 0; i < numberOfNodes; i++)
+    {
+      if (state[i] != ORPHANED)
+        {
+          continue;
+        }
+      tree.reached--;
+      tree.parent[i] = -1;
+      tree.depth[i] = std::numeric_limits<uint32_t>::max ();
+
+      std::vector<uint32_t> downstream;
+      GetDownstreamNeighbors (NodeList::GetNode (i), false, downstream);
+      for (std::vector<uint32_t>::const_iterator k = downstream.begin (); k != downstream.end (); k++)
+        {
+          if (state[*k] == ATTACHED && tree.depth[*k] + 1 < tree.depth[i])
+            {
+              tree.parent[i] = *k;
+              tree.depth[i] = tree.depth[*k] + 1;
+            }
+        }
+      if (tree.parent[i] >= 0)
+        {
+          queue.push (DepthNode_t (tree.depth[i], i));
+        }
+    }
+
+  while (!queue.empty ())
+    {
+      uint32_t depth = queue.top ().first;
+      uint32_t i = queue.top ().second;
+      queue.pop ();
+      if (state[i] == ATTACHED || depth > tree.depth[i])
+        {
+          continue;
+        }
+      state[i] = ATTACHED;
+      tree.reached++;
+
+      std::vector<uint32_t> upstream;
+      GetUpstreamNeighbors (NodeList::GetNode (i), false, upstream);
+      for (std::vector<uint32_t>::const_iterator k = upstream.begin (); k != upstream.end (); k++)
+        {
+          if (state[*k] == ORPHANED && depth + 1 < tree.depth[*k])
+            {
+              tree.parent[*k] = i;
+              tree.depth[*k] = depth + 1;
+              queue.push (DepthNode_t (depth + 1, *k));
+            }
+        }
+    }
+}
+
+bool
+Ipv4NixVectorRouting::GrowDestinationTree (NixDestinationTree & tree, uint32_t sourceId, bool followDownEdges)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  // the tree is grown from the destination, one BFS step at a time,
+  // until it reaches the source; later sources resume from there
+  std::vector<uint32_t> upstream;
+  while (tree.parent[sourceId] < 0 && !tree.frontier.empty ())
+    {
+      uint32_t currId = tree.frontier.front ();
+      tree.frontier.pop_front ();
+
+      upstream.clear ();
+      GetUpstreamNeighbors (NodeList::GetNode (currId), followDownEdges, upstream);
+      for (std::vector<uint32_t>::const_iterator id = upstream.begin (); id != upstream.end (); id++)
+        {
+          if (tree.parent[*id] < 0)
+            {
+              tree.parent[*id] = currId;
+              tree.depth[*id] = tree.depth[currId] + 1;
+              tree.frontier.push_back (*id);
+              tree.reached++;
+            }
+        }
+
+      // nothing is left to discover once every node is reached
+      if (tree.reached == tree.parent.size ())
+        {
+          tree.frontier.clear ();
+        }
+    }
+
+  return tree.parent[sourceId] >= 0;
+}
+
+void
+Ipv4NixVectorRouting::GetUpstreamNeighbors (Ptr<Node> node, bool followDownEdges, std::vector<uint32_t> & neighbors)
+{
+  for (uint32_t i = 0; i < node->GetNDevices (); i++)
+    {
+      Ptr<NetDevice> localNetDevice = node->GetDevice (i);
+      Ptr<Channel> channel = localNetDevice->GetChannel ();
+      if (channel == 0)
+        {
+          continue;
+        }
+
+      NetDeviceContainer netDeviceContainer;
+      GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
+
+      // as in BFS, whether an edge can be used depends on
+      // the state of the interface it is sent from
+      for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
+        {
+          Ptr<Node> remoteNode = (*iter)->GetNode ();
+          if (!followDownEdges)
+            {
+              Ptr<Ipv4> ipv4 = remoteNode->GetObject<Ipv4> ();
+              if (ipv4 && !ipv4->IsUp (ipv4->GetInterfaceForDevice (*iter)))
+                {
+                  continue;
+                }
+              if (!(*iter)->IsLinkUp ())
+                {
+                  continue;
+                }
+            }
+          neighbors.push_back (remoteNode->GetId ());
+        }
+    }
+}
+
+void
+Ipv4NixVectorRouting::GetDownstreamNeighbors (Ptr<Node> node, bool followDownEdges, std::vector<uint32_t> & neighbors)
+{
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  for (uint32_t i = 0; i < node->GetNDevices (); i++)
+    {
+      Ptr<NetDevice> localNetDevice = node->GetDevice (i);
+      if (!followDownEdges)
+        {
+          if (ipv4 && !ipv4->IsUp (ipv4->GetInterfaceForDevice (localNetDevice)))
+            {
+              continue;
+            }
+          if (!localNetDevice->IsLinkUp ())
+            {
+              continue;
+            }
+        }
+      Ptr<Channel> channel = localNetDevice->GetChannel ();
+      if (channel == 0)
+        {
+          continue;
+        }
+
+      NetDeviceContainer netDeviceContainer;
+      GetAdjacentNetDevices (localNetDevice, channel, netDeviceContainer);
+      for (NetDeviceContainer::Iterator iter = netDeviceContainer.Begin (); iter != netDeviceContainer.End (); iter++)
+        {
+          neighbors.push_back ((*iter)->GetNode ()->GetId ());
+        }
+    }
+}
+
+bool
+Ipv4NixVectorRouting::GetPathFromDestinationTree (uint32_t sourceId, uint32_t destId, std::vector<uint32_t> & pathNodes)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  uint32_t numberOfNodes = NodeList::GetNNodes ();
+  CriticalSection cs (g_destinationTreesMutex);
+  NixDestinationTreeMap_t & trees = GetDestinationTrees (m_followDownEdges);
+  NixDestinationTree & tree = trees[destId];
+
+  // (re)start the tree from its root if it is new or nodes were added
+  if (tree.parent.size () != numberOfNodes)
+    {
+      NS_LOG_LOGIC ("Starting tree towards node " << destId);
+      tree.parent.assign (numberOfNodes, -1);
+      tree.depth.assign (numberOfNodes, 0);
+      tree.frontier.clear ();
+      tree.parent[destId] = destId;
+      tree.frontier.push_back (destId);
+      tree.reached = 1;
+    }
+
+  if (!GrowDestinationTree (tree, sourceId, m_followDownEdges))
+    {
+      return false;
+    }
+
+  pathNodes.clear ();
+  for (uint32_t id = sourceId; id != destId; id = tree.parent[id])
+    {
+      pathNodes.push_back (id);
+    }
+  pathNodes.push_back (destId);
+  std::reverse (pathNodes.begin (), pathNodes.end ());
+  return true;
+}
+
 Ptr<NixVector>
-Ipv4NixVectorRouting::GetNixVector (Ptr<Node> source, Ipv4Address dest, Ptr<NetDevice> oif)
+Ipv4NixVectorRouting::GetNixVector (Ptr<Node> source, Ipv4Address dest, Ptr<NetDevice> oif,
+                                    std::vector<uint32_t> & pathNodes)
 {
   NS_LOG_FUNCTION_NOARGS ();
 
@@ -159,6 +603,19 @@ Ipv4NixVectorRouting::GetNixVector (Ptr<Node> source, Ipv4Address dest, Ptr<NetD
     }
   else
     {
+      // paths to the same destination from every source
+      // are kept in a single shared tree
+      if (m_useDestinationTrees && !oif)
+        {
+          if (!GetPathFromDestinationTree (source->GetId (), destNode->GetId (), pathNodes))
+            {
+              NS_LOG_ERROR ("No routing path exists");
+              return 0;
+            }
+          BuildNixVectorFromPath (pathNodes, nixVector);
+          return nixVector;
+        }
+
       // otherwise proceed as normal 
       // and build the nix vector
       std::vector< Ptr<Node> > parentVector;
@@ -167,6 +624,13 @@ Ipv4NixVectorRouting::GetNixVector (Ptr<Node> source, Ipv4Address dest, Ptr<NetD
 
       if (BuildNixVector (parentVector, source->GetId (), destNode->GetId (), nixVector))
         {
+          // retrace the parent vector to record which nodes this path traverses
+          pathNodes.clear ();
+          for (uint32_t id = destNode->GetId (); id != source->GetId (); id = parentVector.at (id)->GetId ())
+            {
+              pathNodes.push_back (id);
+            }
+          pathNodes.push_back (source->GetId ());
           return nixVector;
         }
       else
@@ -253,9 +717,43 @@ Ipv4NixVectorRouting::BuildNixVector (const std::vector< Ptr<Node> > & parentVec
 
   Ptr<Node> parentNode = parentVector.at (dest);
 
+  uint32_t totalNeighbors = 0;
+  uint32_t destId = FindNeighborIndex (parentNode, dest, totalNeighbors);
+  NS_LOG_LOGIC ("Adding Nix: " << destId << " with " 
+                               << nixVector->BitCount (totalNeighbors) << " bits, for node " << parentNode->GetId ());
+  nixVector->AddNeighborIndex (destId, nixVector->BitCount (totalNeighbors));
+
+  // recurse through parent vector, grabbing the path 
+  // and building the nix vector
+  BuildNixVector (parentVector, source, (parentVector.at (dest))->GetId (), nixVector);
+  return true;
+}
+
+void
+Ipv4NixVectorRouting::BuildNixVectorFromPath (const std::vector<uint32_t> & pathNodes, Ptr<NixVector> nixVector)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
+  // same order as BuildNixVector: the last hop is added first
+  for (uint32_t hop = 0; hop + 1 < pathNodes.size (); hop++)
+    {
+      Ptr<Node> parentNode = NodeList::GetNode (pathNodes[hop + 1]);
+      uint32_t totalNeighbors = 0;
+      uint32_t destId = FindNeighborIndex (parentNode, pathNodes[hop], totalNeighbors);
+      NS_LOG_LOGIC ("Adding Nix: " << destId << " with " 
+                                   << nixVector->BitCount (totalNeighbors) << " bits, for node " << parentNode->GetId ());
+      nixVector->AddNeighborIndex (destId, nixVector->BitCount (totalNeighbors));
+    }
+}
+
+uint32_t
+Ipv4NixVectorRouting::FindNeighborIndex (Ptr<Node> parentNode, uint32_t dest, uint32_t & totalNeighbors)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+
   uint32_t numberOfDevices = parentNode->GetNDevices ();
   uint32_t destId = 0;
-  uint32_t totalNeighbors = 0;
+  totalNeighbors = 0;
 
   // scan through the net devices on the parent node
   // and then look at the nodes adjacent to them
@@ -299,14 +797,7 @@ Ipv4NixVectorRouting::BuildNixVector (const std::vector< Ptr<Node> > & parentVec
 
       totalNeighbors += netDeviceContainer.GetN ();
     }
-  NS_LOG_LOGIC ("Adding Nix: " << destId << " with " 
-                               << nixVector->BitCount (totalNeighbors) << " bits, for node " << parentNode->GetId ());
-  nixVector->AddNeighborIndex (destId, nixVector->BitCount (totalNeighbors));
-
-  // recurse through parent vector, grabbing the path 
-  // and building the nix vector
-  BuildNixVector (parentVector, source, (parentVector.at (dest))->GetId (), nixVector);
-  return true;
+  return destId;
 }
 
 void
@@ -354,19 +845,7 @@ Ipv4NixVectorRouting::GetNodeByIp (Ipv4Address dest)
 { 
   NS_LOG_FUNCTION_NOARGS ();
 
-  NodeContainer allNodes = NodeContainer::GetGlobal ();
-  Ptr<Node> destNode;
-
-  for (NodeContainer::Iterator i = allNodes.Begin (); i != allNodes.End (); ++i)
-    {
-      Ptr<Node> node = *i;
-      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
-      if (ipv4->GetInterfaceForAddress (dest) != -1)
-        {
-          destNode = node;
-          break;
-        }
-    }
+  Ptr<Node> destNode = Ipv4AddressNodeIndex::GetNode (dest);
 
   if (!destNode)
     {
@@ -409,7 +888,7 @@ Ipv4NixVectorRouting::FindTotalNeighbors ()
 }
 
 Ptr<BridgeNetDevice>
-Ipv4NixVectorRouting::NetDeviceIsBridged (Ptr<NetDevice> nd) const
+Ipv4NixVectorRouting::NetDeviceIsBridged (Ptr<NetDevice> nd)
 {
   NS_LOG_FUNCTION (nd);
 
@@ -512,10 +991,15 @@ Ipv4NixVectorRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<
       NS_LOG_LOGIC ("Nix-vector not in cache, build: ");
       // Build the nix-vector, given this node and the
       // dest IP address
-      nixVectorInCache = GetNixVector (m_node, header.GetDestination (), oif);
+      std::vector<uint32_t> pathNodes;
+      nixVectorInCache = GetNixVector (m_node, header.GetDestination (), oif, pathNodes);
 
       // cache it
       m_nixCache.insert (NixMap_t::value_type (header.GetDestination (), nixVectorInCache));
+      if (nixVectorInCache)
+        {
+          m_nixCachePaths.insert (NixPathMap_t::value_type (header.GetDestination (), pathNodes));
+        }
     }
 
   // path exists
@@ -721,22 +1205,22 @@ Ipv4NixVectorRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const
 void
 Ipv4NixVectorRouting::NotifyInterfaceUp (uint32_t i)
 {
-  FlushGlobalNixRoutingCache ();
+  NotifyTopologyChange (false);
 }
 void
 Ipv4NixVectorRouting::NotifyInterfaceDown (uint32_t i)
 {
-  FlushGlobalNixRoutingCache ();
+  NotifyTopologyChange (true);
 }
 void
 Ipv4NixVectorRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
-  FlushGlobalNixRoutingCache ();
+  NotifyTopologyChange (false);
 }
 void
 Ipv4NixVectorRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
-  FlushGlobalNixRoutingCache ();
+  NotifyTopologyChange (false);
 }
 
 bool
@@ -21,7 +21,10 @@
 #ifndef IPV4_NIX_VECTOR_ROUTING_H
 #define IPV4_NIX_VECTOR_ROUTING_H
 
+#include <deque>
 #include <map>
+#include <set>
+#include <vector>
 
 #include "ns3/channel.h"
 #include "ns3/node-container.h"
@@ -42,6 +45,33 @@ typedef std::map<Ipv4Address, Ptr<NixVector> > NixMap_t;
  * Map of Ipv4Address to Ipv4Route
  */
 typedef std::map<Ipv4Address, Ptr<Ipv4Route> > Ipv4RouteMap_t;
+/**
+ * Map of Ipv4Address to the ids of the nodes traversed by its NixVector
+ */
+typedef std::map<Ipv4Address, std::vector<uint32_t> > NixPathMap_t;
+
+/**
+ * Shortest-path tree towards a single destination node, shared by
+ * every source node routing towards it.  Trees are grown breadth
+ * first from the destination only as far as needed to reach the
+ * requesting source, so they may be partial.
+ */
+struct NixDestinationTree
+{
+  /* next hop from each node towards the destination, the
+   * destination itself for the root and -1 if not reached */
+  std::vector<int32_t> parent;
+  /* hop count from each reached node to the destination */
+  std::vector<uint32_t> depth;
+  /* nodes reached but whose neighbors are not yet explored */
+  std::deque<uint32_t> frontier;
+  /* number of nodes reached */
+  uint32_t reached;
+};
+/**
+ * Map of destination node id to its NixDestinationTree
+ */
+typedef std::map<uint32_t, NixDestinationTree> NixDestinationTreeMap_t;
 
 /**
  * Nix-vector routing protocol
@@ -73,11 +103,77 @@ public:
    */
   void FlushGlobalNixRoutingCache (void);
 
+  /**
+   * @brief Start a batch of run-time topology changes.
+   *
+   * While a batch is open, interface and address notifications
+   * are only recorded instead of each one walking the node list
+   * to flush the caches.  Batches may be nested; the caches are
+   * invalidated once, when the outermost batch is committed.
+   */
+  static void BeginTopologyChangeBatch (void);
+
+  /**
+   * @brief Commit the currently open batch of topology changes.
+   *
+   * If every change in the batch took an interface down, only
+   * the cached nix-vectors traversing a node with a downed
+   * interface are dropped.  Any other change (interface up,
+   * address added or removed) flushes all caches, since it may
+   * create shorter paths than the cached ones.
+   */
+  static void CommitTopologyChangeBatch (void);
+
 private:
+  friend class Ipv4NixVectorRoutingTestCase;
+
   /* flushes the cache which stores nix-vector based on
    * destination IP */
   void FlushNixCache (void);
 
+  /* flushes the cached nix-vectors whose path traverses
+   * any of the given nodes */
+  void FlushNixCacheForNodes (const std::set<uint32_t> & nodeIds);
+
+  /* flushes the caches of every node, or records that they
+   * must be flushed if a topology change batch is open */
+  void NotifyTopologyChange (bool interfaceDown);
+
+  /* returns the destination trees built by nodes with the given
+   * FollowDownEdges setting */
+  static NixDestinationTreeMap_t & GetDestinationTrees (bool followDownEdges);
+
+  /* drops every destination tree that depends on link state */
+  static void FlushDestinationTrees (void);
+
+  /* repairs the destination trees that depend on link state after
+   * interfaces of the given nodes went down: only the subtrees
+   * hanging off a broken tree edge are reattached.  Partial trees
+   * are dropped and regrown on demand instead */
+  static void RepairDestinationTrees (const std::set<uint32_t> & nodeIds);
+
+  /* reattaches the given orphaned subtree roots and their
+   * descendants to a complete destination tree */
+  static void RepairDestinationTree (NixDestinationTree & tree, const std::vector<uint32_t> & brokenNodes);
+
+  /* grows the tree until sourceId is reached or every node
+   * reachable from the destination is in the tree */
+  static bool GrowDestinationTree (NixDestinationTree & tree, uint32_t sourceId, bool followDownEdges);
+
+  /* writes to the last argument the ids of the nodes which can
+   * forward packets directly to the given node */
+  static void GetUpstreamNeighbors (Ptr<Node> node, bool followDownEdges, std::vector<uint32_t> & neighbors);
+
+  /* writes to the last argument the ids of the nodes to which
+   * the given node can forward packets directly */
+  static void GetDownstreamNeighbors (Ptr<Node> node, bool followDownEdges, std::vector<uint32_t> & neighbors);
+
+  /* looks up the path from sourceId to destId in the shared
+   * destination tree, growing it if needed, and writes the ids of
+   * the nodes traversed, from destination back to source, to the
+   * last argument.  Returns false if there is no path */
+  bool GetPathFromDestinationTree (uint32_t sourceId, uint32_t destId, std::vector<uint32_t> & pathNodes);
+
   /* flushes the cache which stores the Ipv4 route
    * based on the destination IP */
   void FlushIpv4RouteCache (void);
@@ -89,8 +185,9 @@ private:
 
   /*  takes in the source node and dest IP and calls GetNodeByIp,
    *  BFS, accounting for any output interface specified, and finally
-   *  BuildNixVector to return the built nix-vector */
-  Ptr<NixVector> GetNixVector (Ptr<Node>, Ipv4Address, Ptr<NetDevice>);
+   *  BuildNixVector to return the built nix-vector.  The ids of the
+   *  nodes along the path are written to the last argument */
+  Ptr<NixVector> GetNixVector (Ptr<Node>, Ipv4Address, Ptr<NetDevice>, std::vector<uint32_t> &);
 
   /* checks the cache based on dest IP for the nix-vector */
   Ptr<NixVector> GetNixVectorInCache (Ipv4Address);
@@ -100,15 +197,23 @@ private:
 
   /* given a net-device returns all the adjacent net-devices,
    * essentially getting the neighbors on that channel */
-  void GetAdjacentNetDevices (Ptr<NetDevice>, Ptr<Channel>, NetDeviceContainer &);
+  static void GetAdjacentNetDevices (Ptr<NetDevice>, Ptr<Channel>, NetDeviceContainer &);
 
-  /* iterates through the node list and finds the one
-   * corresponding to the given Ipv4Address */
+  /* looks up the node owning the given Ipv4Address
+   * in the global Ipv4AddressNodeIndex */
   Ptr<Node> GetNodeByIp (Ipv4Address);
 
   /* Recurses the parent vector, created by BFS and actually builds the nixvector */
   bool BuildNixVector (const std::vector< Ptr<Node> > & parentVector, uint32_t source, uint32_t dest, Ptr<NixVector> nixVector);
 
+  /* builds the nixvector from the ids of the nodes along the path,
+   * ordered from destination back to source */
+  void BuildNixVectorFromPath (const std::vector<uint32_t> & pathNodes, Ptr<NixVector> nixVector);
+
+  /* returns the neighbor index of node dest among all the neighbors
+   * of parentNode, whose number is written to the last argument */
+  uint32_t FindNeighborIndex (Ptr<Node> parentNode, uint32_t dest, uint32_t & totalNeighbors);
+
   /* special variation of BuildNixVector for when a node is sending to itself */
   bool BuildNixVectorLocal (Ptr<NixVector> nixVector);
 
@@ -117,7 +222,7 @@ private:
   uint32_t FindTotalNeighbors (void);
 
   /* determine if the netdevice is bridged */
-  Ptr<BridgeNetDevice> NetDeviceIsBridged (Ptr<NetDevice> nd) const;
+  static Ptr<BridgeNetDevice> NetDeviceIsBridged (Ptr<NetDevice> nd);
 
 
   /* Nix index is with respect to the neighbors.  The net-device index must be
@@ -159,6 +264,10 @@ private:
   /* cache stores Ipv4Routes based on destination ip */
   Ipv4RouteMap_t m_ipv4RouteCache;
 
+  /* cache stores the nodes traversed by each cached nix-vector,
+   * for selective invalidation when interfaces go down */
+  NixPathMap_t m_nixCachePaths;
+
   Ptr<Ipv4> m_ipv4;
   Ptr<Node> m_node;
 
@@ -168,6 +277,10 @@ private:
 
   /* If true, BFS will follow down links and down interfaces */
   bool m_followDownEdges;
+
+  /* If true, paths are looked up in shortest-path trees shared
+   * by all the source nodes instead of running a BFS per source */
+  bool m_useDestinationTrees;
 };
 } // namespace ns3
 
@@ -0,0 +1,518 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/node-container.h"
+#include "ns3/node-list.h"
+#include "ns3/simple-channel.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-nix-vector-helper.h"
+#include "ns3/ipv4-nix-vector-routing.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace ns3 {
+
+namespace {
+
+// nodes 0 to 9 form the mesh below, node 10 has an address but no link
+//
+//   0 - 1 - 2
+//   | \ |   |
+//   3 - 4 - 5
+//   |   |   |
+//   6 - 7 - 8 - 9
+//
+const uint32_t N_NODES = 11;
+const uint32_t LINKS[][2] = {
+  { 0, 1 }, { 1, 2 }, { 3, 4 }, { 4, 5 }, { 6, 7 }, { 7, 8 }, { 8, 9 },
+  { 0, 3 }, { 3, 6 }, { 1, 4 }, { 4, 7 }, { 2, 5 }, { 5, 8 }, { 0, 4 }
+};
+const uint32_t UNREACHABLE = 0xffffffff;
+
+} // anonymous namespace
+
+/**
+ * Builds the mesh, with nix-vector routing using destination trees on
+ * every node, and gives its test cases access to the trees and caches.
+ * The trees are indexed by node id, the helpers by the index of the node
+ * in the mesh.
+ */
+class Ipv4NixVectorRoutingTestCase : public TestCase
+{
+public:
+  Ipv4NixVectorRoutingTestCase (std::string name);
+
+protected:
+  void BuildMesh (Ipv4Address network);
+  uint32_t GetId (uint32_t node) const;
+  Ptr<Ipv4NixVectorRouting> GetRouting (uint32_t node) const;
+  /** Takes every interface of the node down. */
+  void TakeDown (uint32_t node);
+  /** Returns the hops from source to dest of a cold BFS, or UNREACHABLE. */
+  uint32_t GetBfsDistance (uint32_t source, uint32_t dest);
+  bool GetTreePath (uint32_t source, uint32_t dest, std::vector<uint32_t> &path);
+  /** Looks up the path from every node to every node in the trees, which completes them. */
+  void GrowTrees (void);
+  /** Checks the paths from every node against a cold BFS. */
+  void CheckPaths (void);
+  /** Checks the parents and depths of a complete tree against a cold BFS. */
+  void CheckTree (uint32_t dest, const NixDestinationTree &tree);
+  void CompareTrees (uint32_t dest, const NixDestinationTree &tree, const NixDestinationTree &expected);
+  NixDestinationTreeMap_t &GetTrees (void);
+  NixMap_t &GetNixCache (uint32_t node);
+  NixPathMap_t &GetNixCachePaths (uint32_t node);
+  Ipv4RouteMap_t &GetIpv4RouteCache (uint32_t node);
+  void RouteOutput (uint32_t source, uint32_t dest);
+
+  NodeContainer m_nodes;
+  std::vector<Ipv4Address> m_addresses;
+
+private:
+  virtual void DoTeardown (void);
+};
+
+Ipv4NixVectorRoutingTestCase::Ipv4NixVectorRoutingTestCase (std::string name)
+  : TestCase (name)
+{
+}
+
+void
+Ipv4NixVectorRoutingTestCase::DoTeardown (void)
+{
+  GetTrees ().clear ();
+  Simulator::Destroy ();
+}
+
+void
+Ipv4NixVectorRoutingTestCase::BuildMesh (Ipv4Address network)
+{
+  Ipv4NixVectorHelper nixRouting;
+  nixRouting.SetAttribute ("UseDestinationTrees", BooleanValue (true));
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (nixRouting);
+  m_nodes.Create (N_NODES);
+  internet.Install (m_nodes);
+
+  Ipv4AddressHelper addresses;
+  addresses.SetBase (network, "255.255.255.252");
+  for (uint32_t i = 0; i < sizeof (LINKS) / sizeof (LINKS[0]); i++)
+    {
+      Ptr<SimpleChannel> channel = CreateObject<SimpleChannel> ();
+      NetDeviceContainer devices;
+      for (uint32_t j = 0; j < 2; j++)
+        {
+          Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+          device->SetAddress (Mac48Address::Allocate ());
+          device->SetChannel (channel);
+          m_nodes.Get (LINKS[i][j])->AddDevice (device);
+          devices.Add (device);
+        }
+      addresses.Assign (devices);
+      addresses.NewNetwork ();
+    }
+  Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+  device->SetAddress (Mac48Address::Allocate ());
+  m_nodes.Get (N_NODES - 1)->AddDevice (device);
+  addresses.Assign (NetDeviceContainer (device));
+
+  m_addresses.clear ();
+  for (uint32_t i = 0; i < N_NODES; i++)
+    {
+      m_addresses.push_back (m_nodes.Get (i)->GetObject<Ipv4> ()->GetAddress (1, 0).GetLocal ());
+    }
+}
+
+uint32_t
+Ipv4NixVectorRoutingTestCase::GetId (uint32_t node) const
+{
+  return m_nodes.Get (node)->GetId ();
+}
+
+Ptr<Ipv4NixVectorRouting>
+Ipv4NixVectorRoutingTestCase::GetRouting (uint32_t node) const
+{
+  return m_nodes.Get (node)->GetObject<Ipv4NixVectorRouting> ();
+}
+
+void
+Ipv4NixVectorRoutingTestCase::TakeDown (uint32_t node)
+{
+  Ptr<Ipv4> ipv4 = m_nodes.Get (node)->GetObject<Ipv4> ();
+  for (uint32_t i = 1; i < ipv4->GetNInterfaces (); i++)
+    {
+      ipv4->SetDown (i);
+    }
+}
+
+uint32_t
+Ipv4NixVectorRoutingTestCase::GetBfsDistance (uint32_t source, uint32_t dest)
+{
+  if (source == dest)
+    {
+      return 0;
+    }
+  std::vector< Ptr<Node> > parents;
+  if (!GetRouting (source)->BFS (NodeList::GetNNodes (), m_nodes.Get (source), m_nodes.Get (dest), parents, 0))
+    {
+      return UNREACHABLE;
+    }
+  uint32_t hops = 0;
+  for (uint32_t id = GetId (dest); id != GetId (source); id = parents.at (id)->GetId ())
+    {
+      hops++;
+    }
+  return hops;
+}
+
+bool
+Ipv4NixVectorRoutingTestCase::GetTreePath (uint32_t source, uint32_t dest, std::vector<uint32_t> &path)
+{
+  return GetRouting (source)->GetPathFromDestinationTree (GetId (source), GetId (dest), path);
+}
+
+void
+Ipv4NixVectorRoutingTestCase::GrowTrees (void)
+{
+  // node 10 can't reach any other node, so looking up its paths grows
+  // every tree until its frontier is empty
+  std::vector<uint32_t> path;
+  for (uint32_t dest = 0; dest < N_NODES; dest++)
+    {
+      for (uint32_t source = 0; source < N_NODES; source++)
+        {
+          GetTreePath (source, dest, path);
+        }
+    }
+}
+
+void
+Ipv4NixVectorRoutingTestCase::CheckPaths (void)
+{
+  for (uint32_t dest = 0; dest < N_NODES; dest++)
+    {
+      for (uint32_t source = 0; source < N_NODES; source++)
+        {
+          if (source == dest)
+            {
+              continue;
+            }
+          std::vector<uint32_t> path;
+          bool found = GetTreePath (source, dest, path);
+          uint32_t distance = GetBfsDistance (source, dest);
+          bool reachable = distance != UNREACHABLE;
+          NS_TEST_EXPECT_MSG_EQ (found, reachable,
+                                 "tree and BFS disagree on a path from " << source << " to " << dest);
+          if (!found || distance == UNREACHABLE)
+            {
+              continue;
+            }
+          NS_TEST_EXPECT_MSG_EQ (path.size (), distance + 1, "path from " << source << " to " << dest << " not shortest");
+          NS_TEST_EXPECT_MSG_EQ (path.front (), GetId (dest), "path from " << source << " to " << dest << " ends elsewhere");
+          NS_TEST_EXPECT_MSG_EQ (path.back (), GetId (source), "path from " << source << " to " << dest << " starts elsewhere");
+          for (uint32_t hop = 0; hop + 1 < path.size (); hop++)
+            {
+              std::vector<uint32_t> downstream;
+              Ipv4NixVectorRouting::GetDownstreamNeighbors (NodeList::GetNode (path[hop + 1]), false, downstream);
+              NS_TEST_EXPECT_MSG_EQ (std::count (downstream.begin (), downstream.end (), path[hop]), 1,
+                                     "path from " << source << " to " << dest << " takes an unusable edge");
+            }
+        }
+    }
+}
+
+void
+Ipv4NixVectorRoutingTestCase::CheckTree (uint32_t dest, const NixDestinationTree &tree)
+{
+  NS_TEST_ASSERT_MSG_EQ (tree.parent.size (), NodeList::GetNNodes (), "tree towards " << dest << " has a wrong size");
+  NS_TEST_EXPECT_MSG_EQ (tree.frontier.empty (), true, "tree towards " << dest << " is not complete");
+  uint32_t reached = 0;
+  for (uint32_t node = 0; node < N_NODES; node++)
+    {
+      uint32_t id = GetId (node);
+      uint32_t distance = GetBfsDistance (node, dest);
+      bool inTree = tree.parent[id] >= 0;
+      bool reachable = distance != UNREACHABLE;
+      NS_TEST_EXPECT_MSG_EQ (inTree, reachable,
+                             "tree towards " << dest << " and BFS disagree on node " << node);
+      if (tree.parent[id] < 0 || distance == UNREACHABLE)
+        {
+          continue;
+        }
+      reached++;
+      NS_TEST_EXPECT_MSG_EQ (tree.depth[id], distance, "wrong depth of node " << node << " in the tree towards " << dest);
+      if (node == dest)
+        {
+          NS_TEST_EXPECT_MSG_EQ (tree.parent[id], (int32_t)id, "root of the tree towards " << dest << " has a parent");
+          continue;
+        }
+      std::vector<uint32_t> downstream;
+      Ipv4NixVectorRouting::GetDownstreamNeighbors (m_nodes.Get (node), false, downstream);
+      NS_TEST_EXPECT_MSG_EQ (std::count (downstream.begin (), downstream.end (), (uint32_t)tree.parent[id]), 1,
+                             "node " << node << " can't send to its parent in the tree towards " << dest);
+      NS_TEST_EXPECT_MSG_EQ (tree.depth[tree.parent[id]] + 1, tree.depth[id],
+                             "parent of node " << node << " in the tree towards " << dest << " is not one hop closer");
+    }
+  NS_TEST_EXPECT_MSG_EQ (tree.reached, reached, "wrong number of nodes reached by the tree towards " << dest);
+}
+
+void
+Ipv4NixVectorRoutingTestCase::CompareTrees (uint32_t dest, const NixDestinationTree &tree, const NixDestinationTree &expected)
+{
+  // nodes at the same depth may be discovered in another order, so the
+  // parents of equal depth chosen may differ, but not who is reached nor
+  // how far from the destination
+  NS_TEST_EXPECT_MSG_EQ (tree.reached, expected.reached, "tree towards " << dest << " reaches other nodes");
+  for (uint32_t node = 0; node < N_NODES; node++)
+    {
+      uint32_t id = GetId (node);
+      bool inTree = tree.parent[id] >= 0;
+      bool inExpected = expected.parent[id] >= 0;
+      NS_TEST_EXPECT_MSG_EQ (inTree, inExpected,
+                             "node " << node << " wrongly (un)reached by the tree towards " << dest);
+      if (tree.parent[id] >= 0 && expected.parent[id] >= 0)
+        {
+          NS_TEST_EXPECT_MSG_EQ (tree.depth[id], expected.depth[id],
+                                 "wrong depth of node " << node << " in the tree towards " << dest);
+        }
+    }
+}
+
+NixDestinationTreeMap_t &
+Ipv4NixVectorRoutingTestCase::GetTrees (void)
+{
+  return Ipv4NixVectorRouting::GetDestinationTrees (false);
+}
+
+NixMap_t &
+Ipv4NixVectorRoutingTestCase::GetNixCache (uint32_t node)
+{
+  return GetRouting (node)->m_nixCache;
+}
+
+NixPathMap_t &
+Ipv4NixVectorRoutingTestCase::GetNixCachePaths (uint32_t node)
+{
+  return GetRouting (node)->m_nixCachePaths;
+}
+
+Ipv4RouteMap_t &
+Ipv4NixVectorRoutingTestCase::GetIpv4RouteCache (uint32_t node)
+{
+  return GetRouting (node)->m_ipv4RouteCache;
+}
+
+void
+Ipv4NixVectorRoutingTestCase::RouteOutput (uint32_t source, uint32_t dest)
+{
+  Ipv4Header header;
+  header.SetDestination (m_addresses[dest]);
+  Socket::SocketErrno sockerr;
+  GetRouting (source)->RouteOutput (0, header, 0, sockerr);
+}
+
+
+class NixDestinationTreeTestCase : public Ipv4NixVectorRoutingTestCase
+{
+public:
+  NixDestinationTreeTestCase ();
+  virtual void DoRun (void);
+};
+
+NixDestinationTreeTestCase::NixDestinationTreeTestCase ()
+  : Ipv4NixVectorRoutingTestCase ("Check the destination trees and the paths looked up in them against a cold BFS")
+{
+}
+
+void
+NixDestinationTreeTestCase::DoRun (void)
+{
+  BuildMesh ("10.1.0.0");
+  GetTrees ().clear ();
+  CheckPaths ();
+  for (uint32_t dest = 0; dest < N_NODES; dest++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (GetTrees ().count (GetId (dest)), 1, "no tree towards " << dest);
+      CheckTree (dest, GetTrees ()[GetId (dest)]);
+    }
+
+  // out of a batch, an interface going down drops every tree
+  TakeDown (4);
+  NS_TEST_EXPECT_MSG_EQ (GetTrees ().size (), 0, "trees kept after an interface went down");
+  CheckPaths ();
+  for (uint32_t dest = 0; dest < N_NODES; dest++)
+    {
+      CheckTree (dest, GetTrees ()[GetId (dest)]);
+    }
+}
+
+
+class NixDestinationTreeRepairTestCase : public Ipv4NixVectorRoutingTestCase
+{
+public:
+  NixDestinationTreeRepairTestCase ();
+  virtual void DoRun (void);
+};
+
+NixDestinationTreeRepairTestCase::NixDestinationTreeRepairTestCase ()
+  : Ipv4NixVectorRoutingTestCase ("Check that the trees repaired after a batch of failures are those rebuilt from scratch")
+{
+}
+
+void
+NixDestinationTreeRepairTestCase::DoRun (void)
+{
+  BuildMesh ("10.2.0.0");
+  GetTrees ().clear ();
+  std::vector<uint32_t> path;
+  uint32_t complete[] = { 0, 1, 2, 3, 4, 5, 8, 9, 10 };
+  for (uint32_t i = 0; i < sizeof (complete) / sizeof (complete[0]); i++)
+    {
+      for (uint32_t source = 0; source < N_NODES; source++)
+        {
+          GetTreePath (source, complete[i], path);
+        }
+    }
+  // trees which stop once they reach their first source: the one towards
+  // 6 only reaches 3 and 7, the one towards 7 reaches 4, whose edge to 7
+  // goes down
+  GetTreePath (7, 6, path);
+  GetTreePath (4, 7, path);
+  NS_TEST_ASSERT_MSG_EQ (GetTrees ()[GetId (6)].frontier.empty (), false, "tree towards 6 not partial");
+  NS_TEST_ASSERT_MSG_EQ (GetTrees ()[GetId (7)].frontier.empty (), false, "tree towards 7 not partial");
+  NS_TEST_ASSERT_MSG_EQ (GetTrees ()[GetId (9)].reached, 10, "tree towards 9 not complete");
+
+  // 8 is the only way to and from 9, which is then unreachable
+  Ipv4NixVectorRouting::BeginTopologyChangeBatch ();
+  TakeDown (4);
+  TakeDown (8);
+  NS_TEST_EXPECT_MSG_EQ (GetTrees ().size (), 11, "trees changed before the batch is committed");
+  Ipv4NixVectorRouting::CommitTopologyChangeBatch ();
+
+  NS_TEST_EXPECT_MSG_EQ (GetTrees ().size (), 10, "wrong trees dropped");
+  NS_TEST_EXPECT_MSG_EQ (GetTrees ().count (GetId (7)), 0, "broken partial tree kept");
+  NS_TEST_ASSERT_MSG_EQ (GetTrees ().count (GetId (6)), 1, "partial tree dropped though intact");
+  NS_TEST_EXPECT_MSG_EQ (GetTrees ()[GetId (6)].frontier.empty (), false, "partial tree lost its frontier");
+  NS_TEST_EXPECT_MSG_EQ (GetTrees ()[GetId (9)].reached, 1, "unreachable destination still reached");
+
+  // the partial tree resumes from its frontier, the dropped one regrows
+  GrowTrees ();
+  NixDestinationTreeMap_t repaired = GetTrees ();
+  GetTrees ().clear ();
+  GrowTrees ();
+  for (uint32_t dest = 0; dest < N_NODES; dest++)
+    {
+      CheckTree (dest, repaired[GetId (dest)]);
+      CompareTrees (dest, repaired[GetId (dest)], GetTrees ()[GetId (dest)]);
+    }
+}
+
+
+class NixCacheFlushTestCase : public Ipv4NixVectorRoutingTestCase
+{
+public:
+  NixCacheFlushTestCase ();
+  virtual void DoRun (void);
+};
+
+NixCacheFlushTestCase::NixCacheFlushTestCase ()
+  : Ipv4NixVectorRoutingTestCase ("Check that a batch of failures only flushes the nix-vectors through the failed nodes")
+{
+}
+
+void
+NixCacheFlushTestCase::DoRun (void)
+{
+  BuildMesh ("10.3.0.0");
+  for (uint32_t source = 0; source < N_NODES; source++)
+    {
+      for (uint32_t dest = 0; dest < N_NODES; dest++)
+        {
+          if (source != dest)
+            {
+              RouteOutput (source, dest);
+            }
+        }
+    }
+  std::vector<NixMap_t> caches;
+  std::vector<NixPathMap_t> paths;
+  for (uint32_t node = 0; node < N_NODES; node++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (GetNixCache (node).size (), N_NODES - 1, "nix-vectors of node " << node << " not cached");
+      bool isolated = node == N_NODES - 1;
+      NS_TEST_ASSERT_MSG_EQ (GetIpv4RouteCache (node).empty (), isolated,
+                             "routes of node " << node << " not cached");
+      caches.push_back (GetNixCache (node));
+      paths.push_back (GetNixCachePaths (node));
+    }
+
+  Ipv4NixVectorRouting::BeginTopologyChangeBatch ();
+  TakeDown (4);
+  Ipv4NixVectorRouting::CommitTopologyChangeBatch ();
+
+  uint32_t flushed = 0;
+  uint32_t kept = 0;
+  for (uint32_t node = 0; node < N_NODES; node++)
+    {
+      for (NixMap_t::const_iterator i = caches[node].begin (); i != caches[node].end (); i++)
+        {
+          // misses, such as those towards 10, are not paths
+          bool isPath = paths[node].count (i->first) == 1;
+          bool isHit = i->second != 0;
+          NS_TEST_EXPECT_MSG_EQ (isPath, isHit, "path of node " << node << " to " << i->first << " not recorded");
+          const std::vector<uint32_t> &path = paths[node][i->first];
+          bool traverses = std::count (path.begin (), path.end (), GetId (4)) > 0;
+          uint32_t expectedCount = traverses ? 0 : 1;
+          NS_TEST_EXPECT_MSG_EQ (GetNixCache (node).count (i->first), expectedCount,
+                                 "wrong flush of the nix-vector of node " << node << " to " << i->first);
+          expectedCount = isPath && !traverses ? 1 : 0;
+          NS_TEST_EXPECT_MSG_EQ (GetNixCachePaths (node).count (i->first), expectedCount,
+                                 "wrong flush of the path of node " << node << " to " << i->first);
+          if (!traverses)
+            {
+              NS_TEST_EXPECT_MSG_EQ (GetNixCache (node)[i->first], i->second,
+                                     "nix-vector of node " << node << " to " << i->first << " rebuilt");
+            }
+          flushed += traverses;
+          kept += isPath && !traverses;
+        }
+      // routes are cheap to rebuild and may all have another next hop
+      NS_TEST_EXPECT_MSG_EQ (GetIpv4RouteCache (node).empty (), true, "routes of node " << node << " kept");
+    }
+  NS_TEST_EXPECT_MSG_GT (flushed, 0, "no nix-vector went through the failed node");
+  NS_TEST_EXPECT_MSG_GT (kept, 0, "every nix-vector went through the failed node");
+}
+
+
+static class Ipv4NixVectorRoutingTestSuite : public TestSuite
+{
+public:
+  Ipv4NixVectorRoutingTestSuite ()
+    : TestSuite ("ipv4-nix-vector-routing", UNIT)
+  {
+    AddTestCase (new NixDestinationTreeTestCase ());
+    AddTestCase (new NixDestinationTreeRepairTestCase ());
+    AddTestCase (new NixCacheFlushTestCase ());
+  }
+} g_ipv4NixVectorRoutingTestSuite;
+
+} // namespace ns3
@@ -189,6 +189,19 @@ PointToPointNetDevice::DoDispose ()
   NetDevice::DoDispose ();
 }
 
+void
+PointToPointNetDevice::DoReset ()
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_txMachineState = READY;
+  m_currentPkt = 0;
+  if (m_queue != 0)
+    {
+      m_queue->DequeueAll ();
+    }
+  NetDevice::DoReset ();
+}
+
 void
 PointToPointNetDevice::SetDataRate (DataRate bps)
 {
@@ -194,6 +194,11 @@ private:
   PointToPointNetDevice (const PointToPointNetDevice &);
 
   virtual void DoDispose (void);
+  /**
+   * \brief Drop the packets and transmission left behind by a stopped simulation,
+   * so the device can be used again in the next one.
+   */
+  virtual void DoReset (void);
 
 private:
 
@@ -3,6 +3,18 @@
 #include "ns3/simulator.h"
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
+#include "ns3/core-config.h"
+#include "ns3/object-factory.h"
+#include "ns3/uinteger.h"
+#include "ns3/node-list.h"
+#include "ns3/output-stream-wrapper.h"
+#ifdef HAVE_PTHREAD_H
+#include "ns3/multithreaded-simulator-impl.h"
+#endif /* HAVE_PTHREAD_H */
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
 
 using namespace ns3;
 
@@ -55,6 +67,351 @@ PointToPointTest::DoRun (void)
 
   Simulator::Destroy ();
 }
+
+/**
+ * Packets go round a ring of nodes, each node logging what it receives
+ * and forwarding a smaller packet after a while, with the default and the
+ * multithreaded simulators: each node must receive the same packets at
+ * the same times.
+ */
+class PointToPointParallelTest : public TestCase
+{
+public:
+  PointToPointParallelTest ();
+
+  virtual void DoRun (void);
+
+private:
+  // the times and sizes of the packets received by one node
+  typedef std::vector<std::pair<int64_t, uint32_t> > Log;
+
+  void Simulate (std::string implementation, uint32_t threads);
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+  void Forward (uint32_t node, uint32_t size);
+
+  static const uint32_t N = 8;
+  uint32_t m_firstId;
+  // whether the ring holds the only nodes, whose channels set the lookahead
+  bool m_alone;
+  std::vector<Ptr<PointToPointNetDevice> > m_next;
+  std::vector<Log> m_logs;
+};
+
+PointToPointParallelTest::PointToPointParallelTest ()
+  : TestCase ("Check that the multithreaded simulator runs the nodes of a ring as the default one does")
+{
+}
+
+bool
+PointToPointParallelTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from)
+{
+  uint32_t node = device->GetNode ()->GetId () - m_firstId;
+  NS_ASSERT (Simulator::GetContext () == device->GetNode ()->GetId ());
+  m_logs[node].push_back (std::make_pair (Simulator::Now ().GetTimeStep (), packet->GetSize ()));
+  if (packet->GetSize () > 1)
+    {
+      Simulator::Schedule (MicroSeconds (packet->GetSize ()), &PointToPointParallelTest::Forward,
+                           this, node, packet->GetSize () - 1);
+    }
+  return true;
+}
+
+void
+PointToPointParallelTest::Forward (uint32_t node, uint32_t size)
+{
+  m_next[node]->Send (Create<Packet> (size), m_next[node]->GetBroadcast (), 0x800);
+}
+
+void
+PointToPointParallelTest::Simulate (std::string implementation, uint32_t threads)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (implementation);
+  if (threads != 0)
+    {
+      factory.Set ("ThreadCount", UintegerValue (threads));
+    }
+  Simulator::SetImplementation (factory.Create<SimulatorImpl> ());
+
+  std::vector<Ptr<Node> > nodes;
+  for (uint32_t i = 0; i < N; i++)
+    {
+      nodes.push_back (CreateObject<Node> ());
+    }
+  m_firstId = nodes[0]->GetId ();
+  m_next.clear ();
+  for (uint32_t i = 0; i < N; i++)
+    {
+      Ptr<PointToPointNetDevice> next = CreateObject<PointToPointNetDevice> ();
+      Ptr<PointToPointNetDevice> prev = CreateObject<PointToPointNetDevice> ();
+      Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+      channel->SetAttribute ("Delay", TimeValue (MilliSeconds (2 + i % 3)));
+      next->Attach (channel);
+      next->SetAddress (Mac48Address::Allocate ());
+      next->SetQueue (CreateObject<DropTailQueue> ());
+      prev->Attach (channel);
+      prev->SetAddress (Mac48Address::Allocate ());
+      prev->SetQueue (CreateObject<DropTailQueue> ());
+      nodes[i]->AddDevice (next);
+      nodes[(i + 1) % N]->AddDevice (prev);
+      next->SetReceiveCallback (MakeCallback (&PointToPointParallelTest::Receive, this));
+      prev->SetReceiveCallback (MakeCallback (&PointToPointParallelTest::Receive, this));
+      m_next.push_back (next);
+    }
+  m_logs.assign (N, Log ());
+
+  for (uint32_t i = 0; i < N; i++)
+    {
+      Simulator::ScheduleWithContext (nodes[i]->GetId (), MicroSeconds (100 * i + 7),
+                                      &PointToPointParallelTest::Forward, this, i, 20 + i);
+    }
+  // an event without context, which runs between the windows
+  Simulator::Schedule (MilliSeconds (50), &PointToPointParallelTest::Forward, this, 3, 10);
+  Simulator::Stop (MilliSeconds (200));
+  Simulator::Run ();
+  NS_TEST_EXPECT_MSG_EQ (Simulator::Now (), MilliSeconds (200), "stopped at the wrong time by " << implementation);
+
+#ifdef HAVE_PTHREAD_H
+  Ptr<MultithreadedSimulatorImpl> impl = DynamicCast<MultithreadedSimulatorImpl> (Simulator::GetImplementation ());
+  if (impl != 0)
+    {
+      if (m_alone)
+        {
+          NS_TEST_EXPECT_MSG_EQ (impl->GetLookahead (), MilliSeconds (2), "wrong lookahead");
+        }
+      NS_TEST_EXPECT_MSG_EQ (impl->GetThreads (), threads, "wrong number of threads");
+      NS_TEST_EXPECT_MSG_GT (impl->GetWindows (), 1, "no windows");
+    }
+#endif /* HAVE_PTHREAD_H */
+
+  Simulator::Destroy ();
+  m_next.clear ();
+}
+
+void
+PointToPointParallelTest::DoRun (void)
+{
+  // the nodes of the earlier test cases outlive them
+  m_alone = NodeList::GetNNodes () == 0;
+  Simulate ("ns3::DefaultSimulatorImpl", 0);
+  std::vector<Log> expected = m_logs;
+  uint32_t received = 0;
+  for (uint32_t i = 0; i < N; i++)
+    {
+      received += expected[i].size ();
+    }
+  NS_TEST_ASSERT_MSG_GT (received, N * 10, "too few packets went round the ring");
+
+#ifdef HAVE_PTHREAD_H
+  uint32_t threads[] = { 1, 4 };
+  for (uint32_t t = 0; t < 2; t++)
+    {
+      Simulate ("ns3::MultithreadedSimulatorImpl", threads[t]);
+      for (uint32_t i = 0; i < N; i++)
+        {
+          NS_TEST_ASSERT_MSG_EQ (m_logs[i].size (), expected[i].size (),
+                                 "node " << i << " received other packets with " << threads[t] << " threads");
+          for (uint32_t j = 0; j < expected[i].size (); j++)
+            {
+              NS_TEST_ASSERT_MSG_EQ (m_logs[i][j].first, expected[i][j].first,
+                                     "packet " << j << " of node " << i << " received at another time with "
+                                     << threads[t] << " threads");
+              NS_TEST_ASSERT_MSG_EQ (m_logs[i][j].second, expected[i][j].second,
+                                     "packet " << j << " of node " << i << " differs with "
+                                     << threads[t] << " threads");
+            }
+        }
+    }
+#endif /* HAVE_PTHREAD_H */
+}
+
+#ifdef HAVE_PTHREAD_H
+static std::string
+Sort (std::string trace)
+{
+  std::vector<std::string> lines;
+  std::istringstream in (trace);
+  std::string line;
+  while (std::getline (in, line))
+    {
+      lines.push_back (line);
+    }
+  std::sort (lines.begin (), lines.end ());
+  std::ostringstream out;
+  for (uint32_t i = 0; i < lines.size (); i++)
+    {
+      out << lines[i] << '\n';
+    }
+  return out.str ();
+}
+
+/**
+ * All the nodes of a ring send a packet to the next one at the same time,
+ * and forward at once a new packet when they receive one, so that every
+ * window of the multithreaded simulator runs them all: the uids of the
+ * packets and the trace the nodes write must not depend on the threads.
+ *
+ * The multithreaded simulator doesn't break ties between the events of
+ * different nodes as DefaultSimulatorImpl does, in the order they were
+ * scheduled, but runs them in the order of the nodes: when the first sends
+ * are scheduled in the reverse order of the nodes, both run the same
+ * events at the same times, in another order.
+ */
+class PointToPointParallelTieTest : public TestCase
+{
+public:
+  PointToPointParallelTieTest ();
+
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \param simulator the TypeId name of the simulator implementation
+   * \param threads the ThreadCount of a MultithreadedSimulatorImpl
+   * \param reversed whether to schedule the first sends from the last node to the first
+   * \param uids whether to trace the packet uids, which only the multithreaded simulator gives per node
+   * \returns the trace
+   */
+  std::string Simulate (std::string simulator, uint32_t threads, bool reversed, bool uids);
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from);
+  void Forward (uint32_t node, uint32_t size);
+  // the uid of the packet, its node counted from the first of the ring
+  std::string GetUid (Ptr<const Packet> packet) const;
+
+  static const uint32_t N = 8;
+  uint32_t m_firstId;
+  std::vector<Ptr<PointToPointNetDevice> > m_next;
+  Ptr<OutputStreamWrapper> m_trace;
+  bool m_multithreaded;
+  bool m_uids;
+  uint32_t m_wrongUids;
+};
+
+PointToPointParallelTieTest::PointToPointParallelTieTest ()
+  : TestCase ("Check that the multithreaded simulator gives the same packet uids and traces with any number of threads, "
+              "running simultaneous events in the order of the nodes")
+{
+}
+
+bool
+PointToPointParallelTieTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> packet, uint16_t protocol, const Address &from)
+{
+  uint32_t node = device->GetNode ()->GetId () - m_firstId;
+  // the previous node of the ring created the packet
+  if (m_multithreaded && packet->GetUid () >> 32 != m_firstId + (node + N - 1) % N + 1)
+    {
+      m_wrongUids++;
+    }
+  *m_trace->GetStream () << Simulator::Now ().GetTimeStep () << " node " << node
+                         << " received " << GetUid (packet) << " of " << packet->GetSize () << " bytes\n";
+  if (packet->GetSize () > 1)
+    {
+      Forward (node, packet->GetSize () - 1);
+    }
+  return true;
+}
+
+std::string
+PointToPointParallelTieTest::GetUid (Ptr<const Packet> packet) const
+{
+  if (!m_uids)
+    {
+      return "packet";
+    }
+  std::ostringstream uid;
+  uid << (packet->GetUid () >> 32) - m_firstId << ':' << (packet->GetUid () & 0xffffffff);
+  return uid.str ();
+}
+
+void
+PointToPointParallelTieTest::Forward (uint32_t node, uint32_t size)
+{
+  Ptr<Packet> packet = Create<Packet> (size);
+  *m_trace->GetStream () << Simulator::Now ().GetTimeStep () << " node " << node
+                         << " sent " << GetUid (packet) << '\n';
+  m_next[node]->Send (packet, m_next[node]->GetBroadcast (), 0x800);
+}
+
+std::string
+PointToPointParallelTieTest::Simulate (std::string simulator, uint32_t threads, bool reversed, bool uids)
+{
+  ObjectFactory factory;
+  factory.SetTypeId (simulator);
+  m_multithreaded = simulator == "ns3::MultithreadedSimulatorImpl";
+  m_uids = uids;
+  if (m_multithreaded)
+    {
+      factory.Set ("ThreadCount", UintegerValue (threads));
+    }
+  Simulator::SetImplementation (factory.Create<SimulatorImpl> ());
+
+  std::vector<Ptr<Node> > nodes;
+  for (uint32_t i = 0; i < N; i++)
+    {
+      nodes.push_back (CreateObject<Node> ());
+    }
+  m_firstId = nodes[0]->GetId ();
+  m_next.clear ();
+  for (uint32_t i = 0; i < N; i++)
+    {
+      Ptr<PointToPointNetDevice> next = CreateObject<PointToPointNetDevice> ();
+      Ptr<PointToPointNetDevice> prev = CreateObject<PointToPointNetDevice> ();
+      Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+      channel->SetAttribute ("Delay", TimeValue (MilliSeconds (1)));
+      next->Attach (channel);
+      next->SetAddress (Mac48Address::Allocate ());
+      next->SetQueue (CreateObject<DropTailQueue> ());
+      prev->Attach (channel);
+      prev->SetAddress (Mac48Address::Allocate ());
+      prev->SetQueue (CreateObject<DropTailQueue> ());
+      nodes[i]->AddDevice (next);
+      nodes[(i + 1) % N]->AddDevice (prev);
+      prev->SetReceiveCallback (MakeCallback (&PointToPointParallelTieTest::Receive, this));
+      m_next.push_back (next);
+    }
+
+  std::ostringstream trace;
+  m_trace = Create<OutputStreamWrapper> (&trace);
+  m_wrongUids = 0;
+  for (uint32_t j = 0; j < N; j++)
+    {
+      uint32_t i = reversed ? N - 1 - j : j;
+      Simulator::ScheduleWithContext (nodes[i]->GetId (), MicroSeconds (10),
+                                      &PointToPointParallelTieTest::Forward, this, i, 20);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_next.clear ();
+  m_trace = 0;
+  NS_TEST_EXPECT_MSG_EQ (m_wrongUids, 0, "packets not given the uids of their node with " << threads << " threads");
+  return trace.str ();
+}
+
+void
+PointToPointParallelTieTest::DoRun (void)
+{
+  std::string expected = Simulate ("ns3::MultithreadedSimulatorImpl", 1, false, true);
+  NS_TEST_ASSERT_MSG_EQ (std::count (expected.begin (), expected.end (), '\n'), 2 * N * 20, "wrong number of trace lines");
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      std::string trace = Simulate ("ns3::MultithreadedSimulatorImpl", 4, false, true);
+      NS_TEST_ASSERT_MSG_EQ (trace, expected, "other uids or trace with 4 threads");
+    }
+
+  // simultaneous events of different nodes run in the order of the nodes,
+  // not in the order they were scheduled, as they do with DefaultSimulatorImpl
+  std::string reversed = Simulate ("ns3::MultithreadedSimulatorImpl", 4, true, true);
+  NS_TEST_ASSERT_MSG_EQ (reversed, expected, "order of the nodes' simultaneous events depends on the order they were scheduled in");
+  std::string multithreaded = Simulate ("ns3::MultithreadedSimulatorImpl", 4, true, false);
+  std::string sequential = Simulate ("ns3::DefaultSimulatorImpl", 1, true, false);
+  std::string sequentialInOrder = Simulate ("ns3::DefaultSimulatorImpl", 1, false, false);
+  NS_TEST_ASSERT_MSG_EQ (Sort (multithreaded), Sort (sequential), "other events or times than DefaultSimulatorImpl's");
+  NS_TEST_ASSERT_MSG_NE (multithreaded, sequential, "DefaultSimulatorImpl's order of simultaneous events reproduced");
+  NS_TEST_ASSERT_MSG_NE (sequentialInOrder, sequential,
+                         "DefaultSimulatorImpl's order of simultaneous events doesn't depend on the order they were scheduled in");
+}
+#endif /* HAVE_PTHREAD_H */
+
 //-----------------------------------------------------------------------------
 class PointToPointTestSuite : public TestSuite
 {
@@ -65,6 +422,10 @@ public:
 PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
+  AddTestCase (new PointToPointParallelTest);
+#ifdef HAVE_PTHREAD_H
+  AddTestCase (new PointToPointParallelTieTest);
+#endif /* HAVE_PTHREAD_H */
   AddTestCase (new PointToPointTest);
 }
 
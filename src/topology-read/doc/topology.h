@@ -11,10 +11,12 @@
  *
  * Hence, model is focused on being able to read correctly the various topology formats.
  *
- * Currently there are three models:
+ * Currently there are four models:
  * - ns3::OrbisTopologyReader for Orbis 0.7 traces (http://sysnet.ucsd.edu/~pmahadevan/topo_research/topo.html)
  * - ns3::InetTopologyReader for Inet 3.0 traces (http://topology.eecs.umich.edu/inet/)
  * - ns3::RocketfuelTopologyReader for Rocketfuel traces (http://www.cs.washington.edu/research/networking/rocketfuel/)
+ * - ns3::BinaryTopologyReader for topologies read by the others and converted by the topology-convert example,
+ *   loaded without parsing
  *
  * See the ns-3 modules manual for further informations.
  *
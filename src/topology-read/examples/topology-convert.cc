@@ -0,0 +1,75 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+// Reads a topology in one of the text formats and writes it in the binary
+// format of BinaryTopologyReader, so that simulations started many times on
+// the same map can load it without parsing it each time:
+//
+//   ./waf --run "topology-convert --format=Rocketfuel --input=1239.r0.cch --output=1239.r0.topo"
+//
+// and then read 1239.r0.topo with format Binary.
+
+#include "ns3/core-module.h"
+#include "ns3/topology-read-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("TopologyConvert");
+
+int main (int argc, char *argv[])
+{
+  std::string format ("Inet");
+  std::string input ("src/topology-read/examples/Inet_small_toposample.txt");
+  std::string output ("");
+
+  CommandLine cmd;
+  cmd.AddValue ("format", "Format of the input file [Orbis|Inet|Rocketfuel].", format);
+  cmd.AddValue ("input", "Name of the input file.", input);
+  cmd.AddValue ("output", "Name of the binary file to write (the input's name with its extension replaced by .topo if empty).", output);
+  cmd.Parse (argc, argv);
+
+  // keep the name of the map, which simulations may use to name their output
+  if (output.empty ())
+    {
+      std::string::size_type dot = input.rfind ('.');
+      if (dot == std::string::npos || input.find ('/', dot) != std::string::npos)
+        {
+          dot = input.size ();
+        }
+      output = input.substr (0, dot) + ".topo";
+    }
+
+  TopologyReaderHelper topoHelp;
+  topoHelp.SetFileName (input);
+  topoHelp.SetFileType (format);
+  Ptr<TopologyReader> inFile = topoHelp.GetTopologyReader ();
+
+  NodeContainer nodes = inFile->Read ();
+  if (inFile->LinksSize () == 0)
+    {
+      NS_LOG_ERROR ("Problems reading the topology file. Failing.");
+      return -1;
+    }
+
+  if (!BinaryTopologyReader::Write (output, nodes, inFile))
+    {
+      NS_LOG_ERROR ("Problems writing " << output << ". Failing.");
+      return -1;
+    }
+
+  std::cout << "Wrote " << nodes.GetN () << " nodes and " << inFile->LinksSize () << " links to " << output << std::endl;
+  return 0;
+}
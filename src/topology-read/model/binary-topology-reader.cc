@@ -0,0 +1,440 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "ns3/log.h"
+#include "binary-topology-reader.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("BinaryTopologyReader");
+
+NS_OBJECT_ENSURE_REGISTERED (BinaryTopologyReader);
+
+namespace {
+
+struct BinaryTopologyHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t nNodes;
+  uint32_t nRows;
+  uint32_t nLinks;
+  uint32_t nAttributes;
+  uint32_t nStrings;
+  uint64_t nStringBytes;
+};
+
+struct BinaryTopologyAttribute
+{
+  uint32_t name;
+  // NO_STRING if the value is a number
+  uint32_t string;
+  double number;
+};
+
+const char BINARY_TOPOLOGY_MAGIC[8] = {'N', 'S', '3', 'T', 'O', 'P', 'O', 'B'};
+const uint32_t BINARY_TOPOLOGY_VERSION = 1;
+const uint32_t NO_STRING = 0xffffffff;
+
+/* The sections follow the header in this order, each starting on an 8-byte boundary. */
+struct BinaryTopologyLayout
+{
+  uint64_t nodeNames;      // uint32_t[nNodes]
+  uint64_t rowNodes;       // uint32_t[nRows]
+  uint64_t rowOffsets;     // uint32_t[nRows + 1], into the links
+  uint64_t linkTargets;    // uint32_t[nLinks]
+  uint64_t linkOffsets;    // uint32_t[nLinks + 1], into the attributes
+  uint64_t attributes;     // BinaryTopologyAttribute[nAttributes]
+  uint64_t stringOffsets;  // uint32_t[nStrings + 1], into the string bytes
+  uint64_t stringBytes;    // char[nStringBytes]
+  uint64_t size;
+};
+
+uint64_t
+Align (uint64_t offset)
+{
+  return (offset + 7) & ~(uint64_t)7;
+}
+
+BinaryTopologyLayout
+GetLayout (const BinaryTopologyHeader &header)
+{
+  BinaryTopologyLayout layout;
+  layout.nodeNames = Align (sizeof (BinaryTopologyHeader));
+  layout.rowNodes = Align (layout.nodeNames + (uint64_t)header.nNodes * sizeof (uint32_t));
+  layout.rowOffsets = Align (layout.rowNodes + (uint64_t)header.nRows * sizeof (uint32_t));
+  layout.linkTargets = Align (layout.rowOffsets + ((uint64_t)header.nRows + 1) * sizeof (uint32_t));
+  layout.linkOffsets = Align (layout.linkTargets + (uint64_t)header.nLinks * sizeof (uint32_t));
+  layout.attributes = Align (layout.linkOffsets + ((uint64_t)header.nLinks + 1) * sizeof (uint32_t));
+  layout.stringOffsets = Align (layout.attributes + (uint64_t)header.nAttributes * sizeof (BinaryTopologyAttribute));
+  layout.stringBytes = Align (layout.stringOffsets + ((uint64_t)header.nStrings + 1) * sizeof (uint32_t));
+  layout.size = layout.stringBytes + header.nStringBytes;
+  return layout;
+}
+
+/* Whether the n + 1 offsets start at 0 and never decrease up to end. */
+bool
+AreOffsetsValid (const uint32_t *offsets, uint64_t n, uint64_t end)
+{
+  if (offsets[0] != 0 || offsets[n] != end)
+    {
+      return false;
+    }
+  for (uint64_t i = 0; i < n; i++)
+    {
+      if (offsets[i] > offsets[i + 1])
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+/* Whether every index in the sections of the file is in range, so that reading it can't
+   go outside of it.  The layout must already fit the file. */
+bool
+IsValid (const BinaryTopologyHeader &header, const char *data, const BinaryTopologyLayout &layout)
+{
+  const uint32_t *nodeNames = (const uint32_t *)(data + layout.nodeNames);
+  const uint32_t *rowNodes = (const uint32_t *)(data + layout.rowNodes);
+  const uint32_t *linkTargets = (const uint32_t *)(data + layout.linkTargets);
+  const BinaryTopologyAttribute *attributes = (const BinaryTopologyAttribute *)(data + layout.attributes);
+
+  if (!AreOffsetsValid ((const uint32_t *)(data + layout.rowOffsets), header.nRows, header.nLinks) ||
+      !AreOffsetsValid ((const uint32_t *)(data + layout.linkOffsets), header.nLinks, header.nAttributes) ||
+      !AreOffsetsValid ((const uint32_t *)(data + layout.stringOffsets), header.nStrings, header.nStringBytes))
+    {
+      return false;
+    }
+  for (uint32_t i = 0; i < header.nNodes; i++)
+    {
+      if (nodeNames[i] >= header.nStrings)
+        {
+          return false;
+        }
+    }
+  for (uint32_t i = 0; i < header.nRows; i++)
+    {
+      if (rowNodes[i] >= header.nNodes)
+        {
+          return false;
+        }
+    }
+  for (uint32_t i = 0; i < header.nLinks; i++)
+    {
+      if (linkTargets[i] >= header.nNodes)
+        {
+          return false;
+        }
+    }
+  for (uint32_t i = 0; i < header.nAttributes; i++)
+    {
+      if (attributes[i].name >= header.nStrings ||
+          (attributes[i].string != NO_STRING && attributes[i].string >= header.nStrings))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+/* The shortest representation of the number that reads back as the same number. */
+std::string
+FormatNumber (double number)
+{
+  char buffer[32];
+  for (int precision = 1; precision <= 17; precision++)
+    {
+      snprintf (buffer, sizeof (buffer), "%.*g", precision, number);
+      if (std::strtod (buffer, NULL) == number)
+        {
+          break;
+        }
+    }
+  return buffer;
+}
+
+/* Whether the value can be stored as a number and read back as the same string. */
+bool
+IsNumber (const std::string &value, double &number)
+{
+  if (value.empty ())
+    {
+      return false;
+    }
+  char *end;
+  number = std::strtod (value.c_str (), &end);
+  return *end == '\0' && FormatNumber (number) == value;
+}
+
+class StringTable
+{
+public:
+  uint32_t Intern (const std::string &value)
+  {
+    std::pair<std::map<std::string, uint32_t>::iterator, bool> added =
+      m_ids.insert (std::make_pair (value, (uint32_t)m_offsets.size ()));
+    if (added.second)
+      {
+        m_offsets.push_back (m_bytes.size ());
+        m_bytes.insert (m_bytes.end (), value.begin (), value.end ());
+      }
+    return added.first->second;
+  }
+  std::vector<uint32_t> GetOffsets (void) const
+  {
+    std::vector<uint32_t> offsets (m_offsets);
+    offsets.push_back (m_bytes.size ());
+    return offsets;
+  }
+  const std::vector<char> & GetBytes (void) const
+  {
+    return m_bytes;
+  }
+
+private:
+  std::map<std::string, uint32_t> m_ids;
+  std::vector<uint32_t> m_offsets;
+  std::vector<char> m_bytes;
+};
+
+template <typename T>
+void
+WriteSection (std::ofstream &file, uint64_t offset, const std::vector<T> &section)
+{
+  // pad up to where the section starts
+  static const char padding[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+  file.write (padding, offset - (uint64_t)file.tellp ());
+  if (!section.empty ())
+    {
+      file.write ((const char *)&section[0], section.size () * sizeof (T));
+    }
+}
+
+} // anonymous namespace
+
+TypeId BinaryTopologyReader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::BinaryTopologyReader")
+    .SetParent<Object> ()
+  ;
+  return tid;
+}
+
+BinaryTopologyReader::BinaryTopologyReader ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+BinaryTopologyReader::~BinaryTopologyReader ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+bool
+BinaryTopologyReader::IsBinaryTopology (std::string fileName)
+{
+  std::ifstream file (fileName.c_str (), std::ios::in | std::ios::binary);
+  char magic[sizeof (BINARY_TOPOLOGY_MAGIC)];
+  return file.read (magic, sizeof (magic)) && !std::memcmp (magic, BINARY_TOPOLOGY_MAGIC, sizeof (magic));
+}
+
+NodeContainer
+BinaryTopologyReader::Read (void)
+{
+  NodeContainer nodes;
+
+  int fd = open (GetFileName ().c_str (), O_RDONLY);
+  struct stat info;
+  if (fd < 0 || fstat (fd, &info) < 0 || (size_t)info.st_size < sizeof (BinaryTopologyHeader))
+    {
+      NS_LOG_WARN ("Couldn't open the file " << GetFileName ());
+      if (fd >= 0)
+        {
+          close (fd);
+        }
+      return nodes;
+    }
+
+  const char *data = (const char *)mmap (NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (data == MAP_FAILED)
+    {
+      NS_LOG_WARN ("Couldn't map the file " << GetFileName ());
+      return nodes;
+    }
+
+  const BinaryTopologyHeader *header = (const BinaryTopologyHeader *)data;
+  BinaryTopologyLayout layout = GetLayout (*header);
+  if (std::memcmp (header->magic, BINARY_TOPOLOGY_MAGIC, sizeof (header->magic)) ||
+      header->version != BINARY_TOPOLOGY_VERSION || layout.size != (uint64_t)info.st_size ||
+      header->nStringBytes > (uint64_t)info.st_size)
+    {
+      NS_LOG_WARN ("The file " << GetFileName () << " isn't a binary topology of this version");
+      munmap ((void *)data, info.st_size);
+      return nodes;
+    }
+  if (!IsValid (*header, data, layout))
+    {
+      NS_LOG_WARN ("The file " << GetFileName () << " is corrupt");
+      munmap ((void *)data, info.st_size);
+      return nodes;
+    }
+
+  const uint32_t *nodeNames = (const uint32_t *)(data + layout.nodeNames);
+  const uint32_t *rowNodes = (const uint32_t *)(data + layout.rowNodes);
+  const uint32_t *rowOffsets = (const uint32_t *)(data + layout.rowOffsets);
+  const uint32_t *linkTargets = (const uint32_t *)(data + layout.linkTargets);
+  const uint32_t *linkOffsets = (const uint32_t *)(data + layout.linkOffsets);
+  const BinaryTopologyAttribute *attributes = (const BinaryTopologyAttribute *)(data + layout.attributes);
+  const uint32_t *stringOffsets = (const uint32_t *)(data + layout.stringOffsets);
+  const char *stringBytes = data + layout.stringBytes;
+
+  std::vector<std::string> strings (header->nStrings);
+  for (uint32_t i = 0; i < header->nStrings; i++)
+    {
+      strings[i].assign (stringBytes + stringOffsets[i], stringBytes + stringOffsets[i + 1]);
+    }
+
+  nodes.Create (header->nNodes);
+  for (uint32_t row = 0; row < header->nRows; row++)
+    {
+      uint32_t from = rowNodes[row];
+      for (uint32_t link = rowOffsets[row]; link < rowOffsets[row + 1]; link++)
+        {
+          uint32_t to = linkTargets[link];
+          Link newLink (nodes.Get (from), strings[nodeNames[from]], nodes.Get (to), strings[nodeNames[to]]);
+          for (uint32_t attribute = linkOffsets[link]; attribute < linkOffsets[link + 1]; attribute++)
+            {
+              const BinaryTopologyAttribute &value = attributes[attribute];
+              newLink.SetAttribute (strings[value.name],
+                                    value.string == NO_STRING ? FormatNumber (value.number) : strings[value.string]);
+            }
+          AddLink (newLink);
+        }
+    }
+
+  munmap ((void *)data, info.st_size);
+
+  NS_LOG_INFO ("Binary topology created with " << nodes.GetN () << " nodes and " << LinksSize () << " links");
+  return nodes;
+}
+
+bool
+BinaryTopologyReader::Write (std::string fileName, NodeContainer nodes, Ptr<const TopologyReader> reader)
+{
+  StringTable strings;
+
+  std::map<uint32_t, uint32_t> nodeIndices;
+  std::vector<uint32_t> nodeNames (nodes.GetN (), strings.Intern (""));
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      nodeIndices[nodes.Get (i)->GetId ()] = i;
+    }
+
+  std::vector<uint32_t> rowNodes, rowOffsets, linkTargets, linkOffsets;
+  std::vector<BinaryTopologyAttribute> attributes;
+  for (ConstLinksIterator link = reader->LinksBegin (); link != reader->LinksEnd (); link++)
+    {
+      std::map<uint32_t, uint32_t>::iterator from = nodeIndices.find (link->GetFromNode ()->GetId ());
+      std::map<uint32_t, uint32_t>::iterator to = nodeIndices.find (link->GetToNode ()->GetId ());
+      if (from == nodeIndices.end () || to == nodeIndices.end ())
+        {
+          NS_LOG_WARN ("A link's node isn't among the nodes given, not writing " << fileName);
+          return false;
+        }
+      nodeNames[from->second] = strings.Intern (link->GetFromNodeName ());
+      nodeNames[to->second] = strings.Intern (link->GetToNodeName ());
+
+      // start a new row whenever the links move on to another node
+      if (rowNodes.empty () || rowNodes.back () != from->second)
+        {
+          rowNodes.push_back (from->second);
+          rowOffsets.push_back (linkTargets.size ());
+        }
+      linkTargets.push_back (to->second);
+
+      linkOffsets.push_back (attributes.size ());
+      for (TopologyReader::Link::ConstAttributesIterator attribute = link->AttributesBegin ();
+           attribute != link->AttributesEnd (); attribute++)
+        {
+          BinaryTopologyAttribute value;
+          value.name = strings.Intern (attribute->first);
+          value.string = NO_STRING;
+          value.number = 0.0;
+          if (!IsNumber (attribute->second, value.number))
+            {
+              value.string = strings.Intern (attribute->second);
+            }
+          attributes.push_back (value);
+        }
+    }
+  rowOffsets.push_back (linkTargets.size ());
+  linkOffsets.push_back (attributes.size ());
+
+  std::vector<uint32_t> stringOffsets = strings.GetOffsets ();
+
+  BinaryTopologyHeader header;
+  std::memset (&header, 0, sizeof (header));
+  std::memcpy (header.magic, BINARY_TOPOLOGY_MAGIC, sizeof (header.magic));
+  header.version = BINARY_TOPOLOGY_VERSION;
+  header.nNodes = nodes.GetN ();
+  header.nRows = rowNodes.size ();
+  header.nLinks = linkTargets.size ();
+  header.nAttributes = attributes.size ();
+  header.nStrings = stringOffsets.size () - 1;
+  header.nStringBytes = strings.GetBytes ().size ();
+  BinaryTopologyLayout layout = GetLayout (header);
+
+  std::ofstream file (fileName.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file)
+    {
+      NS_LOG_WARN ("Couldn't open the file " << fileName);
+      return false;
+    }
+  file.write ((const char *)&header, sizeof (header));
+  WriteSection (file, layout.nodeNames, nodeNames);
+  WriteSection (file, layout.rowNodes, rowNodes);
+  WriteSection (file, layout.rowOffsets, rowOffsets);
+  WriteSection (file, layout.linkTargets, linkTargets);
+  WriteSection (file, layout.linkOffsets, linkOffsets);
+  WriteSection (file, layout.attributes, attributes);
+  WriteSection (file, layout.stringOffsets, stringOffsets);
+  WriteSection (file, layout.stringBytes, strings.GetBytes ());
+  file.close ();
+
+  if (!file)
+    {
+      NS_LOG_WARN ("Couldn't write the file " << fileName);
+      return false;
+    }
+  NS_LOG_INFO ("Wrote " << header.nNodes << " nodes and " << header.nLinks << " links in "
+                        << header.nRows << " rows to " << fileName);
+  return true;
+}
+
+} /* namespace ns3 */
@@ -0,0 +1,92 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef BINARY_TOPOLOGY_READER_H
+#define BINARY_TOPOLOGY_READER_H
+
+#include "topology-reader.h"
+
+namespace ns3 {
+
+
+// ------------------------------------------------------------
+// --------------------------------------------
+/**
+ * \ingroup topology
+ *
+ * \brief Topology file reader (binary format written by Write).
+ *
+ * Parsing a large map in one of the text formats can take longer than the
+ * rest of a short simulation, so a topology read by any other reader can be
+ * written out once in this format and loaded from it afterwards without
+ * any parsing.  The file is mapped into memory and holds:
+ *
+ *  - the name of each node, in the order the original reader created them;
+ *  - the links in compressed sparse row form: each row is a run of links
+ *    from the same node, in the order the original reader added them, and
+ *    holds just the index of each link's other node;
+ *  - each link's attributes, stored as numbers when they round-trip
+ *    exactly and as strings otherwise;
+ *  - a table of all the strings, each stored once (node names, attribute
+ *    names, and values such as locations that repeat across many links).
+ *
+ * So the nodes and links read are the same, and in the same order, as
+ * those of the reader the file was written from.
+ */
+class BinaryTopologyReader : public TopologyReader
+{
+public:
+  static TypeId GetTypeId (void);
+
+  BinaryTopologyReader ();
+  virtual ~BinaryTopologyReader ();
+
+  /**
+   * \brief Main topology reading function.
+   *
+   * This method maps the binary file and creates the nodes and links it holds.
+   *
+   * \return the container of the nodes created (or empty container if there was an error)
+   */
+  virtual NodeContainer Read (void);
+
+  /**
+   * \brief Writes a topology read by another reader in this format.
+   *
+   * \param fileName the file to write
+   * \param nodes the nodes returned by the reader's Read
+   * \param reader the reader, holding the links between the nodes
+   * \return true if the file was written, false otherwise
+   */
+  static bool Write (std::string fileName, NodeContainer nodes, Ptr<const TopologyReader> reader);
+
+  /**
+   * \return true if the file is in this format, false otherwise
+   */
+  static bool IsBinaryTopology (std::string fileName);
+
+private:
+  BinaryTopologyReader (const BinaryTopologyReader&);
+  BinaryTopologyReader& operator= (const BinaryTopologyReader&);
+
+  // end class BinaryTopologyReader
+};
+
+// end namespace ns3
+};
+
+
+#endif /* BINARY_TOPOLOGY_READER_H */
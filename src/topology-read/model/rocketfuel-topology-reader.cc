@@ -24,6 +24,11 @@
 #include <sstream>
 #include <regex.h>
 #include <algorithm>
+#include <cstdio>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "ns3/log.h"
 #include "rocketfuel-topology-reader.h"
@@ -87,95 +92,364 @@ std::map<std::string, std::string> nodeAddresses;
 // whether the file contains latencies or weights
 bool isLatencies;
 
-RocketfuelTopologyReader::LatenciesMap
-RocketfuelTopologyReader::ReadLatencies (std::string filename)
+namespace {
+
+struct LatenciesCacheHeader
+{
+  char magic[8];
+  uint32_t version;
+  uint32_t nLocations;
+  uint64_t inputHash;
+  uint64_t nLatencies;
+};
+
+struct LatenciesCacheRecord
 {
-  LatenciesMap weights;
+  uint32_t from;
+  uint32_t to;
+  int64_t nanoseconds;
+};
 
-  std::ifstream weightFile;
-  weightFile.open (filename.c_str ());
+const char LATENCIES_CACHE_MAGIC[8] = {'R', 'F', 'L', 'A', 'T', 'B', 'I', 'N'};
+const uint32_t LATENCIES_CACHE_VERSION = 1;
 
-  std::istringstream lineBuffer;
-  std::string line;
-  int lineNumber = 0;
-  char errbuf[512];
-  char *buf;
+// 64-bit FNV-1a
+uint64_t
+HashBytes (const char *data, size_t length)
+{
+  uint64_t hash = 14695981039346656037ULL;
+  for (size_t i = 0; i < length; i++)
+    {
+      hash ^= (unsigned char)data[i];
+      hash *= 1099511628211ULL;
+    }
+  return hash;
+}
+
+bool
+IsLocationChar (char c)
+{
+  return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || c == ',' || c == '+' || c == '.';
+}
+
+bool
+IsDigit (char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+bool
+IsSpace (char c)
+{
+  return c == ' ' || c == '\t';
+}
 
-  if (!weightFile.is_open ())
+/* Reads "<location>[uid]" at pos, leaving pos after it; the uid is dropped
+   and the '+'s that stand for spaces in the location are replaced. */
+bool
+ReadLocation (const char *&pos, const char *end, std::string &location)
+{
+  const char *start = pos;
+  while (pos != end && IsLocationChar (*pos))
     {
-      NS_LOG_WARN ("Couldn't open the file " << filename);
-      return weights;
+      pos++;
+    }
+  if (pos == start)
+    {
+      return false;
+    }
+  location.assign (start, pos);
+  std::replace (location.begin (), location.end (), '+', ' ');
+  while (pos != end && IsDigit (*pos))
+    {
+      pos++;
     }
+  return true;
+}
 
-  while (!weightFile.eof ())
+bool
+SkipSpaces (const char *&pos, const char *end)
+{
+  const char *start = pos;
+  while (pos != end && IsSpace (*pos))
     {
-      int ret;
-      char *argv[REGMATCH_MAX];
+      pos++;
+    }
+  return pos != start;
+}
 
-      lineNumber++;
-      line.clear ();
-      lineBuffer.clear ();
+} // anonymous namespace
 
-      getline (weightFile, line);
-      if (weightFile.eof ())
-        break;
-      buf = (char *)line.c_str ();
+uint32_t
+RocketfuelLatencies::AddLocation (const std::string & location)
+{
+  std::pair<boost::unordered_map<std::string, uint32_t>::iterator, bool> added =
+    m_locationIds.insert (std::make_pair (location, (uint32_t)m_locations.size ()));
+  if (added.second)
+    {
+      m_locations.push_back (location);
+    }
+  return added.first->second;
+}
 
-      regmatch_t regmatch[REGMATCH_MAX];
-      regex_t regex;
+uint32_t
+RocketfuelLatencies::GetLocationId (const std::string & location) const
+{
+  boost::unordered_map<std::string, uint32_t>::const_iterator id = m_locationIds.find (location);
+  return id == m_locationIds.end () ? NO_LOCATION : id->second;
+}
 
-      ret = regcomp (&regex, ROCKETFUEL_WEIGHTS_LINE, REG_EXTENDED | REG_NEWLINE);
-      if (ret != 0)
+std::string
+RocketfuelLatencies::GetLocationName (uint32_t id) const
+{
+  NS_ASSERT_MSG (id < m_locations.size (), "Unknown location id " << id);
+  return m_locations[id];
+}
+
+uint32_t
+RocketfuelLatencies::GetNLocations (void) const
+{
+  return m_locations.size ();
+}
+
+uint64_t
+RocketfuelLatencies::GetKey (uint32_t from, uint32_t to)
+{
+  return ((uint64_t)from << 32) | to;
+}
+
+bool
+RocketfuelLatencies::Add (uint32_t from, uint32_t to, Time latency)
+{
+  return m_latencies.insert (std::make_pair (GetKey (from, to), latency.GetNanoSeconds ())).second;
+}
+
+bool
+RocketfuelLatencies::GetLatency (uint32_t from, uint32_t to, Time & latency) const
+{
+  boost::unordered_map<uint64_t, int64_t>::const_iterator found = m_latencies.find (GetKey (from, to));
+  if (found == m_latencies.end ())
+    {
+      found = m_latencies.find (GetKey (to, from));
+      if (found == m_latencies.end ())
         {
-          regerror (ret, &regex, errbuf, sizeof (errbuf));
-          regfree (&regex);
-          break;
+          return false;
+        }
+    }
+  latency = NanoSeconds (found->second);
+  return true;
+}
+
+bool
+RocketfuelLatencies::GetLatency (const std::string & from, const std::string & to, Time & latency) const
+{
+  uint32_t fromId = GetLocationId (from), toId = GetLocationId (to);
+  if (fromId == NO_LOCATION || toId == NO_LOCATION)
+    {
+      return false;
+    }
+  return GetLatency (fromId, toId, latency);
+}
+
+uint32_t
+RocketfuelLatencies::GetN (void) const
+{
+  return m_latencies.size ();
+}
+
+bool
+RocketfuelLatencies::Save (std::string filename, uint64_t inputHash) const
+{
+  // write it aside first so that a reader never finds half of it
+  std::string tmpFilename = filename + ".tmp";
+  std::ofstream file (tmpFilename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file)
+    {
+      NS_LOG_WARN ("Couldn't open the latencies cache " << tmpFilename);
+      return false;
+    }
+
+  LatenciesCacheHeader header;
+  std::copy (LATENCIES_CACHE_MAGIC, LATENCIES_CACHE_MAGIC + sizeof (header.magic), header.magic);
+  header.version = LATENCIES_CACHE_VERSION;
+  header.nLocations = m_locations.size ();
+  header.inputHash = inputHash;
+  header.nLatencies = m_latencies.size ();
+  file.write ((const char *)&header, sizeof (header));
+
+  for (std::vector<std::string>::const_iterator location = m_locations.begin ();
+       location != m_locations.end (); location++)
+    {
+      uint32_t length = location->size ();
+      file.write ((const char *)&length, sizeof (length));
+      file.write (location->data (), length);
+    }
+
+  std::vector<LatenciesCacheRecord> records;
+  records.reserve (m_latencies.size ());
+  for (boost::unordered_map<uint64_t, int64_t>::const_iterator latency = m_latencies.begin ();
+       latency != m_latencies.end (); latency++)
+    {
+      LatenciesCacheRecord record;
+      record.from = latency->first >> 32;
+      record.to = latency->first & 0xffffffff;
+      record.nanoseconds = latency->second;
+      records.push_back (record);
+    }
+  if (!records.empty ())
+    {
+      file.write ((const char *)&records[0], records.size () * sizeof (LatenciesCacheRecord));
+    }
+
+  file.close ();
+  if (!file || rename (tmpFilename.c_str (), filename.c_str ()) != 0)
+    {
+      NS_LOG_WARN ("Couldn't write the latencies cache " << filename);
+      unlink (tmpFilename.c_str ());
+      return false;
+    }
+  return true;
+}
+
+bool
+RocketfuelLatencies::Load (std::string filename, uint64_t inputHash)
+{
+  *this = RocketfuelLatencies ();
+
+  std::ifstream file (filename.c_str (), std::ios::in | std::ios::binary);
+  if (!file)
+    {
+      return false;
+    }
+
+  LatenciesCacheHeader header;
+  if (!file.read ((char *)&header, sizeof (header)) ||
+      !std::equal (LATENCIES_CACHE_MAGIC, LATENCIES_CACHE_MAGIC + sizeof (header.magic), header.magic) ||
+      header.version != LATENCIES_CACHE_VERSION || header.inputHash != inputHash)
+    {
+      return false;
+    }
+
+  m_locations.reserve (header.nLocations);
+  std::string location;
+  for (uint32_t i = 0; i < header.nLocations; i++)
+    {
+      uint32_t length;
+      if (!file.read ((char *)&length, sizeof (length)))
+        {
+          *this = RocketfuelLatencies ();
+          return false;
         }
+      location.resize (length);
+      if (length && !file.read (&location[0], length))
+        {
+          *this = RocketfuelLatencies ();
+          return false;
+        }
+      AddLocation (location);
+    }
 
-      ret = regexec (&regex, buf, REGMATCH_MAX, regmatch, 0);
-      if (ret == REG_NOMATCH)
+  std::vector<LatenciesCacheRecord> records (header.nLatencies);
+  if (!records.empty () &&
+      !file.read ((char *)&records[0], records.size () * sizeof (LatenciesCacheRecord)))
+    {
+      *this = RocketfuelLatencies ();
+      return false;
+    }
+  m_latencies.rehash (records.size ());
+  for (std::vector<LatenciesCacheRecord>::iterator record = records.begin (); record != records.end (); record++)
+    {
+      m_latencies[GetKey (record->from, record->to)] = record->nanoseconds;
+    }
+  return true;
+}
+
+RocketfuelLatencies
+RocketfuelTopologyReader::ReadLatencies (std::string filename, std::string cacheFilename)
+{
+  RocketfuelLatencies latencies;
+
+  int fd = open (filename.c_str (), O_RDONLY);
+  struct stat info;
+  if (fd < 0 || fstat (fd, &info) < 0)
+    {
+      NS_LOG_WARN ("Couldn't open the file " << filename);
+      if (fd >= 0)
         {
-          NS_LOG_WARN ("match failed (maps file): %s" << buf);
-          regfree (&regex);
-          break;
+          close (fd);
         }
-      
-      line = buf;
-      
-      /* regmatch[0] is the entire strings that matched */
-      for (int i = 1; i < REGMATCH_MAX; i++)
+      return latencies;
+    }
+  if (info.st_size == 0)
+    {
+      close (fd);
+      return latencies;
+    }
+
+  const char *data = (const char *)mmap (NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close (fd);
+  if (data == MAP_FAILED)
+    {
+      NS_LOG_WARN ("Couldn't map the file " << filename);
+      return latencies;
+    }
+  const char *end = data + info.st_size;
+
+  uint64_t hash = 0;
+  if (cacheFilename != "")
+    {
+      hash = HashBytes (data, info.st_size);
+      if (latencies.Load (cacheFilename, hash))
         {
-          if (regmatch[i].rm_so == -1)
-            {
-              argv[i - 1] = NULL;
-            }
-          else
-            {
-              line[regmatch[i].rm_eo] = '\0';
-              argv[i - 1] = &line[regmatch[i].rm_so];
-            }
+          NS_LOG_INFO ("Read " << latencies.GetN () << " latencies from the cache " << cacheFilename);
+          munmap ((void *)data, info.st_size);
+          return latencies;
         }
+    }
 
-      std::string loc1 = argv[0];
-      std::string loc2 = argv[2];
-      std::string weight = argv[4];
-      
-      std::replace(loc1.begin(), loc1.end(), '+', ' ');
-      std::replace(loc2.begin(), loc2.end(), '+', ' ');
+  std::string loc1, loc2, weight;
+  int lineNumber = 0;
+  for (const char *line = data; line != end; )
+    {
+      lineNumber++;
+      const char *lineEnd = std::find (line, end, '\n');
+      const char *pos = line;
+
+      // <location>[uid] <location>[uid] <latency>
+      bool match = ReadLocation (pos, lineEnd, loc1) && SkipSpaces (pos, lineEnd) &&
+        ReadLocation (pos, lineEnd, loc2) && SkipSpaces (pos, lineEnd);
+      const char *weightStart = pos;
+      while (match && pos != lineEnd && (IsDigit (*pos) || *pos == '.'))
+        {
+          pos++;
+        }
+      weight.assign (weightStart, pos);
+      while (pos != lineEnd && (IsSpace (*pos) || *pos == '\r'))
+        {
+          pos++;
+        }
+      if (!match || weight.empty () || pos != lineEnd)
+        {
+          NS_LOG_WARN ("match failed (weights file) at line " << lineNumber << ": " << std::string (line, lineEnd));
+          break;
+        }
 
-      std::string key = loc1 + " -> " + loc2;
-      
-      if (weights.find(key) == weights.end())
+      Time latency = Time::FromDouble (std::strtod (weight.c_str (), NULL), Time::MS);
+      if (latencies.Add (latencies.AddLocation (loc1), latencies.AddLocation (loc2), latency))
         {
-          NS_LOG_INFO (key << ": " << weight << "ms added");
-          weights[key] = weight;
+          NS_LOG_INFO (loc1 << " -> " << loc2 << ": " << weight << "ms added");
         }
-      
-      regfree (&regex);
+
+      line = lineEnd == end ? end : lineEnd + 1;
     }
 
-  weightFile.close ();
-  return weights;
+  munmap ((void *)data, info.st_size);
+
+  if (cacheFilename != "")
+    {
+      latencies.Save (cacheFilename, hash);
+    }
+  return latencies;
 }
 
 NodeContainer
@@ -25,9 +25,72 @@
 #include "topology-reader.h"
 //#include <map>
 #include "boost/unordered_map.hpp"
+#include <vector>
 
 namespace ns3 {
 
+/**
+ * \ingroup topology
+ *
+ * \brief Latencies of the links between the locations of a Rocketfuel weights file.
+ *
+ * Location names are interned as they're added, so looking up a link by the
+ * ids of its locations is a single hash of the two ids.  Locations are named
+ * as in the maps files, with spaces rather than '+'.
+ */
+class RocketfuelLatencies
+{
+public:
+  static const uint32_t NO_LOCATION = 0xffffffff;
+
+  /**
+   * \returns the id of the location, adding it if it's new
+   */
+  uint32_t AddLocation (const std::string & location);
+  /**
+   * \returns the id of the location, or NO_LOCATION if it hasn't been added
+   */
+  uint32_t GetLocationId (const std::string & location) const;
+  std::string GetLocationName (uint32_t id) const;
+  uint32_t GetNLocations (void) const;
+
+  /**
+   * Set the latency of the link from one location to another, unless it's already set.
+   * \returns whether it wasn't already set
+   */
+  bool Add (uint32_t from, uint32_t to, Time latency);
+  /**
+   * Finds the latency of the link from one location to another, or else of
+   * the link in the opposite direction.
+   * \returns whether either was found, setting latency if so
+   */
+  bool GetLatency (uint32_t from, uint32_t to, Time & latency) const;
+  bool GetLatency (const std::string & from, const std::string & to, Time & latency) const;
+  /**
+   * \returns the number of links with a latency
+   */
+  uint32_t GetN (void) const;
+
+  /**
+   * Write the table to a binary file tagged with the hash of the file it was read from.
+   * \returns whether it was written
+   */
+  bool Save (std::string filename, uint64_t inputHash) const;
+  /**
+   * Replace the table by one written by Save if it was tagged with the given hash.
+   * \returns whether it was, leaving the table empty if not
+   */
+  bool Load (std::string filename, uint64_t inputHash);
+
+private:
+  static uint64_t GetKey (uint32_t from, uint32_t to);
+
+  std::vector<std::string> m_locations;
+  boost::unordered_map<std::string, uint32_t> m_locationIds;
+  // in nanoseconds, keyed by GetKey
+  boost::unordered_map<uint64_t, int64_t> m_latencies;
+};
+
 
 // ------------------------------------------------------------
 // --------------------------------------------
@@ -62,9 +125,19 @@ public:
    */
   virtual NodeContainer Read (void);
 
-  //static std::map<std::string, std::string> ReadLatencies (std::string filename);
-  typedef boost::unordered_map<std::string,std::string> LatenciesMap;
-  static LatenciesMap ReadLatencies (std::string filename);
+  /**
+   * \brief Read the link latencies from a Rocketfuel weights file.
+   *
+   * Lines are "<location>[uid] <location>[uid] <latency in ms>"; the first
+   * latency given for a pair of locations is kept, and reading stops at the
+   * first line that isn't of that form.
+   *
+   * \param filename the weights file
+   * \param cacheFilename if not empty, a binary copy of the table is kept in this file
+   *        and read instead of parsing the weights file again while its contents don't change
+   * \return the latencies read (or an empty table if there was an error)
+   */
+  static RocketfuelLatencies ReadLatencies (std::string filename, std::string cacheFilename = "");
 
 private:
   RocketfuelTopologyReader (const RocketfuelTopologyReader&);
@@ -0,0 +1,164 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+//-----------------------------------------------------------------------------
+// Unit tests
+//-----------------------------------------------------------------------------
+
+#include "ns3/test.h"
+#include "ns3/binary-topology-reader.h"
+#include "ns3/simulator.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+namespace ns3 {
+
+// Holds links added by hand, as another reader would have read them
+class LinkListTopologyReader : public TopologyReader
+{
+public:
+  virtual NodeContainer Read (void)
+  {
+    return NodeContainer ();
+  }
+};
+
+class BinaryTopologyReaderTest : public TestCase
+{
+public:
+  BinaryTopologyReaderTest ();
+private:
+  virtual void DoRun (void);
+};
+
+BinaryTopologyReaderTest::BinaryTopologyReaderTest ()
+  : TestCase ("BinaryTopologyReaderTest")
+{
+}
+
+void
+BinaryTopologyReaderTest::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (5);
+
+  // links from the same node that aren't next to each other, repeated locations,
+  // numbers that do and don't round-trip, and a node without any links
+  Ptr<LinkListTopologyReader> original = CreateObject<LinkListTopologyReader> ();
+  TopologyReader::Link link (nodes.Get (0), "a", nodes.Get (1), "b");
+  link.SetAttribute ("From Location", "Atlanta, GA");
+  link.SetAttribute ("To Location", "Chicago, IL");
+  link.SetAttribute ("Latency", "7");
+  original->AddLink (link);
+  link = TopologyReader::Link (nodes.Get (2), "c", nodes.Get (0), "a");
+  link.SetAttribute ("From Location", "Chicago, IL");
+  link.SetAttribute ("Weight", "0.1");
+  link.SetAttribute ("Address", "");
+  original->AddLink (link);
+  link = TopologyReader::Link (nodes.Get (0), "a", nodes.Get (2), "c");
+  link.SetAttribute ("Weight", "1.50");
+  original->AddLink (link);
+  link = TopologyReader::Link (nodes.Get (0), "a", nodes.Get (3), "d");
+  link.SetAttribute ("Weight", "-2.5e-07");
+  original->AddLink (link);
+
+  std::string fileName = CreateTempDirFilename ("topology.topo");
+  NS_TEST_ASSERT_MSG_EQ (BinaryTopologyReader::Write (fileName, nodes, original), true, "couldn't write the topology");
+  NS_TEST_ASSERT_MSG_EQ (BinaryTopologyReader::IsBinaryTopology (fileName), true, "written file not recognized");
+
+  Ptr<BinaryTopologyReader> binary = CreateObject<BinaryTopologyReader> ();
+  binary->SetFileName (fileName);
+  NodeContainer readNodes = binary->Read ();
+  NS_TEST_ASSERT_MSG_EQ (readNodes.GetN (), nodes.GetN (), "wrong number of nodes read");
+  NS_TEST_ASSERT_MSG_EQ (binary->LinksSize (), original->LinksSize (), "wrong number of links read");
+
+  TopologyReader::ConstLinksIterator readLink = binary->LinksBegin ();
+  for (TopologyReader::ConstLinksIterator link = original->LinksBegin (); link != original->LinksEnd (); link++, readLink++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (readLink->GetFromNode (), readNodes.Get (link->GetFromNode ()->GetId () - nodes.Get (0)->GetId ()),
+                             "link from the wrong node");
+      NS_TEST_ASSERT_MSG_EQ (readLink->GetToNode (), readNodes.Get (link->GetToNode ()->GetId () - nodes.Get (0)->GetId ()),
+                             "link to the wrong node");
+      NS_TEST_ASSERT_MSG_EQ (readLink->GetFromNodeName (), link->GetFromNodeName (), "wrong name of the from node");
+      NS_TEST_ASSERT_MSG_EQ (readLink->GetToNodeName (), link->GetToNodeName (), "wrong name of the to node");
+
+      uint32_t nAttributes = 0;
+      for (TopologyReader::Link::ConstAttributesIterator attribute = readLink->AttributesBegin ();
+           attribute != readLink->AttributesEnd (); attribute++)
+        {
+          nAttributes++;
+        }
+      for (TopologyReader::Link::ConstAttributesIterator attribute = link->AttributesBegin ();
+           attribute != link->AttributesEnd (); attribute++)
+        {
+          std::string value;
+          NS_TEST_ASSERT_MSG_EQ (readLink->GetAttributeFailSafe (attribute->first, value), true,
+                                 "attribute " << attribute->first << " missing");
+          NS_TEST_ASSERT_MSG_EQ (value, attribute->second, "wrong value of attribute " << attribute->first);
+          nAttributes--;
+        }
+      NS_TEST_ASSERT_MSG_EQ (nAttributes, 0, "wrong number of attributes read");
+    }
+
+  // corrupt indices: the first node's name, the first row's node, and the second row's start
+  // past the third's; the sections follow the 40-byte header at 8-byte boundaries
+  uint32_t corruptions[][2] = {{40, 0xffffffff}, {64, 99}, {84, 3}};
+  std::ifstream written (fileName.c_str (), std::ios::in | std::ios::binary);
+  std::string bytes ((std::istreambuf_iterator<char> (written)), std::istreambuf_iterator<char> ());
+  written.close ();
+  for (uint32_t i = 0; i < sizeof (corruptions) / sizeof (corruptions[0]); i++)
+    {
+      std::string corrupt (bytes);
+      std::memcpy (&corrupt[corruptions[i][0]], &corruptions[i][1], sizeof (uint32_t));
+      std::ofstream file (fileName.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+      file.write (corrupt.data (), corrupt.size ());
+      file.close ();
+      binary = CreateObject<BinaryTopologyReader> ();
+      binary->SetFileName (fileName);
+      NS_TEST_ASSERT_MSG_EQ (binary->Read ().GetN (), 0, "nodes read from a file corrupt at byte " << corruptions[i][0]);
+      NS_TEST_ASSERT_MSG_EQ (binary->LinksSize (), 0, "links read from a file corrupt at byte " << corruptions[i][0]);
+    }
+
+  // not a binary topology
+  FILE *text = std::fopen (fileName.c_str (), "w");
+  std::fputs ("1 2\n", text);
+  std::fclose (text);
+  NS_TEST_ASSERT_MSG_EQ (BinaryTopologyReader::IsBinaryTopology (fileName), false, "text file taken for a binary topology");
+  binary = CreateObject<BinaryTopologyReader> ();
+  binary->SetFileName (fileName);
+  NS_TEST_ASSERT_MSG_EQ (binary->Read ().GetN (), 0, "nodes read from a text file");
+
+  std::remove (fileName.c_str ());
+  Simulator::Destroy ();
+}
+
+class BinaryTopologyReaderTestSuite : public TestSuite
+{
+public:
+  BinaryTopologyReaderTestSuite ();
+};
+
+BinaryTopologyReaderTestSuite::BinaryTopologyReaderTestSuite ()
+  : TestSuite ("binary-topology-reader", UNIT)
+{
+  AddTestCase (new BinaryTopologyReaderTest ());
+}
+
+static BinaryTopologyReaderTestSuite binaryTopologyReaderTestSuite;
+}
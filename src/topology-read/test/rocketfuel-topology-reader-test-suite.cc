@@ -31,6 +31,9 @@
 #include "ns3/object-factory.h"
 #include "ns3/simulator.h"
 
+#include <fstream>
+#include <cstdio>
+
 namespace ns3 {
 
 class RocketfuelTopologyReaderTest : public TestCase
@@ -72,6 +75,86 @@ RocketfuelTopologyReaderTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+class RocketfuelLatenciesTest : public TestCase
+{
+public:
+  RocketfuelLatenciesTest ();
+private:
+  virtual void DoRun (void);
+  void WriteWeights (std::string filename, std::string contents);
+};
+
+RocketfuelLatenciesTest::RocketfuelLatenciesTest ()
+  : TestCase ("RocketfuelLatenciesTest")
+{
+}
+
+void
+RocketfuelLatenciesTest::WriteWeights (std::string filename, std::string contents)
+{
+  std::ofstream file (filename.c_str ());
+  file << contents;
+}
+
+void
+RocketfuelLatenciesTest::DoRun (void)
+{
+  std::string weights = CreateTempDirFilename ("latencies.intra");
+  std::string cache = CreateTempDirFilename ("latencies.cache");
+  std::remove (cache.c_str ());
+
+  // with and without uids, a repeated pair, and a malformed line that ends the file
+  WriteWeights (weights,
+                "San+Jose,+CA4062 Anaheim,+CA4101 4\n"
+                "Weehawken,+NJ New+York,+NY 1.5\n"
+                "Anaheim,+CA4099 San+Jose,+CA4119 9\n"
+                "San+Jose,+CA4062 Anaheim,+CA4099 7\n"
+                "this line isn't a latency\n"
+                "Chicago,+IL San+Jose,+CA 16\n");
+
+  RocketfuelLatencies latencies = RocketfuelTopologyReader::ReadLatencies (weights, cache);
+  NS_TEST_ASSERT_MSG_EQ (latencies.GetN (), 3, "wrong number of latencies read");
+  NS_TEST_ASSERT_MSG_EQ (latencies.GetNLocations (), 4, "wrong number of locations read");
+  NS_TEST_ASSERT_MSG_EQ (latencies.GetLocationId ("Chicago, IL"), RocketfuelLatencies::NO_LOCATION,
+                         "read past a malformed line");
+
+  Time latency;
+  NS_TEST_ASSERT_MSG_EQ (latencies.GetLatency ("San Jose, CA", "Anaheim, CA", latency), true, "latency not found");
+  NS_TEST_ASSERT_MSG_EQ (latency, MilliSeconds (4), "the first latency given for a pair should be kept");
+  NS_TEST_ASSERT_MSG_EQ (latencies.GetLatency ("Anaheim, CA", "San Jose, CA", latency), true, "latency not found");
+  NS_TEST_ASSERT_MSG_EQ (latency, MilliSeconds (9), "the latency in the given direction should be preferred");
+  NS_TEST_ASSERT_MSG_EQ (latencies.GetLatency ("New York, NY", "Weehawken, NJ", latency), true,
+                         "the latency in the other direction should be used if there's none in this one");
+  NS_TEST_ASSERT_MSG_EQ (latency, MicroSeconds (1500), "fractional latency misread");
+  NS_TEST_ASSERT_MSG_EQ (latencies.GetLatency ("New York, NY", "Anaheim, CA", latency), false,
+                         "found a latency for a pair not in the file");
+
+  // the cache gives the same table, until the file changes
+  RocketfuelLatencies cached;
+  NS_TEST_ASSERT_MSG_EQ (cached.Load (cache, 0), false, "loaded a cache for the wrong input");
+  cached = RocketfuelTopologyReader::ReadLatencies (weights, cache);
+  NS_TEST_ASSERT_MSG_EQ (cached.GetN (), 3, "wrong number of latencies read from the cache");
+  for (uint32_t from = 0; from < latencies.GetNLocations (); from++)
+    for (uint32_t to = 0; to < latencies.GetNLocations (); to++)
+      {
+        Time original, copy;
+        bool found = latencies.GetLatency (from, to, original);
+        bool same = found == cached.GetLatency (latencies.GetLocationName (from), latencies.GetLocationName (to), copy) &&
+          original == copy;
+        NS_TEST_ASSERT_MSG_EQ (same, true, "cached latency differs from " << latencies.GetLocationName (from) <<
+                               " to " << latencies.GetLocationName (to));
+      }
+
+  WriteWeights (weights, "Chicago,+IL San+Jose,+CA 16\n");
+  latencies = RocketfuelTopologyReader::ReadLatencies (weights, cache);
+  NS_TEST_ASSERT_MSG_EQ (latencies.GetN (), 1, "stale cache used after the file changed");
+  NS_TEST_ASSERT_MSG_EQ (latencies.GetLatency ("Chicago, IL", "San Jose, CA", latency), true, "latency not found");
+  NS_TEST_ASSERT_MSG_EQ (latency, MilliSeconds (16), "wrong latency after the file changed");
+
+  std::remove (weights.c_str ());
+  std::remove (cache.c_str ());
+}
+
 class RocketfuelTopologyReaderTestSuite : public TestSuite
 {
 public:
@@ -83,6 +166,7 @@ RocketfuelTopologyReaderTestSuite::RocketfuelTopologyReaderTestSuite ()
   : TestSuite ("rocketfuel-topology-reader", UNIT)
 {
   AddTestCase (new RocketfuelTopologyReaderTest ());
+  AddTestCase (new RocketfuelLatenciesTest ());
 }
 
 static RocketfuelTopologyReaderTestSuite rocketfuelTopologyReaderTestSuite;